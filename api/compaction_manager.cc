@@ -72,6 +72,46 @@ void set_compaction_manager(http_context& ctx, routes& r) {
         });
     });
 
+    cm::get_maintenance_progress.set(r, [&ctx] (std::unique_ptr<request> req) {
+        return ctx.db.map_reduce0([](database& db) {
+            return db.get_compaction_manager().get_maintenance_progress();
+        }, std::vector<compaction_manager::maintenance_progress>(), concat<compaction_manager::maintenance_progress>).then([](const std::vector<compaction_manager::maintenance_progress>& progress) {
+            // Each shard works on its own part of a table, sum them up.
+            std::map<std::tuple<sstring, sstring, sstring>, compaction_manager::maintenance_progress> by_table;
+            for (auto& p : progress) {
+                auto [it, inserted] = by_table.try_emplace(std::make_tuple(p.ks_name, p.cf_name, sstables::compaction_name(p.type)), p);
+                if (!inserted) {
+                    it->second.total_bytes += p.total_bytes;
+                    it->second.completed_bytes += p.completed_bytes;
+                    // Operations still waiting for a maintenance slot haven't started yet.
+                    if (it->second.started_at == db_clock::time_point() || (p.started_at != db_clock::time_point() && p.started_at < it->second.started_at)) {
+                        it->second.started_at = p.started_at;
+                    }
+                }
+            }
+            auto now = db_clock::now();
+            std::vector<cm::maintenance_progress> res;
+            res.reserve(by_table.size());
+            for (auto& [key, p] : by_table) {
+                cm::maintenance_progress m;
+                m.ks = p.ks_name;
+                m.cf = p.cf_name;
+                m.task_type = std::get<2>(key);
+                m.total_bytes = p.total_bytes;
+                m.completed_bytes = p.completed_bytes;
+                m.started_at = std::chrono::duration_cast<std::chrono::milliseconds>(p.started_at.time_since_epoch()).count();
+                int64_t eta = -1;
+                if (p.completed_bytes && p.started_at != db_clock::time_point()) {
+                    auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - p.started_at).count();
+                    eta = elapsed * double(p.total_bytes - p.completed_bytes) / p.completed_bytes;
+                }
+                m.eta = eta;
+                res.push_back(std::move(m));
+            }
+            return make_ready_future<json::json_return_type>(res);
+        });
+    });
+
     cm::get_pending_tasks_by_table.set(r, [&ctx] (std::unique_ptr<request> req) {
         return ctx.db.map_reduce0([&ctx](database& db) {
             return do_with(std::unordered_map<std::pair<sstring, sstring>, uint64_t, utils::tuple_hash>(), [&ctx, &db](std::unordered_map<std::pair<sstring, sstring>, uint64_t, utils::tuple_hash>& tasks) {
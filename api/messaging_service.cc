@@ -59,7 +59,7 @@ future_json_function get_client_getter(sharded<netw::messaging_service>& ms, std
         auto get_shard_map = [f](messaging_service& ms) {
             std::unordered_map<gms::inet_address, unsigned long> map;
             ms.foreach_client([&map, f] (const msg_addr& id, const shard_info& info) {
-                map[id.addr] = f(info);
+                map[id.addr] += f(info);
             });
             return map;
         };
@@ -456,7 +456,7 @@ void set_storage_service(http_context& ctx, routes& r) {
         bool exclude_current_version = req_param<bool>(*req, "exclude_current_version", false);
 
         return ctx.db.invoke_on_all([=] (database& db) {
-            return do_for_each(column_families, [=, &db](sstring cfname) {
+            return parallel_for_each(column_families, [=, &db](sstring cfname) {
                 auto& cm = db.get_compaction_manager();
                 auto& cf = db.find_column_family(keyspace, cfname);
                 return cm.perform_sstable_upgrade(db, &cf, exclude_current_version);
@@ -1155,7 +1155,7 @@ void set_snapshot(http_context& ctx, routes& r, sharded<db::snapshot_ctl>& snap_
 
         return f.then([&ctx, keyspace, column_families, skip_corrupted] {
             return ctx.db.invoke_on_all([=] (database& db) {
-                return do_for_each(column_families, [=, &db](sstring cfname) {
+                return parallel_for_each(column_families, [=, &db](sstring cfname) {
                     auto& cm = db.get_compaction_manager();
                     auto& cf = db.find_column_family(keyspace, cfname);
                     return cm.perform_sstable_scrub(&cf, skip_corrupted);
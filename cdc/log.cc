@@ -114,6 +114,10 @@ cdc::stats::stats() {
                         sm::description(format("number of {} preimage queries performed", kind)),
                         {}),
 
+                sm::make_total_operations("preimage_selects_local_" + kind, counters.preimage_selects_local,
+                        sm::description(format("number of {} preimage queries served by the local replica", kind)),
+                        {}),
+
                 sm::make_total_operations("operations_with_preimage_" + kind, counters.with_preimage_count,
                         sm::description(format("number of {} operations that included preimage", kind)),
                         {}),
@@ -1599,7 +1603,6 @@ class transformer final : public change_processor {
 
         query::column_id_vector static_columns, regular_columns;
 
-        // TODO: this assumes all mutations touch the same set of columns. This might not be true, and we may need to do more horrible set operation here.
         if (!p.static_row().empty()) {
             // for postimage we need everything...
             if (_schema->cdc_options().postimage() || _schema->cdc_options().full_preimage()) {
@@ -1626,11 +1629,18 @@ class transformer final : public change_processor {
                     columns.emplace_back(&c);
                 }
             } else {
-                p.clustered_rows().begin()->row().cells().for_each_cell([&] (column_id id, const atomic_cell_or_collection&) {
-                    const auto& cdef =_schema->column_at(column_kind::regular_column, id);
+                // Rows may touch different columns, in particular if the mutation
+                // merges the writes of several statements.
+                one_kind_column_set touched(_schema->regular_columns_count());
+                for (const rows_entry& re : p.clustered_rows()) {
+                    re.row().cells().for_each_cell([&] (column_id id, const atomic_cell_or_collection&) {
+                        touched.set(id);
+                    });
+                }
+                for (auto id = touched.find_first(); id != one_kind_column_set::npos; id = touched.find_next(id)) {
                     regular_columns.emplace_back(id);
-                    columns.emplace_back(&cdef);
-                });
+                    columns.emplace_back(&_schema->column_at(column_kind::regular_column, id));
+                }
             }
         }
         
@@ -1646,16 +1656,35 @@ class transformer final : public change_processor {
 
         const auto select_cl = adjust_cl(write_cl);
 
+        auto to_result_set = [s = _schema, partition_slice = std::move(partition_slice), selection = std::move(selection)] (const query::result& qr) -> lw_shared_ptr<cql3::untyped_result_set> {
+            cql3::selection::result_set_builder builder(*selection, gc_clock::now(), cql_serialization_format::latest());
+            query::result_view::consume(qr, partition_slice, cql3::selection::result_set_builder::visitor(builder, *s, *selection));
+            auto result_set = builder.build();
+            if (!result_set || result_set->empty()) {
+                return {};
+            }
+            return make_lw_shared<cql3::untyped_result_set>(*result_set);
+        };
+
+        // A single replica is enough for these CLs. If it's this node, read
+        // its memtables and cache directly, the row was likely just written.
+        if ((select_cl == db::consistency_level::ONE || select_cl == db::consistency_level::LOCAL_ONE)
+                && _ctx._proxy.is_local_replica(*_schema, m.token())) {
+            auto& cdc_stats = _ctx._proxy.get_cdc_stats();
+            cdc_stats.counters_total.preimage_selects_local++;
+            return _ctx._proxy.query_singular_locally(_schema, std::move(command), partition_ranges.front(), default_timeout()).then_wrapped(
+                    [&cdc_stats, to_result_set = std::move(to_result_set)] (future<foreign_ptr<lw_shared_ptr<query::result>>> f) {
+                if (f.failed()) {
+                    cdc_stats.counters_failed.preimage_selects_local++;
+                }
+                return to_result_set(*f.get0());
+            });
+        }
+
       try {
         return _ctx._proxy.query(_schema, std::move(command), std::move(partition_ranges), select_cl, service::storage_proxy::coordinator_query_options(default_timeout(), empty_service_permit(), client_state)).then(
-                [s = _schema, partition_slice = std::move(partition_slice), selection = std::move(selection)] (service::storage_proxy::coordinator_query_result qr) -> lw_shared_ptr<cql3::untyped_result_set> {
-                    cql3::selection::result_set_builder builder(*selection, gc_clock::now(), cql_serialization_format::latest());
-                    query::result_view::consume(*qr.query_result, partition_slice, cql3::selection::result_set_builder::visitor(builder, *s, *selection));
-                    auto result_set = builder.build();
-                    if (!result_set || result_set->empty()) {
-                        return {};
-                    }
-                    return make_lw_shared<cql3::untyped_result_set>(*result_set);
+                [to_result_set = std::move(to_result_set)] (service::storage_proxy::coordinator_query_result qr) {
+            return to_result_set(*qr.query_result);
         });
       } catch (exceptions::unavailable_exception& e) {
         // `query` can throw `unavailable_exception`, which is seen by clients as ~ "NoHostAvailable". 
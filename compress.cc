@@ -73,6 +73,18 @@ std::map<sstring, sstring> compressor::options() const {
     return {};
 }
 
+size_t compressor::dictionary_size() const {
+    return 0;
+}
+
+bytes compressor::train_dictionary(const std::vector<bytes_view>& samples) const {
+    return bytes();
+}
+
+shared_ptr<compressor> compressor::with_dictionary(bytes_view dictionary) const {
+    throw std::logic_error(format("Compressor {} doesn't support dictionaries", name()));
+}
+
 shared_ptr<compressor> compressor::create(const sstring& name, const opt_getter& opts) {
     if (name.empty()) {
         return {};
@@ -23,12 +23,14 @@
 
 #include <map>
 #include <set>
+#include <vector>
 
 #include <seastar/core/future.hh>
 #include <seastar/core/shared_ptr.hh>
 #include <seastar/core/sstring.hh>
 
 #include "exceptions/exceptions.hh"
+#include "bytes.hh"
 
 
 class compressor {
@@ -64,6 +66,26 @@ class compressor {
      */
     virtual std::map<sstring, sstring> options() const;
 
+    /**
+     * Returns the size of the dictionary which should be trained for
+     * this compressor, or 0 if it doesn't use one.
+     */
+    virtual size_t dictionary_size() const;
+    /**
+     * Trains a dictionary of at most dictionary_size() bytes on samples of
+     * uncompressed data. Returns an empty dictionary if one can't be trained,
+     * e.g. because there is too little data.
+     */
+    virtual bytes train_dictionary(const std::vector<bytes_view>& samples) const;
+    /**
+     * Returns a compressor with the same options which compresses and uncompresses
+     * using the dictionary. Data compressed with a dictionary can only be
+     * uncompressed with the same one.
+     *
+     * The dictionary is not copied, it has to outlive the returned compressor.
+     */
+    virtual shared_ptr<compressor> with_dictionary(bytes_view dictionary) const;
+
     /**
      * Compressor class name.
      */
@@ -310,6 +310,7 @@ scylla_tests = set([
     'test/boost/cql_auth_query_test',
     'test/boost/cql_auth_syntax_test',
     'test/boost/cql_query_test',
+    'test/boost/cql_segment_test',
     'test/boost/cql_query_large_test',
     'test/boost/cql_query_like_test',
     'test/boost/cql_query_group_test',
@@ -332,9 +333,11 @@ scylla_tests = set([
     'test/boost/gossip_test',
     'test/boost/gossiping_property_file_snitch_test',
     'test/boost/hash_test',
+    'test/boost/iblt_test',
     'test/boost/idl_test',
     'test/boost/imr_test',
     'test/boost/input_stream_test',
+    'test/boost/intrusive_btree_test',
     'test/boost/json_cql_query_test',
     'test/boost/json_test',
     'test/boost/keys_test',
@@ -350,6 +353,7 @@ scylla_tests = set([
     'test/boost/intrusive_array_test',
     'test/boost/map_difference_test',
     'test/boost/memtable_test',
+    'test/boost/messaging_service_test',
     'test/boost/meta_test',
     'test/boost/multishard_mutation_query_test',
     'test/boost/murmur_hash_test',
@@ -368,6 +372,7 @@ scylla_tests = set([
     'test/boost/query_processor_test',
     'test/boost/range_test',
     'test/boost/range_tombstone_list_test',
+    'test/boost/replica_scores_test',
     'test/boost/reusable_buffer_test',
     'test/boost/restrictions_test',
     'test/boost/role_manager_test',
@@ -418,6 +423,7 @@ scylla_tests = set([
     'test/manual/streaming_histogram_test',
     'test/manual/sstable_scan_footprint_test',
     'test/perf/memory_footprint_test',
+    'test/perf/perf_bloom_filter',
     'test/perf/perf_cache_eviction',
     'test/perf/perf_cql_parser',
     'test/perf/perf_fast_forward',
@@ -579,6 +585,8 @@ scylla_core = (['database.cc',
                 'sstables/mp_row_consumer.cc',
                 'sstables/sstables.cc',
                 'sstables/sstables_manager.cc',
+                'sstables/partition_index_cache.cc',
+                'sstables/range_hashes.cc',
                 'sstables/sstable_set.cc',
                 'sstables/mx/writer.cc',
                 'sstables/kl/writer.cc',
@@ -589,6 +597,7 @@ scylla_core = (['database.cc',
                 'sstables/compaction_strategy.cc',
                 'sstables/size_tiered_compaction_strategy.cc',
                 'sstables/leveled_compaction_strategy.cc',
+                'sstables/incremental_compaction_strategy.cc',
                 'sstables/time_window_compaction_strategy.cc',
                 'sstables/compaction_manager.cc',
                 'sstables/integrity_checked_file_impl.cc',
@@ -601,6 +610,7 @@ scylla_core = (['database.cc',
                 'transport/cql_protocol_extension.cc',
                 'transport/event.cc',
                 'transport/event_notifier.cc',
+                'transport/segment.cc',
                 'transport/server.cc',
                 'transport/controller.cc',
                 'transport/messages/result_message.cc',
@@ -686,6 +696,7 @@ scylla_core = (['database.cc',
                 'service/priority_manager.cc',
                 'service/migration_manager.cc',
                 'service/storage_proxy.cc',
+                'service/replica_scores.cc',
                 'service/paxos/proposal.cc',
                 'service/paxos/prepare_response.cc',
                 'service/paxos/paxos_state.cc',
@@ -733,6 +744,7 @@ scylla_core = (['database.cc',
                 'db/view/view.cc',
                 'db/view/view_update_generator.cc',
                 'db/view/row_locking.cc',
+                'db/view/base_read_batcher.cc',
                 'db/sstables-format-selector.cc',
                 'db/snapshot-ctl.cc',
                 'index/secondary_index_manager.cc',
@@ -744,6 +756,7 @@ scylla_core = (['database.cc',
                 'utils/rate_limiter.cc',
                 'utils/file_lock.cc',
                 'utils/dynamic_bitset.cc',
+                'utils/iblt.cc',
                 'utils/managed_bytes.cc',
                 'utils/exceptions.cc',
                 'utils/config_file.cc',
@@ -949,6 +962,7 @@ idls = ['idl/gossip_digest.idl.hh',
         'idl/view.idl.hh',
         'idl/messaging_service.idl.hh',
         'idl/paxos.idl.hh',
+        'idl/replica_load.idl.hh',
         ]
 
 headers = find_headers('.', excluded_dirs=['idl', 'build', 'seastar', '.git'])
@@ -1007,6 +1021,7 @@ pure_boost_tests = set([
     'test/boost/dynamic_bitset_test',
     'test/boost/enum_option_test',
     'test/boost/enum_set_test',
+    'test/boost/iblt_test',
     'test/boost/idl_test',
     'test/boost/json_test',
     'test/boost/keys_test',
@@ -1018,11 +1033,13 @@ pure_boost_tests = set([
     'test/boost/observable_test',
     'test/boost/range_test',
     'test/boost/range_tombstone_list_test',
+    'test/boost/replica_scores_test',
     'test/boost/serialization_test',
     'test/boost/small_vector_test',
     'test/boost/top_k_test',
     'test/boost/vint_serialization_test',
     'test/boost/bptree_test',
+    'test/boost/intrusive_btree_test',
     'test/manual/streaming_histogram_test',
 ])
 
@@ -1032,6 +1049,7 @@ tests_not_using_seastar_test_framework = set([
     'test/manual/gossip',
     'test/manual/message',
     'test/perf/memory_footprint_test',
+    'test/perf/perf_bloom_filter',
     'test/perf/perf_cache_eviction',
     'test/perf/perf_cql_parser',
     'test/perf/perf_hash',
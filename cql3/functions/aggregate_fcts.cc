@@ -63,6 +63,9 @@ class impl_count_function : public aggregate_function::aggregate {
     virtual void add_input(cql_serialization_format sf, const std::vector<opt_bytes>& values) override {
         ++_count;
     }
+    virtual void add_repeated_input(cql_serialization_format sf, const std::vector<opt_bytes>& values, uint64_t n) override {
+        _count += n;
+    }
 };
 
 class count_rows_function final : public native_aggregate_function {
@@ -76,6 +79,56 @@ class count_rows_function final : public native_aggregate_function {
     }
 };
 
+template <typename T>
+struct aggregate_type_for {
+    using type = T;
+};
+
+template<>
+struct aggregate_type_for<ascii_native_type> {
+    using type = ascii_native_type::primary_type;
+};
+
+template<>
+struct aggregate_type_for<simple_date_native_type> {
+    using type = simple_date_native_type::primary_type;
+};
+
+template<>
+struct aggregate_type_for<timeuuid_native_type> {
+    using type = timeuuid_native_type::primary_type;
+};
+
+template<>
+struct aggregate_type_for<time_native_type> {
+    using type = time_native_type::primary_type;
+};
+
+// Decodes an aggregate input.
+//
+// Fixed-size numeric values are read straight from their serialized form,
+// which saves the allocation of a data_value for every aggregated cell.
+// Everything else, including empty values, goes through deserialize().
+template <typename Type>
+typename aggregate_type_for<Type>::type deserialize_input(const bytes& v) {
+    using native_type = typename aggregate_type_for<Type>::type;
+    if constexpr (std::is_arithmetic_v<native_type> && !std::is_same_v<native_type, bool>) {
+        if (v.size() == sizeof(native_type)) {
+            if constexpr (std::is_integral_v<native_type>) {
+                return read_simple_exactly<native_type>(v);
+            } else {
+                using int_type = std::conditional_t<sizeof(native_type) == sizeof(uint32_t), uint32_t, uint64_t>;
+                static_assert(sizeof(int_type) == sizeof(native_type));
+                auto i = read_simple_exactly<int_type>(v);
+                native_type ret;
+                std::memcpy(&ret, &i, sizeof(ret));
+                return ret;
+            }
+        }
+    }
+    return value_cast<native_type>(data_type_for<Type>()->deserialize(v));
+}
+
 // We need a wider accumulator for sum and average,
 // since summing the inputs can overflow the input type
 template <typename T>
@@ -124,7 +177,7 @@ class impl_sum_function_for final : public aggregate_function::aggregate {
         if (!values[0]) {
             return;
         }
-        _sum += value_cast<Type>(data_type_for<Type>()->deserialize(*values[0]));
+        _sum += deserialize_input<Type>(*values[0]);
     }
 };
 
@@ -182,7 +235,7 @@ class impl_avg_function_for final : public aggregate_function::aggregate {
             return;
         }
         ++_count;
-        _sum += value_cast<Type>(data_type_for<Type>()->deserialize(*values[0]));
+        _sum += deserialize_input<Type>(*values[0]);
     }
 };
 
@@ -202,31 +255,6 @@ make_avg_function() {
     return make_shared<avg_function_for<Type>>();
 }
 
-template <typename T>
-struct aggregate_type_for {
-    using type = T;
-};
-
-template<>
-struct aggregate_type_for<ascii_native_type> {
-    using type = ascii_native_type::primary_type;
-};
-
-template<>
-struct aggregate_type_for<simple_date_native_type> {
-    using type = simple_date_native_type::primary_type;
-};
-
-template<>
-struct aggregate_type_for<timeuuid_native_type> {
-    using type = timeuuid_native_type::primary_type;
-};
-
-template<>
-struct aggregate_type_for<time_native_type> {
-    using type = time_native_type::primary_type;
-};
-
 template <typename Type>
 const Type& max_wrapper(const Type& t1, const Type& t2) {
     using std::max;
@@ -258,7 +286,7 @@ class impl_max_function_for final : public aggregate_function::aggregate {
         if (!values[0]) {
             return;
         }
-        auto val = value_cast<typename aggregate_type_for<Type>::type>(data_type_for<Type>()->deserialize(*values[0]));
+        auto val = deserialize_input<Type>(*values[0]);
         if (!_max) {
             _max = val;
         } else {
@@ -354,7 +382,7 @@ class impl_min_function_for final : public aggregate_function::aggregate {
         if (!values[0]) {
             return;
         }
-        auto val = value_cast<typename aggregate_type_for<Type>::type>(data_type_for<Type>()->deserialize(*values[0]));
+        auto val = deserialize_input<Type>(*values[0]);
         if (!_min) {
             _min = val;
         } else {
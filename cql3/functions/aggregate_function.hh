@@ -79,6 +79,19 @@ class aggregate_function : public virtual function {
          */
         virtual void add_input(cql_serialization_format sf, const std::vector<opt_bytes>& values) = 0;
 
+        /**
+         * Adds the same input \p n times to this aggregate.
+         *
+         * @param protocol_version native protocol version
+         * @param values the values to add to the aggregate.
+         * @param n the number of times to add them.
+         */
+        virtual void add_repeated_input(cql_serialization_format sf, const std::vector<opt_bytes>& values, uint64_t n) {
+            while (n--) {
+                add_input(sf, values);
+            }
+        }
+
         /**
          * Computes and returns the aggregate current value.
          *
@@ -26,6 +26,9 @@
 
 namespace cql3 {
 
+// Feeds the rows of a query::result directly to a result set visitor, such as
+// the CQL response writer, without materializing a result_set. Only usable
+// for selections which don't transform the values and don't need post-filtering.
 class result_generator {
     schema_ptr _schema;
     foreign_ptr<lw_shared_ptr<query::result>> _result;
@@ -36,8 +39,11 @@ class result_generator {
     template<typename Visitor>
     class query_result_visitor {
         const schema& _schema;
-        std::vector<bytes> _partition_key;
-        std::vector<bytes> _clustering_key;
+        // Views of the components of the current keys. query::result_view::consume()
+        // keeps the partition key alive until accept_partition_end() returns;
+        // the clustering key views are dropped when accept_new_row() returns.
+        std::vector<bytes_view> _partition_key;
+        std::vector<bytes_view> _clustering_key;
         uint64_t _partition_row_count = 0;
         uint64_t _total_row_count = 0;
         Visitor& _visitor;
@@ -56,7 +62,10 @@ class result_generator {
             : _schema(s), _visitor(visitor), _selection(select) { }
 
         void accept_new_partition(const partition_key& key, uint64_t row_count) {
-            _partition_key = key.explode(_schema);
+            _partition_key.clear();
+            for (bytes_view c : key.components(_schema)) {
+                _partition_key.push_back(c);
+            }
             accept_new_partition(row_count);
         }
         void accept_new_partition(uint64_t row_count) {
@@ -66,8 +75,12 @@ class result_generator {
 
         void accept_new_row(const clustering_key& key, query::result_row_view static_row,
                             query::result_row_view row) {
-            _clustering_key = key.explode(_schema);
+            _clustering_key.clear();
+            for (bytes_view c : key.components(_schema)) {
+                _clustering_key.push_back(c);
+            }
             accept_new_row(static_row, row);
+            _clustering_key.clear();
         }
         void accept_new_row(query::result_row_view static_row, query::result_row_view row) {
             auto static_row_iterator = static_row.iterator();
@@ -76,11 +89,11 @@ class result_generator {
             for (auto&& def : _selection.get_columns()) {
                 switch (def->kind) {
                 case column_kind::partition_key:
-                    _visitor.accept_value(query::result_bytes_view(bytes_view(_partition_key[def->component_index()])));
+                    _visitor.accept_value(query::result_bytes_view(_partition_key[def->component_index()]));
                     break;
                 case column_kind::clustering_key:
                     if (_clustering_key.size() > def->component_index()) {
-                        _visitor.accept_value(query::result_bytes_view(bytes_view(_clustering_key[def->component_index()])));
+                        _visitor.accept_value(query::result_bytes_view(_clustering_key[def->component_index()]));
                     } else {
                         _visitor.accept_value({});
                     }
@@ -103,7 +116,7 @@ class result_generator {
                 auto static_row_iterator = static_row.iterator();
                 for (auto&& def : _selection.get_columns()) {
                     if (def->is_partition_key()) {
-                        _visitor.accept_value(query::result_bytes_view(bytes_view(_partition_key[def->component_index()])));
+                        _visitor.accept_value(query::result_bytes_view(_partition_key[def->component_index()]));
                     } else if (def->is_static()) {
                         accept_cell_value(*def, static_row_iterator);
                     } else {
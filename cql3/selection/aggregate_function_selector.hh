@@ -65,6 +65,14 @@ class aggregate_function_selector : public abstract_function_selector_for<functi
         _aggregate->add_input(sf, _args);
     }
 
+    virtual bool counts_rows() const override {
+        return _arg_selectors.empty();
+    }
+
+    virtual void add_rows(cql_serialization_format sf, result_set_builder& rs, uint64_t n) override {
+        _aggregate->add_repeated_input(sf, _args, n);
+    }
+
     virtual bytes_opt get_output(cql_serialization_format sf) override {
         return _aggregate->compute(sf);
     }
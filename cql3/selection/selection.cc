@@ -39,6 +39,7 @@
  * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <boost/algorithm/cxx11/all_of.hpp>
 #include <boost/range/adaptors.hpp>
 #include <boost/range/algorithm/equal.hpp>
 #include <boost/range/algorithm/transform.hpp>
@@ -212,6 +213,16 @@ class selection_with_processing : public selection {
                 s->add_input(sf, rs);
             }
         }
+
+        virtual bool counts_rows() const override {
+            return boost::algorithm::all_of(_selectors, [] (auto& s) { return s->counts_rows(); });
+        }
+
+        virtual void add_rows(cql_serialization_format sf, result_set_builder& rs, uint64_t n) override {
+            for (auto&& s : _selectors) {
+                s->add_rows(sf, rs, n);
+            }
+        }
     };
 
     std::unique_ptr<selectors> new_selectors() const override  {
@@ -281,6 +292,7 @@ result_set_builder::result_set_builder(const selection& s, gc_clock::time_point
     , _group_by_cell_indices(std::move(group_by_cell_indices))
     , _last_group(_group_by_cell_indices.size())
     , _group_began(false)
+    , _counts_rows(_group_by_cell_indices.empty() && _selectors->counts_rows())
     , _now(now)
     , _cql_serialization_format(sf)
 {
@@ -375,6 +387,10 @@ void result_set_builder::new_row() {
 }
 
 std::unique_ptr<result_set> result_set_builder::build() {
+    if (_counted_rows) {
+        _selectors->add_rows(_cql_serialization_format, *this, _counted_rows);
+        _counted_rows = 0;
+    }
     process_current_row(/*more_rows_coming=*/false);
     if (_result_set->empty() && _selectors->is_aggregate()) {
         _result_set->add_row(_selectors->get_output_row(_cql_serialization_format));
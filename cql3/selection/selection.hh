@@ -83,6 +83,22 @@ class selectors {
     virtual std::vector<bytes_opt> get_output_row(cql_serialization_format sf) = 0;
 
     virtual void reset() = 0;
+
+    /**
+    * Checks if the output depends only on the number of input rows, like the output of
+    * <code>SELECT count(*)</code>. If so, the rows can be added with <code>add_rows()</code>
+    * without extracting their values.
+    */
+    virtual bool counts_rows() const {
+        return false;
+    }
+
+    /**
+    * Adds \p n rows at once. Only valid if <code>counts_rows()</code> is true.
+    */
+    virtual void add_rows(cql_serialization_format sf, result_set_builder& rs, uint64_t n) {
+        assert(0);
+    }
 };
 
 class selection {
@@ -251,6 +267,8 @@ class result_set_builder {
     const std::vector<size_t> _group_by_cell_indices; ///< Indices in \c current of cells holding GROUP BY values.
     std::vector<bytes_opt> _last_group; ///< Previous row's group: all of GROUP BY column values.
     bool _group_began; ///< Whether a group began being formed.
+    const bool _counts_rows; ///< Whether rows are only counted; see selectors::counts_rows().
+    uint64_t _counted_rows = 0; ///< Rows counted, but not yet added to _selectors.
 public:
     std::optional<std::vector<bytes_opt>> current;
 private:
@@ -318,6 +336,14 @@ class result_set_builder {
     void add(const column_definition& def, const query::result_atomic_cell_view& c);
     void add_collection(const column_definition& def, bytes_view c);
     void new_row();
+    /// True iff the selection only counts rows, so accepted rows should be passed to
+    /// add_counted_row() instead of having their values added.
+    bool counts_rows() const {
+        return _counts_rows;
+    }
+    void add_counted_row() {
+        ++_counted_rows;
+    }
     std::unique_ptr<result_set> build();
     api::timestamp_type timestamp_of(size_t idx);
     int32_t ttl_of(size_t idx);
@@ -384,6 +410,10 @@ class result_set_builder {
             if (!_filter(_selection, _partition_key, _clustering_key, static_row, &row)) {
                 return;
             }
+            if (_builder.counts_rows()) {
+                _builder.add_counted_row();
+                return;
+            }
             _builder.new_row();
             for (auto&& def : _selection.get_columns()) {
                 switch (def->kind) {
@@ -414,6 +444,10 @@ class result_set_builder {
                 if (!_filter(_selection, _partition_key, _clustering_key, static_row, nullptr)) {
                     return _filter.get_rows_dropped();
                 }
+                if (_builder.counts_rows()) {
+                    _builder.add_counted_row();
+                    return _filter.get_rows_dropped();
+                }
                 _builder.new_row();
                 auto static_row_iterator = static_row.iterator();
                 for (auto&& def : _selection.get_columns()) {
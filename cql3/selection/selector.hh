@@ -102,6 +102,30 @@ class selector : public assignment_testable {
         return false;
     }
 
+    /**
+     * Checks if the output of this <code>selector</code> depends only on the number of rows it was given,
+     * and not on their values, like the output of <code>count(*)</code>.
+     *
+     * @return <code>true</code> if this <code>selector</code> only counts rows, <code>false</code> otherwise.
+     */
+    virtual bool counts_rows() const {
+        return false;
+    }
+
+    /**
+     * Adds \p n rows at once. Only called if <code>counts_rows()</code> is true, so the values
+     * of the rows are not available from the <code>result_set_builder</code>.
+     *
+     * @param protocol_version protocol version used for serialization
+     * @param rs the <code>result_set_builder</code>
+     * @param n the number of rows
+     */
+    virtual void add_rows(cql_serialization_format sf, result_set_builder& rs, uint64_t n) {
+        while (n--) {
+            add_input(sf, rs);
+        }
+    }
+
     /**
      * Reset the internal state of this <code>selector</code>.
      */
@@ -66,6 +66,7 @@ const sstring cf_prop_defs::KW_MIN_INDEX_INTERVAL = "min_index_interval";
 const sstring cf_prop_defs::KW_MAX_INDEX_INTERVAL = "max_index_interval";
 const sstring cf_prop_defs::KW_SPECULATIVE_RETRY = "speculative_retry";
 const sstring cf_prop_defs::KW_BF_FP_CHANCE = "bloom_filter_fp_chance";
+const sstring cf_prop_defs::KW_BF_TYPE = "bloom_filter_type";
 const sstring cf_prop_defs::KW_MEMTABLE_FLUSH_PERIOD = "memtable_flush_period_in_ms";
 
 const sstring cf_prop_defs::KW_COMPACTION = "compaction";
@@ -106,7 +107,8 @@ void cf_prop_defs::validate(const database& db, const schema::extensions_map& sc
         KW_GCGRACESECONDS, KW_CACHING, KW_DEFAULT_TIME_TO_LIVE,
         KW_MIN_INDEX_INTERVAL, KW_MAX_INDEX_INTERVAL, KW_SPECULATIVE_RETRY,
         KW_BF_FP_CHANCE, KW_MEMTABLE_FLUSH_PERIOD, KW_COMPACTION,
-        KW_COMPRESSION, KW_CRC_CHECK_CHANCE, KW_ID, KW_PAXOSGRACESECONDS
+        KW_COMPRESSION, KW_CRC_CHECK_CHANCE, KW_ID, KW_PAXOSGRACESECONDS,
+        KW_BF_TYPE
     });
     static std::set<sstring> obsolete_keywords({
         sstring("index_interval"),
@@ -145,6 +147,12 @@ void cf_prop_defs::validate(const database& db, const schema::extensions_map& sc
         }
         compression_parameters cp(*compression_options);
         cp.validate();
+        // Older nodes can't read sstables with a CompressionDictionary component,
+        // e.g. after streaming.
+        auto compressor = cp.get_compressor();
+        if (compressor && compressor->dictionary_size() && !db.features().cluster_supports_zstd_compression_dictionary()) {
+            throw exceptions::configuration_exception(KW_COMPRESSION + " can't use a dictionary unless whole cluster supports it");
+        }
     }
 
     if (auto caching_options = get_caching_options(); caching_options && !caching_options->enabled() && !db.features().cluster_supports_per_table_caching()) {
@@ -156,6 +164,18 @@ void cf_prop_defs::validate(const database& db, const schema::extensions_map& sc
         throw exceptions::configuration_exception("CDC not supported by the cluster");
     }
 
+    if (has_property(KW_BF_TYPE)) {
+        utils::filter_type bf_type;
+        try {
+            bf_type = get_bloom_filter_type();
+        } catch (const std::invalid_argument& e) {
+            throw exceptions::configuration_exception(e.what());
+        }
+        if (bf_type != utils::filter_type::classic && !db.features().cluster_supports_split_block_bloom_filter()) {
+            throw exceptions::configuration_exception(KW_BF_TYPE + " can't be set to " + format("{}", bf_type) + " unless whole cluster supports it");
+        }
+    }
+
     validate_minimum_int(KW_DEFAULT_TIME_TO_LIVE, 0, DEFAULT_DEFAULT_TIME_TO_LIVE);
 
     auto min_index_interval = get_int(KW_MIN_INDEX_INTERVAL, DEFAULT_MIN_INDEX_INTERVAL);
@@ -200,6 +220,10 @@ int32_t cf_prop_defs::get_paxos_grace_seconds() const {
     return get_int(KW_PAXOSGRACESECONDS, DEFAULT_GC_GRACE_SECONDS);
 }
 
+utils::filter_type cf_prop_defs::get_bloom_filter_type() const {
+    return utils::filter_type_from_string(get_string(KW_BF_TYPE, "classic"));
+}
+
 std::optional<utils::UUID> cf_prop_defs::get_id() const {
     auto id = get_simple(KW_ID);
     if (id) {
@@ -255,6 +279,10 @@ void cf_prop_defs::apply_to_builder(schema_builder& builder, schema::extensions_
         builder.set_paxos_grace_seconds(get_paxos_grace_seconds());
     }
 
+    if (has_property(KW_BF_TYPE)) {
+        builder.set_bloom_filter_type(get_bloom_filter_type());
+    }
+
     std::optional<sstring> tmp_value = {};
     if (has_property(KW_COMPACTION)) {
         if (get_compaction_options().contains(KW_MINCOMPACTIONTHRESHOLD)) {
@@ -73,6 +73,7 @@ class cf_prop_defs : public property_definitions {
     static const sstring KW_MAX_INDEX_INTERVAL;
     static const sstring KW_SPECULATIVE_RETRY;
     static const sstring KW_BF_FP_CHANCE;
+    static const sstring KW_BF_TYPE;
     static const sstring KW_MEMTABLE_FLUSH_PERIOD;
 
     static const sstring KW_COMPACTION;
@@ -119,6 +120,7 @@ class cf_prop_defs : public property_definitions {
     int32_t get_default_time_to_live() const;
     int32_t get_gc_grace_seconds() const;
     int32_t get_paxos_grace_seconds() const;
+    utils::filter_type get_bloom_filter_type() const;
     std::optional<utils::UUID> get_id() const;
 
     void apply_to_builder(schema_builder& builder, schema::extensions_map schema_extensions);
@@ -117,10 +117,14 @@ make_flush_controller(const db::config& cfg, seastar::scheduling_group sg, const
 inline
 std::unique_ptr<compaction_manager>
 make_compaction_manager(const db::config& cfg, database_config& dbcfg, abort_source& as) {
+    std::unique_ptr<compaction_manager> cm;
     if (cfg.compaction_static_shares() > 0) {
-        return std::make_unique<compaction_manager>(dbcfg.compaction_scheduling_group, service::get_local_compaction_priority(), dbcfg.available_memory, cfg.compaction_static_shares(), as);
+        cm = std::make_unique<compaction_manager>(dbcfg.compaction_scheduling_group, service::get_local_compaction_priority(), dbcfg.available_memory, cfg.compaction_static_shares(), as);
+    } else {
+        cm = std::make_unique<compaction_manager>(dbcfg.compaction_scheduling_group, service::get_local_compaction_priority(), dbcfg.available_memory, as);
     }
-    return std::make_unique<compaction_manager>(dbcfg.compaction_scheduling_group, service::get_local_compaction_priority(), dbcfg.available_memory, as);
+    cm->configure_maintenance(cfg.compaction_maintenance_concurrency(), cfg.compaction_maintenance_shares());
+    return cm;
 }
 
 lw_shared_ptr<keyspace_metadata>
@@ -371,11 +375,18 @@ database::database(const db::config& cfg, database_config dbcfg, service::migrat
             max_count_concurrent_reads,
             max_memory_system_concurrent_reads(),
             "_system_read_concurrency_sem")
+    , _row_cache_tracker(cache_tracker::register_metrics::yes)
     , _data_query_stage("data_query", &column_family::query)
     , _mutation_query_stage()
     , _apply_stage("db_apply", &database::do_apply)
     , _version(empty_version)
     , _compaction_manager(make_compaction_manager(_cfg, dbcfg, as))
+    , _compaction_maintenance_concurrency_observer(_cfg.compaction_maintenance_concurrency.observe([this] (const uint32_t&) {
+        _compaction_manager->configure_maintenance(_cfg.compaction_maintenance_concurrency(), _cfg.compaction_maintenance_shares());
+    }))
+    , _compaction_maintenance_shares_observer(_cfg.compaction_maintenance_shares.observe([this] (const float&) {
+        _compaction_manager->configure_maintenance(_cfg.compaction_maintenance_concurrency(), _cfg.compaction_maintenance_shares());
+    }))
     , _enable_incremental_backups(cfg.incremental_backups())
     , _querier_cache(dbcfg.available_memory * 0.04)
     , _large_data_handler(std::make_unique<db::cql_table_large_data_handler>(_cfg.compaction_large_partition_warning_threshold_mb()*1024*1024,
@@ -383,8 +394,8 @@ database::database(const db::config& cfg, database_config dbcfg, service::migrat
               _cfg.compaction_large_cell_warning_threshold_mb()*1024*1024,
               _cfg.compaction_rows_count_warning_threshold()))
     , _nop_large_data_handler(std::make_unique<db::nop_large_data_handler>())
-    , _user_sstables_manager(std::make_unique<sstables::sstables_manager>(*_large_data_handler, _cfg, feat))
-    , _system_sstables_manager(std::make_unique<sstables::sstables_manager>(*_nop_large_data_handler, _cfg, feat))
+    , _user_sstables_manager(std::make_unique<sstables::sstables_manager>(*_large_data_handler, _cfg, feat, _row_cache_tracker))
+    , _system_sstables_manager(std::make_unique<sstables::sstables_manager>(*_nop_large_data_handler, _cfg, feat, _row_cache_tracker))
     , _result_memory_limiter(dbcfg.available_memory / 10)
     , _data_listeners(std::make_unique<db::data_listeners>(*this))
     , _mnotifier(mn)
@@ -394,6 +405,9 @@ database::database(const db::config& cfg, database_config dbcfg, service::migrat
 {
     assert(dbcfg.available_memory != 0); // Detect misconfigured unit tests, see #7544
 
+    _user_sstables_manager->set_token_metadata(_shared_token_metadata);
+    _system_sstables_manager->set_token_metadata(_shared_token_metadata);
+
     local_schema_registry().init(*this); // TODO: we're never unbound.
     setup_metrics();
 
@@ -474,6 +488,10 @@ dirty_memory_manager::setup_collectd(sstring namestr) {
 
         sm::make_gauge(namestr +"_virtual_dirty_bytes", [this] { return virtual_dirty_memory(); },
                        sm::description("Holds the size of used memory in bytes. Compare it to \"dirty_bytes\" to see how many memory is wasted (neither used nor available).")),
+
+        sm::make_histogram(namestr + "_segment_occupancy", sm::description("Histogram of the occupancy (in percents) of the LSA segments holding memtables. "
+                                       "Sparse segments waste memory until they are compacted."),
+                       [this] { return _real_region_group.segment_occupancy_histogram(); }),
     });
 }
 
@@ -511,6 +529,17 @@ database::setup_metrics() {
         sm::make_gauge("failed_flushes", _cf_stats.failed_memtables_flushes_count,
                        sm::description("Holds the number of failed memtable flushes. "
                                        "High value in this metric may indicate a permanent failure to flush a memtable.")),
+        sm::make_derive("flushes", _cf_stats.memtables_flushed_count,
+                       sm::description("Counts the memtable flushes which completed.")),
+        sm::make_derive("flushed_bytes", _cf_stats.memtables_flushed_bytes,
+                       sm::description("Counts the bytes of memtable memory written to sstables by completed flushes. "
+                                       "Flushing falling behind the rate of writes shows in database_requests_blocked_memory.")),
+        sm::make_derive("flushed_sstables", _cf_stats.memtables_flushed_sstables,
+                       sm::description("Counts the sstables written by completed memtable flushes. "
+                                       "A large memtable is split into up to memtable_flush_segments sstables.")),
+        sm::make_derive("flush_time_ms", _cf_stats.memtables_flush_time_ms,
+                       sm::description("Counts the milliseconds spent in completed memtable flushes, from the start of the write until the cache is updated. "
+                                       "Comparing flushed_bytes to it gives the throughput of flushes.")),
     });
 
     _metrics.add_group("database", {
@@ -526,6 +555,11 @@ database::setup_metrics() {
         sm::make_derive("clustering_filter_count", _cf_stats.clustering_filter_count,
                        sm::description("Counts bloom filter invocations.")),
 
+        sm::make_gauge("sstables_range_hashes_bytes", [this] {
+                           return _user_sstables_manager->range_hashes_memory() + _system_sstables_manager->range_hashes_memory();
+                       },
+                       sm::description("Holds the memory used by the RangeHashes components loaded by repair.")),
+
         sm::make_derive("clustering_filter_sstables_checked", _cf_stats.sstables_checked_by_clustering_filter,
                        sm::description("Counts sstables checked after applying the bloom filter. "
                                        "High value indicates that bloom filter is not very efficient.")),
@@ -1154,6 +1188,7 @@ keyspace::make_column_family_config(const schema& s, const database& db) const {
     cfg.enable_cache = _config.enable_cache;
     cfg.enable_dangerous_direct_import_of_cassandra_counters = _config.enable_dangerous_direct_import_of_cassandra_counters;
     cfg.compaction_enforce_min_threshold = _config.compaction_enforce_min_threshold;
+    cfg.memtable_flush_segments = _config.memtable_flush_segments;
     cfg.dirty_memory_manager = _config.dirty_memory_manager;
     cfg.streaming_read_concurrency_semaphore = _config.streaming_read_concurrency_semaphore;
     cfg.compaction_concurrency_semaphore = _config.compaction_concurrency_semaphore;
@@ -1873,6 +1908,7 @@ database::make_keyspace_config(const keyspace_metadata& ksm) {
     }
     cfg.enable_dangerous_direct_import_of_cassandra_counters = _cfg.enable_dangerous_direct_import_of_cassandra_counters();
     cfg.compaction_enforce_min_threshold = _cfg.compaction_enforce_min_threshold;
+    cfg.memtable_flush_segments = _cfg.memtable_flush_segments;
     cfg.dirty_memory_manager = &_dirty_memory_manager;
     cfg.streaming_read_concurrency_semaphore = &_streaming_concurrency_sem;
     cfg.compaction_concurrency_semaphore = &_compaction_concurrency_sem;
@@ -81,6 +81,7 @@
 #include "db/view/view_stats.hh"
 #include "db/view/view_update_backlog.hh"
 #include "db/view/row_locking.hh"
+#include "db/view/base_read_batcher.hh"
 #include "lister.hh"
 #include "utils/phased_barrier.hh"
 #include "backlog_controller.hh"
@@ -310,6 +311,10 @@ struct cf_stats {
     int64_t pending_memtables_flushes_count = 0;
     int64_t pending_memtables_flushes_bytes = 0;
     int64_t failed_memtables_flushes_count = 0;
+    uint64_t memtables_flushed_count = 0;
+    uint64_t memtables_flushed_bytes = 0;
+    uint64_t memtables_flushed_sstables = 0;
+    uint64_t memtables_flush_time_ms = 0;
 
     // number of time the clustering filter was executed
     int64_t clustering_filter_count = 0;
@@ -380,6 +385,7 @@ class table : public enable_lw_shared_from_this<table> {
         bool enable_commitlog = true;
         bool enable_incremental_backups = false;
         utils::updateable_value<bool> compaction_enforce_min_threshold{false};
+        utils::updateable_value<uint32_t> memtable_flush_segments{1};
         bool enable_dangerous_direct_import_of_cassandra_counters = false;
         ::dirty_memory_manager* dirty_memory_manager = &default_dirty_memory_manager;
         reader_concurrency_semaphore* streaming_read_concurrency_semaphore;
@@ -425,6 +431,13 @@ class table : public enable_lw_shared_from_this<table> {
     lw_shared_ptr<memtable_list> make_memtable_list();
 
     sstables::compaction_strategy _compaction_strategy;
+    // Dictionary for the table's compressor, if it supports one. Trained by compaction
+    // from samples of its input and used by all sstables written afterwards.
+    // Until the first training, the dictionary of the most recent sstable loaded
+    // from disk is used, so it survives restarts.
+    lw_shared_ptr<const bytes> _compression_dictionary;
+    lowres_clock::time_point _compression_dictionary_trained_at;
+    std::optional<int64_t> _compression_dictionary_loaded_generation;
     // generation -> sstable. Ordered by key so we can easily get the most recent.
     lw_shared_ptr<sstables::sstable_set> _sstables;
     // sstables that have been compacted (so don't look up in query) but
@@ -540,13 +553,15 @@ class table : public enable_lw_shared_from_this<table> {
     // Doesn't trigger compaction.
     // Strong exception guarantees.
     void add_sstable(sstables::shared_sstable sstable);
+    void maybe_load_compression_dictionary(const sstables::sstable& sst);
     static void add_sstable_to_backlog_tracker(compaction_backlog_tracker& tracker, sstables::shared_sstable sstable);
     static void remove_sstable_from_backlog_tracker(compaction_backlog_tracker& tracker, sstables::shared_sstable sstable);
     void load_sstable(sstables::shared_sstable& sstable, bool reset_level = false);
     lw_shared_ptr<memtable> new_memtable();
     future<stop_iteration> try_flush_memtable_to_sstable(lw_shared_ptr<memtable> memt, sstable_write_permit&& permit);
+    future<stop_iteration> flush_memtable_to_sstables(lw_shared_ptr<memtable> memt, sstable_write_permit permit);
     // Caller must keep m alive.
-    future<> update_cache(lw_shared_ptr<memtable> m, sstables::shared_sstable sst);
+    future<> update_cache(lw_shared_ptr<memtable> m, std::vector<sstables::shared_sstable> ssts);
     struct merge_comparator;
 
     // update the sstable generation, making sure that new new sstables don't overwrite this one.
@@ -822,6 +837,15 @@ class table : public enable_lw_shared_from_this<table> {
      */
     future<std::unordered_set<sstring>> get_sstables_by_partition_key(const sstring& key) const;
 
+    // Returns the combined hash of the data in the token range, built from the
+    // RangeHashes components of the sstables, see sstables::sstable::get_range_hash().
+    // Tables of two replicas with equal hashes for the range hold the same data in it.
+    //
+    // Returns a disengaged optional if the hash can't be computed without reading
+    // the data: memtables have data in the range, or some sstable in the range
+    // has no range hashes or is shared with other shards.
+    future<std::optional<uint64_t>> get_range_hash(const dht::token_range& range, const io_priority_class& pc) const;
+
     const sstables::sstable_set& get_sstable_set() const;
     lw_shared_ptr<const sstable_list> get_sstables() const;
     lw_shared_ptr<const sstable_list> get_sstables_including_compacted_undeleted() const;
@@ -845,6 +869,20 @@ class table : public enable_lw_shared_from_this<table> {
         return _compaction_strategy;
     }
 
+    lw_shared_ptr<const bytes> compression_dictionary() const {
+        return _compression_dictionary;
+    }
+
+    lowres_clock::time_point compression_dictionary_trained_at() const {
+        return _compression_dictionary_trained_at;
+    }
+
+    void set_compression_dictionary(bytes dictionary) {
+        _compression_dictionary = make_lw_shared<const bytes>(std::move(dictionary));
+        _compression_dictionary_trained_at = lowres_clock::now();
+        _compression_dictionary_loaded_generation.reset();
+    }
+
     table_stats& get_stats() const {
         return _stats;
     }
@@ -978,7 +1016,8 @@ class table : public enable_lw_shared_from_this<table> {
 
 private:
     future<row_locker::lock_holder> do_push_view_replica_updates(const schema_ptr& s, mutation&& m, db::timeout_clock::time_point timeout, mutation_source&& source,
-            tracing::trace_state_ptr tr_state, reader_concurrency_semaphore& sem, const io_priority_class& io_priority, query::partition_slice::option_set custom_opts) const;
+            tracing::trace_state_ptr tr_state, reader_concurrency_semaphore& sem, const io_priority_class& io_priority, query::partition_slice::option_set custom_opts,
+            db::view::base_read_batcher* read_batcher) const;
     std::vector<view_ptr> affected_views(const schema_ptr& base, const mutation& update, gc_clock::time_point now) const;
     future<> generate_and_propagate_view_updates(const schema_ptr& base,
             reader_permit permit,
@@ -989,6 +1028,9 @@ class table : public enable_lw_shared_from_this<table> {
             gc_clock::time_point now) const;
 
     mutable row_locker _row_locker;
+    // Reads the existing rows for view updates of regular writes. Streaming
+    // reads from a different source, so it doesn't use it.
+    mutable db::view::base_read_batcher _view_update_read_batcher;
     future<row_locker::lock_holder> local_base_lock(
             const schema_ptr& s,
             const dht::decorated_key& pk,
@@ -1091,6 +1133,7 @@ class keyspace {
         bool enable_cache = true;
         bool enable_incremental_backups = false;
         utils::updateable_value<bool> compaction_enforce_min_threshold{false};
+        utils::updateable_value<uint32_t> memtable_flush_segments{1};
         bool enable_dangerous_direct_import_of_cassandra_counters = false;
         ::dirty_memory_manager* dirty_memory_manager = &default_dirty_memory_manager;
         reader_concurrency_semaphore* streaming_read_concurrency_semaphore;
@@ -1283,6 +1326,9 @@ class database {
     uint32_t _schema_change_count = 0;
     // compaction_manager object is referenced by all column families of a database.
     std::unique_ptr<compaction_manager> _compaction_manager;
+    // Apply live updates of compaction_maintenance_{concurrency,shares} to _compaction_manager.
+    utils::observer<uint32_t> _compaction_maintenance_concurrency_observer;
+    utils::observer<float> _compaction_maintenance_shares_observer;
     seastar::metrics::metric_groups _metrics;
     bool _enable_incremental_backups = false;
     utils::UUID _local_host_id;
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2020 ScyllaDB
+ */
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "serializer.hh"
+#include "schema.hh"
+#include "utils/i_filter.hh"
+
+extern logging::logger dblog;
+
+namespace db {
+
+/**
+ * \brief Schema extension which represents `bloom_filter_type` per-table option.
+ *
+ * The option selects the layout of the bloom filter of sstables written
+ * for the table, see utils::filter_type. It only affects new sstables,
+ * existing ones keep the filter they were written with.
+ */
+class bloom_filter_type_extension : public schema_extension {
+    utils::filter_type _type = utils::filter_type::classic;
+public:
+    static constexpr auto NAME = "bloom_filter_type";
+
+    bloom_filter_type_extension() = default;
+
+    explicit bloom_filter_type_extension(utils::filter_type type)
+        : _type(type)
+    {}
+
+    explicit bloom_filter_type_extension(const std::map<sstring, sstring>& map) {
+        on_internal_error(dblog, "Cannot create bloom_filter_type_extension from map");
+    }
+
+    explicit bloom_filter_type_extension(bytes b) : _type(deserialize(b))
+    {}
+
+    explicit bloom_filter_type_extension(const sstring& s)
+        : _type(utils::filter_type_from_string(s))
+    {}
+
+    bytes serialize() const override {
+        return ser::serialize_to_buffer<bytes>(format("{}", _type));
+    }
+
+    static utils::filter_type deserialize(const bytes_view& buffer) {
+        return utils::filter_type_from_string(ser::deserialize_from_buffer(buffer, boost::type<sstring>()));
+    }
+
+    utils::filter_type get_bloom_filter_type() const {
+        return _type;
+    }
+};
+
+} // namespace db
@@ -74,6 +74,7 @@
 #include "utils/crc.hh"
 #include "utils/runtime.hh"
 #include "utils/flush_queue.hh"
+#include "utils/estimated_histogram.hh"
 #include "log.hh"
 #include "commitlog_entry.hh"
 #include "commitlog_extensions.hh"
@@ -133,6 +134,10 @@ db::commitlog::config db::commitlog::config::from_db_config(const db::config& cf
     c.extensions = &cfg.extensions();
     c.reuse_segments = cfg.commitlog_reuse_segments();
     c.use_o_dsync = cfg.commitlog_use_o_dsync();
+    c.group_commit_window_in_us = cfg.commitlog_group_commit_window_in_us();
+    c.group_commit_max_bytes = cfg.commitlog_group_commit_max_bytes();
+    c.max_reserve_segments = std::max(cfg.commitlog_max_reserve_segments(), 1u);
+    c.min_reserve_segments = std::min<uint64_t>(std::max(cfg.commitlog_min_reserve_segments(), 1u), c.max_reserve_segments);
 
     return c;
 }
@@ -265,6 +270,14 @@ class db::commitlog::segment_manager : public ::enable_shared_from_this<segment_
         // size allocated on disk - i.e. files created (new, reserve, recycled)
         uint64_t total_size_on_disk = 0;
         uint64_t requests_blocked_memory = 0;
+        // flushes which didn't need an fdatasync, since the segment is written with O_DSYNC
+        uint64_t flushes_elided = 0;
+        // new segments which had to wait for the reserve to be replenished
+        uint64_t segment_allocation_stalls = 0;
+        uint64_t segment_allocation_stall_us = 0;
+        // entries per batch mode group commit, and how long (us) they waited for the window to close
+        utils::estimated_histogram group_commit_batch_size;
+        utils::estimated_histogram group_commit_wait_us;
     };
 
     stats totals;
@@ -471,6 +484,12 @@ class db::commitlog::segment : public enable_shared_from_this<segment>, public c
 
     std::unordered_set<table_schema_version> _known_schema_versions;
 
+    // Open group commit window, see wait_for_group_commit().
+    std::optional<shared_promise<with_clock<db::timeout_clock>>> _group_commit;
+    timer<> _group_commit_timer;
+    std::chrono::steady_clock::time_point _group_commit_opened_at;
+    uint64_t _group_commit_entries = 0;
+
     friend std::ostream& operator<<(std::ostream&, const segment&);
     friend class segment_manager;
 
@@ -512,7 +531,8 @@ class db::commitlog::segment : public enable_shared_from_this<segment>, public c
             : _segment_manager(std::move(m)), _desc(std::move(d)), _file(std::move(f)),
         _file_name(_segment_manager->cfg.commit_log_location + "/" + _desc.filename()), 
         _size_on_disk(initial_disk_size),
-        _sync_time(clock_type::now()), _pending_ops(true) // want exception propagation
+        _sync_time(clock_type::now()), _pending_ops(true), // want exception propagation
+        _group_commit_timer([this] { close_group_commit(); })
     {
         ++_segment_manager->totals.segments_created;
         clogger.debug("Created new segment {}", *this);
@@ -648,6 +668,16 @@ class db::commitlog::segment : public enable_shared_from_this<segment>, public c
                 clogger.trace("{} already synced! ({} < {})", *this, pos, _flush_pos);
                 return make_ready_future<>();
             }
+            if (_segment_manager->cfg.use_o_dsync) {
+                // Writes below pos have completed (see flush()), and with O_DSYNC
+                // each of them is durable once completed. No need for a separate
+                // round trip to the device.
+                _flush_pos = std::max(pos, _flush_pos);
+                ++_segment_manager->totals.flush_count;
+                ++_segment_manager->totals.flushes_elided;
+                clogger.trace("{} synced to {} (O_DSYNC)", *this, _flush_pos);
+                return make_ready_future<>();
+            }
             return _file.flush().then_wrapped([this, pos](future<> f) {
                 try {
                     f.get();
@@ -698,6 +728,9 @@ class db::commitlog::segment : public enable_shared_from_this<segment>, public c
      */
     // See class comment for info
     future<sseg_ptr> cycle(bool flush_after = false, bool termination = false) {
+        // Whoever waits for the group commit gets covered by this write.
+        close_group_commit();
+
         if (_buffer.empty() && !termination) {
             return flush_after ? flush() : make_ready_future<sseg_ptr>(shared_from_this());
         }
@@ -806,18 +839,57 @@ class db::commitlog::segment : public enable_shared_from_this<segment>, public c
         });
     }
 
+    /**
+     * Batch mode group commit: rather than writing and syncing on behalf of
+     * each entry as soon as possible, entries arriving within the configured
+     * window share a single segment write and sync. The window closes early
+     * once enough data is buffered, or when the buffer gets written for any
+     * other reason (see cycle()).
+     */
+    future<> wait_for_group_commit(timeout_clock::time_point timeout) {
+        auto& cfg = _segment_manager->cfg;
+        if (cfg.mode != sync_mode::BATCH || !cfg.group_commit_window_in_us) {
+            return make_ready_future<>();
+        }
+        if (!_group_commit) {
+            _group_commit.emplace();
+            _group_commit_opened_at = std::chrono::steady_clock::now();
+            _group_commit_timer.arm(std::chrono::microseconds(cfg.group_commit_window_in_us));
+        }
+        ++_group_commit_entries;
+        auto f = _group_commit->get_shared_future(timeout);
+        if (buffer_position() >= cfg.group_commit_max_bytes) {
+            close_group_commit();
+        }
+        return f;
+    }
+    void close_group_commit() {
+        if (!_group_commit) {
+            return;
+        }
+        _group_commit_timer.cancel();
+        auto& totals = _segment_manager->totals;
+        totals.group_commit_batch_size.add(std::exchange(_group_commit_entries, 0));
+        totals.group_commit_wait_us.add(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _group_commit_opened_at).count());
+        auto p = std::move(*_group_commit);
+        _group_commit = std::nullopt;
+        p.set_value();
+    }
+
     future<sseg_ptr> batch_cycle(timeout_clock::time_point timeout) {
         /**
-         * For batch mode we force a write "immediately".
-         * However, we first wait for all previous writes/flushes
-         * to complete.
+         * For batch mode we force a write "immediately", or once the
+         * group commit window closes. However, we first wait for all
+         * previous writes/flushes to complete.
          *
          * This has the benefit of allowing several allocations to
          * queue up in a single buffer.
          */
         auto me = shared_from_this();
         auto fp = _file_pos;
-        return _pending_ops.wait_for_pending(timeout).then([me, fp, timeout] {
+        return wait_for_group_commit(timeout).then([me, timeout] {
+            return me->_pending_ops.wait_for_pending(timeout);
+        }).then([me, fp, timeout] {
             if (fp != me->_file_pos) {
                 // some other request already wrote this buffer.
                 // If so, wait for the operation at our intended file offset
@@ -1057,7 +1129,7 @@ db::commitlog::segment_manager::segment_manager(config c)
     // than default_size at the end of the allocation, that allows for every valid mutation to
     // always be admitted for processing.
     , _request_controller(max_request_controller_units(), request_controller_timeout_exception_factory{})
-    , _reserve_segments(1)
+    , _reserve_segments(std::max(cfg.min_reserve_segments, uint64_t(1)))
     , _reserve_replenisher(make_ready_future<>())
 {
     assert(max_size > 0);
@@ -1207,6 +1279,28 @@ void db::commitlog::segment_manager::create_counters(const sstring& metrics_cate
         sm::make_derive("flush", totals.flush_count,
                        sm::description("Counts a number of times the flush() method was called for a file.")),
 
+        sm::make_derive("flushes_elided", totals.flushes_elided,
+                       sm::description("Counts a number of flushes which didn't need to sync the file, since segments are written with O_DSYNC.")),
+
+        sm::make_derive("segment_allocation_stalls", totals.segment_allocation_stalls,
+                       sm::description("Counts a number of times a new segment was needed but the reserve of preallocated segments was empty. "
+                                       "A non-zero value indicates that the reserve is too small to absorb the write rate.")),
+
+        sm::make_derive("segment_allocation_stall_us", totals.segment_allocation_stall_us,
+                       sm::description("Counts the total time, in microseconds, writes waited for a new segment to be created.")),
+
+        sm::make_gauge("reserve_segments", [this] { return _reserve_segments.size(); },
+                       sm::description("Holds the number of preallocated segments ready to be used.")),
+
+        sm::make_gauge("recycled_segments", [this] { return _recycled_segments.size(); },
+                       sm::description("Holds the number of finished segment files waiting to be reused.")),
+
+        sm::make_histogram("group_commit_batch_size", sm::description("Histogram of the number of entries written and synced together by a batch mode group commit."),
+                       [this] { return totals.group_commit_batch_size.get_histogram(1, 16); }),
+
+        sm::make_histogram("group_commit_wait", sm::description("Histogram of the time, in microseconds, batch mode group commits waited for more entries."),
+                       [this] { return totals.group_commit_wait_us.get_histogram(16, 16); }),
+
         sm::make_derive("bytes_written", totals.bytes_written,
                        sm::description("Counts a number of bytes written to the disk. "
                                        "Divide this value by \"alloc\" to get the average number of bytes per mutation written to the disk.")),
@@ -1409,7 +1503,19 @@ future<db::commitlog::segment_manager::sseg_ptr> db::commitlog::segment_manager:
         _reserve_segments.set_max_size(_reserve_segments.max_size() + 1);
         clogger.debug("Increased segment reserve count to {}", _reserve_segments.max_size());
     }
-    return _reserve_segments.pop_eventually().then([this] (auto s) {
+    auto f = make_ready_future<sseg_ptr>(nullptr);
+    if (_reserve_segments.empty()) {
+        // The reserve couldn't keep up, the write path has to wait for a segment to be created.
+        ++totals.segment_allocation_stalls;
+        auto start = std::chrono::steady_clock::now();
+        f = _reserve_segments.pop_eventually().then([this, start] (sseg_ptr s) {
+            totals.segment_allocation_stall_us += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+            return s;
+        });
+    } else {
+        f = make_ready_future<sseg_ptr>(_reserve_segments.pop());
+    }
+    return f.then([this] (sseg_ptr s) {
         _segments.push_back(std::move(s));
         _segments.back()->reset_sync_time();
         return make_ready_future<sseg_ptr>(_segments.back());
@@ -2163,6 +2269,18 @@ uint64_t db::commitlog::get_flush_count() const {
     return _segment_manager->totals.flush_count;
 }
 
+uint64_t db::commitlog::get_num_flushes_elided() const {
+    return _segment_manager->totals.flushes_elided;
+}
+
+const utils::estimated_histogram& db::commitlog::get_group_commit_batch_size() const {
+    return _segment_manager->totals.group_commit_batch_size;
+}
+
+uint64_t db::commitlog::get_num_segment_allocation_stalls() const {
+    return _segment_manager->totals.segment_allocation_stalls;
+}
+
 uint64_t db::commitlog::get_pending_tasks() const {
     return _segment_manager->totals.pending_flushes;
 }
@@ -52,6 +52,7 @@
 #include "utils/fragmented_temporary_buffer.hh"
 
 namespace seastar { class file; }
+namespace utils { struct estimated_histogram; }
 
 #include "seastarx.hh"
 
@@ -125,8 +126,10 @@ class commitlog {
         uint64_t commitlog_total_space_in_mb = 0;
         uint64_t commitlog_segment_size_in_mb = 32;
         uint64_t commitlog_sync_period_in_ms = 10 * 1000; //TODO: verify default!
-        // Max number of segments to keep in pre-alloc reserve.
-        // Not (yet) configurable from scylla.conf.
+        // Min and max number of segments to keep in pre-alloc reserve.
+        // The reserve starts at the min and grows every time the write
+        // path finds it empty.
+        uint64_t min_reserve_segments = 1;
         uint64_t max_reserve_segments = 12;
         // Max active writes/flushes. Default value
         // zero means try to figure it out ourselves
@@ -136,7 +139,16 @@ class commitlog {
         sync_mode mode = sync_mode::PERIODIC;
         std::string fname_prefix = descriptor::FILENAME_PREFIX;
 
+        // Batch mode only: how long a write waits for others to join its
+        // segment write and sync. Zero writes and syncs right away.
+        uint64_t group_commit_window_in_us = 0;
+        // The group commit window closes early once this much data is buffered.
+        uint64_t group_commit_max_bytes = 128 * 1024;
+
         bool reuse_segments = true;
+        // Write segments with O_DSYNC, so that written data is durable without
+        // a separate fdatasync. Segments are zero-filled upfront, so writes
+        // don't need file metadata updates either.
         bool use_o_dsync = false;
         bool warn_about_segments_left_on_disk_after_shutdown = true;
 
@@ -294,6 +306,10 @@ class commitlog {
     uint64_t get_total_size() const;
     uint64_t get_completed_tasks() const;
     uint64_t get_flush_count() const;
+    uint64_t get_num_flushes_elided() const;
+    // Number of entries written and synced together by each batch mode group commit.
+    const utils::estimated_histogram& get_group_commit_batch_size() const;
+    uint64_t get_num_segment_allocation_stalls() const;
     uint64_t get_pending_tasks() const;
     uint64_t get_pending_flushes() const;
     uint64_t get_pending_allocations() const;
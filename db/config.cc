@@ -217,10 +217,16 @@ db::config::config(std::shared_ptr<db::extensions> exts)
         "true: auto-adjust memtable shares for flush processes")
     , memtable_flush_static_shares(this, "memtable_flush_static_shares", value_status::Used, 0,
         "If set to higher than 0, ignore the controller's output and set the memtable shares statically. Do not set this unless you know what you are doing and suspect a problem in the controller. This option will be retired when the controller reaches more maturity")
+    , memtable_flush_segments(this, "memtable_flush_segments", liveness::LiveUpdate, value_status::Used, 1,
+        "The number of sstables a large memtable is split into by token range when it is flushed. The sstables are written concurrently, overlapping the serialization of some with the I/O of others. Each sstable gets at least 16MB of the memtable, so small memtables are split into fewer sstables")
     , compaction_static_shares(this, "compaction_static_shares", value_status::Used, 0,
         "If set to higher than 0, ignore the controller's output and set the compaction shares statically. Do not set this unless you know what you are doing and suspect a problem in the controller. This option will be retired when the controller reaches more maturity")
     , compaction_enforce_min_threshold(this, "compaction_enforce_min_threshold", liveness::LiveUpdate, value_status::Used, false,
         "If set to true, enforce the min_threshold option for compactions strictly. If false (default), Scylla may decide to compact even if below min_threshold")
+    , compaction_maintenance_concurrency(this, "compaction_maintenance_concurrency", liveness::LiveUpdate, value_status::Used, 2,
+        "The number of maintenance operations (major compaction, cleanup, upgradesstables and scrub) each shard runs in parallel. Operations which rewrite the most data are started first. Each running operation may temporarily need as much extra disk space as the sstables it rewrites.")
+    , compaction_maintenance_shares(this, "compaction_maintenance_shares", liveness::LiveUpdate, value_status::Used, 200,
+        "The CPU and I/O shares requested by the compaction controller while maintenance operations run, unless compaction_static_shares is set. Higher values make maintenance finish sooner at the expense of foreground latency.")
     /* Initialization properties */
     /* The minimal properties needed for configuring a cluster. */
     , cluster_name(this, "cluster_name", value_status::Used, "",
@@ -371,6 +377,14 @@ db::config::config(std::shared_ptr<db::extensions> exts)
         "Whether or not to re-use commitlog segments when finished instead of deleting them. Can improve commitlog latency on some file systems.\n")
     , commitlog_use_o_dsync(this, "commitlog_use_o_dsync", value_status::Used, true,
         "Whether or not to use O_DSYNC mode for commitlog segments IO. Can improve commitlog latency on some file systems.\n")
+    , commitlog_min_reserve_segments(this, "commitlog_min_reserve_segments", value_status::Used, 2,
+        "The number of preallocated commitlog segments each shard keeps ready for use. The reserve grows up to commitlog_max_reserve_segments when writes have to wait for a new segment.")
+    , commitlog_max_reserve_segments(this, "commitlog_max_reserve_segments", value_status::Used, 12,
+        "The maximum number of preallocated commitlog segments each shard keeps ready for use.")
+    , commitlog_group_commit_window_in_us(this, "commitlog_group_commit_window_in_us", value_status::Used, 0,
+        "With commitlog_sync: batch, how long (in microseconds) a write waits for concurrent writes so that they are written and synced to disk together. This trades some latency for far fewer syncs under heavy write load. 0 (the default) syncs each write as soon as possible.")
+    , commitlog_group_commit_max_bytes(this, "commitlog_group_commit_max_bytes", value_status::Used, 128 * 1024,
+        "A group commit is written right away, without waiting for commitlog_group_commit_window_in_us to pass, once it holds this many bytes.")
     /* Compaction settings */
     /* Related information: Configuring compaction */
     , compaction_preheat_key_cache(this, "compaction_preheat_key_cache", value_status::Unused, true,
@@ -584,7 +598,9 @@ db::config::config(std::shared_ptr<db::extensions> exts)
         "\t         Note: When selecting this option, you must change the default value (unlimited) of rpc_max_threads.\n"
         "\tYour own RPC server: You must provide a fully-qualified class name of an o.a.c.t.TServerFactory that can create a server instance.")
     , cache_hit_rate_read_balancing(this, "cache_hit_rate_read_balancing", value_status::Used, true,
-        "This boolean controls whether the replicas for read query will be choosen based on cache hit ratio")
+        "This boolean controls whether the replicas for read query will be choosen based on cache hit ratio. Ignored while adaptive_replica_selection is enabled.")
+    , adaptive_replica_selection(this, "adaptive_replica_selection", liveness::LiveUpdate, value_status::Used, true,
+        "Order the replicas of a read within the local datacenter, the local node included, by their recent response times and the load they report, so that a slow replica is avoided. Replaces cache_hit_rate_read_balancing while enabled.")
     /* Advanced fault detection settings */
     /* Settings to handle poorly performing or failing nodes. */
     , dynamic_snitch_badness_threshold(this, "dynamic_snitch_badness_threshold", value_status::Unused, 0,
@@ -603,6 +619,10 @@ db::config::config(std::shared_ptr<db::extensions> exts)
         "Related information: Failure detection and recovery")
     , max_hints_delivery_threads(this, "max_hints_delivery_threads", value_status::Invalid, 2,
         "Number of threads with which to deliver hints. In multiple data-center deployments, consider increasing this number because cross data-center handoff is generally slower.")
+    , hints_replay_batch_size_in_kb(this, "hints_replay_batch_size_in_kb", liveness::LiveUpdate, value_status::Used, 1024,
+        "Size of the batches in which hints are replayed to a node, in kilobytes. A batch is sent with a single request and applied on the node without going through the write path of a coordinator. Set to 0 to replay hints one mutation at a time.")
+    , max_concurrent_hint_replay_batches(this, "max_concurrent_hint_replay_batches", liveness::LiveUpdate, value_status::Used, 4,
+        "Maximum number of batches of hints replayed to a single node concurrently, see hints_replay_batch_size_in_kb.")
     , batchlog_replay_throttle_in_kb(this, "batchlog_replay_throttle_in_kb", value_status::Unused, 1024,
         "Total maximum throttle. Throttling is reduced proportionally to the number of nodes in the cluster.")
     /* Request scheduler properties */
@@ -730,6 +750,7 @@ db::config::config(std::shared_ptr<db::extensions> exts)
     , experimental(this, "experimental", value_status::Used, false, "Set to true to unlock all experimental features.")
     , experimental_features(this, "experimental_features", value_status::Used, {}, "Unlock experimental features provided as the option arguments (possible values: 'lwt', 'cdc', 'udf'). Can be repeated.")
     , lsa_reclamation_step(this, "lsa_reclamation_step", value_status::Used, 1, "Minimum number of segments to reclaim in a single step")
+    , lsa_background_defragment_free_segments(this, "lsa_background_defragment_free_segments", value_status::Used, 0, "If set to higher than 0, compact the sparsest LSA segments in the background, at a low priority, until this many segments are free. The count includes the segments of the emergency reserve, as the lsa free_segments metric does. This way, allocations rarely need to compact or evict memory synchronously, at the cost of copying some memory ahead of time")
     , prometheus_port(this, "prometheus_port", value_status::Used, 9180, "Prometheus port, set to zero to disable")
     , prometheus_address(this, "prometheus_address", value_status::Used, "0.0.0.0", "Prometheus listening address")
     , prometheus_prefix(this, "prometheus_prefix", value_status::Used, "scylla", "Set the prefix of the exported Prometheus metrics. Changing this will break Scylla's dashboard compatibility, do not change unless you know what you are doing.")
@@ -752,6 +773,8 @@ db::config::config(std::shared_ptr<db::extensions> exts)
     , enable_dangerous_direct_import_of_cassandra_counters(this, "enable_dangerous_direct_import_of_cassandra_counters", value_status::Used, false, "Only turn this option on if you want to import tables from Cassandra containing counters, and you are SURE that no counters in that table were created in a version earlier than Cassandra 2.1."
         " It is not enough to have ever since upgraded to newer versions of Cassandra. If you EVER used a version earlier than 2.1 in the cluster where these SSTables come from, DO NOT TURN ON THIS OPTION! You will corrupt your data. You have been warned.")
     , enable_shard_aware_drivers(this, "enable_shard_aware_drivers", value_status::Used, true, "Enable native transport drivers to use connection-per-shard for better performance")
+    , enable_cql_protocol_v5(this, "enable_cql_protocol_v5", value_status::Used, false, "Allow native transport drivers to use protocol v5, which batches responses into checksummed and compressed segments. "
+        "Setting the keyspace or the current time of a request is not supported.")
     , enable_ipv6_dns_lookup(this, "enable_ipv6_dns_lookup", value_status::Used, false, "Use IPv6 address resolution")
     , abort_on_internal_error(this, "abort_on_internal_error", liveness::LiveUpdate, value_status::Used, false, "Abort the server instead of throwing exception when internal invariants are violated")
     , max_partition_key_restrictions_per_query(this, "max_partition_key_restrictions_per_query", liveness::LiveUpdate, value_status::Used, 100,
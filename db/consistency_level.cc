@@ -240,7 +240,8 @@ filter_for_query(consistency_level cl,
         }));
 
         if (!old_node && ht_max - ht_min > 0.01) { // if there is old node or hit rates are close skip calculations
-            // local node is always first if present (see storage_proxy::get_live_sorted_endpoints)
+            // local node is always first if present, as adaptive replica selection is off when we get
+            // here (see storage_proxy::get_live_sorted_endpoints and use_cache_hit_rate_read_balancing)
             unsigned local_idx = epi[0].first == utils::fb_utilities::get_broadcast_address() ? 0 : epi.size() + 1;
             live_endpoints = miss_equalizing_combination(epi, local_idx, remaining_bf, bool(extra));
         }
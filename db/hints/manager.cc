@@ -83,6 +83,12 @@ void manager::register_metrics(const sstring& group_name) {
         sm::make_derive("sent", _stats.sent,
                         sm::description("Number of sent hints.")),
 
+        sm::make_derive("sent_bytes", _stats.sent_bytes,
+                        sm::description("Total size of sent hints.")),
+
+        sm::make_derive("sent_batches", _stats.sent_batches,
+                        sm::description("Number of batches in which hints were sent.")),
+
         sm::make_derive("discarded", _stats.discarded,
                         sm::description("Number of hints that were discarded during sending (too old, schema changed, etc.).")),
 
@@ -734,6 +740,22 @@ void manager::end_point_hints_manager::sender::start() {
     });
 }
 
+bool manager::end_point_hints_manager::sender::is_replica_for(const frozen_mutation_and_schema& m) {
+    keyspace& ks = _db.find_keyspace(m.s->ks_name());
+    auto& rs = ks.get_replication_strategy();
+    auto token = dht::get_token(*m.s, m.fm.key());
+    std::vector<gms::inet_address> natural_endpoints = rs.get_natural_endpoints(std::move(token));
+    return boost::range::find(natural_endpoints, end_point_key()) != natural_endpoints.end();
+}
+
+bool manager::end_point_hints_manager::sender::batch_replay_enabled() const noexcept {
+    return _db.get_config().hints_replay_batch_size_in_kb() > 0;
+}
+
+bool manager::end_point_hints_manager::sender::batch_full(const send_one_file_ctx& ctx) const noexcept {
+    return ctx.batch_size >= size_t(_db.get_config().hints_replay_batch_size_in_kb()) * 1024;
+}
+
 future<> manager::end_point_hints_manager::sender::send_one_mutation(frozen_mutation_and_schema m) {
     keyspace& ks = _db.find_keyspace(m.s->ks_name());
     auto& rs = ks.get_replication_strategy();
@@ -760,8 +782,18 @@ future<> manager::end_point_hints_manager::sender::send_one_hint(lw_shared_ptr<s
                     return make_ready_future<>();
                 }
 
-                return this->send_one_mutation(std::move(m)).then([this, rp, ctx_ptr] {
+                // The mutation is sent as it was read from the hints file, unless its schema has changed
+                // since, so a batch costs one request and no re-serialization.
+                if (ctx_ptr->batch_replay && this->is_replica_for(m)) {
+                    ctx_ptr->batch_size += buf.size_bytes();
+                    ctx_ptr->batch.push_back(std::move(m));
+                    ctx_ptr->batch_hints.push_back({rp, buf.size_bytes()});
+                    return make_ready_future<>();
+                }
+
+                return this->send_one_mutation(std::move(m)).then([this, rp, ctx_ptr, size = buf.size_bytes()] {
                     ++this->shard_stats().sent;
+                    this->shard_stats().sent_bytes += size;
                 }).handle_exception([this, ctx_ptr, rp] (auto eptr) {
                     manager_logger.trace("send_one_hint(): failed to send to {}: {}", end_point_key(), eptr);
                     ctx_ptr->on_hint_send_failure(rp);
@@ -789,6 +821,55 @@ future<> manager::end_point_hints_manager::sender::send_one_hint(lw_shared_ptr<s
     });
 }
 
+future<> manager::end_point_hints_manager::sender::send_batch(lw_shared_ptr<send_one_file_ctx> ctx_ptr) {
+    if (ctx_ptr->batch.empty()) {
+        return make_ready_future<>();
+    }
+    auto mutations = std::exchange(ctx_ptr->batch, {});
+    auto hints = make_lw_shared(std::exchange(ctx_ptr->batch_hints, {}));
+    auto size = std::exchange(ctx_ptr->batch_size, 0);
+    return ctx_ptr->batch_done.wait([this, ctx_ptr] {
+        return ctx_ptr->batches_in_flight < std::max(_db.get_config().max_concurrent_hint_replay_batches(), 1u);
+    }).then([this, size] {
+        return _resource_manager.get_send_units_for(size);
+    }).then([this, ctx_ptr, mutations = std::move(mutations), hints] (auto units) mutable {
+        ++ctx_ptr->batches_in_flight;
+        // Future is waited on indirectly in `send_one_file()` (via `ctx_ptr->file_send_gate`).
+        (void)with_gate(ctx_ptr->file_send_gate, [this, ctx_ptr, mutations = std::move(mutations), hints] () mutable {
+            return _proxy.send_hint_batch_to_endpoint(std::move(mutations), end_point_key()).then([this, ctx_ptr, hints] (std::vector<uint32_t> failed) {
+                // Only the hints which failed are retried, the rest of the batch was applied.
+                auto next_failed = failed.begin();
+                for (uint32_t i = 0; i < hints->size(); ++i) {
+                    if (next_failed != failed.end() && *next_failed == i) {
+                        ++next_failed;
+                        ctx_ptr->on_hint_send_failure((*hints)[i].rp);
+                    } else {
+                        ++this->shard_stats().sent;
+                        this->shard_stats().sent_bytes += (*hints)[i].size;
+                    }
+                }
+                ++this->shard_stats().sent_batches;
+                if (!failed.empty()) {
+                    manager_logger.trace("send_batch(): {} out of {} hints failed to apply on {}", failed.size(), hints->size(), end_point_key());
+                }
+            }).handle_exception([this, ctx_ptr, hints] (auto eptr) {
+                manager_logger.trace("send_batch(): failed to send {} hints to {}: {}", hints->size(), end_point_key(), eptr);
+                for (auto& h : *hints) {
+                    ctx_ptr->on_hint_send_failure(h.rp);
+                }
+            });
+        }).finally([units = std::move(units), ctx_ptr] {
+            --ctx_ptr->batches_in_flight;
+            ctx_ptr->batch_done.signal();
+        });
+    }).handle_exception([ctx_ptr, hints] (auto eptr) {
+        manager_logger.trace("send_batch(): Hmmm. Something bad had happend: {}", eptr);
+        for (auto& h : *hints) {
+            ctx_ptr->on_hint_send_failure(h.rp);
+        }
+    });
+}
+
 void manager::end_point_hints_manager::sender::send_one_file_ctx::on_hint_send_failure(db::replay_position rp) noexcept {
     segment_replay_failed = true;
     if (!first_failed_rp || rp < *first_failed_rp) {
@@ -801,6 +882,7 @@ bool manager::end_point_hints_manager::sender::send_one_file(const sstring& fnam
     timespec last_mod = get_last_file_modification(fname).get0();
     gc_clock::duration secs_since_file_mod = std::chrono::seconds(last_mod.tv_sec);
     lw_shared_ptr<send_one_file_ctx> ctx_ptr = make_lw_shared<send_one_file_ctx>(_last_schema_ver_to_column_mapping);
+    ctx_ptr->batch_replay = batch_replay_enabled();
 
     try {
         commitlog::read_log_file(fname, manager::FILENAME_PREFIX, service::get_local_streaming_priority(), [this, secs_since_file_mod, &fname, ctx_ptr] (commitlog::buffer_and_replay_position buf_rp) mutable {
@@ -819,7 +901,9 @@ bool manager::end_point_hints_manager::sender::send_one_file(const sstring& fnam
             }
 
             return flush_maybe().finally([this, ctx_ptr, buf = std::move(buf), rp, secs_since_file_mod, &fname] () mutable {
-                return send_one_hint(std::move(ctx_ptr), std::move(buf), rp, secs_since_file_mod, fname);
+                return send_one_hint(ctx_ptr, std::move(buf), rp, secs_since_file_mod, fname).then([this, ctx_ptr] {
+                    return batch_full(*ctx_ptr) ? send_batch(ctx_ptr) : make_ready_future<>();
+                });
             });
         }, _last_not_complete_rp.pos, &_db.extensions()).get();
     } catch (db::commitlog::segment_error& ex) {
@@ -831,6 +915,10 @@ bool manager::end_point_hints_manager::sender::send_one_file(const sstring& fnam
         ctx_ptr->segment_replay_failed = true;
     }
 
+    // Send the rest of the batch even if reading the file failed: the hints in it are
+    // before last_attempted_rp, so the next attempt wouldn't retry them.
+    send_batch(ctx_ptr).get();
+
     // wait till all background hints sending is complete
     ctx_ptr->file_send_gate.close().get();
 
@@ -32,6 +32,7 @@
 #include <seastar/core/timer.hh>
 #include <seastar/core/lowres_clock.hh>
 #include <seastar/core/shared_mutex.hh>
+#include <seastar/core/condition-variable.hh>
 #include "lister.hh"
 #include "gms/gossiper.hh"
 #include "locator/snitch_base.hh"
@@ -85,6 +86,8 @@ class manager : public service::endpoint_lifecycle_subscriber {
         uint64_t errors = 0;
         uint64_t dropped = 0;
         uint64_t sent = 0;
+        uint64_t sent_bytes = 0;
+        uint64_t sent_batches = 0;
         uint64_t discarded = 0;
         uint64_t corrupted_files = 0;
     };
@@ -130,6 +133,18 @@ class manager : public service::endpoint_lifecycle_subscriber {
                 std::optional<db::replay_position> last_attempted_rp;
                 bool segment_replay_failed = false;
 
+                // Hints sent to the end point with a single request, see send_batch().
+                struct batched_hint {
+                    db::replay_position rp;
+                    size_t size;
+                };
+                bool batch_replay = false;
+                std::vector<frozen_mutation_and_schema> batch;
+                std::vector<batched_hint> batch_hints;
+                size_t batch_size = 0;
+                unsigned batches_in_flight = 0;
+                seastar::condition_variable batch_done;
+
                 void on_hint_send_failure(db::replay_position rp) noexcept;
             };
 
@@ -226,6 +241,26 @@ class manager : public service::endpoint_lifecycle_subscriber {
             /// \return future that resolves when next hint may be sent
             future<> send_one_hint(lw_shared_ptr<send_one_file_ctx> ctx_ptr, fragmented_temporary_buffer buf, db::replay_position rp, gc_clock::duration secs_since_file_mod, const sstring& fname);
 
+            /// \brief Send the hints accumulated in the current batch of the file with a single request.
+            ///
+            /// Waits until fewer than max_concurrent_hint_replay_batches batches are in flight and for the send
+            /// budget of the batch, then sends it in the background. The hints which the end point failed to apply
+            /// are considered failed, all of them if the request itself fails, see send_one_hint().
+            ///
+            /// \param ctx_ptr shared pointer to the file sending context
+            /// \return future that resolves when the next hint may be read
+            future<> send_batch(lw_shared_ptr<send_one_file_ctx> ctx_ptr);
+
+            /// \brief Checks if hints should be replayed in batches, see send_batch().
+            /// \return TRUE if batching is not disabled in the configuration.
+            bool batch_replay_enabled() const noexcept;
+
+            /// \brief Checks if the current batch should be sent before reading more hints.
+            bool batch_full(const send_one_file_ctx& ctx) const noexcept;
+
+            /// \brief Checks if the end point is still a replica of the mutation, so the hint may be applied on it directly.
+            bool is_replica_for(const frozen_mutation_and_schema& m);
+
             /// \brief Send all hint from a single file and delete it after it has been successfully sent.
             /// Send all hints from the given file. If we failed to send the current segment we will pick up in the next
             /// iteration from where we left in this one.
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include <boost/range/adaptor/transformed.hpp>
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/future-util.hh>
+
+#include "db/view/base_read_batcher.hh"
+#include "db/view/view_stats.hh"
+#include "service/priority_manager.hh"
+
+namespace db {
+
+namespace view {
+
+base_read_batcher::base_read_batcher(mutation_source source, stats& stats)
+    : _source(std::move(source))
+    , _stats(stats)
+{ }
+
+future<mutation_opt> base_read_batcher::read(schema_ptr s, const dht::decorated_key& key, query::clustering_row_ranges ranges,
+        reader_concurrency_semaphore& semaphore, db::timeout_clock::time_point timeout, tracing::trace_state_ptr tr_state) {
+    return with_gate(_gate, [&] {
+        _pending.push_back(request{std::move(s), key, std::move(ranges), &semaphore, timeout, std::move(tr_state), {}});
+        auto f = _pending.back().result.get_future();
+        maybe_start_batches();
+        return f;
+    });
+}
+
+future<> base_read_batcher::stop() {
+    return _gate.close();
+}
+
+void base_read_batcher::maybe_start_batches() {
+    while (_batches_in_flight < max_batches_in_flight && !_pending.empty()) {
+        // Requests of a batch may share a read, so they must agree on the
+        // schema and on the semaphore.
+        auto version = _pending.front().schema->version();
+        auto semaphore = _pending.front().semaphore;
+        std::vector<request> batch;
+        std::vector<request> rest;
+        for (auto& r : _pending) {
+            if (batch.size() < max_batch_size && r.schema->version() == version && r.semaphore == semaphore) {
+                batch.push_back(std::move(r));
+            } else {
+                rest.push_back(std::move(r));
+            }
+        }
+        _pending = std::move(rest);
+        ++_batches_in_flight;
+        // Doesn't fail, errors are forwarded to the requests.
+        (void)read_batch(std::move(batch));
+    }
+}
+
+// Reads the existing rows of one partition on behalf of the requests
+// [p.begin, p.end) of the batch and resolves them. The read waits for the
+// latest of their timeouts and is traced on the first request.
+future<> base_read_batcher::read_partition(const schema_ptr& s, const partition_read& p, std::vector<request>& batch) {
+    mutation_opt existing;
+    std::exception_ptr ex;
+    try {
+        auto timeout = batch[p.begin].timeout;
+        for (size_t i = p.begin + 1; i < p.end; ++i) {
+            timeout = std::max(timeout, batch[i].timeout);
+            tracing::trace(batch[i].tr_state, "Sharing the read of existing base rows of {}.{} with another write to the partition",
+                    s->ks_name(), s->cf_name());
+        }
+        auto permit = batch[p.begin].semaphore->make_permit(s.get(), "push-view-updates-batch");
+        auto reader = _source.make_reader(s, std::move(permit), p.range, p.slice, service::get_local_sstable_query_read_priority(),
+                batch[p.begin].tr_state, streamed_mutation::forwarding::no, mutation_reader::forwarding::no);
+        existing = co_await read_mutation_from_flat_mutation_reader(reader, timeout);
+    } catch (...) {
+        ex = std::current_exception();
+    }
+
+    for (size_t i = p.begin; i < p.end; ++i) {
+        if (ex) {
+            batch[i].result.set_exception(ex);
+        } else if (!existing) {
+            batch[i].result.set_value(mutation_opt());
+        } else if (p.end - p.begin == 1) {
+            batch[i].result.set_value(std::move(existing));
+        } else {
+            batch[i].result.set_value(mutation_opt(existing->sliced(batch[i].ranges)));
+        }
+    }
+}
+
+future<> base_read_batcher::read_batch(std::vector<request> batch) {
+    const schema_ptr s = batch.front().schema;
+    std::sort(batch.begin(), batch.end(), [&s] (const request& a, const request& b) {
+        return a.key.less_compare(*s, b.key);
+    });
+
+    // Requests for rows of the same partition share its read. The readers
+    // keep references to their partition range and slice, so those must stay
+    // in place until all partitions are read.
+    std::vector<partition_read> partitions;
+    std::exception_ptr ex;
+    try {
+        // We read the whole set of regular columns, see table::do_push_view_replica_updates().
+        auto columns = boost::copy_range<query::column_id_vector>(
+                s->regular_columns() | boost::adaptors::transformed(std::mem_fn(&column_definition::id)));
+        query::partition_slice::option_set opts;
+        opts.set(query::partition_slice::option::send_partition_key);
+        opts.set(query::partition_slice::option::send_clustering_key);
+        opts.set(query::partition_slice::option::send_timestamp);
+        opts.set(query::partition_slice::option::send_ttl);
+
+        for (size_t i = 0; i < batch.size();) {
+            query::clustering_row_ranges ranges;
+            size_t end = i;
+            for (; end < batch.size() && batch[end].key.equal(*s, batch[i].key); ++end) {
+                ranges.insert(ranges.end(), batch[end].ranges.begin(), batch[end].ranges.end());
+            }
+            partitions.push_back(partition_read{
+                dht::partition_range::make_singular(batch[i].key),
+                query::partition_slice(query::clustering_range::deoverlap(std::move(ranges), clustering_key::tri_compare(*s)),
+                        { }, columns, opts, { }, cql_serialization_format::internal(), query::max_rows),
+                i,
+                end});
+            i = end;
+        }
+    } catch (...) {
+        ex = std::current_exception();
+    }
+
+    if (ex) {
+        for (auto& r : batch) {
+            r.result.set_exception(ex);
+        }
+    } else {
+        ++_stats.view_update_read_batches;
+        _stats.view_update_batched_reads += batch.size();
+        _stats.view_update_shared_partition_reads += batch.size() - partitions.size();
+        // Doesn't fail, errors are forwarded to the requests.
+        co_await parallel_for_each(partitions, [this, &s, &batch] (const partition_read& p) {
+            return read_partition(s, p, batch);
+        });
+    }
+
+    --_batches_in_flight;
+    maybe_start_batches();
+}
+
+}
+
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <seastar/core/future.hh>
+#include <seastar/core/gate.hh>
+
+#include "mutation.hh"
+#include "mutation_reader.hh"
+#include "query-request.hh"
+#include "reader_concurrency_semaphore.hh"
+#include "tracing/trace_state.hh"
+
+namespace db {
+
+namespace view {
+
+struct stats;
+
+// Reads the pre-existing base rows needed to generate view updates.
+//
+// Reads are started right away only while fewer than max_batches_in_flight
+// batches are running. Reads requested meanwhile wait and are then served
+// together: the reads of rows of the same partition are merged into a single
+// read of the union of their row ranges, and the distinct partitions of a
+// batch are read concurrently, each by its own reader. Admission of those
+// readers is left to the reader concurrency semaphore, the batch limit only
+// bounds how many reads can be merged.
+//
+// The caller must hold the base lock of the rows it reads (see
+// table::local_base_lock()) until it is done with them, so the rows of
+// different reads in a batch never overlap.
+class base_read_batcher {
+    struct request {
+        schema_ptr schema;
+        dht::decorated_key key;
+        query::clustering_row_ranges ranges;
+        reader_concurrency_semaphore* semaphore;
+        db::timeout_clock::time_point timeout;
+        tracing::trace_state_ptr tr_state;
+        promise<mutation_opt> result;
+    };
+    // The requests [begin, end) of a batch, which read the same partition.
+    struct partition_read {
+        dht::partition_range range;
+        query::partition_slice slice;
+        size_t begin;
+        size_t end;
+    };
+    mutation_source _source;
+    stats& _stats;
+    std::vector<request> _pending;
+    unsigned _batches_in_flight = 0;
+    seastar::gate _gate;
+public:
+    static constexpr unsigned max_batches_in_flight = 64;
+    static constexpr size_t max_batch_size = 128;
+
+    base_read_batcher(mutation_source source, stats& stats);
+
+    // Returns the regular rows of the partition which fall into ranges,
+    // or a disengaged optional if the partition doesn't exist.
+    future<mutation_opt> read(schema_ptr s, const dht::decorated_key& key, query::clustering_row_ranges ranges,
+            reader_concurrency_semaphore& semaphore, db::timeout_clock::time_point timeout, tracing::trace_state_ptr tr_state);
+
+    future<> stop();
+private:
+    void maybe_start_batches();
+    future<> read_batch(std::vector<request> batch);
+    future<> read_partition(const schema_ptr& s, const partition_read& p, std::vector<request>& batch);
+};
+
+}
+
+}
@@ -246,6 +246,13 @@ void stats::register_stats() {
                     {_cf_label, _ks_label}),
             ms::make_gauge("view_updates_pending", ms::description("Number of updates pushed to view and are still to be completed"),
                     {_cf_label, _ks_label}, writes),
+            ms::make_total_operations("view_update_read_batches", view_update_read_batches, ms::description("Number of batched reads of existing base rows for view updates"),
+                    {_cf_label, _ks_label}),
+            ms::make_total_operations("view_update_batched_reads", view_update_batched_reads, ms::description("Number of base writes whose existing rows were read in a batch"),
+                    {_cf_label, _ks_label}),
+            ms::make_total_operations("view_update_shared_partition_reads", view_update_shared_partition_reads,
+                    ms::description("Number of base writes which shared the read of their partition's existing rows with another write in the batch"),
+                    {_cf_label, _ks_label}),
     });
 }
 
@@ -1306,7 +1313,8 @@ view_builder::view_builder(database& db, db::system_distributed_keyspace& sys_di
         : _db(db)
         , _sys_dist_ks(sys_dist_ks)
         , _mnotifier(mn)
-        , _permit(_db.get_reader_concurrency_semaphore().make_permit(nullptr, "view_builder")) {
+        , _permit(_db.get_reader_concurrency_semaphore().make_permit(nullptr, "view_builder"))
+        , _populate_memory(max_populate_memory) {
     setup_metrics();
 }
 
@@ -1328,7 +1336,15 @@ void view_builder::setup_metrics() {
 
         sm::make_gauge("builds_in_progress",
                 sm::description("Number of currently active view builds."),
-                [this] { return _base_to_build_step.size(); })
+                [this] { return _base_to_build_step.size(); }),
+
+        sm::make_gauge("pending_view_updates",
+                sm::description("Number of batches of base rows whose view updates are being generated and propagated in the background."),
+                [this] { return _pending_populates.size(); }),
+
+        sm::make_gauge("pending_view_updates_memory",
+                sm::description("Memory of base rows whose view updates are being generated and propagated in the background."),
+                [this] { return max_populate_memory - _populate_memory.available_units(); })
     });
 }
 
@@ -1914,11 +1930,13 @@ class view_builder::consumer {
             auto views = with_base_info_snapshot(_views_to_build);
             auto reader = make_flat_mutation_reader_from_fragments(_step.reader.schema(), _builder._permit, std::move(_fragments));
             reader.upgrade_schema(base_schema);
-            _step.base->populate_views(
+            // Propagate the updates in the background while we read on, see execute().
+            auto units = get_units(_builder._populate_memory, std::min(_fragments_memory_usage, max_populate_memory)).get0();
+            _builder._pending_populates.push_back(_step.base->populate_views(
                     std::move(views),
                     _step.current_token(),
                     std::move(reader),
-                    _now).get();
+                    _now).finally([units = std::move(units)] { }));
             _fragments.clear();
             _fragments_memory_usage = 0;
         }
@@ -1963,7 +1981,30 @@ void view_builder::execute(build_step& step, exponential_backoff_retry r) {
             query::max_partitions,
             view_builder::consumer{*this, step, now});
     consumer.consume_new_partition(step.current_key); // Initialize the state in case we're resuming a partition
-    auto built = step.reader.consume_in_thread(std::move(consumer), db::no_timeout);
+    // The step is redone from here if any of its view updates fail.
+    auto start_key = step.current_key;
+    auto start_build_status = step.build_status;
+    std::optional<view_builder::consumer::built_views> built_opt;
+    std::exception_ptr consume_ex;
+    try {
+        built_opt.emplace(step.reader.consume_in_thread(std::move(consumer), db::no_timeout));
+    } catch (...) {
+        consume_ex = std::current_exception();
+    }
+    // Progress can only be recorded once the updates of the rows read so far
+    // reached the view replicas.
+    if (auto populate_ex = wait_for_pending_populates()) {
+        if (built_opt) {
+            built_opt->release();
+        }
+        step.current_key = std::move(start_key);
+        step.build_status = std::move(start_build_status);
+        std::rethrow_exception(populate_ex);
+    }
+    if (consume_ex) {
+        std::rethrow_exception(consume_ex);
+    }
+    auto& built = *built_opt;
 
     _as.check();
 
@@ -1984,6 +2025,23 @@ void view_builder::execute(build_step& step, exponential_backoff_retry r) {
     }).get();
 }
 
+// Called in the context of a seastar::thread.
+// Returns the first failure of the view updates of the current build step.
+std::exception_ptr view_builder::wait_for_pending_populates() {
+    auto results = seastar::when_all(_pending_populates.begin(), _pending_populates.end()).get0();
+    _pending_populates.clear();
+    std::exception_ptr ex;
+    for (auto& f : results) {
+        if (f.failed()) {
+            auto ep = f.get_exception();
+            if (!ex) {
+                ex = std::move(ep);
+            }
+        }
+    }
+    return ex;
+}
+
 future<> view_builder::maybe_mark_view_as_built(view_ptr view, dht::token next_token) {
     _built_views.emplace(view->id());
     vlogger.debug("Shard finished building view {}.{}", view->ks_name(), view->cf_name());
@@ -65,6 +65,12 @@ namespace db::view {
  * from one reader. We also strive for fairness, in that each build step inserts entries for
  * the views of a different base. Each build step reads and generates updates for batch_size rows.
  *
+ * Generating and propagating the view updates of the rows read so far happens in the background,
+ * while the build step reads on, so the step isn't bound by the latency of view replicas. The base
+ * rows being processed in the background are limited to max_populate_memory per shard. A step
+ * waits for all of its view updates before recording its progress. If any of them failed, the step
+ * is redone from where it started.
+ *
  * We lack a controller, which could potentially allow us to go faster (to execute multiple steps at
  * the same time, or consume more rows per batch), and also which would apply backpressure, so we
  * could, for example, delay executing a build step.
@@ -171,6 +177,9 @@ class view_builder final : public service::migration_listener::only_view_notific
     std::unordered_map<std::pair<sstring, sstring>, seastar::shared_promise<>, utils::tuple_hash> _build_notifiers;
     stats _stats;
     metrics::metric_groups _metrics;
+    // View updates of the current build step, running in the background.
+    std::vector<future<>> _pending_populates;
+    seastar::semaphore _populate_memory;
 
     struct view_builder_init_state {
         std::vector<future<>> bookkeeping_ops;
@@ -185,6 +194,9 @@ class view_builder final : public service::migration_listener::only_view_notific
     // collected batch_memory_max bytes, we can process the rows read so far.
     static constexpr size_t batch_size = 128;
     static constexpr size_t batch_memory_max = 1024*1024;
+    // Limits the memory of base rows whose view updates are generated and
+    // propagated in the background.
+    static constexpr size_t max_populate_memory = 16 * batch_memory_max;
 
 public:
     view_builder(database&, db::system_distributed_keyspace&, service::migration_notifier&);
@@ -220,6 +232,7 @@ class view_builder final : public service::migration_listener::only_view_notific
     future<> do_build_step();
     void execute(build_step&, exponential_backoff_retry);
     future<> maybe_mark_view_as_built(view_ptr, dht::token);
+    std::exception_ptr wait_for_pending_populates();
     void setup_metrics();
 
     struct consumer;
@@ -30,6 +30,7 @@ enum class digest_algorithm : uint8_t {
     MD5 = 1,
     legacy_xxHash_without_null_digest = 2,
     xxHash = 3, // default algorithm
+    xxHash3 = 4,
 };
 
 }
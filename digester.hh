@@ -36,7 +36,7 @@ struct noop_hasher {
 };
 
 class digester final {
-    std::variant<noop_hasher, md5_hasher, xx_hasher, legacy_xx_hasher_without_null_digest> _impl;
+    std::variant<noop_hasher, md5_hasher, xx_hasher, xxh3_hasher, legacy_xx_hasher_without_null_digest> _impl;
 
 public:
     explicit digester(digest_algorithm algo) {
@@ -47,6 +47,9 @@ class digester final {
         case digest_algorithm::xxHash:
             _impl = xx_hasher();
             break;
+        case digest_algorithm::xxHash3:
+            _impl = xxh3_hasher();
+            break;
         case digest_algorithm::legacy_xxHash_without_null_digest:
             _impl = legacy_xx_hasher_without_null_digest();
             break;
@@ -72,8 +75,14 @@ class digester final {
 
 using default_hasher = xx_hasher;
 
+// Whether cells are digested as the hash of each cell, which can be cached
+// in the row (see row::prepare_hash()), rather than fed to the digest as is.
+// Cached hashes are computed with default_hasher, so only it can use them.
+// XXH3 buffers the small updates made for each cell, so it does better
+// hashing the cells directly than hashing the XXH64 hashes of them.
 template<typename Hasher>
-using using_hash_of_hash = std::negation<std::disjunction<std::is_same<Hasher, md5_hasher>, std::is_same<Hasher, noop_hasher>>>;
+using using_hash_of_hash = std::negation<std::disjunction<std::is_same<Hasher, md5_hasher>, std::is_same<Hasher, noop_hasher>,
+        std::is_same<Hasher, xxh3_hasher>>>;
 
 template<typename Hasher>
 inline constexpr bool using_hash_of_hash_v = using_hash_of_hash<Hasher>::value;
@@ -145,6 +145,11 @@ extern const std::string_view PER_TABLE_CACHING;
 extern const std::string_view DIGEST_FOR_NULL_VALUES;
 extern const std::string_view CORRECT_IDX_TOKEN_IN_SECONDARY_INDEX;
 extern const std::string_view ALTERNATOR_STREAMS;
+extern const std::string_view SPLIT_BLOCK_BLOOM_FILTER;
+extern const std::string_view REPAIR_RANGE_HASHES;
+extern const std::string_view HINTED_HANDOFF_BATCH_REPLAY;
+extern const std::string_view XXHASH3_DIGEST;
+extern const std::string_view ZSTD_COMPRESSION_DICTIONARY;
 
 }
 
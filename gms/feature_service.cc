@@ -64,6 +64,11 @@ constexpr std::string_view features::PER_TABLE_CACHING = "PER_TABLE_CACHING";
 constexpr std::string_view features::DIGEST_FOR_NULL_VALUES = "DIGEST_FOR_NULL_VALUES";
 constexpr std::string_view features::CORRECT_IDX_TOKEN_IN_SECONDARY_INDEX = "CORRECT_IDX_TOKEN_IN_SECONDARY_INDEX";
 constexpr std::string_view features::ALTERNATOR_STREAMS = "ALTERNATOR_STREAMS";
+constexpr std::string_view features::SPLIT_BLOCK_BLOOM_FILTER = "SPLIT_BLOCK_BLOOM_FILTER";
+constexpr std::string_view features::REPAIR_RANGE_HASHES = "REPAIR_RANGE_HASHES";
+constexpr std::string_view features::HINTED_HANDOFF_BATCH_REPLAY = "HINTED_HANDOFF_BATCH_REPLAY";
+constexpr std::string_view features::XXHASH3_DIGEST = "XXHASH3_DIGEST";
+constexpr std::string_view features::ZSTD_COMPRESSION_DICTIONARY = "ZSTD_COMPRESSION_DICTIONARY";
 
 static logging::logger logger("features");
 
@@ -90,6 +95,11 @@ feature_service::feature_service(feature_config cfg) : _config(cfg)
         , _digest_for_null_values_feature(*this, features::DIGEST_FOR_NULL_VALUES)
         , _correct_idx_token_in_secondary_index_feature(*this, features::CORRECT_IDX_TOKEN_IN_SECONDARY_INDEX)
         , _alternator_streams_feature(*this, features::ALTERNATOR_STREAMS)
+        , _split_block_bloom_filter_feature(*this, features::SPLIT_BLOCK_BLOOM_FILTER)
+        , _repair_range_hashes_feature(*this, features::REPAIR_RANGE_HASHES)
+        , _hinted_handoff_batch_replay_feature(*this, features::HINTED_HANDOFF_BATCH_REPLAY)
+        , _xxhash3_digest_feature(*this, features::XXHASH3_DIGEST)
+        , _zstd_compression_dictionary_feature(*this, features::ZSTD_COMPRESSION_DICTIONARY)
 {}
 
 feature_config feature_config_from_db_config(db::config& cfg, std::set<sstring> disabled) {
@@ -193,6 +203,11 @@ std::set<std::string_view> feature_service::known_feature_set() {
         gms::features::DIGEST_FOR_NULL_VALUES,
         gms::features::CORRECT_IDX_TOKEN_IN_SECONDARY_INDEX,
         gms::features::ALTERNATOR_STREAMS,
+        gms::features::SPLIT_BLOCK_BLOOM_FILTER,
+        gms::features::REPAIR_RANGE_HASHES,
+        gms::features::HINTED_HANDOFF_BATCH_REPLAY,
+        gms::features::XXHASH3_DIGEST,
+        gms::features::ZSTD_COMPRESSION_DICTIONARY,
     };
 
     for (const sstring& s : _config._disabled_features) {
@@ -274,6 +289,11 @@ void feature_service::enable(const std::set<std::string_view>& list) {
         std::ref(_digest_for_null_values_feature),
         std::ref(_correct_idx_token_in_secondary_index_feature),
         std::ref(_alternator_streams_feature),
+        std::ref(_split_block_bloom_filter_feature),
+        std::ref(_repair_range_hashes_feature),
+        std::ref(_hinted_handoff_batch_replay_feature),
+        std::ref(_xxhash3_digest_feature),
+        std::ref(_zstd_compression_dictionary_feature),
     })
     {
         if (list.contains(f.name())) {
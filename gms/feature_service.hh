@@ -94,6 +94,11 @@ class feature_service final {
     gms::feature _digest_for_null_values_feature;
     gms::feature _correct_idx_token_in_secondary_index_feature;
     gms::feature _alternator_streams_feature;
+    gms::feature _split_block_bloom_filter_feature;
+    gms::feature _repair_range_hashes_feature;
+    gms::feature _hinted_handoff_batch_replay_feature;
+    gms::feature _xxhash3_digest_feature;
+    gms::feature _zstd_compression_dictionary_feature;
 
 public:
     bool cluster_supports_user_defined_functions() const {
@@ -170,6 +175,26 @@ class feature_service final {
     bool cluster_supports_alternator_streams() const {
         return bool(_alternator_streams_feature);
     }
+
+    bool cluster_supports_split_block_bloom_filter() const {
+        return bool(_split_block_bloom_filter_feature);
+    }
+
+    bool cluster_supports_repair_range_hashes() const {
+        return bool(_repair_range_hashes_feature);
+    }
+
+    bool cluster_supports_hinted_handoff_batch_replay() const {
+        return bool(_hinted_handoff_batch_replay_feature);
+    }
+
+    bool cluster_supports_xxhash3_digest() const {
+        return bool(_xxhash3_digest_feature);
+    }
+
+    bool cluster_supports_zstd_compression_dictionary() const {
+        return bool(_zstd_compression_dictionary_feature);
+    }
 };
 
 } // namespace gms
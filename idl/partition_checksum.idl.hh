@@ -72,6 +72,7 @@ struct get_sync_boundary_response {
 enum class row_level_diff_detect_algorithm : uint8_t {
     send_full_set,
     send_full_set_rpc_stream,
+    send_sketch_rpc_stream,
 };
 
 enum class repair_stream_cmd : uint8_t {
@@ -95,6 +96,12 @@ struct repair_row_on_wire_with_cmd {
     partition_key_and_mutation_fragments row;
 };
 
+struct repair_hash_sketch {
+    std::vector<int32_t> counts;
+    std::vector<uint64_t> key_sums;
+    std::vector<uint64_t> hash_sums;
+};
+
 enum class repair_row_level_start_status: uint8_t {
     ok,
     no_such_column_family,
@@ -85,6 +85,7 @@
 #include "alternator/tags_extension.hh"
 #include "alternator/rmw_operation.hh"
 #include "db/paxos_grace_seconds_extension.hh"
+#include "db/bloom_filter_type_extension.hh"
 
 namespace fs = std::filesystem;
 
@@ -427,6 +428,7 @@ int main(int ac, char** av) {
     ext->add_schema_extension<alternator::tags_extension>(alternator::tags_extension::NAME);
     ext->add_schema_extension<cdc::cdc_extension>(cdc::cdc_extension::NAME);
     ext->add_schema_extension<db::paxos_grace_seconds_extension>(db::paxos_grace_seconds_extension::NAME);
+    ext->add_schema_extension<db::bloom_filter_type_extension>(db::bloom_filter_type_extension::NAME);
 
     auto cfg = make_lw_shared<db::config>(ext);
     auto init = app.get_options_description().add_options();
@@ -1306,13 +1308,24 @@ int main(int ac, char** av) {
                 }).get();
             }
 
-            smp::invoke_on_all([&cfg] {
+            seastar::scheduling_group lsa_defragment_scheduling_group;
+            if (cfg->lsa_background_defragment_free_segments()) {
+                lsa_defragment_scheduling_group = make_sched_group("lsa_defragment", 100);
+            }
+            smp::invoke_on_all([&cfg, lsa_defragment_scheduling_group] {
                 logalloc::tracker::config st_cfg;
                 st_cfg.defragment_on_idle = cfg->defragment_memory_on_idle();
                 st_cfg.abort_on_lsa_bad_alloc = cfg->abort_on_lsa_bad_alloc();
                 st_cfg.lsa_reclamation_step = cfg->lsa_reclamation_step();
+                st_cfg.background_defragment_free_segments = cfg->lsa_background_defragment_free_segments();
+                st_cfg.background_defragment_sched_group = lsa_defragment_scheduling_group;
                 logalloc::shard_tracker().configure(st_cfg);
             }).get();
+            auto stop_lsa_defragment = defer_verbose_shutdown("LSA background defragmentation", [] {
+                smp::invoke_on_all([] {
+                    return logalloc::shard_tracker().stop();
+                }).get();
+            });
 
             seastar::set_abort_on_ebadf(cfg->abort_on_ebadf());
             api::set_server_done(ctx).get();
@@ -49,3 +49,15 @@ future<>
 write_memtable_to_sstable(memtable& mt,
         sstables::shared_sstable sst,
         sstables::sstable_writer_config cfg);
+
+// Writes the partitions of the memtable which fall into range, which must be
+// kept alive until the write completes. estimated_partitions sizes the
+// sstable's filter.
+future<>
+write_memtable_to_sstable(memtable& mt,
+        sstables::shared_sstable sst,
+        sstables::write_monitor& mon,
+        sstables::sstable_writer_config& cfg,
+        const io_priority_class& pc,
+        const dht::partition_range& range,
+        uint64_t estimated_partitions);
@@ -59,23 +59,27 @@ void memtable::memtable_encoding_stats_collector::update(tombstone tomb) {
     }
 }
 
+void memtable::memtable_encoding_stats_collector::update(const abstract_type& type, collection_mutation_view cell) {
+    cell.with_deserialized(type, [&] (collection_mutation_view_description mview) {
+        // Note: when some of the collection cells are dead and some are live
+        // we need to encode a "live" deletion_time for the living ones.
+        // It is not strictly required to update encoding_stats for the latter case
+        // since { <int64_t>.min(), <int32_t>.max() } will not affect the encoding_stats
+        // minimum values.  (See #4035)
+        update(mview.tomb);
+        for (auto& entry : mview.cells) {
+            update(entry.second);
+        }
+    });
+}
+
 void memtable::memtable_encoding_stats_collector::update(const ::schema& s, const row& r, column_kind kind) {
     r.for_each_cell([this, &s, kind](column_id id, const atomic_cell_or_collection& item) {
         auto& col = s.column_at(kind, id);
         if (col.is_atomic()) {
             update(item.as_atomic_cell(col));
         } else {
-            item.as_collection_mutation().with_deserialized(*col.type, [&] (collection_mutation_view_description mview) {
-            // Note: when some of the collection cells are dead and some are live
-            // we need to encode a "live" deletion_time for the living ones.
-            // It is not strictly required to update encoding_stats for the latter case
-            // since { <int64_t>.min(), <int32_t>.max() } will not affect the encoding_stats
-            // minimum values.  (See #4035)
-            update(mview.tomb);
-            for (auto& entry : mview.cells) {
-                update(entry.second);
-            }
-            });
+            update(*col.type, item.as_collection_mutation());
         }
     });
 }
@@ -571,9 +575,9 @@ class flush_reader final : public flat_mutation_reader::impl, private iterator_r
     flat_mutation_reader_opt _partition_reader;
     flush_memory_accounter _flushed_memory;
 public:
-    flush_reader(schema_ptr s, reader_permit permit, lw_shared_ptr<memtable> m)
+    flush_reader(schema_ptr s, reader_permit permit, lw_shared_ptr<memtable> m, const dht::partition_range& range)
         : impl(s, std::move(permit))
-        , iterator_reader(std::move(s), m, query::full_partition_range)
+        , iterator_reader(std::move(s), m, range)
         , _flushed_memory(*m)
     {}
     flush_reader(const flush_reader&) = delete;
@@ -688,14 +692,14 @@ memtable::make_flat_reader(schema_ptr s,
 }
 
 flat_mutation_reader
-memtable::make_flush_reader(schema_ptr s, const io_priority_class& pc) {
+memtable::make_flush_reader(schema_ptr s, const io_priority_class& pc, const dht::partition_range& range) {
     auto permit = _flush_semaphore.make_permit(s.get(), "memtable-flush");
     if (group()) {
-        return make_flat_mutation_reader<flush_reader>(std::move(s), std::move(permit), shared_from_this());
+        return make_flat_mutation_reader<flush_reader>(std::move(s), std::move(permit), shared_from_this(), range);
     } else {
         auto& full_slice = s->full_slice();
         return make_flat_mutation_reader<scanning_reader>(std::move(s), shared_from_this(), std::move(permit),
-            query::full_partition_range, full_slice, pc, mutation_reader::forwarding::no);
+            range, full_slice, pc, mutation_reader::forwarding::no);
     }
 }
 
@@ -732,12 +736,91 @@ memtable::apply(const mutation& m, db::rp_handle&& h) {
     update(std::move(h));
 }
 
+// Applies a serialized partition directly into the latest version of a
+// memtable partition, which no snapshot may refer to, without building a
+// temporary mutation_partition first. The partition must be of the
+// memtable's schema.
+//
+// Weak exception guarantees. Merging is idempotent, so applying the whole
+// partition again after a failure gives the same result as a single apply.
+class memtable::partition_applier final : public mutation_partition_view_virtual_visitor {
+    const ::schema& _schema;
+    mutation_partition& _partition;
+    memtable_encoding_stats_collector& _stats;
+    mutation_application_stats& _app_stats;
+    deletable_row* _current_row = nullptr;
+public:
+    partition_applier(const ::schema& s, mutation_partition& p, memtable_encoding_stats_collector& stats, mutation_application_stats& app_stats)
+        : _schema(s)
+        , _partition(p)
+        , _stats(stats)
+        , _app_stats(app_stats)
+    { }
+
+    virtual void accept_partition_tombstone(tombstone t) override {
+        _stats.update(t);
+        _partition.apply(t);
+    }
+
+    virtual void accept_static_cell(column_id id, atomic_cell ac) override {
+        _stats.update(atomic_cell_view(ac));
+        _partition.static_row().apply(_schema.static_column_at(id), atomic_cell_or_collection(std::move(ac)));
+    }
+
+    virtual void accept_static_cell(column_id id, collection_mutation_view cmv) override {
+        auto& col = _schema.static_column_at(id);
+        _stats.update(*col.type, cmv);
+        _partition.static_row().apply(col, collection_mutation(*col.type, cmv));
+    }
+
+    virtual void accept_row_tombstone(range_tombstone rt) override {
+        _stats.update(rt);
+        _partition.apply_row_tombstone(_schema, std::move(rt));
+    }
+
+    virtual void accept_row(position_in_partition_view pos, row_tombstone deleted_at, row_marker rm, is_dummy dummy, is_continuous continuous) override {
+        _stats.update(rm);
+        _stats.update(deleted_at.regular());
+        _stats.update(deleted_at.tomb());
+        auto& rows = _partition.clustered_rows();
+        auto i = rows.find(pos, rows_entry::compare(_schema));
+        if (i == rows.end()) {
+            auto e = alloc_strategy_unique_ptr<rows_entry>(
+                current_allocator().construct<rows_entry>(_schema, pos, dummy, continuous));
+            i = rows.insert(i, *e, rows_entry::compare(_schema));
+            e.release();
+        } else {
+            ++_app_stats.row_hits;
+        }
+        ++_app_stats.row_writes;
+        _current_row = &i->row();
+        _current_row->apply(rm);
+        _current_row->apply(deleted_at);
+    }
+
+    virtual void accept_row_cell(column_id id, atomic_cell ac) override {
+        _stats.update(atomic_cell_view(ac));
+        _current_row->cells().apply(_schema.regular_column_at(id), atomic_cell_or_collection(std::move(ac)));
+    }
+
+    virtual void accept_row_cell(column_id id, collection_mutation_view cmv) override {
+        auto& col = _schema.regular_column_at(id);
+        _stats.update(*col.type, cmv);
+        _current_row->cells().apply(col, collection_mutation(*col.type, cmv));
+    }
+};
+
 void
 memtable::apply(const frozen_mutation& m, const schema_ptr& m_schema, db::rp_handle&& h) {
     with_allocator(allocator(), [this, &m, &m_schema] {
         _allocating_section(*this, [&, this] {
           with_linearized_managed_bytes([&] {
             auto& p = find_or_create_partition_slow(m.key());
+            if (m_schema->version() == _schema->version() && !p.has_snapshot()) {
+                partition_applier pa(*_schema, p.version()->partition(), _stats_collector, _table_stats.memtable_app_stats);
+                m.partition().accept(_schema->get_column_mapping(), pa);
+                return;
+            }
             mutation_partition mp(m_schema);
             partition_builder pb(*m_schema, mp);
             m.partition().accept(*m_schema, pb);
@@ -811,6 +894,13 @@ size_t memtable_entry::object_memory_size(allocation_strategy& allocator) {
     return memtable::partitions_type::estimated_object_memory_size_in_allocator(allocator, this);
 }
 
+bool memtable::has_partitions_in(const dht::partition_range& range) {
+    logalloc::reclaim_lock rl(*this);
+    return with_linearized_managed_bytes([&] {
+        return !slice(range).empty();
+    });
+}
+
 std::ostream& operator<<(std::ostream& out, memtable& mt) {
     logalloc::reclaim_lock rl(mt);
     return out << "{memtable: [" << ::join(",\n", mt.partitions) << "]}";
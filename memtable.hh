@@ -148,6 +148,7 @@ class memtable final : public enable_lw_shared_from_this<memtable>, private loga
 
         void update(tombstone tomb);
 
+        void update(const abstract_type& type, collection_mutation_view cell);
         void update(const ::schema& s, const row& r, column_kind kind);
         void update(const range_tombstone& rt);
         void update(const row_marker& marker);
@@ -159,6 +160,8 @@ class memtable final : public enable_lw_shared_from_this<memtable>, private loga
         }
     } _stats_collector;
 
+    class partition_applier;
+
     void update(db::rp_handle&&);
     friend class row_cache;
     friend class memtable_entry;
@@ -251,11 +254,16 @@ class memtable final : public enable_lw_shared_from_this<memtable>, private loga
         return make_flat_reader(s, std::move(permit), range, full_slice);
     }
 
-    flat_mutation_reader make_flush_reader(schema_ptr, const io_priority_class& pc);
+    // Reads the partitions in range, which must be kept alive as long as the reader.
+    // Flush readers of disjoint ranges may run concurrently.
+    flat_mutation_reader make_flush_reader(schema_ptr, const io_priority_class& pc,
+                                           const dht::partition_range& range = query::full_partition_range);
 
     mutation_source as_data_source();
 
     bool empty() const { return partitions.empty(); }
+    // Returns true iff the memtable has any partition in the range.
+    bool has_partitions_in(const dht::partition_range& range);
     void mark_flushed(mutation_source) noexcept;
     bool is_flushed() const;
     void on_detach_from_region_group() noexcept;
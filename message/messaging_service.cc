@@ -64,6 +64,7 @@
 #include "idl/mutation.dist.hh"
 #include "idl/messaging_service.dist.hh"
 #include "idl/paxos.dist.hh"
+#include "idl/replica_load.dist.hh"
 #include "serializer_impl.hh"
 #include "serialization_visitors.hh"
 #include "idl/consistency_level.dist.impl.hh"
@@ -86,6 +87,7 @@
 #include "idl/mutation.dist.impl.hh"
 #include "idl/messaging_service.dist.impl.hh"
 #include "idl/paxos.dist.impl.hh"
+#include "idl/replica_load.dist.impl.hh"
 #include <seastar/rpc/lz4_compressor.hh>
 #include <seastar/rpc/lz4_fragmented_compressor.hh>
 #include <seastar/rpc/multi_algo_compressor_factory.hh>
@@ -93,6 +95,10 @@
 #include "partition_range_compat.hh"
 #include <boost/range/adaptor/filtered.hpp>
 #include <boost/range/adaptor/indirected.hpp>
+#include <random>
+#include <cstdio>
+#include <seastar/core/posix.hh>
+#include "utils/hash.hh"
 #include "frozen_mutation.hh"
 #include "flat_mutation_reader.hh"
 #include "streaming/stream_manager.hh"
@@ -194,12 +200,12 @@ constexpr int32_t messaging_service::current_version;
 distributed<messaging_service> _the_messaging_service;
 
 bool operator==(const msg_addr& x, const msg_addr& y) noexcept {
-    // Ignore cpu id for now since we do not really support shard to shard connections
+    // Identifies the node. messaging_service keys its clients by shard too.
     return x.addr == y.addr;
 }
 
 bool operator<(const msg_addr& x, const msg_addr& y) noexcept {
-    // Ignore cpu id for now since we do not really support shard to shard connections
+    // Identifies the node. messaging_service keys its clients by shard too.
     if (x.addr < y.addr) {
         return true;
     } else {
@@ -212,12 +218,21 @@ std::ostream& operator<<(std::ostream& os, const msg_addr& x) {
 }
 
 size_t msg_addr::hash::operator()(const msg_addr& id) const noexcept {
-    // Ignore cpu id for now since we do not really support // shard to shard connections
+    // Identifies the node. messaging_service keys its clients by shard too.
     return std::hash<bytes_view>()(id.addr.bytes());
 }
 
-messaging_service::shard_info::shard_info(shared_ptr<rpc_protocol_client_wrapper>&& client)
-    : rpc_client(std::move(client)) {
+size_t messaging_service::client_key_hash::operator()(const msg_addr& id) const noexcept {
+    return utils::hash_combine(msg_addr::hash()(id), std::hash<uint32_t>()(id.cpu_id) ^ id.shard_pinned);
+}
+
+bool messaging_service::client_key_equal::operator()(const msg_addr& x, const msg_addr& y) const noexcept {
+    return x.addr == y.addr && x.cpu_id == y.cpu_id && x.shard_pinned == y.shard_pinned;
+}
+
+messaging_service::shard_info::shard_info(shared_ptr<rpc_protocol_client_wrapper>&& client, uint16_t local_port)
+    : rpc_client(std::move(client))
+    , local_port(local_port) {
 }
 
 rpc::stats messaging_service::shard_info::get_stats() const {
@@ -377,11 +392,37 @@ void messaging_service::do_start_listen() {
     }
 }
 
+// Reads the kernel's ephemeral port range, which the source ports of the
+// pinned connections are picked from.
+static std::pair<uint16_t, uint16_t> read_local_port_range() {
+    constexpr std::pair<uint16_t, uint16_t> default_range{32768, 60999};
+    try {
+        auto f = file_desc::open("/proc/sys/net/ipv4/ip_local_port_range", O_RDONLY | O_CLOEXEC);
+        char buf[64] = {};
+        f.read(buf, sizeof(buf) - 1);
+        unsigned low, high;
+        if (std::sscanf(buf, "%u %u", &low, &high) == 2 && low > 0 && low <= high && high <= std::numeric_limits<uint16_t>::max()) {
+            return {uint16_t(low), uint16_t(high)};
+        }
+        if (this_shard_id() == 0) {
+            mlogger.warn("Cannot parse net.ipv4.ip_local_port_range \"{}\", using {}-{} for shard-pinned connections",
+                    buf, default_range.first, default_range.second);
+        }
+    } catch (const std::system_error& e) {
+        if (this_shard_id() == 0) {
+            mlogger.warn("Cannot read net.ipv4.ip_local_port_range, using {}-{} for shard-pinned connections: {}",
+                    default_range.first, default_range.second, e);
+        }
+    }
+    return default_range;
+}
+
 messaging_service::messaging_service(config cfg, scheduling_config scfg, std::shared_ptr<seastar::tls::credentials_builder> credentials)
     : _cfg(std::move(cfg))
     , _rpc(new rpc_protocol_wrapper(serializer { }))
     , _credentials_builder(credentials ? std::make_unique<seastar::tls::credentials_builder>(*credentials) : nullptr)
     , _clients(2 + scfg.statement_tenants.size() * 2)
+    , _local_port_range(read_local_port_range())
     , _scheduling_config(scfg)
     , _scheduling_info_for_connection_index(initial_scheduling_info())
 {
@@ -504,8 +545,11 @@ static constexpr unsigned do_get_rpc_client_idx(messaging_verb verb) {
     case messaging_verb::REPAIR_GET_ROW_DIFF_WITH_RPC_STREAM:
     case messaging_verb::REPAIR_PUT_ROW_DIFF_WITH_RPC_STREAM:
     case messaging_verb::REPAIR_GET_FULL_ROW_HASHES_WITH_RPC_STREAM:
+    case messaging_verb::REPAIR_GET_ROW_HASHES_SKETCH:
+    case messaging_verb::REPAIR_GET_RANGE_HASH:
     case messaging_verb::NODE_OPS_CMD:
     case messaging_verb::HINT_MUTATION:
+    case messaging_verb::HINT_MUTATION_BATCH:
         return 1;
     case messaging_verb::CLIENT_ID:
     case messaging_verb::MUTATION:
@@ -647,8 +691,104 @@ void messaging_service::cache_preferred_ip(gms::inet_address ep, gms::inet_addre
     _preferred_ip_cache[ep] = ip;
 }
 
+void messaging_service::set_peer_sharding(gms::inet_address ep, unsigned shard_count, unsigned sharding_ignore_msb) {
+    auto it = _peer_sharding.find(ep);
+    if (it == _peer_sharding.end()) {
+        // The plain connections stay, they aren't expected to land on a
+        // particular shard.
+        _peer_sharding.emplace(ep, peer_sharding{shard_count, sharding_ignore_msb});
+        return;
+    }
+    if (it->second.shard_count == shard_count && it->second.sharding_ignore_msb == sharding_ignore_msb) {
+        return;
+    }
+    // The node restarted with a different sharding, the pinned connections
+    // no longer land on the shards they are used for.
+    remove_pinned_rpc_clients(ep, it->second.shard_count);
+    it->second = peer_sharding{shard_count, sharding_ignore_msb};
+}
+
+msg_addr messaging_service::shard_addr(gms::inet_address ep, const dht::token& t) const {
+    auto it = _peer_sharding.find(ep);
+    if (it == _peer_sharding.end()) {
+        return msg_addr(ep);
+    }
+    return msg_addr::pinned(ep, dht::shard_of(it->second.shard_count, it->second.sharding_ignore_msb, t));
+}
+
+msg_addr messaging_service::client_addr(msg_addr id) const {
+    if (!id.shard_pinned) {
+        return msg_addr(id.addr);
+    }
+    auto it = _peer_sharding.find(id.addr);
+    if (it == _peer_sharding.end() || id.cpu_id >= it->second.shard_count) {
+        return msg_addr(id.addr);
+    }
+    return id;
+}
+
+// Whether a socket set up like the rpc client's can be bound to local.
+static bool can_bind(const socket_address& local) {
+    try {
+        auto fd = file_desc::socket(local.u.sa.sa_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        fd.setsockopt(SOL_SOCKET, SO_REUSEADDR, 1);
+        fd.bind(local.u.sa, local.length());
+        return true;
+    } catch (std::system_error& e) {
+        mlogger.debug("Cannot bind to {}: {}", local, e.what());
+        return false;
+    }
+}
+
+// The listeners use load_balancing_algorithm::port, so a connection is
+// accepted on the shard equal to its source port modulo the shard count.
+// Picks a source port in the kernel's ephemeral range which maps to the
+// shard of id, like the drivers do for the shard-aware CQL port.
+//
+// Each local shard picks from its own subset of the candidates, and skips
+// the ports its connections to the same shard already use, so connections
+// of this node never collide with each other. Ports bound by other sockets
+// are detected with a probe socket, and the next candidate is tried.
+// Returns std::nullopt if no port was found, the caller then falls back to
+// a plain connection.
+std::optional<uint16_t> messaging_service::local_port_for_shard(msg_addr id, unsigned shard_count, const net::inet_address& local_ip) const {
+    static thread_local std::default_random_engine rng{std::random_device{}()};
+    const unsigned low = _local_port_range.first;
+    const unsigned high = _local_port_range.second;
+    constexpr unsigned max_attempts = 16;
+    // Candidates are first + (k * smp::count + this_shard_id()) * shard_count.
+    unsigned first = low + (id.cpu_id + shard_count - low % shard_count) % shard_count;
+    if (first > high) {
+        return std::nullopt;
+    }
+    unsigned per_target_shard = (high - first) / shard_count + 1;
+    if (per_target_shard <= this_shard_id()) {
+        return std::nullopt;
+    }
+    unsigned candidates = (per_target_shard - this_shard_id() - 1) / smp::count + 1;
+    auto in_use = [&] (uint16_t port) {
+        return std::any_of(_clients.begin(), _clients.end(), [&] (const clients_map& clients) {
+            auto it = clients.find(id);
+            return it != clients.end() && it->second.local_port == port;
+        });
+    };
+    auto k = std::uniform_int_distribution<unsigned>(0, candidates - 1)(rng);
+    for (unsigned attempt = 0; attempt < std::min(candidates, max_attempts); ++attempt, k = (k + 1) % candidates) {
+        uint16_t port = first + (k * smp::count + this_shard_id()) * shard_count;
+        if (in_use(port)) {
+            continue;
+        }
+        if (!can_bind(socket_address(local_ip, port))) {
+            continue;
+        }
+        return port;
+    }
+    return std::nullopt;
+}
+
 shared_ptr<messaging_service::rpc_protocol_client_wrapper> messaging_service::get_rpc_client(messaging_verb verb, msg_addr id) {
     assert(!_shutting_down);
+    id = client_addr(id);
     auto idx = get_rpc_client_idx(verb);
     auto it = _clients[idx].find(id);
 
@@ -706,6 +846,23 @@ shared_ptr<messaging_service::rpc_protocol_client_wrapper> messaging_service::ge
 
     auto remote_addr = socket_address(get_preferred_ip(id.addr), must_encrypt ? _cfg.ssl_port : _cfg.port);
 
+    uint16_t local_port = 0;
+    auto local_addr = socket_address();
+    if (id.shard_pinned) {
+        // client_addr() only keeps pinned addresses of nodes with known sharding.
+        auto shard_count = _peer_sharding.at(id.addr).shard_count;
+        auto local_ip = net::inet_address(remote_addr.addr().in_family());
+        auto port = local_port_for_shard(id, shard_count, local_ip);
+        if (!port) {
+            static thread_local logger::rate_limit rate_limit(std::chrono::seconds(30));
+            mlogger.log(log_level::info, rate_limit, "No source port in {}-{} available for a connection to {}, using the plain connection",
+                    _local_port_range.first, _local_port_range.second, id);
+            return get_rpc_client(verb, msg_addr(id.addr));
+        }
+        local_port = *port;
+        local_addr = socket_address(local_ip, local_port);
+    }
+
     rpc::client_options opts;
     // send keepalive messages each minute if connection is idle, drop connection after 10 failures
     opts.keepalive = std::optional<net::tcp_keepalive_params>({60s, 60s, 10});
@@ -721,11 +878,11 @@ shared_ptr<messaging_service::rpc_protocol_client_wrapper> messaging_service::ge
 
     auto client = must_encrypt ?
                     ::make_shared<rpc_protocol_client_wrapper>(*_rpc, std::move(opts),
-                                    remote_addr, socket_address(), _credentials) :
+                                    remote_addr, local_addr, _credentials) :
                     ::make_shared<rpc_protocol_client_wrapper>(*_rpc, std::move(opts),
-                                    remote_addr);
+                                    remote_addr, local_addr);
 
-    auto res = _clients[idx].emplace(id, shard_info(std::move(client)));
+    auto res = _clients[idx].emplace(id, shard_info(std::move(client), local_port));
     assert(res.second);
     it = res.first;
     uint32_t src_cpu_id = this_shard_id();
@@ -765,6 +922,7 @@ bool messaging_service::remove_rpc_client_one(clients_map& clients, msg_addr id,
 }
 
 void messaging_service::remove_error_rpc_client(messaging_verb verb, msg_addr id) {
+    id = client_addr(id);
     if (remove_rpc_client_one(_clients[get_rpc_client_idx(verb)], id, true)) {
         for (auto&& cb : _connection_drop_notifiers) {
             cb(id.addr);
@@ -773,8 +931,21 @@ void messaging_service::remove_error_rpc_client(messaging_verb verb, msg_addr id
 }
 
 void messaging_service::remove_rpc_client(msg_addr id) {
+    // Drop the plain connection and the ones pinned to shards of the node.
+    for (auto& c : _clients) {
+        remove_rpc_client_one(c, msg_addr(id.addr), false);
+    }
+    auto it = _peer_sharding.find(id.addr);
+    if (it != _peer_sharding.end()) {
+        remove_pinned_rpc_clients(id.addr, it->second.shard_count);
+    }
+}
+
+void messaging_service::remove_pinned_rpc_clients(gms::inet_address ep, unsigned shard_count) {
     for (auto& c : _clients) {
-        remove_rpc_client_one(c, id, false);
+        for (unsigned shard = 0; shard < shard_count; ++shard) {
+            remove_rpc_client_one(c, msg_addr::pinned(ep, shard), false);
+        }
     }
 }
 
@@ -1149,14 +1320,14 @@ future<> messaging_service::send_mutation_failed(msg_addr id, unsigned shard, re
     return send_message_oneway(this, messaging_verb::MUTATION_FAILED, std::move(id), shard, std::move(response_id), num_failed, std::move(backlog));
 }
 
-void messaging_service::register_read_data(std::function<future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature>> (const rpc::client_info&, rpc::opt_time_point t, query::read_command cmd, ::compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> oda)>&& func) {
+void messaging_service::register_read_data(std::function<future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature, service::replica_load>> (const rpc::client_info&, rpc::opt_time_point t, query::read_command cmd, ::compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> oda)>&& func) {
     register_handler(this, netw::messaging_verb::READ_DATA, std::move(func));
 }
 future<> messaging_service::unregister_read_data() {
     return unregister_handler(netw::messaging_verb::READ_DATA);
 }
-future<rpc::tuple<query::result, rpc::optional<cache_temperature>>> messaging_service::send_read_data(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const dht::partition_range& pr, query::digest_algorithm da) {
-    return send_message_timeout<future<rpc::tuple<query::result, rpc::optional<cache_temperature>>>>(this, messaging_verb::READ_DATA, std::move(id), timeout, cmd, pr, da);
+future<rpc::tuple<query::result, rpc::optional<cache_temperature>, rpc::optional<service::replica_load>>> messaging_service::send_read_data(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const dht::partition_range& pr, query::digest_algorithm da) {
+    return send_message_timeout<future<rpc::tuple<query::result, rpc::optional<cache_temperature>, rpc::optional<service::replica_load>>>>(this, messaging_verb::READ_DATA, std::move(id), timeout, cmd, pr, da);
 }
 
 void messaging_service::register_get_schema_version(std::function<future<frozen_schema>(unsigned, table_schema_version)>&& func) {
@@ -1179,24 +1350,24 @@ future<utils::UUID> messaging_service::send_schema_check(msg_addr dst) {
     return send_message<utils::UUID>(this, netw::messaging_verb::SCHEMA_CHECK, dst);
 }
 
-void messaging_service::register_read_mutation_data(std::function<future<rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature>> (const rpc::client_info&, rpc::opt_time_point t, query::read_command cmd, ::compat::wrapping_partition_range pr)>&& func) {
+void messaging_service::register_read_mutation_data(std::function<future<rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature, service::replica_load>> (const rpc::client_info&, rpc::opt_time_point t, query::read_command cmd, ::compat::wrapping_partition_range pr)>&& func) {
     register_handler(this, netw::messaging_verb::READ_MUTATION_DATA, std::move(func));
 }
 future<> messaging_service::unregister_read_mutation_data() {
     return unregister_handler(netw::messaging_verb::READ_MUTATION_DATA);
 }
-future<rpc::tuple<reconcilable_result, rpc::optional<cache_temperature>>> messaging_service::send_read_mutation_data(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const dht::partition_range& pr) {
-    return send_message_timeout<future<rpc::tuple<reconcilable_result, rpc::optional<cache_temperature>>>>(this, messaging_verb::READ_MUTATION_DATA, std::move(id), timeout, cmd, pr);
+future<rpc::tuple<reconcilable_result, rpc::optional<cache_temperature>, rpc::optional<service::replica_load>>> messaging_service::send_read_mutation_data(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const dht::partition_range& pr) {
+    return send_message_timeout<future<rpc::tuple<reconcilable_result, rpc::optional<cache_temperature>, rpc::optional<service::replica_load>>>>(this, messaging_verb::READ_MUTATION_DATA, std::move(id), timeout, cmd, pr);
 }
 
-void messaging_service::register_read_digest(std::function<future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature>> (const rpc::client_info&, rpc::opt_time_point timeout, query::read_command cmd, ::compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> oda)>&& func) {
+void messaging_service::register_read_digest(std::function<future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature, service::replica_load>> (const rpc::client_info&, rpc::opt_time_point timeout, query::read_command cmd, ::compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> oda)>&& func) {
     register_handler(this, netw::messaging_verb::READ_DIGEST, std::move(func));
 }
 future<> messaging_service::unregister_read_digest() {
     return unregister_handler(netw::messaging_verb::READ_DIGEST);
 }
-future<rpc::tuple<query::result_digest, rpc::optional<api::timestamp_type>, rpc::optional<cache_temperature>>> messaging_service::send_read_digest(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const dht::partition_range& pr, query::digest_algorithm da) {
-    return send_message_timeout<future<rpc::tuple<query::result_digest, rpc::optional<api::timestamp_type>, rpc::optional<cache_temperature>>>>(this, netw::messaging_verb::READ_DIGEST, std::move(id), timeout, cmd, pr, da);
+future<rpc::tuple<query::result_digest, rpc::optional<api::timestamp_type>, rpc::optional<cache_temperature>, rpc::optional<service::replica_load>>> messaging_service::send_read_digest(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const dht::partition_range& pr, query::digest_algorithm da) {
+    return send_message_timeout<future<rpc::tuple<query::result_digest, rpc::optional<api::timestamp_type>, rpc::optional<cache_temperature>, rpc::optional<service::replica_load>>>>(this, netw::messaging_verb::READ_DIGEST, std::move(id), timeout, cmd, pr, da);
 }
 
 // Wrapper for TRUNCATE
@@ -1252,6 +1423,28 @@ future<repair_hash_set> messaging_service::send_repair_get_full_row_hashes(msg_a
     return send_message<future<repair_hash_set>>(this, messaging_verb::REPAIR_GET_FULL_ROW_HASHES, std::move(id), repair_meta_id);
 }
 
+// Wrapper for REPAIR_GET_ROW_HASHES_SKETCH
+void messaging_service::register_repair_get_row_hashes_sketch(std::function<future<repair_hash_sketch> (const rpc::client_info& cinfo, uint32_t repair_meta_id, uint32_t nr_cells)>&& func) {
+    register_handler(this, messaging_verb::REPAIR_GET_ROW_HASHES_SKETCH, std::move(func));
+}
+future<> messaging_service::unregister_repair_get_row_hashes_sketch() {
+    return unregister_handler(messaging_verb::REPAIR_GET_ROW_HASHES_SKETCH);
+}
+future<repair_hash_sketch> messaging_service::send_repair_get_row_hashes_sketch(msg_addr id, uint32_t repair_meta_id, uint32_t nr_cells) {
+    return send_message<future<repair_hash_sketch>>(this, messaging_verb::REPAIR_GET_ROW_HASHES_SKETCH, std::move(id), repair_meta_id, nr_cells);
+}
+
+// Wrapper for REPAIR_GET_RANGE_HASH
+void messaging_service::register_repair_get_range_hash(std::function<future<std::optional<uint64_t>> (const rpc::client_info& cinfo, uint32_t repair_meta_id)>&& func) {
+    register_handler(this, messaging_verb::REPAIR_GET_RANGE_HASH, std::move(func));
+}
+future<> messaging_service::unregister_repair_get_range_hash() {
+    return unregister_handler(messaging_verb::REPAIR_GET_RANGE_HASH);
+}
+future<std::optional<uint64_t>> messaging_service::send_repair_get_range_hash(msg_addr id, uint32_t repair_meta_id) {
+    return send_message<future<std::optional<uint64_t>>>(this, messaging_verb::REPAIR_GET_RANGE_HASH, std::move(id), repair_meta_id);
+}
+
 // Wrapper for REPAIR_GET_COMBINED_ROW_HASH
 void messaging_service::register_repair_get_combined_row_hash(std::function<future<get_combined_row_hash_response> (const rpc::client_info& cinfo, uint32_t repair_meta_id, std::optional<repair_sync_boundary> common_sync_boundary)>&& func) {
     register_handler(this, messaging_verb::REPAIR_GET_COMBINED_ROW_HASH, std::move(func));
@@ -1435,6 +1628,16 @@ future<> messaging_service::send_hint_mutation(msg_addr id, clock_type::time_poi
         std::move(reply_to), shard, std::move(response_id), std::move(trace_info));
 }
 
+void messaging_service::register_hint_mutation_batch(std::function<future<std::vector<uint32_t>> (const rpc::client_info&, rpc::opt_time_point, std::vector<frozen_mutation> fms)>&& func) {
+    register_handler(this, netw::messaging_verb::HINT_MUTATION_BATCH, std::move(func));
+}
+future<> messaging_service::unregister_hint_mutation_batch() {
+    return unregister_handler(netw::messaging_verb::HINT_MUTATION_BATCH);
+}
+future<std::vector<uint32_t>> messaging_service::send_hint_mutation_batch(msg_addr id, clock_type::time_point timeout, std::vector<frozen_mutation> fms) {
+    return send_message_timeout<std::vector<uint32_t>>(this, messaging_verb::HINT_MUTATION_BATCH, std::move(id), timeout, std::move(fms));
+}
+
 void init_messaging_service(sharded<messaging_service>& ms,
                 messaging_service::config mscfg, netw::messaging_service::scheduling_config scfg,
                 sstring ms_trust_store, sstring ms_cert, sstring ms_key, sstring ms_tls_prio, bool ms_client_auth) {
@@ -38,6 +38,7 @@
 #include "streaming/stream_reason.hh"
 #include "streaming/stream_mutation_fragments_cmd.hh"
 #include "cache_temperature.hh"
+#include "service/replica_load.hh"
 #include "service/paxos/prepare_response.hh"
 
 #include <list>
@@ -144,7 +145,10 @@ enum class messaging_verb : int32_t {
     PAXOS_PRUNE = 43,
     GOSSIP_GET_ENDPOINT_STATES = 44,
     NODE_OPS_CMD = 45,
-    LAST = 46,
+    REPAIR_GET_ROW_HASHES_SKETCH = 46,
+    REPAIR_GET_RANGE_HASH = 47,
+    HINT_MUTATION_BATCH = 48,
+    LAST = 49,
 };
 
 } // namespace netw
@@ -177,14 +181,25 @@ class messaging_service : public seastar::async_sharded_service<messaging_servic
     using msg_addr = netw::msg_addr;
     using inet_address = gms::inet_address;
     using UUID = utils::UUID;
-    using clients_map = std::unordered_map<msg_addr, shard_info, msg_addr::hash>;
+    // Clients are kept per node, plus one per shard of the node for the
+    // pinned addresses. Unlike msg_addr's own comparison, which identifies
+    // the node, these tell them apart.
+    struct client_key_hash {
+        size_t operator()(const msg_addr& id) const noexcept;
+    };
+    struct client_key_equal {
+        bool operator()(const msg_addr& x, const msg_addr& y) const noexcept;
+    };
+    using clients_map = std::unordered_map<msg_addr, shard_info, client_key_hash, client_key_equal>;
 
     // This should change only if serialization format changes
     static constexpr int32_t current_version = 0;
 
     struct shard_info {
-        shard_info(shared_ptr<rpc_protocol_client_wrapper>&& client);
+        shard_info(shared_ptr<rpc_protocol_client_wrapper>&& client, uint16_t local_port = 0);
         shared_ptr<rpc_protocol_client_wrapper> rpc_client;
+        // Source port bound by a connection to a specific shard, 0 otherwise.
+        uint16_t local_port;
         rpc::stats get_stats() const;
     };
 
@@ -258,12 +273,20 @@ class messaging_service : public seastar::async_sharded_service<messaging_servic
     config _cfg;
     // map: Node broadcast address -> Node internal IP for communication within the same data center
     std::unordered_map<gms::inet_address, gms::inet_address> _preferred_ip_cache;
+    struct peer_sharding {
+        unsigned shard_count;
+        unsigned sharding_ignore_msb;
+    };
+    // map: Node broadcast address -> sharding of the node, as gossiped
+    std::unordered_map<gms::inet_address, peer_sharding> _peer_sharding;
     std::unique_ptr<rpc_protocol_wrapper> _rpc;
     std::array<std::unique_ptr<rpc_protocol_server_wrapper>, 2> _server;
     ::shared_ptr<seastar::tls::server_credentials> _credentials;
     std::unique_ptr<seastar::tls::credentials_builder> _credentials_builder;
     std::array<std::unique_ptr<rpc_protocol_server_wrapper>, 2> _server_tls;
     std::vector<clients_map> _clients;
+    // Source ports of the pinned connections, from net.ipv4.ip_local_port_range.
+    std::pair<uint16_t, uint16_t> _local_port_range;
     uint64_t _dropped_messages[static_cast<int32_t>(messaging_verb::LAST)] = {};
     bool _shutting_down = false;
     std::list<std::function<void(gms::inet_address ep)>> _connection_drop_notifiers;
@@ -292,6 +315,18 @@ class messaging_service : public seastar::async_sharded_service<messaging_servic
     gms::inet_address get_preferred_ip(gms::inet_address ep);
     future<> init_local_preferred_ip_cache();
     void cache_preferred_ip(gms::inet_address ep, gms::inet_address ip);
+    void set_peer_sharding(gms::inet_address ep, unsigned shard_count, unsigned sharding_ignore_msb);
+    // Pinned address of the shard of ep which owns the token. Connections to
+    // such an address are made to land on that shard, saving the replica a
+    // cross-shard hop. If the sharding of ep isn't known yet, returns the
+    // plain address of ep.
+    //
+    // Each local shard keeps a connection per shard of ep and per connection
+    // index of the verbs sent to such addresses (the one of hints, and the
+    // statement one of each tenant), on top of the plain ones. With the two
+    // default tenants, a node with L shards may thus open up to L * R * 3
+    // pinned connections to a node with R shards.
+    msg_addr shard_addr(gms::inet_address ep, const dht::token& t) const;
 
     future<> unregister_handler(messaging_verb verb);
 
@@ -350,6 +385,16 @@ class messaging_service : public seastar::async_sharded_service<messaging_servic
     future<> unregister_repair_get_full_row_hashes();
     future<repair_hash_set> send_repair_get_full_row_hashes(msg_addr id, uint32_t repair_meta_id);
 
+    // Wrapper for REPAIR_GET_ROW_HASHES_SKETCH
+    void register_repair_get_row_hashes_sketch(std::function<future<repair_hash_sketch> (const rpc::client_info& cinfo, uint32_t repair_meta_id, uint32_t nr_cells)>&& func);
+    future<> unregister_repair_get_row_hashes_sketch();
+    future<repair_hash_sketch> send_repair_get_row_hashes_sketch(msg_addr id, uint32_t repair_meta_id, uint32_t nr_cells);
+
+    // Wrapper for REPAIR_GET_RANGE_HASH
+    void register_repair_get_range_hash(std::function<future<std::optional<uint64_t>> (const rpc::client_info& cinfo, uint32_t repair_meta_id)>&& func);
+    future<> unregister_repair_get_range_hash();
+    future<std::optional<uint64_t>> send_repair_get_range_hash(msg_addr id, uint32_t repair_meta_id);
+
     // Wrapper for REPAIR_GET_COMBINED_ROW_HASH
     void register_repair_get_combined_row_hash(std::function<future<get_combined_row_hash_response> (const rpc::client_info& cinfo, uint32_t repair_meta_id, std::optional<repair_sync_boundary> common_sync_boundary)>&& func);
     future<> unregister_repair_get_combined_row_hash();
@@ -469,9 +514,9 @@ class messaging_service : public seastar::async_sharded_service<messaging_servic
 
     // Wrapper for READ_DATA
     // Note: WTH is future<foreign_ptr<lw_shared_ptr<query::result>>
-    void register_read_data(std::function<future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature>> (const rpc::client_info&, rpc::opt_time_point timeout, query::read_command cmd, ::compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> digest)>&& func);
+    void register_read_data(std::function<future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature, service::replica_load>> (const rpc::client_info&, rpc::opt_time_point timeout, query::read_command cmd, ::compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> digest)>&& func);
     future<> unregister_read_data();
-    future<rpc::tuple<query::result, rpc::optional<cache_temperature>>> send_read_data(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const dht::partition_range& pr, query::digest_algorithm da);
+    future<rpc::tuple<query::result, rpc::optional<cache_temperature>, rpc::optional<service::replica_load>>> send_read_data(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const dht::partition_range& pr, query::digest_algorithm da);
 
     // Wrapper for GET_SCHEMA_VERSION
     void register_get_schema_version(std::function<future<frozen_schema>(unsigned, table_schema_version)>&& func);
@@ -484,14 +529,14 @@ class messaging_service : public seastar::async_sharded_service<messaging_servic
     future<utils::UUID> send_schema_check(msg_addr);
 
     // Wrapper for READ_MUTATION_DATA
-    void register_read_mutation_data(std::function<future<rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature>> (const rpc::client_info&, rpc::opt_time_point timeout, query::read_command cmd, ::compat::wrapping_partition_range pr)>&& func);
+    void register_read_mutation_data(std::function<future<rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature, service::replica_load>> (const rpc::client_info&, rpc::opt_time_point timeout, query::read_command cmd, ::compat::wrapping_partition_range pr)>&& func);
     future<> unregister_read_mutation_data();
-    future<rpc::tuple<reconcilable_result, rpc::optional<cache_temperature>>> send_read_mutation_data(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const dht::partition_range& pr);
+    future<rpc::tuple<reconcilable_result, rpc::optional<cache_temperature>, rpc::optional<service::replica_load>>> send_read_mutation_data(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const dht::partition_range& pr);
 
     // Wrapper for READ_DIGEST
-    void register_read_digest(std::function<future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature>> (const rpc::client_info&, rpc::opt_time_point timeout, query::read_command cmd, ::compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> digest)>&& func);
+    void register_read_digest(std::function<future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature, service::replica_load>> (const rpc::client_info&, rpc::opt_time_point timeout, query::read_command cmd, ::compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> digest)>&& func);
     future<> unregister_read_digest();
-    future<rpc::tuple<query::result_digest, rpc::optional<api::timestamp_type>, rpc::optional<cache_temperature>>> send_read_digest(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const dht::partition_range& pr, query::digest_algorithm da);
+    future<rpc::tuple<query::result_digest, rpc::optional<api::timestamp_type>, rpc::optional<cache_temperature>, rpc::optional<service::replica_load>>> send_read_digest(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const dht::partition_range& pr, query::digest_algorithm da);
 
     // Wrapper for TRUNCATE
     void register_truncate(std::function<future<>(sstring, sstring)>&& func);
@@ -547,9 +592,19 @@ class messaging_service : public seastar::async_sharded_service<messaging_servic
     future<> send_hint_mutation(msg_addr id, clock_type::time_point timeout, const frozen_mutation& fm, std::vector<inet_address> forward,
         inet_address reply_to, unsigned shard, response_id_type response_id, std::optional<tracing::trace_info> trace_info = std::nullopt);
 
+    // Wrapper for HINT_MUTATION_BATCH, the response holds the indexes of the mutations which failed to apply
+    void register_hint_mutation_batch(std::function<future<std::vector<uint32_t>> (const rpc::client_info&, rpc::opt_time_point, std::vector<frozen_mutation> fms)>&& func);
+    future<> unregister_hint_mutation_batch();
+    future<std::vector<uint32_t>> send_hint_mutation_batch(msg_addr id, clock_type::time_point timeout, std::vector<frozen_mutation> fms);
+
     void foreach_server_connection_stats(std::function<void(const rpc::client_info&, const rpc::stats&)>&& f) const;
 private:
     bool remove_rpc_client_one(clients_map& clients, msg_addr id, bool dead_only);
+    // The key of the client used to send to id: id itself if it is pinned and
+    // the sharding of the node is known, the node's plain connection otherwise.
+    msg_addr client_addr(msg_addr id) const;
+    void remove_pinned_rpc_clients(gms::inet_address ep, unsigned shard_count);
+    std::optional<uint16_t> local_port_for_shard(msg_addr id, unsigned shard_count, const net::inet_address& local_ip) const;
     void do_start_listen();
 public:
     // Return rpc::protocol::client for a shard which is a ip + cpuid pair.
@@ -29,6 +29,10 @@ namespace netw {
 struct msg_addr {
     gms::inet_address addr;
     uint32_t cpu_id;
+    // The connection must land on shard cpu_id of the node. Only set for
+    // verbs routed by token, see messaging_service::shard_addr(). Other
+    // messages use the node's plain connection, whatever cpu_id is.
+    bool shard_pinned = false;
     friend bool operator==(const msg_addr& x, const msg_addr& y) noexcept;
     friend bool operator<(const msg_addr& x, const msg_addr& y) noexcept;
     friend std::ostream& operator<<(std::ostream& os, const msg_addr& x);
@@ -37,6 +41,11 @@ struct msg_addr {
     };
     explicit msg_addr(gms::inet_address ip) noexcept : addr(ip), cpu_id(0) { }
     msg_addr(gms::inet_address ip, uint32_t cpu) noexcept : addr(ip), cpu_id(cpu) { }
+    static msg_addr pinned(gms::inet_address ip, uint32_t cpu) noexcept {
+        msg_addr ret(ip, cpu);
+        ret.shard_pinned = true;
+        return ret;
+    }
 };
 
 }
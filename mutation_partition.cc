@@ -32,7 +32,6 @@
 #include "mutation_query.hh"
 #include "service/priority_manager.hh"
 #include "mutation_compactor.hh"
-#include "intrusive_set_external_comparator.hh"
 #include "counters.hh"
 #include "row_cache.hh"
 #include "view_info.hh"
@@ -180,7 +179,10 @@ mutation_partition::mutation_partition(const mutation_partition& x, const schema
     try {
         for(auto&& r : ck_ranges) {
             for (const rows_entry& e : x.range(schema, r)) {
-                _rows.insert(_rows.end(), *current_allocator().construct<rows_entry>(schema, e), rows_entry::compare(schema));
+                auto ce = alloc_strategy_unique_ptr<rows_entry>(current_allocator().construct<rows_entry>(schema, e));
+                if (_rows.insert_check(_rows.end(), *ce, rows_entry::compare(schema)).second) {
+                    ce.release();
+                }
             }
             for (auto&& rt : x._row_tombstones.slice(schema, r)) {
                 _row_tombstones.apply(schema, rt);
@@ -247,8 +249,10 @@ mutation_partition::operator=(mutation_partition&& x) noexcept {
 void mutation_partition::ensure_last_dummy(const schema& s) {
     check_schema(s);
     if (_rows.empty() || !_rows.rbegin()->is_last_dummy()) {
-        _rows.insert_before(_rows.end(),
-            *current_allocator().construct<rows_entry>(s, rows_entry::last_dummy_tag(), is_continuous::yes));
+        auto e = alloc_strategy_unique_ptr<rows_entry>(
+            current_allocator().construct<rows_entry>(s, rows_entry::last_dummy_tag(), is_continuous::yes));
+        _rows.insert_before(_rows.end(), *e);
+        e.release();
     }
 }
 
@@ -329,23 +333,23 @@ stop_iteration mutation_partition::apply_monotonically(const schema& s, mutation
             i = _rows.lower_bound(src_e, less);
         }
         if (i == _rows.end() || less(src_e, *i)) {
-            p_i = p._rows.erase(p_i);
-
-            bool insert = true;
-            if (i != _rows.end() && i->continuous()) {
-                // When falling into a continuous range, preserve continuity.
-                src_e.set_continuous(true);
-
-                if (src_e.dummy()) {
-                    if (tracker) {
-                        tracker->on_remove(src_e);
-                    }
-                    del(&src_e);
-                    insert = false;
+            bool continuous = i != _rows.end() && i->continuous();
+            if (continuous && src_e.dummy()) {
+                p_i = p._rows.erase(p_i);
+                if (tracker) {
+                    tracker->on_remove(src_e);
                 }
-            }
-            if (insert) {
+                del(&src_e);
+            } else {
+                auto next_p_i = std::next(p_i);
+                // Moves src_e out of p only once the insertion can no longer fail,
+                // so that p_i stays valid for the exception handler below.
                 _rows.insert_before(i, src_e);
+                p_i = next_p_i;
+                if (continuous) {
+                    // When falling into a continuous range, preserve continuity.
+                    src_e.set_continuous(true);
+                }
             }
         } else {
             auto continuous = i->continuous() || src_e.continuous();
@@ -748,7 +752,8 @@ void appending_hash<row>::operator()(Hasher& h, const row& cells, const schema&
                 if (cell_and_hash->hash) {
                     feed_hash(h, *cell_and_hash->hash);
                 } else {
-                    Hasher cellh;
+                    // Has to match the cached hash, see row::prepare_hash().
+                    query::default_hasher cellh;
                     feed_hash(cellh, cell_and_hash->cell.as_atomic_cell(def), def);
                     feed_hash(h, cellh.finalize_uint64());
                 }
@@ -762,7 +767,7 @@ void appending_hash<row>::operator()(Hasher& h, const row& cells, const schema&
                 if (cell_and_hash->hash) {
                     feed_hash(h, *cell_and_hash->hash);
                 } else {
-                    Hasher cellh;
+                    query::default_hasher cellh;
                     feed_hash(cellh, cm, def);
                     feed_hash(h, cellh.finalize_uint64());
                 }
@@ -772,8 +777,9 @@ void appending_hash<row>::operator()(Hasher& h, const row& cells, const schema&
         }
     }
 }
-// Instantiation for mutation_test.cc
+// Instantiations for mutation_test.cc and perf_mutation_fragment.cc
 template void appending_hash<row>::operator()<xx_hasher>(xx_hasher& h, const row& cells, const schema& s, column_kind kind, const query::column_id_vector& columns, max_timestamp& max_ts) const;
+template void appending_hash<row>::operator()<xxh3_hasher>(xxh3_hasher& h, const row& cells, const schema& s, column_kind kind, const query::column_id_vector& columns, max_timestamp& max_ts) const;
 
 template<>
 void appending_hash<row>::operator()<legacy_xx_hasher_without_null_digest>(legacy_xx_hasher_without_null_digest& h, const row& cells, const schema& s, column_kind kind, const query::column_id_vector& columns, max_timestamp& max_ts) const {
@@ -1585,21 +1591,15 @@ mutation_partition::row_count() const {
 }
 
 rows_entry::rows_entry(rows_entry&& o) noexcept
-    : _link(std::move(o._link))
+    : evictable(std::move(o))
+    , _flags(std::move(o._flags))
+    , _link(std::move(o._link))
     , _key(std::move(o._key))
     , _row(std::move(o._row))
-    , _lru_link()
-    , _flags(std::move(o._flags))
-{
-    if (o._lru_link.is_linked()) {
-        auto prev = o._lru_link.prev_;
-        o._lru_link.unlink();
-        cache_tracker::lru_type::node_algorithms::link_after(prev, _lru_link.this_ptr());
-    }
-}
+{ }
 
 void rows_entry::replace_with(rows_entry&& o) noexcept {
-    _lru_link.swap_nodes(o._lru_link);
+    swap_lru_position(o);
     _row = std::move(o._row);
 }
 
@@ -2441,8 +2441,10 @@ mutation_partition::mutation_partition(mutation_partition::incomplete_tag, const
     , _schema_version(s.version())
 #endif
 {
-    _rows.insert_before(_rows.end(),
-        *current_allocator().construct<rows_entry>(s, rows_entry::last_dummy_tag(), is_continuous::no));
+    auto e = alloc_strategy_unique_ptr<rows_entry>(
+        current_allocator().construct<rows_entry>(s, rows_entry::last_dummy_tag(), is_continuous::no));
+    _rows.insert_before(_rows.end(), *e);
+    e.release();
 }
 
 bool mutation_partition::is_fully_continuous() const {
@@ -2479,13 +2481,18 @@ void mutation_partition::set_continuity(const schema& s, const position_range& p
 
     auto end = _rows.lower_bound(pr.end(), less);
     if (end == _rows.end() || less(pr.end(), end->position())) {
-        end = _rows.insert_before(end, *current_allocator().construct<rows_entry>(s, pr.end(), is_dummy::yes,
+        auto e = alloc_strategy_unique_ptr<rows_entry>(current_allocator().construct<rows_entry>(s, pr.end(), is_dummy::yes,
             end == _rows.end() ? is_continuous::yes : end->continuous()));
+        end = _rows.insert_before(end, *e);
+        e.release();
     }
 
     auto i = _rows.lower_bound(pr.start(), less);
     if (less(pr.start(), i->position())) {
-        i = _rows.insert_before(i, *current_allocator().construct<rows_entry>(s, pr.start(), is_dummy::yes, i->continuous()));
+        auto e = alloc_strategy_unique_ptr<rows_entry>(
+            current_allocator().construct<rows_entry>(s, pr.start(), is_dummy::yes, i->continuous()));
+        i = _rows.insert_before(i, *e);
+        e.release();
     }
 
     assert(i != end);
@@ -44,7 +44,8 @@
 #include "hashing_partition_visitor.hh"
 #include "range_tombstone_list.hh"
 #include "clustering_key_filter.hh"
-#include "intrusive_set_external_comparator.hh"
+#include "utils/intrusive_btree.hh"
+#include "utils/lru.hh"
 #include "utils/preempt.hh"
 #include "utils/managed_ref.hh"
 
@@ -1020,13 +1021,9 @@ class deletable_row final {
 
 class cache_tracker;
 
-class rows_entry {
-    using lru_link_type = bi::list_member_hook<bi::link_mode<bi::auto_unlink>>;
+class rows_entry final : public evictable {
     friend class size_calculator;
-    intrusive_set_external_comparator_member_hook _link;
-    clustering_key _key;
-    deletable_row _row;
-    lru_link_type _lru_link;
+    // Comes first, so that it's placed into the tail padding of evictable.
     struct flags {
         // _before_ck and _after_ck encode position_in_partition::weight
         bool _before_ck : 1;
@@ -1038,22 +1035,24 @@ class rows_entry {
         bool _last_dummy : 1;
         flags() : _before_ck(0), _after_ck(0), _continuous(true), _dummy(false), _last_dummy(false) { }
     } _flags{};
+    intrusive_b::member_hook _link;
+    clustering_key _key;
+    deletable_row _row;
 public:
-    using container_type = intrusive_set_external_comparator<rows_entry, &rows_entry::_link>;
-    using lru_type = bi::list<rows_entry,
-        bi::member_hook<rows_entry, rows_entry::lru_link_type, &rows_entry::_lru_link>,
-        bi::constant_time_size<false>>; // we need this to have bi::auto_unlink on hooks.
+    using container_type = intrusive_b::tree<rows_entry, &rows_entry::_link, intrusive_b::key_search::linear>;
 
-    void unlink_from_lru() noexcept { _lru_link.unlink(); }
     struct last_dummy_tag {};
     explicit rows_entry(clustering_key&& key)
-        : _key(std::move(key))
+        : evictable(kind::rows_entry)
+        , _key(std::move(key))
     { }
     explicit rows_entry(const clustering_key& key)
-        : _key(key)
+        : evictable(kind::rows_entry)
+        , _key(key)
     { }
     rows_entry(const schema& s, position_in_partition_view pos, is_dummy dummy, is_continuous continuous)
-        : _key(pos.key())
+        : evictable(kind::rows_entry)
+        , _key(pos.key())
     {
         _flags._last_dummy = bool(dummy) && pos.is_after_all_clustered_rows(s);
         _flags._dummy = bool(dummy);
@@ -1065,16 +1064,19 @@ class rows_entry {
         : rows_entry(s, position_in_partition_view::after_all_clustered_rows(), is_dummy::yes, continuous)
     { }
     rows_entry(const clustering_key& key, deletable_row&& row)
-        : _key(key), _row(std::move(row))
+        : evictable(kind::rows_entry)
+        , _key(key), _row(std::move(row))
     { }
     rows_entry(const schema& s, const clustering_key& key, const deletable_row& row)
-        : _key(key), _row(s, row)
+        : evictable(kind::rows_entry)
+        , _key(key), _row(s, row)
     { }
     rows_entry(rows_entry&& o) noexcept;
     rows_entry(const schema& s, const rows_entry& e)
-        : _key(e._key)
-        , _row(s, e._row)
+        : evictable(kind::rows_entry)
         , _flags(e._flags)
+        , _key(e._key)
+        , _row(s, e._row)
     { }
     // Valid only if !dummy()
     clustering_key& key() {
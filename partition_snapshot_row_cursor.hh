@@ -412,11 +412,12 @@ class partition_snapshot_row_cursor final {
         } else {
             // Copy row from older version because rows in evictable versions must
             // hold values which are independently complete to be consistent on eviction.
-            auto e = current_allocator().construct<rows_entry>(_schema, *_current_row[0].it);
+            auto e = alloc_strategy_unique_ptr<rows_entry>(
+                current_allocator().construct<rows_entry>(_schema, *_current_row[0].it));
             e->set_continuous(latest_i != rows.end() && latest_i->continuous());
-            _snp.tracker()->insert(*e);
             rows.insert_before(latest_i, *e);
-            return {*e, true};
+            _snp.tracker()->insert(*e);
+            return {*e.release(), true};
         }
     }
 
@@ -448,11 +449,12 @@ class partition_snapshot_row_cursor final {
         }
         auto&& rows = _snp.version()->partition().clustered_rows();
         auto latest_i = get_iterator_in_latest_version();
-        auto e = current_allocator().construct<rows_entry>(_schema, pos, is_dummy(!pos.is_clustering_row()),
-            is_continuous(latest_i != rows.end() && latest_i->continuous()));
-        _snp.tracker()->insert(*e);
+        auto e = alloc_strategy_unique_ptr<rows_entry>(
+            current_allocator().construct<rows_entry>(_schema, pos, is_dummy(!pos.is_clustering_row()),
+                is_continuous(latest_i != rows.end() && latest_i->continuous())));
         rows.insert_before(latest_i, *e);
-        return ensure_result{*e, true};
+        _snp.tracker()->insert(*e);
+        return ensure_result{*e.release(), true};
     }
 
     // Brings the entry pointed to by the cursor to the front of the LRU
@@ -526,6 +526,12 @@ class partition_entry {
         return _version->all_elements_reversed();
     }
 
+    // Tells whether a snapshot refers to the latest version of this entry.
+    // If not, the latest version can be updated in place.
+    bool has_snapshot() const {
+        return _snapshot;
+    }
+
     // Tells whether this entry is locked.
     // Locked entries are undergoing an update and should not have their snapshots
     // detached from the entry.
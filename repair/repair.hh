@@ -472,9 +472,19 @@ struct repair_row_on_wire_with_cmd {
     repair_row_on_wire row;
 };
 
+// Return value of the REPAIR_GET_ROW_HASHES_SKETCH RPC verb.
+// The cells of a utils::iblt of the row hashes in the working row buf,
+// stored column-wise.
+struct repair_hash_sketch {
+    std::vector<int32_t> counts;
+    std::vector<uint64_t> key_sums;
+    std::vector<uint64_t> hash_sums;
+};
+
 enum class row_level_diff_detect_algorithm : uint8_t {
     send_full_set,
     send_full_set_rpc_stream,
+    send_sketch_rpc_stream,
 };
 
 std::ostream& operator<<(std::ostream& out, row_level_diff_detect_algorithm algo);
@@ -31,6 +31,7 @@
 #include "xx_hasher.hh"
 #include "utils/UUID.hh"
 #include "utils/hash.hh"
+#include "utils/iblt.hh"
 #include "service/priority_manager.hh"
 #include "service/storage_proxy.hh"
 #include "db/view/view_update_checks.hh"
@@ -73,6 +74,8 @@ enum class repair_state : uint16_t {
     get_estimated_partitions_finished,
     set_estimated_partitions_started,
     set_estimated_partitions_finished,
+    get_range_hash_started,
+    get_range_hash_finished,
     get_sync_boundary_started,
     get_sync_boundary_finished,
     get_combined_row_hash_started,
@@ -85,6 +88,8 @@ enum class repair_state : uint16_t {
     get_full_row_hashes_with_rpc_stream_finished,
     get_full_row_hashes_started,
     get_full_row_hashes_finished,
+    get_row_hashes_sketch_started,
+    get_row_hashes_sketch_finished,
     get_row_diff_started,
     get_row_diff_finished,
     put_row_diff_with_rpc_stream_started,
@@ -180,6 +185,10 @@ struct row_level_repair_metrics {
     uint64_t row_from_disk_bytes{0};
     uint64_t tx_hashes_nr{0};
     uint64_t rx_hashes_nr{0};
+    uint64_t rx_hashes_sketch_cells{0};
+    uint64_t hashes_sketch_decoded_nr{0};
+    uint64_t hashes_sketch_failed_nr{0};
+    uint64_t range_hashes_in_sync_nr{0};
     row_level_repair_metrics() {
         namespace sm = seastar::metrics;
         _metrics.add_group("repair", {
@@ -195,6 +204,14 @@ struct row_level_repair_metrics {
                             sm::description("Total number of row hashes sent on this shard.")),
             sm::make_derive("rx_hashes_nr", rx_hashes_nr,
                             sm::description("Total number of row hashes received on this shard.")),
+            sm::make_derive("rx_hashes_sketch_cells", rx_hashes_sketch_cells,
+                            sm::description("Total number of row hash sketch cells received on this shard.")),
+            sm::make_derive("hashes_sketch_decoded_nr", hashes_sketch_decoded_nr,
+                            sm::description("Total number of row hash sketches which were decoded on this shard.")),
+            sm::make_derive("hashes_sketch_failed_nr", hashes_sketch_failed_nr,
+                            sm::description("Total number of row hash sketches which failed to decode on this shard and fell back to the full row hashes.")),
+            sm::make_derive("range_hashes_in_sync_nr", range_hashes_in_sync_nr,
+                            sm::description("Total number of ranges found in sync by the sstable range hashes on this shard, without reading any rows.")),
             sm::make_derive("row_from_disk_nr", row_from_disk_nr,
                             sm::description("Total number of rows read from disk on this shard.")),
             sm::make_derive("row_from_disk_bytes", row_from_disk_bytes,
@@ -209,6 +226,7 @@ static const std::vector<row_level_diff_detect_algorithm>& suportted_diff_detect
     static std::vector<row_level_diff_detect_algorithm> _algorithms = {
         row_level_diff_detect_algorithm::send_full_set,
         row_level_diff_detect_algorithm::send_full_set_rpc_stream,
+        row_level_diff_detect_algorithm::send_sketch_rpc_stream,
     };
     return _algorithms;
 };
@@ -246,6 +264,40 @@ static bool is_rpc_stream_supported(row_level_diff_detect_algorithm algo) {
     return algo != row_level_diff_detect_algorithm::send_full_set;
 }
 
+static bool is_sketch_supported(row_level_diff_detect_algorithm algo) {
+    return algo == row_level_diff_detect_algorithm::send_sketch_rpc_stream;
+}
+
+// Upper bound on the size of a row hashes sketch a peer may ask for, about
+// 5MB on the wire. Larger differences are reconciled with full row hashes.
+static constexpr uint32_t max_row_hashes_sketch_cells = 256 * 1024;
+
+static repair_hash_sketch to_repair_hash_sketch(const utils::iblt& t) {
+    repair_hash_sketch sketch;
+    sketch.counts.reserve(t.size());
+    sketch.key_sums.reserve(t.size());
+    sketch.hash_sums.reserve(t.size());
+    for (auto& c : t.cells()) {
+        sketch.counts.push_back(c.count);
+        sketch.key_sums.push_back(c.key_sum);
+        sketch.hash_sums.push_back(c.hash_sum);
+    }
+    return sketch;
+}
+
+static utils::iblt to_iblt(const repair_hash_sketch& sketch) {
+    if (sketch.key_sums.size() != sketch.counts.size() || sketch.hash_sums.size() != sketch.counts.size()) {
+        throw std::runtime_error(format("Malformed row hashes sketch: counts={}, key_sums={}, hash_sums={}",
+                sketch.counts.size(), sketch.key_sums.size(), sketch.hash_sums.size()));
+    }
+    std::vector<utils::iblt::cell> cells;
+    cells.reserve(sketch.counts.size());
+    for (size_t i = 0; i < sketch.counts.size(); ++i) {
+        cells.push_back(utils::iblt::cell{sketch.counts[i], sketch.key_sums[i], sketch.hash_sums[i]});
+    }
+    return utils::iblt(std::move(cells));
+}
+
 static uint64_t get_random_seed() {
     static thread_local std::default_random_engine random_engine{std::random_device{}()};
     static thread_local std::uniform_int_distribution<uint64_t> random_dist{};
@@ -742,6 +794,9 @@ class repair_meta {
     row_level_repair* _row_level_repair_ptr;
     std::vector<repair_node_state> _all_node_states;
     is_dirty_on_master _dirty_on_master = is_dirty_on_master::no;
+    // Expected number of rows which differ between the working row bufs of
+    // the repair master and a peer, used to size the row hashes sketch.
+    size_t _estimated_set_diff = 0;
 public:
     std::vector<repair_node_state>& all_nodes() {
         return _all_node_states;
@@ -778,6 +833,9 @@ class repair_meta {
     bool use_rpc_stream() const {
         return is_rpc_stream_supported(_algo);
     }
+    bool use_sketch() const {
+        return is_sketch_supported(_algo);
+    }
 
 public:
     repair_meta(
@@ -1095,6 +1153,20 @@ class repair_meta {
         });
     }
 
+    // Returns the hash of the data of the whole range, or a disengaged
+    // optional if the hash can't be compared with the other nodes.
+    // A follower with a different sharding config holds the data of
+    // the range in other shards than the master, so the hash of the
+    // local shard doesn't cover the same rows.
+    future<std::optional<uint64_t>> get_range_hash() {
+        return with_gate(_gate, [this] {
+            if (!_repair_master && !_same_sharding_config) {
+                return make_ready_future<std::optional<uint64_t>>(std::nullopt);
+            }
+            return _cf.get_range_hash(_range, service::get_local_streaming_priority());
+        });
+    }
+
     dht::sharder make_remote_sharder() {
         return dht::sharder(_master_node_shard_config.shard_count, _master_node_shard_config.ignore_msb);
     }
@@ -1542,6 +1614,75 @@ class repair_meta {
         });
     }
 
+    // RPC API
+    // Return a sketch of the hashes of the rows in _working_row_buf
+    future<repair_hash_sketch>
+    get_row_hashes_sketch(gms::inet_address remote_node, uint32_t nr_cells) {
+        if (remote_node == _myip) {
+            return get_row_hashes_sketch_handler(nr_cells);
+        }
+        return _messaging.local().send_repair_get_row_hashes_sketch(msg_addr(remote_node),
+                _repair_meta_id, nr_cells).then([this, remote_node] (repair_hash_sketch sketch) {
+            rlogger.debug("Got row hashes sketch from peer={}, nr_cells={}", remote_node, sketch.counts.size());
+            _metrics.rx_hashes_sketch_cells += sketch.counts.size();
+            stats().rpc_call_nr++;
+            return sketch;
+        });
+    }
+
+    // Must run inside a seastar thread
+    // Reconstructs the row hashes of the peer from a sketch of them and the
+    // local row hashes. Returns a disengaged optional if the sketch fails to
+    // decode, or if it would not be smaller than the full row hashes, in which
+    // case the caller has to fetch the full row hashes.
+    std::optional<repair_hash_set>
+    get_peer_row_hashes_with_sketch(gms::inet_address remote_node) {
+        repair_hash_set hashes = working_row_hashes().get0();
+        auto nr_cells = utils::iblt::cells_for(_estimated_set_diff);
+        // A cell takes 20 bytes on the wire, a row hash 8 bytes. Peers reject
+        // sketches larger than max_row_hashes_sketch_cells.
+        if (nr_cells * 20 >= hashes.size() * 8 || nr_cells > max_row_hashes_sketch_cells) {
+            return std::nullopt;
+        }
+        auto sketch = to_iblt(get_row_hashes_sketch(remote_node, nr_cells).get0());
+        utils::iblt local_sketch(sketch.size());
+        for (auto& h : hashes) {
+            local_sketch.insert(h.hash);
+            thread::maybe_yield();
+        }
+        sketch.subtract(local_sketch);
+        auto diff = sketch.decode();
+        // Decoding is probabilistic, rows only the peer has must be new to
+        // us and rows only we have must be ours, or the result is bogus.
+        auto apply_diff = [&] {
+            for (auto h : diff->removed) {
+                if (!hashes.erase(repair_hash(h))) {
+                    return false;
+                }
+            }
+            for (auto h : diff->added) {
+                if (!hashes.emplace(h).second) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        if (!diff || !apply_diff()) {
+            rlogger.debug("Failed to decode row hashes sketch from peer={}, nr_cells={}, estimated_set_diff={}",
+                    remote_node, sketch.size(), _estimated_set_diff);
+            _metrics.hashes_sketch_failed_nr++;
+            return std::nullopt;
+        }
+        _metrics.hashes_sketch_decoded_nr++;
+        update_estimated_set_diff(diff->added.size() + diff->removed.size());
+        return hashes;
+    }
+
+    // Sizes the next sketch by the difference observed in this round
+    void update_estimated_set_diff(size_t set_diff) {
+        _estimated_set_diff = set_diff + set_diff / 2;
+    }
+
 private:
     future<> get_full_row_hashes_source_op(
             lw_shared_ptr<repair_hash_set> current_hashes,
@@ -1609,6 +1750,24 @@ class repair_meta {
         });
     }
 
+    // RPC handler
+    future<repair_hash_sketch>
+    get_row_hashes_sketch_handler(uint32_t nr_cells) {
+        if (nr_cells == 0 || nr_cells > max_row_hashes_sketch_cells) {
+            return make_exception_future<repair_hash_sketch>(std::runtime_error(
+                    format("Invalid number of row hashes sketch cells: {}, expected 1 to {}", nr_cells, max_row_hashes_sketch_cells)));
+        }
+        return with_gate(_gate, [this, nr_cells] {
+            return do_with(utils::iblt(nr_cells), [this] (utils::iblt& sketch) {
+                return do_for_each(_working_row_buf, [&sketch] (repair_row& r) {
+                    sketch.insert(r.hash().hash);
+                }).then([&sketch] {
+                    return to_repair_hash_sketch(sketch);
+                });
+            });
+        });
+    }
+
     // RPC API
     // Return the combined hashes of the current working row buf
     future<get_combined_row_hash_response>
@@ -1721,6 +1880,26 @@ class repair_meta {
         });
     }
 
+    // RPC API
+    future<std::optional<uint64_t>> repair_get_range_hash(gms::inet_address remote_node) {
+        if (remote_node == _myip) {
+            return get_range_hash();
+        }
+        stats().rpc_call_nr++;
+        return _messaging.local().send_repair_get_range_hash(msg_addr(remote_node), _repair_meta_id);
+    }
+
+
+    // RPC handler
+    static future<std::optional<uint64_t>> repair_get_range_hash_handler(gms::inet_address from, uint32_t repair_meta_id) {
+        auto rm = get_repair_meta(from, repair_meta_id);
+        rm->set_repair_state_for_local_node(repair_state::get_range_hash_started);
+        return rm->get_range_hash().then([rm] (std::optional<uint64_t> hash) {
+            rm->set_repair_state_for_local_node(repair_state::get_range_hash_finished);
+            return hash;
+        });
+    }
+
     // RPC API
     future<> repair_set_estimated_partitions(gms::inet_address remote_node, uint64_t estimated_partitions) {
         if (remote_node == _myip) {
@@ -2316,6 +2495,18 @@ future<> row_level_repair_init_messaging_service_handler(repair_service& rs, dis
                 });
             }) ;
         });
+        ms.register_repair_get_row_hashes_sketch([] (const rpc::client_info& cinfo, uint32_t repair_meta_id, uint32_t nr_cells) {
+            auto src_cpu_id = cinfo.retrieve_auxiliary<uint32_t>("src_cpu_id");
+            auto from = cinfo.retrieve_auxiliary<gms::inet_address>("baddr");
+            return smp::submit_to(src_cpu_id % smp::count, [from, repair_meta_id, nr_cells] {
+                auto rm = repair_meta::get_repair_meta(from, repair_meta_id);
+                rm->set_repair_state_for_local_node(repair_state::get_row_hashes_sketch_started);
+                return rm->get_row_hashes_sketch_handler(nr_cells).then([rm] (repair_hash_sketch sketch) {
+                    rm->set_repair_state_for_local_node(repair_state::get_row_hashes_sketch_finished);
+                    return sketch;
+                });
+            });
+        });
         ms.register_repair_get_combined_row_hash([] (const rpc::client_info& cinfo, uint32_t repair_meta_id,
                 std::optional<repair_sync_boundary> common_sync_boundary) {
             auto src_cpu_id = cinfo.retrieve_auxiliary<uint32_t>("src_cpu_id");
@@ -2424,6 +2615,13 @@ future<> row_level_repair_init_messaging_service_handler(repair_service& rs, dis
                 return repair_meta::repair_set_estimated_partitions_handler(from, repair_meta_id, estimated_partitions);
             });
         });
+        ms.register_repair_get_range_hash([] (const rpc::client_info& cinfo, uint32_t repair_meta_id) {
+            auto src_cpu_id = cinfo.retrieve_auxiliary<uint32_t>("src_cpu_id");
+            auto from = cinfo.retrieve_auxiliary<gms::inet_address>("baddr");
+            return smp::submit_to(src_cpu_id % smp::count, [from, repair_meta_id] () mutable {
+                return repair_meta::repair_get_range_hash_handler(from, repair_meta_id);
+            });
+        });
         ms.register_repair_get_diff_algorithms([] (const rpc::client_info& cinfo) {
             return make_ready_future<std::vector<row_level_diff_detect_algorithm>>(suportted_diff_detect_algorithms());
         });
@@ -2437,6 +2635,7 @@ future<> row_level_repair_uninit_messaging_service_handler() {
             ms.unregister_repair_put_row_diff_with_rpc_stream(),
             ms.unregister_repair_get_full_row_hashes_with_rpc_stream(),
             ms.unregister_repair_get_full_row_hashes(),
+            ms.unregister_repair_get_row_hashes_sketch(),
             ms.unregister_repair_get_combined_row_hash(),
             ms.unregister_repair_get_sync_boundary(),
             ms.unregister_repair_get_row_diff(),
@@ -2445,6 +2644,7 @@ future<> row_level_repair_uninit_messaging_service_handler() {
             ms.unregister_repair_row_level_stop(),
             ms.unregister_repair_get_estimated_partitions(),
             ms.unregister_repair_set_estimated_partitions(),
+            ms.unregister_repair_get_range_hash(),
             ms.unregister_repair_get_diff_algorithms()).discard_result();
     });
 }
@@ -2693,8 +2893,18 @@ class row_level_repair {
 
             rlogger.debug("Before master.get_full_row_hashes for node {}, hash_sets={}",
                 node, master.peer_row_hash_sets(node_idx).size());
+            // If the rows differ only slightly, a sketch of the peer's hashes
+            // is enough to tell which, and much smaller than the full list.
+            std::optional<repair_hash_set> sketched_hashes;
+            if (master.use_sketch()) {
+                ns.state = repair_state::get_row_hashes_sketch_started;
+                sketched_hashes = master.get_peer_row_hashes_with_sketch(node);
+                ns.state = repair_state::get_row_hashes_sketch_finished;
+            }
             // Ask the peer to send the full list hashes in the working row buf.
-            if (master.use_rpc_stream()) {
+            if (sketched_hashes) {
+                master.peer_row_hash_sets(node_idx) = std::move(*sketched_hashes);
+            } else if (master.use_rpc_stream()) {
                 ns.state = repair_state::get_full_row_hashes_with_rpc_stream_started;
                 master.peer_row_hash_sets(node_idx) = master.get_full_row_hashes_with_rpc_stream(node, node_idx).get0();
                 ns.state = repair_state::get_full_row_hashes_with_rpc_stream_finished;
@@ -2714,6 +2924,11 @@ class row_level_repair {
             // repair master might reduce the amount of missing data
             // between repair master and repair follower 2.
             repair_hash_set set_diff = repair_meta::get_set_diff(master.peer_row_hash_sets(node_idx), master.working_row_hashes().get0());
+            if (master.use_sketch() && !sketched_hashes) {
+                // Size the next sketch by the difference the full row hashes revealed
+                auto local_only = repair_meta::get_set_diff(master.working_row_hashes().get0(), master.peer_row_hash_sets(node_idx));
+                master.update_estimated_set_diff(set_diff.size() + local_only.size());
+            }
             // Request missing sets from peer node
             rlogger.debug("Before get_row_diff to node {}, local={}, peer={}, set_diff={}",
                     node, master.working_row_hashes().get0().size(), master.peer_row_hash_sets(node_idx).size(), set_diff.size());
@@ -2767,6 +2982,34 @@ class row_level_repair {
         master.stats().round_nr_slow_path++;
     }
 
+    // Compares the hashes of the whole range kept in the sstables of
+    // all nodes. If they are equal, the nodes hold the same rows in the
+    // range and there is nothing to sync. A node which can't tell the
+    // hash makes the range go through the usual rounds.
+    bool range_hashes_match(repair_meta& master) {
+        if (!_ri.db.local().features().cluster_supports_repair_range_hashes()) {
+            return false;
+        }
+        std::vector<std::optional<uint64_t>> hashes(master.all_nodes().size());
+        size_t idx = 0;
+        parallel_for_each(master.all_nodes(), [&, this] (repair_node_state& ns) {
+            auto& hash = hashes[idx++];
+            ns.state = repair_state::get_range_hash_started;
+            return master.repair_get_range_hash(ns.node).then([&ns, &hash] (std::optional<uint64_t> h) {
+                ns.state = repair_state::get_range_hash_finished;
+                hash = h;
+            });
+        }).get();
+        bool match = std::all_of(hashes.begin(), hashes.end(), [&] (const std::optional<uint64_t>& h) {
+            return h && h == hashes.front();
+        });
+        rlogger.debug("Range hashes of keyspace={}, cf={}, range={}, match={}", _ri.keyspace, _cf_name, _range, match);
+        if (match) {
+            _metrics.range_hashes_in_sync_nr++;
+        }
+        return match;
+    }
+
 public:
     future<> run() {
         return seastar::async([this] {
@@ -2831,7 +3074,8 @@ class row_level_repair {
                     });
                 }).get();
 
-                while (true) {
+                bool in_sync = range_hashes_match(master);
+                while (!in_sync) {
                     auto status = negotiate_sync_boundary(master);
                     if (status == op_status::next_round) {
                         continue;
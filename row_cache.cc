@@ -33,6 +33,7 @@
 #include "dirty_memory_manager.hh"
 #include "cache_flat_mutation_reader.hh"
 #include "real_dirty_memory_accounter.hh"
+#include "sstables/partition_index_cache.hh"
 
 namespace cache {
 
@@ -52,14 +53,20 @@ row_cache::create_underlying_reader(read_context& ctx, mutation_source& src, con
 static thread_local mutation_application_stats dummy_app_stats;
 
 cache_tracker::cache_tracker()
-    : cache_tracker(dummy_app_stats)
+    : cache_tracker(dummy_app_stats, register_metrics::no)
 {}
 
-cache_tracker::cache_tracker(mutation_application_stats& app_stats)
+cache_tracker::cache_tracker(register_metrics with_metrics)
+    : cache_tracker(dummy_app_stats, with_metrics)
+{}
+
+cache_tracker::cache_tracker(mutation_application_stats& app_stats, register_metrics with_metrics)
     : _garbage(_region, this, app_stats)
     , _memtable_cleaner(_region, nullptr, app_stats)
 {
-    setup_metrics();
+    if (with_metrics) {
+        setup_metrics();
+    }
 
     _region.make_evictable([this] {
         return with_allocator(_region.allocator(), [this] {
@@ -155,9 +162,22 @@ void cache_tracker::clear() {
     allocator().invalidate_references();
 }
 
-void cache_tracker::touch(rows_entry& e) {
+void evictable::on_evicted(cache_tracker& tracker) noexcept {
+    switch (_kind) {
+    case kind::rows_entry:
+        static_cast<rows_entry*>(this)->on_evicted(tracker);
+        return;
+    case kind::partition_index_page:
+        static_cast<sstables::partition_index_page*>(this)->on_evicted(tracker);
+        return;
+    }
+    abort();
+}
+
+void cache_tracker::touch(evictable& e) {
     // last dummy may not be linked if evicted, but
-    // the unlink_from_lru() handles it
+    // the unlink_from_lru() handles it.
+    // Also used to link new objects which are not rows.
     e.unlink_from_lru();
     _lru.push_front(e);
 }
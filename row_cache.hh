@@ -28,6 +28,7 @@
 #include <seastar/core/memory.hh>
 #include <seastar/core/thread.hh>
 #include <seastar/util/noncopyable_function.hh>
+#include <seastar/util/bool_class.hh>
 
 #include "mutation_reader.hh"
 #include "mutation_partition.hh"
@@ -155,7 +156,10 @@ class cache_entry {
 // Tracks accesses and performs eviction of cache entries.
 class cache_tracker final {
 public:
-    using lru_type = rows_entry::lru_type;
+    using lru_type = evictable::lru_type;
+    // Only the database's tracker exports metrics, so that auxiliary trackers
+    // (e.g. ones owned by sstables_manager instances in tests) don't clash with it.
+    using register_metrics = bool_class<class register_metrics_tag>;
     friend class row_cache;
     friend class cache::read_context;
     friend class cache::autoupdating_underlying_reader;
@@ -203,11 +207,12 @@ class cache_tracker final {
 private:
     void setup_metrics();
 public:
-    cache_tracker(mutation_application_stats&);
+    cache_tracker(mutation_application_stats&, register_metrics);
+    explicit cache_tracker(register_metrics);
     cache_tracker();
     ~cache_tracker();
     void clear();
-    void touch(rows_entry&);
+    void touch(evictable&);
     void insert(cache_entry&);
     void insert(partition_entry&) noexcept;
     void insert(partition_version&) noexcept;
@@ -41,6 +41,7 @@
 #include "dht/token-sharding.hh"
 #include "cdc/cdc_extension.hh"
 #include "db/paxos_grace_seconds_extension.hh"
+#include "db/bloom_filter_type_extension.hh"
 
 constexpr int32_t schema::NAME_LENGTH;
 
@@ -513,6 +514,7 @@ bool operator==(const schema& x, const schema& y)
         && x._raw._type == y._raw._type
         && x._raw._gc_grace_seconds == y._raw._gc_grace_seconds
         && x.paxos_grace_seconds() == y.paxos_grace_seconds()
+        && x.bloom_filter_type() == y.bloom_filter_type()
         && x._raw._dc_local_read_repair_chance == y._raw._dc_local_read_repair_chance
         && x._raw._read_repair_chance == y._raw._read_repair_chance
         && x._raw._min_compaction_threshold == y._raw._min_compaction_threshold
@@ -1218,6 +1220,12 @@ schema_ptr schema_builder::build() {
             dynamic_pointer_cast<db::paxos_grace_seconds_extension>(it->second)->get_paxos_grace_seconds();
     }
 
+    // cache `bloom_filter_type` too, it's consulted by every sstable writer
+    if (auto it = new_raw._extensions.find(db::bloom_filter_type_extension::NAME); it != new_raw._extensions.end()) {
+        new_raw._bloom_filter_type =
+            dynamic_pointer_cast<db::bloom_filter_type_extension>(it->second)->get_bloom_filter_type();
+    }
+
     return make_lw_shared<schema>(schema(new_raw, _view_info));
 }
 
@@ -1241,6 +1249,11 @@ schema_builder& schema_builder::set_paxos_grace_seconds(int32_t seconds) {
     return *this;
 }
 
+schema_builder& schema_builder::set_bloom_filter_type(utils::filter_type type) {
+    add_extension(db::bloom_filter_type_extension::NAME, ::make_shared<db::bloom_filter_type_extension>(type));
+    return *this;
+}
+
 gc_clock::duration schema::paxos_grace_seconds() const {
     return std::chrono::duration_cast<gc_clock::duration>(
         std::chrono::seconds(
@@ -42,6 +42,7 @@
 #include "compaction_strategy_type.hh"
 #include "caching_options.hh"
 #include "column_computation.hh"
+#include "utils/i_filter.hh"
 
 namespace dht {
 
@@ -625,6 +626,7 @@ class schema final : public enable_lw_shared_from_this<schema> {
         cf_type _type = cf_type::standard;
         int32_t _gc_grace_seconds = DEFAULT_GC_GRACE_SECONDS;
         std::optional<int32_t> _paxos_grace_seconds;
+        utils::filter_type _bloom_filter_type = utils::filter_type::classic;
         double _dc_local_read_repair_chance = 0.0;
         double _read_repair_chance = 0.0;
         double _crc_check_chance = 1;
@@ -774,6 +776,10 @@ class schema final : public enable_lw_shared_from_this<schema> {
 
     gc_clock::duration paxos_grace_seconds() const;
 
+    utils::filter_type bloom_filter_type() const {
+        return _raw._bloom_filter_type;
+    }
+
     double dc_local_read_repair_chance() const {
         return _raw._dc_local_read_repair_chance;
     }
@@ -91,6 +91,8 @@ struct schema_builder {
 
     schema_builder& set_paxos_grace_seconds(int32_t seconds);
 
+    schema_builder& set_bloom_filter_type(utils::filter_type type);
+
     schema_builder& set_dc_local_read_repair_chance(double chance) {
         _raw._dc_local_read_repair_chance = chance;
         return *this;
@@ -278,6 +278,37 @@ class intrusive_set_external_comparator:
             yield n
 
 
+class intrusive_btree:
+    size_t = gdb.lookup_type('size_t')
+    leaf_node_flag = 0x2
+
+    def __init__(self, ref):
+        container_type = ref.type.strip_typedefs()
+        self.elem_type = container_type.template_argument(0)
+        self.link_offset = container_type.template_argument(1).cast(self.size_t)
+        self.inner_node_type = gdb.lookup_type('intrusive_b::inner_node')
+        self.root = ref['_root']
+
+    def __visit(self, node_p):
+        node = node_p.dereference()
+        leaf = node['_flags'] & self.leaf_node_flag
+        kids = None if leaf else node_p.cast(self.inner_node_type.pointer()).dereference()['_kids']
+        for i in range(0, int(node['_num_keys'])):
+            if kids is not None:
+                for e in self.__visit(kids[i]):
+                    yield e
+            hook_ptr = node['_keys'][i].cast(self.size_t) - self.link_offset
+            yield hook_ptr.cast(self.elem_type.pointer()).dereference()
+        if kids is not None:
+            for e in self.__visit(kids[int(node['_num_keys'])]):
+                yield e
+
+    def __iter__(self):
+        if self.root:
+            for e in self.__visit(self.root):
+                yield e
+
+
 class std_array:
     def __init__(self, ref):
         self.ref = ref
@@ -594,7 +625,7 @@ class mutation_partition_printer(gdb.printing.PrettyPrinter):
         self.val = val
 
     def to_string(self):
-        rows = list(str(r) for r in intrusive_set_external_comparator(self.val['_rows']))
+        rows = list(str(r) for r in intrusive_btree(self.val['_rows']))
         range_tombstones = list(str(r) for r in intrusive_set(self.val['_row_tombstones']['_tombstones']))
         return '{_tombstone=%s, _static_row=%s (cont=%s), _row_tombstones=[%s], _rows=[%s]}' % (
             self.val['_tombstone'],
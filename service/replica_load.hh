@@ -0,0 +1,37 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace service {
+
+// The load of the replica shard which served a read, sent back with the
+// response so the coordinator can rank replicas (see replica_scores).
+struct replica_load {
+    // Replica reads in flight on the shard, not counting the answered one.
+    uint32_t queue_length = 0;
+    // Time from receiving the request to having the response ready.
+    uint32_t service_time_us = 0;
+};
+
+}
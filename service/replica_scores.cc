@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "service/replica_scores.hh"
+
+namespace service {
+
+static double moving_average(double average, double sample, bool first) {
+    return first ? sample : average + replica_scores::alpha * (sample - average);
+}
+
+void replica_scores::on_request_sent(gms::inet_address ep) {
+    ++_scores[ep].outstanding;
+}
+
+void replica_scores::on_response(gms::inet_address ep, std::chrono::microseconds response_time) {
+    auto& s = _scores[ep];
+    if (s.outstanding) {
+        --s.outstanding;
+    }
+    s.response_time_us = moving_average(s.response_time_us, response_time.count(), !s.has_response);
+    s.has_response = true;
+    s.last_response = clock_type::now();
+}
+
+void replica_scores::on_load_report(gms::inet_address ep, const replica_load& load) {
+    auto& s = _scores[ep];
+    s.service_time_us = moving_average(s.service_time_us, load.service_time_us, !s.has_load);
+    s.queue_length = moving_average(s.queue_length, load.queue_length, !s.has_load);
+    s.has_load = true;
+}
+
+double replica_scores::score(const endpoint_score& s, clock_type::time_point now) {
+    if (!s.outstanding && (!s.has_response || now - s.last_response > expiry)) {
+        return 0;
+    }
+    if (!s.has_response) {
+        // Reads are in flight, but none was answered yet. Assume they take
+        // as long as the expiry, so that the endpoint ranks after those
+        // which answer, and the more reads it has in flight the later.
+        double q = 1 + s.outstanding;
+        return q * q * q * std::chrono::duration_cast<std::chrono::microseconds>(expiry).count();
+    }
+    auto r = s.response_time_us;
+    // Without load reports (local reads, or older replicas) all of the
+    // response time is attributed to the replica.
+    auto st = s.has_load ? s.service_time_us : r;
+    auto q = 1 + s.outstanding + s.queue_length;
+    return r - st + q * q * q * st;
+}
+
+double replica_scores::score(gms::inet_address ep) const {
+    auto it = _scores.find(ep);
+    return it == _scores.end() ? 0 : score(it->second, clock_type::now());
+}
+
+void replica_scores::sort(std::vector<gms::inet_address>::iterator begin, std::vector<gms::inet_address>::iterator end) const {
+    auto now = clock_type::now();
+    std::vector<std::pair<double, gms::inet_address>> scored;
+    scored.reserve(end - begin);
+    for (auto it = begin; it != end; ++it) {
+        auto s = _scores.find(*it);
+        scored.emplace_back(s == _scores.end() ? 0 : score(s->second, now), *it);
+    }
+    std::stable_sort(scored.begin(), scored.end(), [] (const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+    std::transform(scored.begin(), scored.end(), begin, [] (const auto& p) {
+        return p.second;
+    });
+}
+
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <unordered_map>
+#include <vector>
+
+#include <seastar/core/lowres_clock.hh>
+
+#include "gms/inet_address.hh"
+#include "service/replica_load.hh"
+
+namespace service {
+
+// Ranks the replicas of a read by how fast they are expected to answer,
+// following the C3 adaptive replica selection scheme.
+//
+// The coordinator keeps, per shard, an exponentially weighted moving average
+// of the response time it observes for each endpoint, and of the queue length
+// and service time the endpoint reports with its responses (replica_load).
+// The score of an endpoint is
+//
+//     R - S + q^3 * S
+//
+// where R is the response time, S the service time and q the estimated queue
+// length, i.e. one plus the reads this shard has outstanding on the endpoint
+// plus its reported queue. The cubic term makes the score react quickly to a
+// replica which starts queueing, before its response times grow. A lower
+// score is better.
+//
+// An endpoint which wasn't heard from for a while and has no reads in flight
+// gets the best score, so it's probed again after it recovers. An endpoint
+// which has reads in flight but never answered is assumed to take the expiry
+// time to answer each of them.
+class replica_scores {
+public:
+    using clock_type = seastar::lowres_clock;
+    // Weight of a new sample in the moving averages.
+    static constexpr double alpha = 0.25;
+    static constexpr clock_type::duration expiry = std::chrono::seconds(10);
+private:
+    struct endpoint_score {
+        double response_time_us = 0;
+        double service_time_us = 0;
+        double queue_length = 0;
+        unsigned outstanding = 0;
+        bool has_response = false;
+        bool has_load = false;
+        clock_type::time_point last_response;
+    };
+    std::unordered_map<gms::inet_address, endpoint_score> _scores;
+private:
+    static double score(const endpoint_score& s, clock_type::time_point now);
+public:
+    void on_request_sent(gms::inet_address ep);
+    // Called for every request passed to on_request_sent(), also if it failed
+    // or timed out, in which case response_time is the time until the failure.
+    void on_response(gms::inet_address ep, std::chrono::microseconds response_time);
+    void on_load_report(gms::inet_address ep, const replica_load& load);
+
+    double score(gms::inet_address ep) const;
+
+    // Stable-sorts the endpoints by their score, best first.
+    void sort(std::vector<gms::inet_address>::iterator begin, std::vector<gms::inet_address>::iterator end) const;
+};
+
+}
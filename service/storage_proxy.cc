@@ -62,6 +62,7 @@
 #include "exceptions/exceptions.hh"
 #include <boost/range/algorithm_ext/push_back.hpp>
 #include <boost/iterator/counting_iterator.hpp>
+#include <boost/range/irange.hpp>
 #include <boost/range/adaptors.hpp>
 #include <boost/algorithm/cxx11/any_of.hpp>
 #include <boost/algorithm/cxx11/none_of.hpp>
@@ -84,6 +85,7 @@
 #include <seastar/util/lazy.hh>
 #include <seastar/core/metrics.hh>
 #include <seastar/core/execution_stage.hh>
+#include <seastar/core/with_timeout.hh>
 #include "db/timeout_clock.hh"
 #include "multishard_mutation_query.hh"
 #include "database.hh"
@@ -126,6 +128,9 @@ using fbu = utils::fb_utilities;
 
 static inline
 query::digest_algorithm digest_algorithm(service::storage_proxy& proxy) {
+    if (proxy.features().cluster_supports_xxhash3_digest()) {
+        return query::digest_algorithm::xxHash3;
+    }
     return proxy.features().cluster_supports_digest_for_null_values()
             ? query::digest_algorithm::xxHash
             : query::digest_algorithm::legacy_xxHash_without_null_digest;
@@ -225,7 +230,7 @@ class per_destination_mutation : public mutation_holder {
         auto m = _mutations[ep];
         if (m) {
             tracing::trace(tr_state, "Sending a mutation to /{}", ep);
-            return sp._messaging.send_mutation(netw::messaging_service::msg_addr{ep, 0}, timeout, *m,
+            return sp._messaging.send_mutation(sp._messaging.shard_addr(ep, _token), timeout, *m,
                                     std::move(forward), utils::fb_utilities::get_broadcast_address(), this_shard_id(),
                                     response_id, tracing::make_trace_info(tr_state));
         }
@@ -251,11 +256,13 @@ class per_destination_mutation : public mutation_holder {
 class shared_mutation : public mutation_holder {
 protected:
     lw_shared_ptr<const frozen_mutation> _mutation;
+    dht::token _token;
 public:
     explicit shared_mutation(frozen_mutation_and_schema&& fm_a_s)
             : _mutation(make_lw_shared<const frozen_mutation>(std::move(fm_a_s.fm))) {
         _size = _mutation->representation().size();
         _schema = std::move(fm_a_s.s);
+        _token = dht::get_token(*_schema, _mutation->key());
     }
     explicit shared_mutation(const mutation& m) : shared_mutation(frozen_mutation_and_schema{freeze(m), m.schema()}) {
     }
@@ -271,7 +278,7 @@ class shared_mutation : public mutation_holder {
             storage_proxy::response_id_type response_id, storage_proxy::clock_type::time_point timeout,
             tracing::trace_state_ptr tr_state) override {
         tracing::trace(tr_state, "Sending a mutation to /{}", ep);
-        return sp._messaging.send_mutation(netw::messaging_service::msg_addr{ep, 0}, timeout, *_mutation,
+        return sp._messaging.send_mutation(sp._messaging.shard_addr(ep, _token), timeout, *_mutation,
                 std::move(forward), utils::fb_utilities::get_broadcast_address(), this_shard_id(),
                 response_id, tracing::make_trace_info(tr_state));
     }
@@ -300,7 +307,7 @@ class hint_mutation : public shared_mutation {
             storage_proxy::response_id_type response_id, storage_proxy::clock_type::time_point timeout,
             tracing::trace_state_ptr tr_state) override {
         tracing::trace(tr_state, "Sending a hint to /{}", ep);
-        return sp._messaging.send_hint_mutation(netw::messaging_service::msg_addr{ep, 0}, timeout, *_mutation,
+        return sp._messaging.send_hint_mutation(sp._messaging.shard_addr(ep, _token), timeout, *_mutation,
                 std::move(forward), utils::fb_utilities::get_broadcast_address(), this_shard_id(),
                 response_id, tracing::make_trace_info(tr_state));
     }
@@ -1866,6 +1873,46 @@ storage_proxy::mutate_hint(const schema_ptr& s, const frozen_mutation& m, tracin
     });
 }
 
+future<std::vector<uint32_t>>
+storage_proxy::mutate_hint_batch(std::vector<frozen_mutation_and_schema> mutations, clock_type::time_point timeout) {
+    get_stats().received_mutations += mutations.size();
+    return do_with(std::move(mutations), std::vector<std::vector<uint32_t>>(smp::count), std::vector<global_schema_ptr>(), std::vector<uint32_t>(),
+            [this, timeout] (std::vector<frozen_mutation_and_schema>& mutations, std::vector<std::vector<uint32_t>>& per_shard,
+                    std::vector<global_schema_ptr>& schemas, std::vector<uint32_t>& failed) {
+        schemas.reserve(mutations.size());
+        for (uint32_t i = 0; i < mutations.size(); ++i) {
+            auto& s = *mutations[i].s;
+            per_shard[dht::shard_of(s, dht::get_token(s, mutations[i].fm.key()))].push_back(i);
+            schemas.emplace_back(mutations[i].s);
+        }
+        return parallel_for_each(boost::irange(0u, smp::count), [this, timeout, &mutations, &per_shard, &schemas, &failed] (unsigned shard) {
+            if (per_shard[shard].empty()) {
+                return make_ready_future<>();
+            }
+            get_stats().replica_cross_shard_ops += shard != this_shard_id();
+            return _db.invoke_on(shard, {_hints_write_smp_service_group, timeout}, [&mutations, &indexes = per_shard[shard], &schemas, timeout] (database& db) {
+                return do_with(std::vector<uint32_t>(), [&db, &mutations, &indexes, &schemas, timeout] (std::vector<uint32_t>& failed) {
+                    return parallel_for_each(indexes, [&db, &mutations, &schemas, &failed, timeout] (uint32_t i) {
+                        return futurize_invoke([&db, &mutations, &schemas, timeout, i] {
+                            return db.apply_hint(schemas[i], mutations[i].fm, nullptr, timeout);
+                        }).handle_exception([&failed, i] (std::exception_ptr eptr) {
+                            slogger.debug("Failed to apply hint: {}", eptr);
+                            failed.push_back(i);
+                        });
+                    }).then([&failed] {
+                        return std::move(failed);
+                    });
+                });
+            }).then([&failed] (std::vector<uint32_t> shard_failed) {
+                boost::push_back(failed, shard_failed);
+            });
+        }).then([&failed] {
+            boost::sort(failed);
+            return std::move(failed);
+        });
+    });
+}
+
 future<>
 storage_proxy::mutate_counters_on_leader(std::vector<frozen_mutation_and_schema> mutations, db::consistency_level cl, clock_type::time_point timeout,
                                          tracing::trace_state_ptr trace_state, service_permit permit) {
@@ -2588,6 +2635,35 @@ future<> storage_proxy::send_hint_to_endpoint(frozen_mutation_and_schema fm_a_s,
             allow_hints::no);
 }
 
+future<std::vector<uint32_t>> storage_proxy::send_hint_batch_to_endpoint(std::vector<frozen_mutation_and_schema> mutations, gms::inet_address target) {
+    if (!_features.cluster_supports_hinted_handoff_batch_replay()) {
+        return do_with(std::move(mutations), std::vector<uint32_t>(), [this, target] (std::vector<frozen_mutation_and_schema>& mutations, std::vector<uint32_t>& failed) {
+            return do_for_each(boost::irange(uint32_t(0), uint32_t(mutations.size())), [this, target, &mutations, &failed] (uint32_t i) {
+                return send_hint_to_endpoint(std::move(mutations[i]), target).handle_exception([&failed, i] (std::exception_ptr) {
+                    failed.push_back(i);
+                });
+            }).then([&failed] {
+                return std::move(failed);
+            });
+        });
+    }
+
+    // A batch can be much larger than a single write, so it gets a write
+    // timeout for every started hint_batch_timeout_unit bytes.
+    static constexpr size_t hint_batch_timeout_unit = 128 * 1024;
+    auto size = boost::accumulate(mutations | boost::adaptors::transformed([] (const frozen_mutation_and_schema& m) {
+        return m.fm.representation().size();
+    }), size_t(0));
+    auto timeout = clock_type::now() + std::chrono::milliseconds(_db.local().get_config().write_request_timeout_in_ms()) * (1 + size / hint_batch_timeout_unit);
+    if (fbu::is_me(target)) {
+        return mutate_hint_batch(std::move(mutations), timeout);
+    }
+    auto fms = boost::copy_range<std::vector<frozen_mutation>>(mutations | boost::adaptors::transformed([] (frozen_mutation_and_schema& m) {
+        return std::move(m.fm);
+    }));
+    return _messaging.send_hint_mutation_batch(netw::messaging_service::msg_addr{target, 0}, timeout, std::move(fms));
+}
+
 future<> storage_proxy::send_hint_to_all_replicas(frozen_mutation_and_schema fm_a_s) {
     if (!_features.cluster_supports_hinted_handoff_separate_connection()) {
         std::array<mutation, 1> ms{fm_a_s.fm.unfreeze(fm_a_s.s)};
@@ -3418,53 +3494,83 @@ class abstract_read_executor : public enable_shared_from_this<abstract_read_exec
     }
 
 protected:
+    // Runs the read of a replica, accounting it in the replica scores.
+    template <typename Func>
+    futurize_t<std::invoke_result_t<Func>> track_replica_read(gms::inet_address ep, Func&& func) {
+        auto start = std::chrono::steady_clock::now();
+        _proxy->_replica_scores.on_request_sent(ep);
+        return futurize_invoke(std::forward<Func>(func)).finally([this, ep, start] {
+            _proxy->_replica_scores.on_response(ep, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start));
+        });
+    }
+    // Singular reads are sent to the shard of the replica which owns the partition.
+    netw::messaging_service::msg_addr replica_addr(gms::inet_address ep) const {
+        if (_partition_range.is_singular()) {
+            return _proxy->_messaging.shard_addr(ep, _partition_range.start()->value().token());
+        }
+        return netw::messaging_service::msg_addr{ep, 0};
+    }
+    void got_replica_load(gms::inet_address ep, const rpc::optional<replica_load>& load) {
+        if (load) {
+            _proxy->_replica_scores.on_load_report(ep, *load);
+        }
+    }
     future<rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature>> make_mutation_data_request(lw_shared_ptr<query::read_command> cmd, gms::inet_address ep, clock_type::time_point timeout) {
         ++_proxy->get_stats().mutation_data_read_attempts.get_ep_stat(ep);
-        if (fbu::is_me(ep)) {
+        return track_replica_read(ep, [this, cmd = std::move(cmd), ep, timeout] {
+          if (fbu::is_me(ep)) {
             tracing::trace(_trace_state, "read_mutation_data: querying locally");
             return _proxy->query_mutations_locally(_schema, cmd, _partition_range, timeout, _trace_state);
-        } else {
+          } else {
             tracing::trace(_trace_state, "read_mutation_data: sending a message to /{}", ep);
-            return _proxy->_messaging.send_read_mutation_data(netw::messaging_service::msg_addr{ep, 0}, timeout, *cmd, _partition_range).then([this, ep](rpc::tuple<reconcilable_result, rpc::optional<cache_temperature>> result_and_hit_rate) {
-                auto&& [result, hit_rate] = result_and_hit_rate;
+            return _proxy->_messaging.send_read_mutation_data(replica_addr(ep), timeout, *cmd, _partition_range).then([this, ep](rpc::tuple<reconcilable_result, rpc::optional<cache_temperature>, rpc::optional<replica_load>> result_and_hit_rate) {
+                auto&& [result, hit_rate, load] = result_and_hit_rate;
                 tracing::trace(_trace_state, "read_mutation_data: got response from /{}", ep);
+                got_replica_load(ep, load);
                 return make_ready_future<rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature>>(rpc::tuple(make_foreign(::make_lw_shared<reconcilable_result>(std::move(result))), hit_rate.value_or(cache_temperature::invalid())));
             });
-        }
+          }
+        });
     }
     future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature>> make_data_request(gms::inet_address ep, clock_type::time_point timeout, bool want_digest) {
         ++_proxy->get_stats().data_read_attempts.get_ep_stat(ep);
         auto opts = want_digest
                   ? query::result_options{query::result_request::result_and_digest, digest_algorithm(*_proxy)}
                   : query::result_options{query::result_request::only_result, query::digest_algorithm::none};
-        if (fbu::is_me(ep)) {
+        return track_replica_read(ep, [this, ep, timeout, opts] {
+          if (fbu::is_me(ep)) {
             tracing::trace(_trace_state, "read_data: querying locally");
             return _proxy->query_result_local(_schema, _cmd, _partition_range, opts, _trace_state, timeout);
-        } else {
+          } else {
             tracing::trace(_trace_state, "read_data: sending a message to /{}", ep);
-            return _proxy->_messaging.send_read_data(netw::messaging_service::msg_addr{ep, 0}, timeout, *_cmd, _partition_range, opts.digest_algo).then([this, ep](rpc::tuple<query::result, rpc::optional<cache_temperature>> result_hit_rate) {
-                auto&& [result, hit_rate] = result_hit_rate;
+            return _proxy->_messaging.send_read_data(replica_addr(ep), timeout, *_cmd, _partition_range, opts.digest_algo).then([this, ep](rpc::tuple<query::result, rpc::optional<cache_temperature>, rpc::optional<replica_load>> result_hit_rate) {
+                auto&& [result, hit_rate, load] = result_hit_rate;
                 tracing::trace(_trace_state, "read_data: got response from /{}", ep);
+                got_replica_load(ep, load);
                 return make_ready_future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature>>(rpc::tuple(make_foreign(::make_lw_shared<query::result>(std::move(result))), hit_rate.value_or(cache_temperature::invalid())));
             });
-        }
+          }
+        });
     }
     future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature>> make_digest_request(gms::inet_address ep, clock_type::time_point timeout) {
         ++_proxy->get_stats().digest_read_attempts.get_ep_stat(ep);
-        if (fbu::is_me(ep)) {
+        return track_replica_read(ep, [this, ep, timeout] {
+          if (fbu::is_me(ep)) {
             tracing::trace(_trace_state, "read_digest: querying locally");
             return _proxy->query_result_local_digest(_schema, _cmd, _partition_range, _trace_state,
                         timeout, digest_algorithm(*_proxy));
-        } else {
+          } else {
             tracing::trace(_trace_state, "read_digest: sending a message to /{}", ep);
-            return _proxy->_messaging.send_read_digest(netw::messaging_service::msg_addr{ep, 0}, timeout, *_cmd,
+            return _proxy->_messaging.send_read_digest(replica_addr(ep), timeout, *_cmd,
                         _partition_range, digest_algorithm(*_proxy)).then([this, ep] (
-                    rpc::tuple<query::result_digest, rpc::optional<api::timestamp_type>, rpc::optional<cache_temperature>> digest_timestamp_hit_rate) {
-                auto&& [d, t, hit_rate] = digest_timestamp_hit_rate;
+                    rpc::tuple<query::result_digest, rpc::optional<api::timestamp_type>, rpc::optional<cache_temperature>, rpc::optional<replica_load>> digest_timestamp_hit_rate) {
+                auto&& [d, t, hit_rate, load] = digest_timestamp_hit_rate;
                 tracing::trace(_trace_state, "read_digest: got response from /{}", ep);
+                got_replica_load(ep, load);
                 return make_ready_future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature>>(rpc::tuple(d, t ? t.value() : api::missing_timestamp, hit_rate.value_or(cache_temperature::invalid())));
             });
-        }
+          }
+        });
     }
     future<> make_mutation_data_requests(lw_shared_ptr<query::read_command> cmd, data_resolver_ptr resolver, targets_iterator begin, targets_iterator end, clock_type::time_point timeout) {
         return parallel_for_each(begin, end, [this, &cmd, resolver = std::move(resolver), timeout] (gms::inet_address ep) {
@@ -3808,15 +3914,13 @@ ::shared_ptr<abstract_read_executor> storage_proxy::get_read_executor(lw_shared_
 
     std::vector<gms::inet_address> all_replicas = get_live_sorted_endpoints(ks, token);
     // Check for a non-local read before heat-weighted load balancing
-    // reordering of endpoints happens. The local endpoint, if
-    // present, is always first in the list, as get_live_sorted_endpoints()
-    // orders the list by proximity to the local endpoint.
-    is_read_non_local |= !all_replicas.empty() && all_replicas.front() != utils::fb_utilities::get_broadcast_address();
+    // reordering of endpoints happens.
+    is_read_non_local |= boost::range::find(all_replicas, utils::fb_utilities::get_broadcast_address()) == all_replicas.end();
 
     auto cf = _db.local().find_column_family(schema).shared_from_this();
     std::vector<gms::inet_address> target_replicas = db::filter_for_query(cl, ks, all_replicas, preferred_endpoints, repair_decision,
             retry_type == speculative_retry::type::NONE ? nullptr : &extra_replica,
-            _db.local().get_config().cache_hit_rate_read_balancing() ? &*cf : nullptr);
+            use_cache_hit_rate_read_balancing() ? &*cf : nullptr);
 
     slogger.trace("creating read executor for token {} with all: {} targets: {} rp decision: {}", token, all_replicas, target_replicas, repair_decision);
     tracing::trace(trace_state, "Creating read executor for token {} with all: {} targets: {} repair decision: {}", token, all_replicas, target_replicas, repair_decision);
@@ -4010,7 +4114,7 @@ storage_proxy::query_partition_key_range_concurrent(storage_proxy::clock_type::t
     std::vector<::shared_ptr<abstract_read_executor>> exec;
     auto p = shared_from_this();
     auto& cf= _db.local().find_column_family(schema);
-    auto pcf = _db.local().get_config().cache_hit_rate_read_balancing() ? &cf : nullptr;
+    auto pcf = use_cache_hit_rate_read_balancing() ? &cf : nullptr;
     std::unordered_map<abstract_read_executor*, std::vector<dht::token_range>> ranges_per_exec;
     const auto tmptr = get_token_metadata_ptr();
 
@@ -4252,6 +4356,21 @@ storage_proxy::query(schema_ptr s,
     return do_query(s, cmd, std::move(partition_ranges), cl, std::move(query_options));
 }
 
+bool storage_proxy::is_local_replica(const schema& s, const dht::token& token) const {
+    auto& ks = _db.local().find_keyspace(s.ks_name());
+    auto eps = ks.get_replication_strategy().get_natural_endpoints_without_node_being_replaced(token);
+    return boost::algorithm::any_of(eps, fbu::is_me);
+}
+
+future<foreign_ptr<lw_shared_ptr<query::result>>>
+storage_proxy::query_singular_locally(schema_ptr s, lw_shared_ptr<query::read_command> cmd, const dht::partition_range& pr,
+        clock_type::time_point timeout, tracing::trace_state_ptr trace_state) {
+    return query_result_local(std::move(s), std::move(cmd), pr, query::result_options::only_result(), std::move(trace_state), timeout).then(
+            [] (rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature>&& r) {
+        return std::move(std::get<0>(r));
+    });
+}
+
 future<storage_proxy::coordinator_query_result>
 storage_proxy::do_query(schema_ptr s,
     lw_shared_ptr<query::read_command> cmd,
@@ -4588,12 +4707,42 @@ void storage_proxy::sort_endpoints_by_proximity(std::vector<gms::inet_address>&
     }
 }
 
+bool storage_proxy::use_cache_hit_rate_read_balancing() const {
+    // Both reorder the replicas of the local datacenter. Balancing by cache
+    // hit rate would reshuffle the order adaptive replica selection chose,
+    // so it only applies when adaptive replica selection is off.
+    auto& cfg = _db.local().get_config();
+    return cfg.cache_hit_rate_read_balancing() && !cfg.adaptive_replica_selection();
+}
+
 std::vector<gms::inet_address> storage_proxy::get_live_sorted_endpoints(keyspace& ks, const dht::token& token) const {
     auto eps = get_live_endpoints(ks, token);
     sort_endpoints_by_proximity(eps);
+    if (_db.local().get_config().adaptive_replica_selection()) {
+        // The endpoints of the local datacenter, including the local
+        // endpoint, come first ordered by score, so that a degraded
+        // coordinator isn't read from either. The other datacenters follow
+        // by proximity. Endpoints with equal scores keep the proximity order,
+        // so the local endpoint stays first until it's found to be slower.
+        auto& snitch_ptr = locator::i_endpoint_snitch::get_local_snitch_ptr();
+        auto local_dc = snitch_ptr->get_datacenter(utils::fb_utilities::get_broadcast_address());
+        auto local_end = std::find_if(eps.begin(), eps.end(), [&] (gms::inet_address ep) {
+            return snitch_ptr->get_datacenter(ep) != local_dc;
+        });
+        _replica_scores.sort(eps.begin(), local_end);
+    }
     return eps;
 }
 
+replica_load storage_proxy::get_replica_load(std::chrono::steady_clock::time_point read_start) const {
+    auto service_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - read_start);
+    return replica_load{
+        // Don't count the read being answered.
+        _replica_reads_in_flight - 1,
+        uint32_t(std::min<int64_t>(service_time.count(), std::numeric_limits<uint32_t>::max())),
+    };
+}
+
 std::vector<gms::inet_address> storage_proxy::intersection(const std::vector<gms::inet_address>& l1, const std::vector<gms::inet_address>& l2) {
     std::vector<gms::inet_address> inter;
     inter.reserve(l1.size());
@@ -4886,6 +5035,45 @@ void storage_proxy::init_messaging_service() {
     };
     ms.register_mutation(std::bind_front<>(receive_mutation_handler, _write_smp_service_group));
     ms.register_hint_mutation(std::bind_front<>(receive_mutation_handler, _hints_write_smp_service_group));
+    ms.register_hint_mutation_batch([&ms] (const rpc::client_info& cinfo, rpc::opt_time_point t, std::vector<frozen_mutation> fms) -> future<std::vector<uint32_t>> {
+        auto src_addr = netw::messaging_service::get_source(cinfo);
+        storage_proxy::clock_type::time_point timeout;
+        if (!t) {
+            auto timeout_in_ms = get_local_shared_storage_proxy()->_db.local().get_config().write_request_timeout_in_ms();
+            timeout = clock_type::now() + std::chrono::milliseconds(timeout_in_ms);
+        } else {
+            timeout = *t;
+        }
+        // indexes[j] is the position in the batch of mutations[j].
+        return do_with(std::move(fms), std::vector<frozen_mutation_and_schema>(), std::vector<uint32_t>(), std::vector<uint32_t>(),
+                [src_addr, timeout, &ms] (std::vector<frozen_mutation>& fms, std::vector<frozen_mutation_and_schema>& mutations,
+                        std::vector<uint32_t>& indexes, std::vector<uint32_t>& failed) {
+            mutations.reserve(fms.size());
+            indexes.reserve(fms.size());
+            // Schemas are looked up one after another, the batch usually has few of them,
+            // which are cached after the first lookup. A hint whose schema can't be fetched
+            // before the timeout fails, as get_schema_for_write() itself doesn't time out.
+            return do_for_each(boost::irange(uint32_t(0), uint32_t(fms.size())), [&fms, &mutations, &indexes, &failed, src_addr, timeout, &ms] (uint32_t i) {
+                return with_timeout(timeout, get_schema_for_write(fms[i].schema_version(), src_addr, ms)).then_wrapped([&fms, &mutations, &indexes, &failed, i] (future<schema_ptr> f) {
+                    if (f.failed()) {
+                        slogger.debug("Failed to get the schema of a hint: {}", f.get_exception());
+                        failed.push_back(i);
+                        return;
+                    }
+                    mutations.emplace_back(frozen_mutation_and_schema{std::move(fms[i]), f.get0()});
+                    indexes.push_back(i);
+                });
+            }).then([&mutations, &indexes, &failed, timeout] {
+                return get_local_shared_storage_proxy()->mutate_hint_batch(std::move(mutations), timeout).then([&indexes, &failed] (std::vector<uint32_t> failed_to_apply) {
+                    for (auto j : failed_to_apply) {
+                        failed.push_back(indexes[j]);
+                    }
+                    boost::sort(failed);
+                    return std::move(failed);
+                });
+            });
+        });
+    });
 
     ms.register_paxos_learn([] (const rpc::client_info& cinfo, rpc::opt_time_point t, paxos::proposal decision,
             std::vector<gms::inet_address> forward, gms::inet_address reply_to, unsigned shard,
@@ -4936,6 +5124,8 @@ void storage_proxy::init_messaging_service() {
         }
         return do_with(std::move(pr), get_local_shared_storage_proxy(), std::move(trace_state_ptr), [&cinfo, cmd = make_lw_shared<query::read_command>(std::move(cmd)), src_addr = std::move(src_addr), da, t] (::compat::wrapping_partition_range& pr, shared_ptr<storage_proxy>& p, tracing::trace_state_ptr& trace_state_ptr) mutable {
             p->get_stats().replica_data_reads++;
+            ++p->_replica_reads_in_flight;
+            auto start = std::chrono::steady_clock::now();
             auto src_ip = src_addr.addr;
             return get_schema_for_read(cmd->schema_version, std::move(src_addr), p->_messaging).then([cmd, da, &pr, &p, &trace_state_ptr, t] (schema_ptr s) {
                 auto pr2 = ::compat::unwrap(std::move(pr), *s);
@@ -4948,7 +5138,11 @@ void storage_proxy::init_messaging_service() {
                 opts.request = da == query::digest_algorithm::none ? query::result_request::only_result : query::result_request::result_and_digest;
                 auto timeout = t ? *t : db::no_timeout;
                 return p->query_result_local(std::move(s), cmd, std::move(pr2.first), opts, trace_state_ptr, timeout);
-            }).finally([&trace_state_ptr, src_ip] () mutable {
+            }).then([&p, start] (rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature> result_and_hit_rate) {
+                auto&& [result, hit_rate] = result_and_hit_rate;
+                return make_ready_future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature, replica_load>>(rpc::tuple(std::move(result), hit_rate, p->get_replica_load(start)));
+            }).finally([&p, &trace_state_ptr, src_ip] () mutable {
+                --p->_replica_reads_in_flight;
                 tracing::trace(trace_state_ptr, "read_data handling is done, sending a response to /{}", src_ip);
             });
         });
@@ -4974,12 +5168,18 @@ void storage_proxy::init_messaging_service() {
                                tracing::trace_state_ptr& trace_state_ptr,
                                ::compat::one_or_two_partition_ranges& unwrapped) mutable {
             p->get_stats().replica_mutation_data_reads++;
+            ++p->_replica_reads_in_flight;
+            auto start = std::chrono::steady_clock::now();
             auto src_ip = src_addr.addr;
             return get_schema_for_read(cmd->schema_version, std::move(src_addr), p->_messaging).then([cmd, &pr, &p, &trace_state_ptr, &unwrapped, t] (schema_ptr s) mutable {
                 unwrapped = ::compat::unwrap(std::move(pr), *s);
                 auto timeout = t ? *t : db::no_timeout;
                 return p->query_mutations_locally(std::move(s), std::move(cmd), unwrapped, timeout, trace_state_ptr);
-            }).finally([&trace_state_ptr, src_ip] () mutable {
+            }).then([&p, start] (rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature> result_and_hit_rate) {
+                auto&& [result, hit_rate] = result_and_hit_rate;
+                return make_ready_future<rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature, replica_load>>(rpc::tuple(std::move(result), hit_rate, p->get_replica_load(start)));
+            }).finally([&p, &trace_state_ptr, src_ip] () mutable {
+                --p->_replica_reads_in_flight;
                 tracing::trace(trace_state_ptr, "read_mutation_data handling is done, sending a response to /{}", src_ip);
             });
         });
@@ -4998,6 +5198,8 @@ void storage_proxy::init_messaging_service() {
         }
         return do_with(std::move(pr), get_local_shared_storage_proxy(), std::move(trace_state_ptr), [&cinfo, cmd = make_lw_shared<query::read_command>(std::move(cmd)), src_addr = std::move(src_addr), da, t] (::compat::wrapping_partition_range& pr, shared_ptr<storage_proxy>& p, tracing::trace_state_ptr& trace_state_ptr) mutable {
             p->get_stats().replica_digest_reads++;
+            ++p->_replica_reads_in_flight;
+            auto start = std::chrono::steady_clock::now();
             auto src_ip = src_addr.addr;
             return get_schema_for_read(cmd->schema_version, std::move(src_addr), p->_messaging).then([cmd, &pr, &p, &trace_state_ptr, t, da] (schema_ptr s) {
                 auto pr2 = ::compat::unwrap(std::move(pr), *s);
@@ -5007,7 +5209,11 @@ void storage_proxy::init_messaging_service() {
                 }
                 auto timeout = t ? *t : db::no_timeout;
                 return p->query_result_local_digest(std::move(s), cmd, std::move(pr2.first), trace_state_ptr, timeout, da);
-            }).finally([&trace_state_ptr, src_ip] () mutable {
+            }).then([&p, start] (rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature> digest_timestamp_hit_rate) {
+                auto&& [d, t, hit_rate] = digest_timestamp_hit_rate;
+                return make_ready_future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature, replica_load>>(rpc::tuple(d, t, hit_rate, p->get_replica_load(start)));
+            }).finally([&p, &trace_state_ptr, src_ip] () mutable {
+                --p->_replica_reads_in_flight;
                 tracing::trace(trace_state_ptr, "read_digest handling is done, sending a response to /{}", src_ip);
             });
         });
@@ -5130,6 +5336,7 @@ future<> storage_proxy::uninit_messaging_service() {
         ms.unregister_counter_mutation(),
         ms.unregister_mutation(),
         ms.unregister_hint_mutation(),
+        ms.unregister_hint_mutation_batch(),
         ms.unregister_mutation_done(),
         ms.unregister_mutation_failed(),
         ms.unregister_read_data(),
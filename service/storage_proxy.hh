@@ -62,6 +62,7 @@
 #include "cache_temperature.hh"
 #include "service_permit.hh"
 #include "service/client_state.hh"
+#include "service/replica_scores.hh"
 #include "cdc/stats.hh"
 #include "locator/token_metadata.hh"
 #include "db/hints/host_filter.hh"
@@ -295,6 +296,10 @@ class storage_proxy : public seastar::async_sharded_service<storage_proxy>, publ
             lw_shared_ptr<cdc::operation_result_tracker>> _mutate_stage;
     db::view::node_update_backlog& _max_view_update_backlog;
     std::unordered_map<gms::inet_address, view_update_backlog_timestamped> _view_update_backlogs;
+    // Ranks the replicas this shard reads from (adaptive_replica_selection).
+    replica_scores _replica_scores;
+    // Replica reads served by this shard, reported to coordinators in replica_load.
+    uint32_t _replica_reads_in_flight = 0;
 
     //NOTICE(sarna): This opaque pointer is here just to avoid moving write handler class definitions from .cc to .hh. It's slow path.
     class view_update_handlers_list;
@@ -353,6 +358,8 @@ class storage_proxy : public seastar::async_sharded_service<storage_proxy>, publ
     std::vector<gms::inet_address> get_live_endpoints(keyspace& ks, const dht::token& token) const;
     static void sort_endpoints_by_proximity(std::vector<gms::inet_address>& eps);
     std::vector<gms::inet_address> get_live_sorted_endpoints(keyspace& ks, const dht::token& token) const;
+    bool use_cache_hit_rate_read_balancing() const;
+    replica_load get_replica_load(std::chrono::steady_clock::time_point read_start) const;
     db::read_repair_decision new_read_repair_decision(const schema& s);
     ::shared_ptr<abstract_read_executor> get_read_executor(lw_shared_ptr<query::read_command> cmd,
             schema_ptr schema,
@@ -509,6 +516,11 @@ class storage_proxy : public seastar::async_sharded_service<storage_proxy>, publ
 
     future<> mutate_hint(const schema_ptr&, const frozen_mutation& m, tracing::trace_state_ptr tr_state, clock_type::time_point timeout = clock_type::time_point::max());
 
+    // Applies a batch of hints on this node. Mutations are grouped by the
+    // shard which owns them, so each shard is reached once per batch.
+    // Returns the indexes of the mutations which failed to apply, in increasing order.
+    future<std::vector<uint32_t>> mutate_hint_batch(std::vector<frozen_mutation_and_schema> mutations, clock_type::time_point timeout);
+
     /**
     * Use this method to have these Mutations applied
     * across all replicas. This method will take care
@@ -558,6 +570,14 @@ class storage_proxy : public seastar::async_sharded_service<storage_proxy>, publ
     // and use different RPC verb.
     future<> send_hint_to_endpoint(frozen_mutation_and_schema fm_a_s, gms::inet_address target);
 
+    // Send a batch of hints to a specific remote target with a single request.
+    // The target applies them locally, without going through the write path
+    // of a coordinator. Returns the indexes of the hints which failed to apply,
+    // in increasing order; the returned future fails if the whole batch failed.
+    // Unless the whole cluster supports the HINTED_HANDOFF_BATCH_REPLAY feature,
+    // the hints are sent one by one with send_hint_to_endpoint().
+    future<std::vector<uint32_t>> send_hint_batch_to_endpoint(std::vector<frozen_mutation_and_schema> mutations, gms::inet_address target);
+
     /**
      * Performs the truncate operatoin, which effectively deletes all data from
      * the column family cfname
@@ -586,6 +606,15 @@ class storage_proxy : public seastar::async_sharded_service<storage_proxy>, publ
         db::consistency_level cl,
         coordinator_query_options optional_params);
 
+    // Returns true if this node is a replica of the token, so a read at CL
+    // ONE or LOCAL_ONE can be served by query_singular_locally().
+    bool is_local_replica(const schema& s, const dht::token& token) const;
+
+    // Reads a single partition from the replica on this node, bypassing
+    // the coordinator read path: no endpoint selection, digests or read repair.
+    future<foreign_ptr<lw_shared_ptr<query::result>>> query_singular_locally(schema_ptr s, lw_shared_ptr<query::read_command> cmd,
+        const dht::partition_range& pr, clock_type::time_point timeout, tracing::trace_state_ptr trace_state = nullptr);
+
     future<rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature>> query_mutations_locally(
         schema_ptr, lw_shared_ptr<query::read_command> cmd, const dht::partition_range&,
         clock_type::time_point timeout,
@@ -1426,6 +1426,17 @@ void storage_service::on_change(inet_address endpoint, application_state state,
             slogger.debug("Ignoring state change for dead or unknown endpoint: {}", endpoint);
             return;
         }
+        if (state == application_state::SHARD_COUNT || state == application_state::IGNORE_MSB_BITS) {
+            auto* shard_count = ep_state->get_application_state_ptr(application_state::SHARD_COUNT);
+            auto* ignore_msb = ep_state->get_application_state_ptr(application_state::IGNORE_MSB_BITS);
+            unsigned shards = shard_count ? std::stoi(shard_count->value) : 0;
+            if (shards && ignore_msb) {
+                unsigned msb = std::stoi(ignore_msb->value);
+                _messaging.invoke_on_all([endpoint, shards, msb] (netw::messaging_service& ms) {
+                    ms.set_peer_sharding(endpoint, shards, msb);
+                }).get();
+            }
+        }
         if (get_token_metadata().is_member(endpoint)) {
             do_update_system_peers_table(endpoint, state, value);
             if (state == application_state::SCHEMA) {
@@ -38,7 +38,7 @@ concept ChecksumUtils = requires(const char* input, size_t size, uint32_t checks
     { Checksum::prefer_combine() } -> std::same_as<bool>;
 };
 
-struct adler32_utils {
+struct zlib_adler32_checksummer {
     inline static uint32_t init_checksum() {
         return adler32(0, Z_NULL, 0);
     }
@@ -61,6 +61,28 @@ struct adler32_utils {
     static constexpr bool prefer_combine() { return true; }
 };
 
+// libdeflate picks an AVX2 or SSE2 (NEON on aarch64) implementation at runtime,
+// falling back to a portable one. zlib's is byte-at-a-time.
+struct libdeflate_adler32_checksummer {
+    static uint32_t init_checksum() {
+        return 1;
+    }
+
+    static uint32_t checksum(const char* input, size_t input_len) {
+        return checksum(init_checksum(), input, input_len);
+    }
+
+    static uint32_t checksum(uint32_t prev, const char* input, size_t input_len) {
+        return libdeflate_adler32(prev, input, input_len);
+    }
+
+    static uint32_t checksum_combine(uint32_t first, uint32_t second, size_t input_len2) {
+        return zlib_adler32_checksummer::checksum_combine(first, second, input_len2);
+    }
+
+    static constexpr bool prefer_combine() { return true; }
+};
+
 struct zlib_crc32_checksummer {
     inline static uint32_t init_checksum() {
         return crc32(0, Z_NULL, 0);
@@ -84,6 +106,8 @@ struct zlib_crc32_checksummer {
     static constexpr bool prefer_combine() { return false; } // crc32_combine() is very slow
 };
 
+// libdeflate picks a PCLMUL (PMULL on aarch64) folding implementation at runtime,
+// falling back to a table-driven one.
 struct libdeflate_crc32_checksummer {
     static uint32_t init_checksum() {
         return 0;
@@ -113,6 +137,24 @@ inline uint32_t checksum_combine_or_feed(uint32_t first, uint32_t second, const
     }
 }
 
+struct adler32_utils {
+    static uint32_t init_checksum() { return libdeflate_adler32_checksummer::init_checksum(); }
+
+    static uint32_t checksum(const char* input, size_t input_len) {
+        return libdeflate_adler32_checksummer::checksum(input, input_len);
+    }
+
+    static uint32_t checksum(uint32_t prev, const char* input, size_t input_len) {
+        return libdeflate_adler32_checksummer::checksum(prev, input, input_len);
+    }
+
+    static uint32_t checksum_combine(uint32_t first, uint32_t second, size_t input_len2) {
+        return libdeflate_adler32_checksummer::checksum_combine(first, second, input_len2);
+    }
+
+    static constexpr bool prefer_combine() { return true; }
+};
+
 struct crc32_utils {
     static uint32_t init_checksum() { return libdeflate_crc32_checksummer::init_checksum(); }
 
@@ -507,9 +507,90 @@ class compaction {
         cfg.run_identifier = _run_identifier;
         cfg.replay_position = _rp;
         cfg.sstable_level = _sstable_level;
+        cfg.compression_dictionary = _cf.compression_dictionary();
         return cfg;
     }
 
+    // Trains a new compression dictionary for the table from chunks sampled evenly
+    // from the input sstables, unless the table's compressor doesn't use dictionaries
+    // or the current dictionary is recent enough.
+    //
+    // Training runs on the reactor, can't be preempted and takes time roughly
+    // proportional to the size of the samples. They are bounded by a small multiple
+    // of the dictionary size and by a hard cap, which keeps the stall to a few
+    // milliseconds. Must be called in a seastar thread.
+    void maybe_train_compression_dictionary() {
+        static constexpr auto retrain_interval = std::chrono::hours(1);
+        static constexpr size_t samples_per_dictionary = 32;
+        static constexpr size_t max_samples_size = 128 * 1024;
+        static constexpr size_t max_concurrent_sample_reads = 16;
+
+        auto& cp = _schema->get_compressor_params();
+        auto compressor = cp.get_compressor();
+        if (!compressor || !compressor->dictionary_size()) {
+            return;
+        }
+        if (_cf.compression_dictionary() && lowres_clock::now() - _cf.compression_dictionary_trained_at() < retrain_interval) {
+            return;
+        }
+        const size_t budget = std::min(compressor->dictionary_size() * samples_per_dictionary, max_samples_size);
+        const size_t sample_len = cp.chunk_length();
+        uint64_t input_size = 0;
+        for (auto& sst : *_compacting->all()) {
+            input_size += sst->data_size();
+        }
+        if (input_size < budget) {
+            return;
+        }
+
+        struct sample_position {
+            shared_sstable sst;
+            uint64_t pos;
+            size_t len;
+        };
+        std::vector<sample_position> positions;
+        for (auto& sst : *_compacting->all()) {
+            auto nr_samples = uint64_t(double(budget) * sst->data_size() / input_size) / sample_len;
+            if (!nr_samples) {
+                continue;
+            }
+            auto stride = sst->data_size() / nr_samples;
+            for (uint64_t i = 0; i < nr_samples; ++i) {
+                auto pos = i * stride;
+                positions.push_back(sample_position{sst, pos, size_t(std::min<uint64_t>(sample_len, sst->data_size() - pos))});
+            }
+        }
+
+        std::vector<temporary_buffer<char>> samples(positions.size());
+        try {
+            semaphore concurrency(max_concurrent_sample_reads);
+            parallel_for_each(boost::irange<size_t>(0, positions.size()), [&] (size_t i) {
+                return with_semaphore(concurrency, 1, [&, i] {
+                    auto& p = positions[i];
+                    return p.sst->data_read(p.pos, p.len, _io_priority, _permit).then([&samples, i] (temporary_buffer<char> buf) {
+                        samples[i] = std::move(buf);
+                    });
+                });
+            }).get();
+        } catch (...) {
+            log_warning("Failed to sample data for the compression dictionary: {}", std::current_exception());
+            return;
+        }
+
+        std::vector<bytes_view> views;
+        views.reserve(samples.size());
+        for (auto& s : samples) {
+            views.emplace_back(reinterpret_cast<const int8_t*>(s.get()), s.size());
+        }
+        auto dictionary = compressor->train_dictionary(views);
+        if (dictionary.empty()) {
+            log_debug("Failed to train compression dictionary from {} samples", samples.size());
+            return;
+        }
+        log_debug("Trained compression dictionary of {} bytes from {} samples", dictionary.size(), samples.size());
+        _cf.set_compression_dictionary(std::move(dictionary));
+    }
+
     api::timestamp_type maximum_timestamp() const {
         auto m = std::max_element(_sstables.begin(), _sstables.end(), [] (const shared_sstable& sst1, const shared_sstable& sst2) {
             return sst1->get_stats_metadata().max_timestamp < sst2->get_stats_metadata().max_timestamp;
@@ -598,6 +679,7 @@ class compaction {
         }
 
         _compacting = std::move(ssts);
+        maybe_train_compression_dictionary();
 
         _ms_metadata.min_timestamp = timestamp_tracker.min();
         _ms_metadata.max_timestamp = timestamp_tracker.max();
@@ -794,6 +876,7 @@ void garbage_collected_sstable_writer::data::maybe_create_new_sstable_writer() {
         sstable_writer_config cfg = _c->_cf.get_sstables_manager().configure_writer();
         cfg.run_identifier = _run_identifier;
         cfg.monitor = monitor.get();
+        cfg.compression_dictionary = _c->_cf.compression_dictionary();
         auto writer = sst->get_writer(*_c->schema(), _c->partitions_per_sstable(), cfg, _c->get_encoding_stats(), priority);
         _compaction_writer.emplace(std::move(monitor), std::move(writer), std::move(sst));
     }
@@ -29,6 +29,8 @@
 #include <seastar/core/metrics.hh>
 #include "exceptions.hh"
 #include <cmath>
+#include <boost/range/numeric.hpp>
+#include <boost/range/adaptor/transformed.hpp>
 
 static logging::logger cmlog("compaction_manager");
 using namespace std::chrono_literals;
@@ -227,18 +229,30 @@ class user_initiated_backlog_tracker final : public compaction_backlog_tracker::
     virtual void remove_sstable(sstables::shared_sstable sst)  override { }
 };
 
+static uint64_t total_bytes_on_disk(const std::vector<sstables::shared_sstable>& sstables) {
+    return boost::accumulate(sstables | boost::adaptors::transformed(std::mem_fn(&sstables::sstable::bytes_on_disk)), uint64_t(0));
+}
+
+// Orders the _maintenance_waiters heap: highest priority on top, FIFO among equal priorities.
+bool compaction_manager::maintenance_waiter_less(const maintenance_waiter& a, const maintenance_waiter& b) {
+    return std::tie(a.priority, b.seq) < std::tie(b.priority, a.seq);
+}
+
 future<> compaction_manager::submit_major_compaction(column_family* cf) {
     if (_state != state::enabled) {
         return make_ready_future<>();
     }
     auto task = make_lw_shared<compaction_manager::task>();
     task->compacting_cf = cf;
+    task->maintenance = true;
+    task->total_bytes = total_bytes_on_disk(get_candidates(*cf));
     _tasks.push_back(task);
 
-    // first take major compaction semaphore, then exclusely take compaction lock for column family.
+    // first take a maintenance slot, then exclusely take compaction lock for column family.
     // it cannot be the other way around, or minor compaction for this column family would be
-    // prevented while an ongoing major compaction doesn't release the semaphore.
-    task->compaction_done = with_semaphore(_major_compaction_sem, 1, [this, task, cf] {
+    // prevented while an ongoing major compaction doesn't release the slot.
+    task->compaction_done = with_maintenance_slot(task->total_bytes, [this, task, cf] {
+        task->started_at = db_clock::now();
         return with_lock(_compaction_locks[cf].for_write(), [this, task, cf] {
             _stats.active_tasks++;
             if (!can_proceed(task)) {
@@ -249,19 +263,25 @@ future<> compaction_manager::submit_major_compaction(column_family* cf) {
             // those are eligible for major compaction.
             sstables::compaction_strategy cs = cf->get_compaction_strategy();
             sstables::compaction_descriptor descriptor = cs.get_major_compaction_job(*cf, get_candidates(*cf));
+            task->total_bytes = total_bytes_on_disk(descriptor.sstables);
             auto compacting = make_lw_shared<compacting_sstable_registration>(this, descriptor.sstables);
-            descriptor.release_exhausted = [compacting] (const std::vector<sstables::shared_sstable>& exhausted_sstables) {
+            // Input sstables are released as soon as they are exhausted, which for
+            // incremental compaction is long before the whole compaction finishes.
+            descriptor.release_exhausted = [task, compacting] (const std::vector<sstables::shared_sstable>& exhausted_sstables) {
+                task->completed_bytes = std::min(task->completed_bytes + total_bytes_on_disk(exhausted_sstables), task->total_bytes);
                 compacting->release_compacting(exhausted_sstables);
             };
 
             cmlog.info0("User initiated compaction started on behalf of {}.{}", cf->schema()->ks_name(), cf->schema()->cf_name());
-            compaction_backlog_tracker user_initiated(std::make_unique<user_initiated_backlog_tracker>(_compaction_controller.backlog_of_shares(200), _available_memory));
+            compaction_backlog_tracker user_initiated(std::make_unique<user_initiated_backlog_tracker>(_compaction_controller.backlog_of_shares(_maintenance_shares), _available_memory));
             return do_with(std::move(user_initiated), [this, cf, descriptor = std::move(descriptor)] (compaction_backlog_tracker& bt) mutable {
                 register_backlog_tracker(bt);
                 return with_scheduling_group(_scheduling_group, [this, cf, descriptor = std::move(descriptor)] () mutable {
                     return cf->compact_sstables(std::move(descriptor));
                 });
-            }).then([compacting = std::move(compacting)] {});
+            }).then([task, compacting = std::move(compacting)] {
+                task->completed_bytes = task->total_bytes;
+            });
         });
     }).then_wrapped([this, task] (future<> f) {
         _stats.active_tasks--;
@@ -280,6 +300,61 @@ future<> compaction_manager::submit_major_compaction(column_family* cf) {
     return task->compaction_done.get_future().then([task] {});
 }
 
+future<> compaction_manager::acquire_maintenance_slot(uint64_t priority) {
+    if (_maintenance_running < _maintenance_concurrency && _maintenance_waiters.empty()) {
+        _maintenance_running++;
+        return make_ready_future<>();
+    }
+    _maintenance_waiters.push_back(maintenance_waiter{priority, _maintenance_waiter_seq++, promise<>()});
+    auto f = _maintenance_waiters.back().admitted.get_future();
+    std::push_heap(_maintenance_waiters.begin(), _maintenance_waiters.end(), maintenance_waiter_less);
+    return f;
+}
+
+void compaction_manager::release_maintenance_slot() noexcept {
+    _maintenance_running--;
+    admit_maintenance_waiters();
+}
+
+void compaction_manager::admit_maintenance_waiters() noexcept {
+    while (_maintenance_running < _maintenance_concurrency && !_maintenance_waiters.empty()) {
+        std::pop_heap(_maintenance_waiters.begin(), _maintenance_waiters.end(), maintenance_waiter_less);
+        auto admitted = std::move(_maintenance_waiters.back().admitted);
+        _maintenance_waiters.pop_back();
+        _maintenance_running++;
+        admitted.set_value();
+    }
+}
+
+void compaction_manager::configure_maintenance(size_t concurrency, float shares) {
+    _maintenance_concurrency = std::max(concurrency, size_t(1));
+    _maintenance_shares = shares;
+    admit_maintenance_waiters();
+}
+
+std::vector<compaction_manager::maintenance_progress> compaction_manager::get_maintenance_progress() const {
+    std::vector<maintenance_progress> ret;
+    for (auto& task : _tasks) {
+        if (!task->maintenance) {
+            continue;
+        }
+        auto completed_bytes = task->completed_bytes;
+        if (task->type == sstables::compaction_type::Compaction) {
+            // Unless it's incremental, a major compaction releases its input only when
+            // it's done, so extrapolate from the partitions it has written so far.
+            for (auto& info : _compactions) {
+                if (info->cf == task->compacting_cf && info->type == sstables::compaction_type::Compaction && info->total_partitions) {
+                    auto written = double(std::min(info->total_keys_written, info->total_partitions)) / info->total_partitions;
+                    completed_bytes = std::max(completed_bytes, uint64_t(written * task->total_bytes));
+                }
+            }
+        }
+        auto s = task->compacting_cf->schema();
+        ret.push_back(maintenance_progress{s->ks_name(), s->cf_name(), task->type, task->total_bytes, completed_bytes, task->started_at});
+    }
+    return ret;
+}
+
 future<> compaction_manager::run_custom_job(column_family* cf, sstring name, noncopyable_function<future<>()> job) {
     if (_state != state::enabled) {
         return make_ready_future<>();
@@ -626,9 +701,15 @@ future<> compaction_manager::rewrite_sstables(column_family* cf, sstables::compa
     auto task = make_lw_shared<compaction_manager::task>();
     task->compacting_cf = cf;
     task->type = options.type();
+    task->maintenance = true;
     _tasks.push_back(task);
 
     auto sstables = std::make_unique<std::vector<sstables::shared_sstable>>(get_func(*cf));
+    // sstables are popped from the back, so the largest ones, which reclaim the most space, go first.
+    std::sort(sstables->begin(), sstables->end(), [] (const sstables::shared_sstable& a, const sstables::shared_sstable& b) {
+        return a->bytes_on_disk() < b->bytes_on_disk();
+    });
+    task->total_bytes = total_bytes_on_disk(*sstables);
     auto sstables_ptr = sstables.get();
     _stats.pending_tasks += sstables->size();
 
@@ -641,8 +722,18 @@ future<> compaction_manager::rewrite_sstables(column_family* cf, sstables::compa
 
         auto sst = sstables_ptr->back();
         sstables_ptr->pop_back();
+        auto size = sst->bytes_on_disk();
 
-        return repeat([this, task, options, sst = std::move(sst)] () mutable {
+        // The slot is taken for each attempt, so that it's not held while sleeping before a retry.
+        return repeat([this, task, options, size, sst = std::move(sst)] () mutable {
+          return with_maintenance_slot(size, [this, task, options, size, sst] () mutable {
+            if (!can_proceed(task)) {
+                _stats.pending_tasks--;
+                return make_ready_future<stop_iteration>(stop_iteration::yes);
+            }
+            if (task->started_at == db_clock::time_point()) {
+                task->started_at = db_clock::now();
+            }
             column_family& cf = *task->compacting_cf;
             auto sstable_level = sst->get_sstable_level();
             auto run_identifier = sst->run_identifier();
@@ -659,29 +750,37 @@ future<> compaction_manager::rewrite_sstables(column_family* cf, sstables::compa
             _stats.pending_tasks--;
             _stats.active_tasks++;
             task->compaction_running = true;
-            compaction_backlog_tracker user_initiated(std::make_unique<user_initiated_backlog_tracker>(_compaction_controller.backlog_of_shares(200), _available_memory));
+            compaction_backlog_tracker user_initiated(std::make_unique<user_initiated_backlog_tracker>(_compaction_controller.backlog_of_shares(_maintenance_shares), _available_memory));
             return do_with(std::move(user_initiated), [this, &cf, descriptor = std::move(descriptor)] (compaction_backlog_tracker& bt) mutable {
+                register_backlog_tracker(bt);
                 return with_scheduling_group(_scheduling_group, [this, &cf, descriptor = std::move(descriptor)] () mutable {
                     return cf.run_compaction(std::move(descriptor));
                 });
-            }).then_wrapped([this, task, compacting = std::move(compacting)] (future<> f) mutable {
+            }).then_wrapped([this, task, size, compacting = std::move(compacting)] (future<> f) mutable {
                 task->compaction_running = false;
                 _stats.active_tasks--;
                 if (!can_proceed(task)) {
                     maybe_stop_on_error(std::move(f), stop_iteration::yes);
-                    return make_ready_future<stop_iteration>(stop_iteration::yes);
+                    return stop_iteration::yes;
                 }
                 if (maybe_stop_on_error(std::move(f))) {
                     _stats.errors++;
                     _stats.pending_tasks++;
-                    return put_task_to_sleep(task).then([] {
-                        return make_ready_future<stop_iteration>(stop_iteration::no);
-                    });
+                    return stop_iteration::no;
                 }
                 _stats.completed_tasks++;
+                task->completed_bytes += size;
                 reevaluate_postponed_compactions();
+                return stop_iteration::yes;
+            });
+          }).then([this, task] (stop_iteration done) {
+            if (done) {
                 return make_ready_future<stop_iteration>(stop_iteration::yes);
+            }
+            return put_task_to_sleep(task).then([] {
+                return make_ready_future<stop_iteration>(stop_iteration::no);
             });
+          });
         });
     }).finally([this, task, sstables = std::move(sstables)] {
         _stats.pending_tasks -= sstables->size();
@@ -40,6 +40,7 @@
 #include "compaction_weight_registration.hh"
 #include "compaction_backlog_manager.hh"
 #include "backlog_controller.hh"
+#include "db_clock.hh"
 #include "seastarx.hh"
 
 class table;
@@ -56,6 +57,17 @@ class compaction_manager {
         uint64_t active_tasks = 0; // Number of compaction going on.
         int64_t errors = 0;
     };
+
+    // Progress of a maintenance operation (major compaction, cleanup, upgrade or scrub) of a table.
+    struct maintenance_progress {
+        sstring ks_name;
+        sstring cf_name;
+        sstables::compaction_type type;
+        uint64_t total_bytes = 0;
+        uint64_t completed_bytes = 0;
+        // Set when the operation is granted a maintenance slot, so queueing doesn't count as progress.
+        db_clock::time_point started_at;
+    };
 private:
     struct task {
         column_family* compacting_cf = nullptr;
@@ -64,6 +76,11 @@ class compaction_manager {
         bool stopping = false;
         sstables::compaction_type type = sstables::compaction_type::Compaction;
         bool compaction_running = false;
+        // Set for maintenance operations, which are reported by get_maintenance_progress().
+        bool maintenance = false;
+        uint64_t total_bytes = 0;
+        uint64_t completed_bytes = 0;
+        db_clock::time_point started_at;
     };
 
     // compaction manager may have N fibers to allow parallel compaction per shard.
@@ -104,9 +121,22 @@ class compaction_manager {
     // weight is value assigned to a compaction job that is log base N of total size of all input sstables.
     std::unordered_set<int> _weight_tracker;
 
-    // Purpose is to serialize major compaction across all column families, so as to
-    // reduce disk space requirement.
-    semaphore _major_compaction_sem{1};
+    // Maintenance operations (major compaction, cleanup, upgrade and scrub) of all
+    // column families compete for _maintenance_concurrency slots, which bounds the
+    // disk space they need. Waiters with the most bytes to rewrite are admitted first,
+    // so that the work which reclaims the most space is done first.
+    struct maintenance_waiter {
+        uint64_t priority;
+        uint64_t seq;
+        promise<> admitted;
+    };
+    static bool maintenance_waiter_less(const maintenance_waiter& a, const maintenance_waiter& b);
+    std::vector<maintenance_waiter> _maintenance_waiters; // heap ordered by maintenance_waiter_less
+    uint64_t _maintenance_waiter_seq = 0;
+    size_t _maintenance_concurrency = 1;
+    size_t _maintenance_running = 0;
+    // Shares of the compaction scheduling group and I/O class requested while maintenance runs.
+    float _maintenance_shares = 200;
     // Prevents column family from running major and minor compaction at same time.
     std::unordered_map<column_family*, rwlock> _compaction_locks;
 
@@ -162,6 +192,20 @@ class compaction_manager {
 
     future<> rewrite_sstables(column_family* cf, sstables::compaction_options options, get_candidates_func);
 
+    future<> acquire_maintenance_slot(uint64_t priority);
+    void release_maintenance_slot() noexcept;
+    void admit_maintenance_waiters() noexcept;
+
+    // Runs func once a maintenance slot is available, waiters with higher priority first.
+    template <typename Func>
+    futurize_t<std::invoke_result_t<Func>> with_maintenance_slot(uint64_t priority, Func&& func) {
+        return acquire_maintenance_slot(priority).then([this, func = std::forward<Func>(func)] () mutable {
+            return futurize_invoke(func).finally([this] {
+                release_maintenance_slot();
+            });
+        });
+    }
+
     future<> stop_ongoing_compactions(sstring reason);
     optimized_optional<abort_source::subscription> _early_abort_subscription;
 public:
@@ -172,6 +216,11 @@ class compaction_manager {
 
     void register_metrics();
 
+    // Sets the number of maintenance operations (major compaction, cleanup, upgrade
+    // and scrub) which may run in parallel on this shard, and the shares of the
+    // compaction CPU scheduling group and I/O priority class they ask for.
+    void configure_maintenance(size_t concurrency, float shares);
+
     // enable/disable compaction manager.
     void enable();
     void disable();
@@ -245,6 +294,8 @@ class compaction_manager {
         return _compactions;
     }
 
+    std::vector<maintenance_progress> get_maintenance_progress() const;
+
     // Returns true if table has an ongoing compaction, running on its behalf
     bool has_table_ongoing_compaction(column_family* cf) const {
         return std::any_of(_tasks.begin(), _tasks.end(), [cf] (const lw_shared_ptr<task>& task) {
@@ -273,6 +324,7 @@ class compaction_manager {
 
     friend class compacting_sstable_registration;
     friend class compaction_weight_registration;
+    friend class compaction_manager_test_helper;
 };
 
 bool needs_cleanup(const sstables::shared_sstable& sst, const dht::token_range_vector& owned_ranges, schema_ptr s);
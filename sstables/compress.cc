@@ -22,6 +22,7 @@
 #include <stdexcept>
 #include <cstdlib>
 
+#include <boost/lexical_cast.hpp>
 #include <boost/range/algorithm/find_if.hpp>
 #include <seastar/core/align.hh>
 #include <seastar/core/bitops.hh>
@@ -33,6 +34,7 @@
 #include "unimplemented.hh"
 #include "segmented_compress_params.hh"
 #include "utils/class_registrator.hh"
+#include "exceptions.hh"
 
 namespace sstables {
 
@@ -263,9 +265,12 @@ local_compression::local_compression(compressor_ptr p)
 {}
 
 local_compression::local_compression(const compression& c)
-    : _compressor([&c] {
+    : _compressor([&c] () -> compressor_ptr {
+        if (c._dictionary_compressor) {
+            return c._dictionary_compressor;
+        }
         sstring n(c.name.value.begin(), c.name.value.end());
-        return compressor::create(n, [&c, &n](const sstring& key) -> compressor::opt_string {
+        auto cp = compressor::create(n, [&c, &n](const sstring& key) -> compressor::opt_string {
             if (key == compression_parameters::CHUNK_LENGTH_KB || key == compression_parameters::CHUNK_LENGTH_KB_ERR) {
                 return to_sstring(c.chunk_len / 1024);
             }
@@ -279,6 +284,11 @@ local_compression::local_compression(const compression& c)
             }
             return std::nullopt;
         });
+        if (c && !c.dictionary().empty()) {
+            c._dictionary_compressor = cp->with_dictionary(c.dictionary());
+            return c._dictionary_compressor;
+        }
+        return cp;
     }())
 {}
 
@@ -315,6 +325,20 @@ void compression::set_compressor(compressor_ptr c) {
     }
 }
 
+std::optional<uint32_t> compression::dictionary_checksum() const {
+    for (auto& o : options.elements) {
+        if (sstring(o.key.value.begin(), o.key.value.end()) == dictionary_option) {
+            auto v = sstring(o.value.value.begin(), o.value.value.end());
+            try {
+                return boost::lexical_cast<uint32_t>(v);
+            } catch (const boost::bad_lexical_cast&) {
+                throw malformed_sstable_exception(format("Invalid value of {}: {}", dictionary_option, v));
+            }
+        }
+    }
+    return std::nullopt;
+}
+
 void compression::update(uint64_t compressed_file_length) {
     _compressed_file_length = compressed_file_length;
 }
@@ -570,6 +594,12 @@ inline output_stream<char> make_compressed_file_output_stream(output_stream<char
     // probability to verify the checksum of a compressed chunk we read.
     // defaults to 1.0.
     cm->options.elements.push_back({"crc_check_chance", "1.0"});
+    if (!cm->dictionary().empty()) {
+        auto& dict = cm->dictionary();
+        auto crc = to_sstring(crc32_utils::checksum(reinterpret_cast<const char*>(dict.data()), dict.size()));
+        cm->options.elements.push_back({sstables::compression::dictionary_option, bytes(crc.begin(), crc.end())});
+        p = p->with_dictionary(dict);
+    }
 
     auto outer_buffer_size = cm->uncompressed_chunk_length();
     return output_stream<char>(compressed_file_data_sink<ChecksumType, mode>(std::move(out), cm, p), outer_buffer_size, true);
@@ -310,10 +310,19 @@ struct compression {
     uint64_t data_len = 0;
     segmented_offsets offsets;
 
+    // Option which marks chunks compressed with a dictionary, stored in the
+    // CompressionDictionary component. The value is the crc32 of the dictionary.
+    static constexpr auto dictionary_option = "compression_dictionary_crc32";
+
 private:
     // Variables *not* found in the "Compression Info" file (added by update()):
     uint64_t _compressed_file_length = 0;
     uint32_t _full_checksum = 0;
+    // Contents of the CompressionDictionary component, empty if there is none.
+    bytes _dictionary;
+    // Compressor using _dictionary, created by the first reader and shared by
+    // the following ones, so the dictionary is only digested once.
+    mutable compressor_ptr _dictionary_compressor;
 public:
     // Set the compressor algorithm, please check the definition of enum compressor.
     void set_compressor(compressor_ptr c);
@@ -371,7 +380,21 @@ struct compression {
         _full_checksum = checksum;
     }
 
+    const bytes& dictionary() const {
+        return _dictionary;
+    }
+
+    // Must be called before the compressor is set.
+    void set_dictionary(bytes dictionary) {
+        _dictionary = std::move(dictionary);
+        _dictionary_compressor = nullptr;
+    }
+
+    // The crc32 of the dictionary which the chunks were compressed with, if any.
+    std::optional<uint32_t> dictionary_checksum() const;
+
     friend class sstable;
+    friend class local_compression;
 };
 
 // for API query only. Free function just to distinguish it from an accessor in compression
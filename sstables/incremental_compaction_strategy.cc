@@ -0,0 +1,305 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "incremental_compaction_strategy.hh"
+#include "service/priority_manager.hh"
+#include <boost/range/adaptors.hpp>
+#include <boost/range/algorithm.hpp>
+#include <cmath>
+
+namespace sstables {
+
+extern logging::logger clogger;
+
+// The STCS backlog (see size_tiered_backlog_tracker), with runs in place of sstables:
+//
+//   A = T * log4(T) - Sum(runs) { Ri * log4(Ri) },
+//
+// where Ri is the size of a run. Fragments being written or compacted are accounted
+// to the run they belong to.
+class incremental_backlog_tracker final : public compaction_backlog_tracker::impl {
+    int64_t _total_bytes = 0;
+    double _runs_backlog_contribution = 0;
+    std::unordered_map<utils::UUID, int64_t> _run_sizes;
+
+    static double log4(double x) {
+        double inv_log_4 = 1.0f / std::log(4);
+        return log(x) * inv_log_4;
+    }
+
+    static double contribution(int64_t size) {
+        return size > 0 ? size * log4(size) : 0;
+    }
+
+    void update_run(utils::UUID run_id, int64_t delta) {
+        auto& size = _run_sizes[run_id];
+        _runs_backlog_contribution -= contribution(size);
+        size += delta;
+        _runs_backlog_contribution += contribution(size);
+        _total_bytes += delta;
+        if (size <= 0) {
+            _run_sizes.erase(run_id);
+        }
+    }
+public:
+    virtual double backlog(const compaction_backlog_tracker::ongoing_writes& ow, const compaction_backlog_tracker::ongoing_compactions& oc) const override {
+        // Runs being written are considered full runs of the size written so far.
+        std::unordered_map<utils::UUID, int64_t> partial_runs;
+        int64_t partial_bytes = 0;
+        for (auto& [sst, progress] : ow) {
+            auto written = progress->written();
+            if (written > 0) {
+                partial_runs[sst->run_identifier()] += written;
+                partial_bytes += written;
+            }
+        }
+        double partial_contribution = 0;
+        for (auto size : partial_runs | boost::adaptors::map_values) {
+            partial_contribution += contribution(size);
+        }
+
+        int64_t compacted_bytes = 0;
+        double compacted_contribution = 0;
+        for (auto& [sst, progress] : oc) {
+            auto compacted = progress->compacted();
+            auto it = _run_sizes.find(sst->run_identifier());
+            int64_t run_size = it != _run_sizes.end() ? it->second : sst->data_size();
+            auto effective_size = run_size - int64_t(compacted);
+            compacted_bytes += compacted;
+            if (effective_size > 0) {
+                compacted_contribution += compacted * log4(effective_size);
+            }
+        }
+
+        auto effective_total_size = _total_bytes + partial_bytes - compacted_bytes;
+        if (effective_total_size <= 0) {
+            return 0;
+        }
+        auto runs_contribution = _runs_backlog_contribution + partial_contribution - compacted_contribution;
+        auto b = (effective_total_size * log4(effective_total_size)) - runs_contribution;
+        return b > 0 ? b : 0;
+    }
+
+    virtual void add_sstable(sstables::shared_sstable sst) override {
+        if (sst->data_size() > 0) {
+            update_run(sst->run_identifier(), sst->data_size());
+        }
+    }
+
+    virtual void remove_sstable(sstables::shared_sstable sst) override {
+        if (sst->data_size() > 0) {
+            update_run(sst->run_identifier(), -int64_t(sst->data_size()));
+        }
+    }
+};
+
+incremental_compaction_strategy::incremental_compaction_strategy(const std::map<sstring, sstring>& options)
+    : compaction_strategy_impl(options)
+    , _fragment_size(calculate_fragment_size(compaction_strategy_impl::get_value(options, SSTABLE_SIZE_OPTION)))
+    , _options(options)
+    , _backlog_tracker(std::make_unique<incremental_backlog_tracker>())
+{}
+
+uint64_t incremental_compaction_strategy::calculate_fragment_size(std::optional<sstring> option_value) const {
+    using namespace cql3::statements;
+    auto size_in_mb = property_definitions::to_int(SSTABLE_SIZE_OPTION, option_value, DEFAULT_MAX_SSTABLE_SIZE_IN_MB);
+    if (size_in_mb <= 0) {
+        throw exceptions::configuration_exception(format("{} must be greater than 0, got {}", SSTABLE_SIZE_OPTION, size_in_mb));
+    }
+    if (size_in_mb < 100) {
+        clogger.warn("Fragment size of {}MB is configured for incremental compaction. Small fragments "
+                "increase the number of sstables and the cost of reads", size_in_mb);
+    }
+    return uint64_t(size_in_mb) * 1024 * 1024;
+}
+
+std::vector<sstable_run>
+incremental_compaction_strategy::get_runs(const std::vector<shared_sstable>& candidates) {
+    // Fragments of a run which is being compacted are not candidates until they are released,
+    // and the compaction manager excludes runs which are being written, so candidates never
+    // hold a part of a run.
+    std::unordered_map<utils::UUID, sstable_run> runs;
+    for (auto& sst : candidates) {
+        runs[sst->run_identifier()].insert(sst);
+    }
+    return boost::copy_range<std::vector<sstable_run>>(runs | boost::adaptors::map_values);
+}
+
+std::vector<std::vector<sstable_run>>
+incremental_compaction_strategy::get_buckets(std::vector<sstable_run> runs) const {
+    std::vector<std::pair<sstable_run, uint64_t>> sorted_runs;
+    sorted_runs.reserve(runs.size());
+    for (auto& run : runs) {
+        auto size = run.data_size();
+        sorted_runs.emplace_back(std::move(run), size);
+    }
+    std::sort(sorted_runs.begin(), sorted_runs.end(), [] (auto& i, auto& j) {
+        return i.second < j.second;
+    });
+
+    std::map<size_t, std::vector<sstable_run>> buckets;
+    for (auto& [run, size] : sorted_runs) {
+        bool found = false;
+        for (auto it = buckets.begin(); it != buckets.end(); it++) {
+            size_t old_average_size = it->first;
+
+            if ((size > (old_average_size * _options.bucket_low) && size < (old_average_size * _options.bucket_high)) ||
+                    (size < _options.min_sstable_size && old_average_size < _options.min_sstable_size)) {
+                auto bucket = std::move(it->second);
+                size_t total_size = bucket.size() * old_average_size;
+                size_t new_average_size = (total_size + size) / (bucket.size() + 1);
+
+                bucket.push_back(std::move(run));
+                buckets.erase(it);
+                buckets.insert({ new_average_size, std::move(bucket) });
+
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            std::vector<sstable_run> new_bucket;
+            new_bucket.push_back(std::move(run));
+            buckets.insert({ size, std::move(new_bucket) });
+        }
+    }
+
+    return boost::copy_range<std::vector<std::vector<sstable_run>>>(buckets | boost::adaptors::map_values);
+}
+
+std::vector<sstable_run>
+incremental_compaction_strategy::most_interesting_bucket(std::vector<std::vector<sstable_run>> buckets,
+        size_t min_threshold, size_t max_threshold) {
+    // Buckets are ordered by the average size of their runs, compact the smallest runs first.
+    for (auto& bucket : buckets) {
+        if (bucket.size() >= min_threshold) {
+            bucket.resize(std::min(bucket.size(), max_threshold));
+            return std::move(bucket);
+        }
+    }
+    return {};
+}
+
+compaction_descriptor
+incremental_compaction_strategy::make_descriptor(column_family& cf, const std::vector<sstable_run>& runs) const {
+    std::vector<shared_sstable> sstables;
+    for (auto& run : runs) {
+        boost::copy(run.all(), std::back_inserter(sstables));
+    }
+    return compaction_descriptor(std::move(sstables), cf.get_sstable_set(), service::get_local_compaction_priority(),
+                                 compaction_descriptor::default_level, _fragment_size);
+}
+
+compaction_descriptor
+incremental_compaction_strategy::get_sstables_for_compaction(column_family& cf, std::vector<sstables::shared_sstable> candidates) {
+    size_t min_threshold = cf.min_compaction_threshold();
+    size_t max_threshold = cf.schema()->max_compaction_threshold();
+    auto gc_before = gc_clock::now() - cf.schema()->gc_grace_seconds();
+
+    auto buckets = get_buckets(get_runs(candidates));
+
+    if (auto runs = most_interesting_bucket(buckets, min_threshold, max_threshold); !runs.empty()) {
+        return make_descriptor(cf, runs);
+    }
+
+    // If we are not enforcing min_threshold explicitly, try any pair of runs in the same tier.
+    if (!cf.compaction_enforce_min_threshold()) {
+        if (auto runs = most_interesting_bucket(buckets, 2, max_threshold); !runs.empty()) {
+            return make_descriptor(cf, runs);
+        }
+    }
+
+    // If there is nothing to compact in the standard way, try compacting a single fragment
+    // whose droppable tombstone ratio is greater than the threshold, preferring the oldest
+    // fragments from the biggest tiers, like size_tiered_compaction_strategy does.
+    for (auto& bucket : buckets | boost::adaptors::reversed) {
+        std::vector<shared_sstable> sstables;
+        for (auto& run : bucket) {
+            boost::copy(run.all() | boost::adaptors::filtered([this, &gc_before] (const shared_sstable& sst) {
+                return worth_dropping_tombstones(sst, gc_before);
+            }), std::back_inserter(sstables));
+        }
+        if (sstables.empty()) {
+            continue;
+        }
+        auto it = std::min_element(sstables.begin(), sstables.end(), [] (auto& i, auto& j) {
+            return i->get_stats_metadata().min_timestamp < j->get_stats_metadata().min_timestamp;
+        });
+        return compaction_descriptor({ *it }, cf.get_sstable_set(), service::get_local_compaction_priority(),
+                                     compaction_descriptor::default_level, _fragment_size);
+    }
+    return compaction_descriptor();
+}
+
+compaction_descriptor
+incremental_compaction_strategy::get_major_compaction_job(column_family& cf, std::vector<sstables::shared_sstable> candidates) {
+    if (candidates.empty()) {
+        return compaction_descriptor();
+    }
+    return compaction_descriptor(std::move(candidates), cf.get_sstable_set(), service::get_local_compaction_priority(),
+                                 compaction_descriptor::default_level, _fragment_size);
+}
+
+int64_t incremental_compaction_strategy::estimated_pending_compactions(column_family& cf) const {
+    size_t min_threshold = cf.min_compaction_threshold();
+    size_t max_threshold = cf.schema()->max_compaction_threshold();
+    std::vector<shared_sstable> sstables;
+    sstables.reserve(cf.sstables_count());
+    for (auto& entry : *cf.get_sstables()) {
+        sstables.push_back(entry);
+    }
+
+    int64_t n = 0;
+    for (auto& bucket : get_buckets(get_runs(sstables))) {
+        if (bucket.size() >= min_threshold) {
+            n += std::ceil(double(bucket.size()) / max_threshold);
+        }
+    }
+    return n;
+}
+
+compaction_descriptor
+incremental_compaction_strategy::get_reshaping_job(std::vector<shared_sstable> input, schema_ptr schema, const ::io_priority_class& iop, reshape_mode mode) {
+    size_t offstrategy_threshold = std::max(schema->min_compaction_threshold(), 4);
+    size_t max_runs = std::max(schema->max_compaction_threshold(), int(offstrategy_threshold));
+
+    if (mode == reshape_mode::relaxed) {
+        offstrategy_threshold = max_runs;
+    }
+
+    for (auto& bucket : get_buckets(get_runs(input))) {
+        if (bucket.size() >= offstrategy_threshold) {
+            bucket.resize(std::min(max_runs, bucket.size()));
+            std::vector<shared_sstable> sstables;
+            for (auto& run : bucket) {
+                boost::copy(run.all(), std::back_inserter(sstables));
+            }
+            compaction_descriptor desc(std::move(sstables), std::optional<sstables::sstable_set>(), iop,
+                                       compaction_descriptor::default_level, _fragment_size);
+            desc.options = compaction_options::make_reshape();
+            return desc;
+        }
+    }
+
+    return compaction_descriptor();
+}
+
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "size_tiered_compaction_strategy.hh"
+#include "sstable_set.hh"
+
+namespace sstables {
+
+// Incremental compaction strategy (ICS) is size-tiered compaction applied to
+// sstable runs rather than to individual sstables.
+//
+// Compaction output is split into fragments of at most sstable_size_in_mb, which
+// together form a run. Tiers are made of runs of similar size. When runs are
+// compacted, an input fragment is released as soon as the output covers all its keys
+// (see regular_compaction::maybe_replace_exhausted_sstables_by_sst()), so the
+// temporary space needed by a compaction is bounded by a few fragments instead of
+// the size of the whole tier, as it is with STCS.
+class incremental_compaction_strategy : public compaction_strategy_impl {
+    static constexpr int32_t DEFAULT_MAX_SSTABLE_SIZE_IN_MB = 1000;
+    const sstring SSTABLE_SIZE_OPTION = "sstable_size_in_mb";
+
+    uint64_t _fragment_size;
+    size_tiered_compaction_strategy_options _options;
+    compaction_backlog_tracker _backlog_tracker;
+
+    uint64_t calculate_fragment_size(std::optional<sstring> option_value) const;
+
+    // Groups the candidates into runs. Runs are compacted as a whole.
+    static std::vector<sstable_run> get_runs(const std::vector<shared_sstable>& candidates);
+
+    // Groups runs of similar size into buckets, like size_tiered_compaction_strategy::get_buckets() does for sstables.
+    std::vector<std::vector<sstable_run>> get_buckets(std::vector<sstable_run> runs) const;
+
+    // Returns the bucket with the smallest runs which has at least min_threshold runs,
+    // trimmed to max_threshold runs, or an empty one if there is none.
+    static std::vector<sstable_run> most_interesting_bucket(std::vector<std::vector<sstable_run>> buckets,
+        size_t min_threshold, size_t max_threshold);
+
+    compaction_descriptor make_descriptor(column_family& cf, const std::vector<sstable_run>& runs) const;
+public:
+    incremental_compaction_strategy(const std::map<sstring, sstring>& options);
+
+    virtual compaction_descriptor get_sstables_for_compaction(column_family& cfs, std::vector<sstables::shared_sstable> candidates) override;
+
+    virtual compaction_descriptor get_major_compaction_job(column_family& cf, std::vector<sstables::shared_sstable> candidates) override;
+
+    virtual int64_t estimated_pending_compactions(column_family& cf) const override;
+
+    virtual compaction_strategy_type type() const override {
+        return compaction_strategy_type::incremental;
+    }
+
+    virtual compaction_backlog_tracker& get_backlog_tracker() override {
+        return _backlog_tracker;
+    }
+
+    virtual compaction_descriptor get_reshaping_job(std::vector<shared_sstable> input, schema_ptr schema, const ::io_priority_class& iop, reshape_mode mode) override;
+
+    uint64_t fragment_size() const {
+        return _fragment_size;
+    }
+};
+
+}
@@ -398,18 +398,26 @@ class clustered_index_cursor {
 
 class promoted_index {
     deletion_time _del_time;
+    uint64_t _promoted_index_start;
     uint32_t _promoted_index_size;
+    uint32_t _num_blocks;
     std::unique_ptr<clustered_index_cursor> _cursor;
     bool _reader_closed = false;
 public:
-    promoted_index(const schema& s, deletion_time del_time, uint32_t promoted_index_size, std::unique_ptr<clustered_index_cursor> index)
+    promoted_index(const schema& s, deletion_time del_time, uint64_t promoted_index_start, uint32_t promoted_index_size,
+            uint32_t num_blocks, std::unique_ptr<clustered_index_cursor> index)
             : _del_time{del_time}
+            , _promoted_index_start(promoted_index_start)
             , _promoted_index_size(promoted_index_size)
+            , _num_blocks(num_blocks)
             , _cursor(std::move(index))
     { }
 
     [[nodiscard]] deletion_time get_deletion_time() const { return _del_time; }
+    // Position of the promoted index in the index file
+    [[nodiscard]] uint64_t get_promoted_index_start() const { return _promoted_index_start; }
     [[nodiscard]] uint32_t get_promoted_index_size() const { return _promoted_index_size; }
+    [[nodiscard]] uint32_t get_num_blocks() const { return _num_blocks; }
     [[nodiscard]] clustered_index_cursor& cursor() { return *_cursor; };
     [[nodiscard]] const clustered_index_cursor& cursor() const { return *_cursor; };
     future<> close_reader() { return _cursor->close(); }
@@ -24,6 +24,7 @@
 #include "consumer.hh"
 #include "downsampling.hh"
 #include "sstables/shared_index_lists.hh"
+#include "sstables/partition_index_cache.hh"
 #include <seastar/util/bool_class.hh>
 #include "utils/buffer_input_stream.hh"
 #include "sstables/prepended_input_stream.hh"
@@ -258,7 +259,8 @@ class index_consume_entry_context : public data_consumer::continuous_data_consum
                     cursor = std::make_unique<scanning_clustered_index_cursor>(_s, continuous_data_consumer::_permit,
                         std::move(promoted_index_stream), promoted_index_size, _num_pi_blocks, _ck_values_fixed_lengths);
                 }
-                pi = std::make_unique<promoted_index>(_s, *_deletion_time, promoted_index_size, std::move(cursor));
+                pi = std::make_unique<promoted_index>(_s, *_deletion_time, promoted_index_start, promoted_index_size,
+                    _num_pi_blocks, std::move(cursor));
             } else {
                 _num_pi_blocks = 0;
             }
@@ -409,6 +411,45 @@ class index_reader {
     std::optional<index_bound> _upper_bound;
 
 private:
+    // Opens a cursor over the promoted index of an entry which was found in the partition index cache.
+    std::unique_ptr<clustered_index_cursor> make_cursor(const cached_index_entry& e) {
+        auto f = reader::get_file(*_sstable, _permit, _trace_state);
+        std::optional<column_values_fixed_lengths> cvfl;
+        if (_sstable->get_version() >= sstable_version_types::mc) {
+            cvfl = get_clustering_values_fixed_lengths(_sstable->get_serialization_header());
+            if (use_binary_search_in_promoted_index) {
+                cached_file cf(std::move(f), _permit, index_page_cache_metrics, e.promoted_index_start(), e.promoted_index_size(),
+                    _trace_state ? _sstable->filename(component_type::Index) : sstring());
+                return std::make_unique<mc::bsearch_clustered_cursor>(*_sstable->_schema,
+                    promoted_index_cache_metrics, _permit, std::move(*cvfl), std::move(cf), _pc, e.num_pi_blocks(), _trace_state);
+            }
+        }
+        auto options = reader::get_file_input_stream_options(_sstable, _pc);
+        return std::make_unique<scanning_clustered_index_cursor>(*_sstable->_schema, _permit,
+            make_file_input_stream(std::move(f), e.promoted_index_start(), e.promoted_index_size(), options),
+            e.promoted_index_size(), e.num_pi_blocks(), std::move(cvfl));
+    }
+
+    // Makes index entries out of a page cached in the partition_index_cache.
+    index_list materialize(const partition_index_page& page) {
+        const schema& s = *_sstable->_schema;
+        index_list entries;
+        entries.reserve(page.entries().size());
+        with_linearized_managed_bytes([&] {
+            for (const cached_index_entry& e : page.entries()) {
+                bytes_view key = e.key();
+                std::unique_ptr<promoted_index> pi;
+                if (e.has_promoted_index()) {
+                    pi = std::make_unique<promoted_index>(s, e.get_deletion_time(), e.promoted_index_start(),
+                        e.promoted_index_size(), e.num_pi_blocks(), make_cursor(e));
+                }
+                entries.emplace_back(s, temporary_buffer<char>(reinterpret_cast<const char*>(key.data()), key.size()),
+                    e.position(), std::move(pi));
+            }
+        });
+        return entries;
+    }
+
     void advance_to_end(index_bound& bound) {
         sstlog.trace("index {}: advance_to_end() bound {}", fmt::ptr(this), fmt::ptr(&bound));
         bound.data_file_position = data_file_end();
@@ -433,6 +474,14 @@ class index_reader {
             return make_ready_future<>();
         }
         auto loader = [this] (uint64_t summary_idx) -> future<index_list> {
+            auto cached = _sstable->get_index_cache().get(summary_idx, [this] (const partition_index_page& page) {
+                return materialize(page);
+            });
+            if (cached) {
+                sstlog.trace("index {}: page {} found in partition index cache", fmt::ptr(this), summary_idx);
+                return make_ready_future<index_list>(std::move(*cached));
+            }
+
             auto& summary = _sstable->get_summary();
             uint64_t position = summary.entries[summary_idx].position;
             uint64_t quantity = downsampling::get_effective_index_interval_after_index(summary_idx, summary.header.sampling_level,
@@ -453,7 +502,7 @@ class index_reader {
                         sstlog.error("failed reading index for {}: {}", _sstable->get_filename(), ex);
                     }
                     auto indexes = std::move(entries_reader->_consumer.indexes);
-                    return entries_reader->_context.close().then([indexes = std::move(indexes), ex = std::move(ex)] () mutable {
+                    return entries_reader->_context.close().then([this, summary_idx, indexes = std::move(indexes), ex = std::move(ex)] () mutable {
                         if (ex) {
                             return do_with(std::move(indexes), [ex = std::move(ex)] (index_list& indexes) mutable {
                                 return parallel_for_each(indexes, [] (index_entry& ie) mutable {
@@ -464,6 +513,7 @@ class index_reader {
                                 });
                             });
                         }
+                        _sstable->get_index_cache().populate(summary_idx, indexes);
                         return make_ready_future<index_list>(std::move(indexes));
                     });
 
@@ -22,7 +22,9 @@
 #include "integrity_checked_file_impl.hh"
 #include <seastar/core/do_with.hh>
 #include <seastar/core/print.hh>
-#include <boost/algorithm/cxx11/all_of.hpp>
+#include <array>
+#include <cstring>
+#include <optional>
 
 namespace sstables {
 
@@ -41,21 +43,32 @@ static bytes data_sample(const int8_t* buf, size_t buf_len, size_t sample_off, s
 }
 
 static sstring report_zeroed_4k_aligned_blocks(const temporary_buffer<int8_t>& buf) {
+    // memcmp() is vectorized, unlike a byte-by-byte scan.
+    static const std::array<int8_t, 4096> zeroes = {};
     sstring report;
     auto nr_blocks = buf.size() / 4096UL;
     for (auto i = 0UL; i < nr_blocks; i++) {
         auto off = i * 4096UL;
-        auto len = std::min(buf.size() - off, 4096UL);
-
-        auto begin = buf.get() + off;
-        auto end = begin + len;
-        if (boost::algorithm::all_of_equal(begin, end, 0)) {
+        if (!std::memcmp(buf.get() + off, zeroes.data(), zeroes.size())) {
             report += format("{:d}, ", off);
         }
     }
     return report;
 }
 
+// Like std::mismatch(), but compares with memcmp() first, since the buffers are almost always equal.
+static std::optional<size_t> find_mismatch(const int8_t* a, size_t a_len, const int8_t* b, size_t b_len) {
+    if (a_len == b_len && !std::memcmp(a, b, a_len)) {
+        return std::nullopt;
+    }
+    auto a_end = a + a_len;
+    auto r = std::mismatch(a, a_end, b, b + b_len);
+    if (r.first == a_end) {
+        return std::nullopt;
+    }
+    return r.first - a;
+}
+
 future<size_t>
 integrity_checked_file_impl::write_dma(uint64_t pos, const void* buffer, size_t len, const io_priority_class& pc) {
     auto wbuf = temporary_buffer<int8_t>(static_cast<const int8_t*>(buffer), len);
@@ -73,10 +86,8 @@ integrity_checked_file_impl::write_dma(uint64_t pos, const void* buffer, size_t
                 "reason: only {} bytes were written.", _fname, len, pos, ret);
         }
 
-        auto wbuf_end = wbuf.get() + wbuf.size();
-        auto r = std::mismatch(wbuf.get(), wbuf_end, buffer, buffer + len);
-        if (r.first != wbuf_end) {
-            auto mismatch_off = r.first - wbuf.get();
+        if (auto mismatch = find_mismatch(wbuf.get(), wbuf.size(), buffer, len)) {
+            auto mismatch_off = *mismatch;
 
             sstlog.error("integrity check failed for {}, stage: after write verification, write: {} bytes to offset {}, " \
                 "reason: buffer was modified during write call, mismatch at byte {}:\n" \
@@ -94,10 +105,8 @@ integrity_checked_file_impl::write_dma(uint64_t pos, const void* buffer, size_t
                     "reason: only able to read {} bytes for further verification", _fname, len, pos, rbuf.size());
             }
 
-            auto rbuf_end = rbuf.get() + rbuf.size();
-            auto r = std::mismatch(rbuf.get(), rbuf.get() + rbuf.size(), wbuf.get(), wbuf.get() + wbuf.size());
-            if (r.first != rbuf_end) {
-                auto mismatch_off = r.first - rbuf.get();
+            if (auto mismatch = find_mismatch(rbuf.get(), rbuf.size(), wbuf.get(), wbuf.size())) {
+                auto mismatch_off = *mismatch;
 
                 sstlog.error("integrity check failed for {}, stage: read after write verification, write: {} bytes to offset {}, " \
                     "reason: data read from underlying storage isn't the same as written, mismatch at byte {}:\n" \
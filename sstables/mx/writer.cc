@@ -27,6 +27,7 @@
 #include "vint-serialization.hh"
 #include "sstables/types.hh"
 #include "sstables/mx/types.hh"
+#include "sstables/range_hashes.hh"
 #include "db/config.hh"
 #include "atomic_cell.hh"
 #include "utils/exceptions.hh"
@@ -609,6 +610,7 @@ class writer : public sstable_writer::writer_impl {
     utils::UUID _run_identifier;
     bool _write_regular_as_static; // See #4139
     scylla_metadata::large_data_stats _large_data_stats;
+    range_hashes_builder _range_hashes;
 
     void init_file_writers();
 
@@ -793,13 +795,19 @@ class writer : public sstable_writer::writer_impl {
                     }
                 },
             }})
+        , _range_hashes(s, cfg.range_hash_boundaries)
     {
         // This can be 0 in some cases, which is albeit benign, can wreak havoc
         // in lower-level writer code, so clamp it to [1, +inf) here, which is
         // exactly what callers used to do anyway.
         estimated_partitions = std::max(uint64_t(1), estimated_partitions);
 
-        _sst.generate_toc(_schema.get_compressor_params().get_compressor(), _schema.bloom_filter_fp_chance());
+        auto compressor = _schema.get_compressor_params().get_compressor();
+        if (_cfg.compression_dictionary && compressor && compressor->dictionary_size()) {
+            _sst._components->compression.set_dictionary(*_cfg.compression_dictionary);
+        }
+        _sst.generate_toc(std::move(compressor), _schema.bloom_filter_fp_chance());
+        _sst._recognized_components.insert(component_type::RangeHashes);
         _sst.write_toc(_pc);
         _sst.create_data().get();
         _compression_enabled = !_sst.has_component(component_type::CRC);
@@ -807,7 +815,8 @@ class writer : public sstable_writer::writer_impl {
         _sst._shards = { shard };
 
         _cfg.monitor->on_write_started(_data_writer->offset_tracker());
-        _sst._components->filter = utils::i_filter::get_filter(estimated_partitions, _schema.bloom_filter_fp_chance(), utils::filter_format::m_format);
+        _sst._components->filter = utils::i_filter::get_filter(estimated_partitions, _schema.bloom_filter_fp_chance(), utils::filter_format::m_format,
+                                                                  _schema.bloom_filter_type());
         _pi_write_m.desired_block_size = cfg.promoted_index_block_size;
         _index_sampling_state.summary_byte_cost = _cfg.summary_byte_cost;
         prepare_summary(_sst._components->summary, estimated_partitions, _schema.min_index_interval());
@@ -996,6 +1005,7 @@ void writer::consume_new_partition(const dht::decorated_key& dk) {
 
     _partition_key = key::from_partition_key(_schema, dk.key());
     maybe_add_summary_entry(dk.token(), bytes_view(*_partition_key));
+    _range_hashes.consume_new_partition(dk);
 
     _sst._components->filter->add(bytes_view(*_partition_key));
     _collector.add_key(bytes_view(*_partition_key));
@@ -1034,6 +1044,7 @@ void writer::consume(tombstone t) {
 
     _pi_write_m.tomb = t;
     _tombstone_written = true;
+    _range_hashes.consume(t);
 
     if (t) {
         _collector.update_min_max_components(clustering_key_prefix::make_empty(_schema));
@@ -1314,6 +1325,7 @@ void writer::write_static_row(const row& static_row, column_kind kind) {
 
 stop_iteration writer::consume(static_row&& sr) {
     ensure_tombstone_is_written();
+    _range_hashes.consume(sr);
     write_static_row(sr.cells(), column_kind::static_column);
     return stop_iteration::no;
 }
@@ -1365,6 +1377,7 @@ void writer::write_clustered(const clustering_row& clustered_row, uint64_t prev_
 }
 
 stop_iteration writer::consume(clustering_row&& cr) {
+    _range_hashes.consume(cr);
     if (_write_regular_as_static) {
         ensure_tombstone_is_written();
         write_static_row(cr.cells(), column_kind::regular_column);
@@ -1444,6 +1457,7 @@ void writer::consume(rt_marker&& marker) {
 }
 
 stop_iteration writer::consume(range_tombstone&& rt) {
+    _range_hashes.consume(rt);
     drain_tombstones(rt.position());
     _range_tombstones.apply(std::move(rt));
     return stop_iteration::no;
@@ -1504,6 +1518,7 @@ void writer::consume_end_of_stream() {
     _sst.write_filter(_pc);
     _sst.write_statistics(_pc);
     _sst.write_compression(_pc);
+    _sst.write_range_hashes(_pc, std::move(_range_hashes).build());
     auto features = sstable_enabled_features::all();
     if (!_cfg.correctly_serialize_non_compound_range_tombstones) {
         features.disable(sstable_feature::NonCompoundRangeTombstones);
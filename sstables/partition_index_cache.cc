@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sstables/partition_index_cache.hh"
+#include "sstables/index_entry.hh"
+#include "row_cache.hh"
+#include "log.hh"
+
+namespace sstables {
+
+extern logging::logger sstlog;
+
+thread_local partition_index_cache::stats partition_index_cache::_shard_stats;
+
+cached_index_entry::cached_index_entry(const index_entry& e)
+    : _key(e.get_key_bytes())
+    , _position(e.position())
+{
+    if (auto& pi = e.get_promoted_index()) {
+        _deletion_time = pi->get_deletion_time();
+        _promoted_index_start = pi->get_promoted_index_start();
+        _promoted_index_size = pi->get_promoted_index_size();
+        _num_pi_blocks = pi->get_num_blocks();
+    }
+}
+
+partition_index_page::partition_index_page(partition_index_cache& cache, uint64_t summary_idx, const index_list& entries)
+    : evictable(kind::partition_index_page)
+    , _cache(cache)
+    , _summary_idx(summary_idx)
+{
+    _entries.reserve(entries.size());
+    for (const index_entry& e : entries) {
+        _entries.emplace_back(e);
+    }
+}
+
+partition_index_page::partition_index_page(partition_index_page&& o) noexcept
+    : evictable(std::move(o))
+    , _link(std::move(o._link))
+    , _cache(o._cache)
+    , _summary_idx(o._summary_idx)
+    , _entries(std::move(o._entries))
+{ }
+
+size_t partition_index_page::memory_usage() const {
+    size_t size = sizeof(*this) + _entries.used_space_external_memory_usage();
+    for (const cached_index_entry& e : _entries) {
+        size += e.external_memory_usage();
+    }
+    return size;
+}
+
+void partition_index_page::on_evicted(cache_tracker&) noexcept {
+    _cache.on_evicted(*this);
+}
+
+partition_index_cache::partition_index_cache(cache_tracker& tracker)
+    : _tracker(tracker)
+    , _region(tracker.region())
+{ }
+
+partition_index_cache::~partition_index_cache() {
+    clear();
+}
+
+void partition_index_cache::touch(partition_index_page& page) noexcept {
+    _tracker.touch(page);
+}
+
+void partition_index_cache::on_evicted(partition_index_page& page) noexcept {
+    ++_shard_stats.evictions;
+    --_shard_stats.pages;
+    _shard_stats.used_bytes -= page.memory_usage();
+    // Called by the cache_tracker with the region's allocator already set.
+    current_deleter<partition_index_page>()(&page);
+}
+
+void partition_index_cache::populate(key_type key, const index_list& entries) noexcept {
+    try {
+        _populate_section(_region, [&] {
+            with_allocator(_region.allocator(), [&] {
+                auto i = _pages.lower_bound(key, partition_index_page::compare{});
+                if (i != _pages.end() && i->summary_idx() == key) {
+                    return;
+                }
+                auto page = alloc_strategy_unique_ptr<partition_index_page>(
+                    current_allocator().construct<partition_index_page>(*this, key, entries));
+                _pages.insert_before(i, *page);
+                auto& p = *page.release();
+                _tracker.touch(p);
+                ++_shard_stats.populations;
+                ++_shard_stats.pages;
+                _shard_stats.used_bytes += p.memory_usage();
+            });
+        });
+    } catch (...) {
+        sstlog.debug("Failed to cache partition index page {}: {}", key, std::current_exception());
+    }
+}
+
+void partition_index_cache::clear() noexcept {
+    with_allocator(_region.allocator(), [&] {
+        _pages.clear_and_dispose([] (partition_index_page* page) noexcept {
+            --_shard_stats.pages;
+            _shard_stats.used_bytes -= page->memory_usage();
+            current_deleter<partition_index_page>()(page);
+        });
+    });
+}
+
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <optional>
+#include <type_traits>
+
+#include "sstables/types.hh"
+#include "sstables/shared_index_lists.hh"
+#include "utils/intrusive_btree.hh"
+#include "utils/logalloc.hh"
+#include "utils/lru.hh"
+#include "utils/managed_bytes.hh"
+#include "utils/managed_vector.hh"
+
+class cache_tracker;
+
+namespace sstables {
+
+// Partition index entry as stored in the partition_index_cache.
+//
+// Holds only the location of the promoted index, not its contents,
+// the promoted index cursor is re-created each time the entry is materialized.
+class cached_index_entry {
+    managed_bytes _key;
+    uint64_t _position;
+    deletion_time _deletion_time;
+    uint64_t _promoted_index_start = 0;
+    uint32_t _promoted_index_size = 0; // 0 when the entry has no promoted index
+    uint32_t _num_pi_blocks = 0;
+public:
+    explicit cached_index_entry(const index_entry&);
+    cached_index_entry(cached_index_entry&&) noexcept = default;
+
+    // Valid only within a linearization context, see with_linearized_managed_bytes().
+    bytes_view key() const { return _key; }
+    uint64_t position() const { return _position; }
+    bool has_promoted_index() const { return _promoted_index_size; }
+    deletion_time get_deletion_time() const { return _deletion_time; }
+    uint64_t promoted_index_start() const { return _promoted_index_start; }
+    uint32_t promoted_index_size() const { return _promoted_index_size; }
+    uint32_t num_pi_blocks() const { return _num_pi_blocks; }
+
+    size_t external_memory_usage() const { return _key.external_memory_usage(); }
+};
+
+class partition_index_cache;
+
+// All partition index entries covered by a single summary entry.
+//
+// Lives in the cache_tracker's LSA region and is linked into its LRU,
+// so it is evicted along with rows of the row cache.
+class partition_index_page final : public evictable {
+    friend class partition_index_cache;
+    intrusive_b::member_hook _link;
+    partition_index_cache& _cache;
+    uint64_t _summary_idx;
+    managed_vector<cached_index_entry> _entries;
+public:
+    partition_index_page(partition_index_cache&, uint64_t summary_idx, const index_list&);
+    partition_index_page(partition_index_page&&) noexcept;
+
+    uint64_t summary_idx() const { return _summary_idx; }
+    const managed_vector<cached_index_entry>& entries() const { return _entries; }
+    size_t memory_usage() const;
+
+    void on_evicted(cache_tracker&) noexcept;
+
+    struct compare {
+        bool operator()(const partition_index_page& a, const partition_index_page& b) const noexcept { return a._summary_idx < b._summary_idx; }
+        bool operator()(const partition_index_page& a, uint64_t b) const noexcept { return a._summary_idx < b; }
+        bool operator()(uint64_t a, const partition_index_page& b) const noexcept { return a < b._summary_idx; }
+    };
+
+    using container_type = intrusive_b::tree<partition_index_page, &partition_index_page::_link, intrusive_b::key_search::binary>;
+};
+
+// Persistent cache of partition index pages (Index.db) of a single sstable.
+//
+// Unlike shared_index_lists, which only deduplicates concurrent reads of the same page,
+// pages stay cached after readers are done with them, until evicted by the cache_tracker.
+// Pages compete for memory with the row cache under the same LRU.
+//
+// The cache is filled by the index_reader after it reads a page from disk, so concurrent
+// misses for the same page may each read it. Only the first one gets inserted.
+class partition_index_cache {
+public:
+    using key_type = uint64_t;
+    static thread_local struct stats {
+        uint64_t hits = 0; // Number of pages which were found in the cache
+        uint64_t misses = 0; // Number of pages which had to be read from disk
+        uint64_t populations = 0; // Number of pages inserted into the cache
+        uint64_t evictions = 0; // Number of pages evicted by the cache_tracker
+        uint64_t used_bytes = 0; // Memory occupied by cached pages
+        uint64_t pages = 0; // Number of cached pages
+    } _shard_stats;
+private:
+    friend class partition_index_page;
+    cache_tracker& _tracker;
+    logalloc::region& _region;
+    logalloc::allocating_section _populate_section;
+    partition_index_page::container_type _pages;
+private:
+    void touch(partition_index_page&) noexcept;
+    void on_evicted(partition_index_page&) noexcept;
+public:
+    explicit partition_index_cache(cache_tracker&);
+    ~partition_index_cache();
+
+    partition_index_cache(partition_index_cache&&) = delete;
+    partition_index_cache(const partition_index_cache&) = delete;
+
+    // If the page is cached, returns the result of invoking func on it.
+    // Otherwise returns a disengaged optional.
+    //
+    // func must not allocate in LSA and must not keep references to the page,
+    // it's meant to copy the contents out.
+    template <typename Func>
+    std::optional<std::invoke_result_t<Func, const partition_index_page&>> get(key_type key, Func&& func) {
+        logalloc::reclaim_lock rl(_region);
+        auto i = _pages.find(key, partition_index_page::compare{});
+        if (i == _pages.end()) {
+            ++_shard_stats.misses;
+            return std::nullopt;
+        }
+        std::optional<std::invoke_result_t<Func, const partition_index_page&>> result(func(*i));
+        ++_shard_stats.hits;
+        touch(*i);
+        return result;
+    }
+
+    // Inserts a page which was read from disk.
+    // Failure to allocate memory is not an error, the page is just not cached then.
+    void populate(key_type key, const index_list&) noexcept;
+
+    // Drops all cached pages.
+    void clear() noexcept;
+
+    static const stats& shard_stats() { return _shard_stats; }
+};
+
+}
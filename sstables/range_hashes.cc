@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <limits>
+
+#include "sstables/range_hashes.hh"
+#include "atomic_cell_hash.hh"
+#include "xx_hasher.hh"
+
+namespace sstables {
+
+// Buckets and ranges are represented as (start, end] in raw token values.
+// No key has the minimum raw value, so it stands for the start of the ring.
+static constexpr int64_t ring_start = std::numeric_limits<int64_t>::min();
+static constexpr int64_t ring_end = std::numeric_limits<int64_t>::max();
+
+static range_hash_bucket bucket_of(dht::token t, const std::vector<dht::token>& boundaries) {
+    auto it = std::lower_bound(boundaries.begin(), boundaries.end(), t);
+    return range_hash_bucket{
+        it == boundaries.begin() ? ring_start : std::prev(it)->raw(),
+        it == boundaries.end() ? ring_end : it->raw(),
+        0,
+    };
+}
+
+// Start of the range as the raw value before its first token.
+static int64_t start_of(const dht::token_range& range) {
+    if (!range.start() || range.start()->value().is_minimum()) {
+        return ring_start;
+    }
+    if (range.start()->value().is_maximum()) {
+        return ring_end;
+    }
+    auto raw = range.start()->value().raw();
+    return range.start()->is_inclusive() && raw != ring_start ? raw - 1 : raw;
+}
+
+// End of the range as the raw value of its last token.
+static int64_t end_of(const dht::token_range& range) {
+    if (!range.end() || range.end()->value().is_maximum()) {
+        return ring_end;
+    }
+    if (range.end()->value().is_minimum()) {
+        return ring_start;
+    }
+    auto raw = range.end()->value().raw();
+    return range.end()->is_inclusive() || raw == ring_start ? raw : raw - 1;
+}
+
+// Identifies the column by name rather than by id, which changes when
+// columns are added or dropped, so that replicas which wrote the same data
+// under different schema versions produce the same hashes.
+static void feed_column(xx_hasher& h, const column_definition& col) {
+    feed_hash(h, col.name());
+    feed_hash(h, static_cast<uint8_t>(col.kind));
+}
+
+range_hashes_builder::range_hashes_builder(const schema& s, lw_shared_ptr<const std::vector<dht::token>> boundaries)
+    : _schema(s)
+    , _boundaries(boundaries ? std::move(boundaries) : make_lw_shared<const std::vector<dht::token>>())
+{
+    _hashes.version = range_hashes_version;
+}
+
+void range_hashes_builder::add(uint64_t hash) {
+    _sum += hash;
+    _empty = false;
+}
+
+void range_hashes_builder::consume_new_partition(const dht::decorated_key& dk) {
+    if (!_started || dk.token().raw() > _bucket.end) {
+        if (!_empty) {
+            _bucket.hash = _sum;
+            _hashes.buckets.elements.push_back(_bucket);
+        }
+        _bucket = bucket_of(dk.token(), *_boundaries);
+        _started = true;
+        _sum = 0;
+        _empty = true;
+    }
+    xx_hasher h;
+    feed_hash(h, dk.key(), _schema);
+    _key_hash = h.finalize_uint64();
+}
+
+void range_hashes_builder::consume(tombstone t) {
+    if (!t) {
+        return;
+    }
+    xx_hasher h;
+    feed_hash(h, _key_hash);
+    feed_hash(h, t);
+    add(h.finalize_uint64());
+}
+
+void range_hashes_builder::consume(const static_row& sr) {
+    // The writer passes an empty static row if the partition has none.
+    if (sr.empty()) {
+        return;
+    }
+    xx_hasher h;
+    feed_hash(h, _key_hash);
+    sr.cells().for_each_cell([&] (column_id id, const atomic_cell_or_collection& cell) {
+        auto&& col = _schema.static_column_at(id);
+        feed_column(h, col);
+        feed_hash(h, cell, col);
+    });
+    add(h.finalize_uint64());
+}
+
+void range_hashes_builder::consume(const clustering_row& cr) {
+    xx_hasher h;
+    feed_hash(h, _key_hash);
+    feed_hash(h, cr.key(), _schema);
+    feed_hash(h, cr.tomb());
+    feed_hash(h, cr.marker());
+    cr.cells().for_each_cell([&] (column_id id, const atomic_cell_or_collection& cell) {
+        auto&& col = _schema.regular_column_at(id);
+        feed_column(h, col);
+        feed_hash(h, cell, col);
+    });
+    add(h.finalize_uint64());
+}
+
+void range_hashes_builder::consume(const range_tombstone& rt) {
+    xx_hasher h;
+    feed_hash(h, _key_hash);
+    feed_hash(h, rt.start, _schema);
+    feed_hash(h, rt.start_kind);
+    feed_hash(h, rt.tomb);
+    feed_hash(h, rt.end, _schema);
+    feed_hash(h, rt.end_kind);
+    add(h.finalize_uint64());
+}
+
+range_hashes range_hashes_builder::build() && {
+    if (!_empty) {
+        _bucket.hash = _sum;
+        _hashes.buckets.elements.push_back(_bucket);
+    }
+    return std::move(_hashes);
+}
+
+std::optional<uint64_t> sum_range_hashes(const range_hashes& hashes, const dht::token_range& range) {
+    if (hashes.version != range_hashes_version || range.is_wrap_around(dht::token_comparator())) {
+        return std::nullopt;
+    }
+    auto start = start_of(range);
+    auto end = end_of(range);
+    auto& buckets = hashes.buckets.elements;
+    // The first bucket which ends after the start of the range.
+    auto it = std::upper_bound(buckets.begin(), buckets.end(), start, [] (int64_t start, const range_hash_bucket& b) {
+        return start < b.end;
+    });
+    uint64_t sum = 0;
+    for (; it != buckets.end() && it->start < end; ++it) {
+        if (it->start < start || it->end > end) {
+            return std::nullopt;
+        }
+        sum += it->hash;
+    }
+    return sum;
+}
+
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include "sstables/types.hh"
+#include "dht/token.hh"
+#include "mutation_fragment.hh"
+
+namespace sstables {
+
+// Version of the RangeHashes component written by this version. Hashes of
+// different versions can't be combined.
+constexpr uint8_t range_hashes_version = 1;
+
+// Accumulates the RangeHashes component of an sstable from the fragments
+// written to it, which must come in ring order.
+//
+// Buckets are the token ranges of the ring, (t[i-1], t[i]] for the sorted
+// tokens t of the nodes, so that the hash of a range owned by a set of
+// replicas is made of whole buckets. Without tokens, e.g. before the node
+// joined the ring, a single bucket covers the whole ring.
+//
+// Each clustering row, static row, range tombstone and partition tombstone is
+// hashed along with its partition key, and the hash is added to the bucket of
+// the partition's token. Addition (unlike xor) keeps duplicates of a row in
+// different sstables from cancelling out, so the sums over all sstables of
+// two replicas are equal only if they hold the same rows.
+class range_hashes_builder {
+    const schema& _schema;
+    lw_shared_ptr<const std::vector<dht::token>> _boundaries;
+    range_hashes _hashes;
+    range_hash_bucket _bucket{};
+    bool _started = false;
+    uint64_t _sum = 0;
+    bool _empty = true;
+    uint64_t _key_hash = 0;
+private:
+    void add(uint64_t hash);
+public:
+    // The boundaries are the sorted tokens of the ring, may be null.
+    range_hashes_builder(const schema& s, lw_shared_ptr<const std::vector<dht::token>> boundaries);
+
+    void consume_new_partition(const dht::decorated_key& dk);
+    void consume(tombstone t);
+    void consume(const static_row& sr);
+    void consume(const clustering_row& cr);
+    void consume(const range_tombstone& rt);
+
+    range_hashes build() &&;
+};
+
+// Returns the sum of the buckets contained in the range, which accounts for
+// exactly the rows in the range.
+// Returns a disengaged optional if a non-empty bucket is only partially
+// contained in the range, e.g. because the ring changed since the sstable was
+// written, if the range wraps around, or if the hashes have a different version than range_hashes_version,
+// so can't be combined with the hashes of other sstables.
+std::optional<uint64_t> sum_range_hashes(const range_hashes& hashes, const dht::token_range& range);
+
+}
@@ -72,6 +72,8 @@
 #include "db/config.hh"
 #include "sstables/random_access_reader.hh"
 #include "sstables/sstables_manager.hh"
+#include "sstables/partition_index_cache.hh"
+#include "sstables/range_hashes.hh"
 #include "utils/UUID_gen.hh"
 #include "database.hh"
 #include "sstables_manager.hh"
@@ -846,6 +848,30 @@ void write(sstable_version_types v, file_writer& out, const compression& c) {
     }
 }
 
+future<> parse(const schema& s, sstable_version_types v, random_access_reader& in, filter& f) {
+    return parse(s, v, in, f.hashes).then([v, &s, &in, &f] {
+        if (!f.is_split_block()) {
+            return parse(s, v, in, f.buckets);
+        }
+        return parse(s, v, in, f.version).then([v, &s, &in, &f] {
+            if (f.version != filter::split_block_version) {
+                throw malformed_sstable_exception(format("Unsupported split block filter version {}", f.version));
+            }
+            return parse(s, v, in, f.buckets);
+        });
+    });
+}
+
+template <typename Filter>
+requires std::same_as<Filter, filter> || std::same_as<Filter, filter_ref>
+void write(sstable_version_types v, file_writer& out, const Filter& f) {
+    write(v, out, f.hashes);
+    if (f.is_split_block()) {
+        write(v, out, f.version);
+    }
+    write(v, out, f.buckets);
+}
+
 // This is small enough, and well-defined. Easier to just read it all
 // at once
 future<> sstable::read_toc() noexcept {
@@ -917,6 +943,9 @@ void sstable::generate_toc(compressor_ptr c, double filter_fp_chance) {
         _recognized_components.insert(component_type::CRC);
     } else {
         _recognized_components.insert(component_type::CompressionInfo);
+        if (!_components->compression.dictionary().empty()) {
+            _recognized_components.insert(component_type::CompressionDictionary);
+        }
     }
     _recognized_components.insert(component_type::Scylla);
 }
@@ -1136,7 +1165,26 @@ future<> sstable::read_compression(const io_priority_class& pc) {
         return make_ready_future<>();
     }
 
-    return read_simple<component_type::CompressionInfo>(_components->compression, pc);
+    return read_simple<component_type::CompressionInfo>(_components->compression, pc).then([this, &pc] {
+        auto crc = _components->compression.dictionary_checksum();
+        if (!crc) {
+            return make_ready_future<>();
+        }
+        if (!has_component(component_type::CompressionDictionary)) {
+            throw malformed_sstable_exception("CompressionInfo refers to a dictionary, but there is no CompressionDictionary component",
+                    filename(component_type::CompressionInfo));
+        }
+        return do_with(compression_dictionary{}, [this, &pc, crc = *crc] (compression_dictionary& dict) {
+            return read_simple<component_type::CompressionDictionary>(dict, pc).then([this, &dict, crc] {
+                auto& data = dict.data.value;
+                if (crc32_utils::checksum(reinterpret_cast<const char*>(data.data()), data.size()) != crc) {
+                    throw malformed_sstable_exception("Checksum mismatch of the compression dictionary",
+                            filename(component_type::CompressionDictionary));
+                }
+                _components->compression.set_dictionary(std::move(data));
+            });
+        });
+    });
 }
 
 void sstable::write_compression(const io_priority_class& pc) {
@@ -1145,6 +1193,9 @@ void sstable::write_compression(const io_priority_class& pc) {
     }
 
     write_simple<component_type::CompressionInfo>(_components->compression, pc);
+    if (has_component(component_type::CompressionDictionary)) {
+        write_simple<component_type::CompressionDictionary>(compression_dictionary{{_components->compression.dictionary()}}, pc);
+    }
 }
 
 void sstable::validate_partitioner() {
@@ -1395,6 +1446,10 @@ future<> sstable::read_filter(const io_priority_class& pc) {
     return seastar::async([this, &pc] () mutable {
         sstables::filter filter;
         read_simple<component_type::Filter>(filter, pc).get();
+        if (filter.is_split_block()) {
+            _components->filter = utils::filter::create_split_block_filter(std::move(filter.buckets.elements));
+            return;
+        }
         auto nr_bits = filter.buckets.elements.size() * std::numeric_limits<typename decltype(filter.buckets.elements)::value_type>::digits;
         large_bitset bs(nr_bits, std::move(filter.buckets.elements));
         utils::filter_format format = (_version >= sstable_version_types::mc)
@@ -1409,6 +1464,11 @@ void sstable::write_filter(const io_priority_class& pc) {
         return;
     }
 
+    if (auto f = dynamic_cast<utils::filter::split_block_bloom_filter*>(_components->filter.get())) {
+        write_simple<component_type::Filter>(sstables::filter_ref::split_block(f->words()), pc);
+        return;
+    }
+
     auto f = static_cast<utils::filter::murmur3_bloom_filter *>(_components->filter.get());
 
     auto&& bs = f->bits();
@@ -1631,6 +1691,27 @@ sstable::write_scylla_metadata(const io_priority_class& pc, shard_id shard, ssta
     write_simple<component_type::Scylla>(*_components->scylla_metadata, pc);
 }
 
+void sstable::write_range_hashes(const io_priority_class& pc, const range_hashes& hashes) {
+    write_simple<component_type::RangeHashes>(hashes, pc);
+}
+
+future<std::optional<uint64_t>> sstable::get_range_hash(const dht::token_range& range, const io_priority_class& pc) {
+    if (_range_hashes) {
+        return make_ready_future<std::optional<uint64_t>>(sum_range_hashes(*_range_hashes, range));
+    }
+    if (!has_component(component_type::RangeHashes)) {
+        return make_ready_future<std::optional<uint64_t>>();
+    }
+    auto hashes = make_lw_shared<range_hashes>();
+    return read_simple<component_type::RangeHashes>(*hashes, pc).then([this, hashes, range] {
+        if (!_range_hashes) {
+            _range_hashes = hashes;
+            _manager._range_hashes_memory += range_hashes_memory_size();
+        }
+        return sum_range_hashes(*_range_hashes, range);
+    });
+}
+
 bool sstable::may_contain_rows(const query::clustering_row_ranges& ranges) const {
     if (_version < sstables::sstable_version_types::md) {
         return true;
@@ -2792,6 +2873,19 @@ future<> init_metrics() {
         sm::make_derive("index_page_blocks", [] { return shared_index_lists::shard_stats().blocks; },
             sm::description("Index page requests which needed to wait due to page not being loaded yet")),
 
+        sm::make_derive("partition_index_cache_hits", [] { return partition_index_cache::shard_stats().hits; },
+            sm::description("Partition index page requests which were served from the partition index cache")),
+        sm::make_derive("partition_index_cache_misses", [] { return partition_index_cache::shard_stats().misses; },
+            sm::description("Partition index page requests which missed in the partition index cache")),
+        sm::make_derive("partition_index_cache_populations", [] { return partition_index_cache::shard_stats().populations; },
+            sm::description("Total number of partition index pages which were inserted into the partition index cache")),
+        sm::make_derive("partition_index_cache_evictions", [] { return partition_index_cache::shard_stats().evictions; },
+            sm::description("Total number of partition index pages which were evicted from the partition index cache")),
+        sm::make_gauge("partition_index_cache_bytes", [] { return partition_index_cache::shard_stats().used_bytes; },
+            sm::description("Total number of bytes used by the partition index cache")),
+        sm::make_gauge("partition_index_cache_pages", [] { return partition_index_cache::shard_stats().pages; },
+            sm::description("Number of partition index pages currently cached")),
+
         sm::make_derive("index_page_cache_hits", [] { return index_page_cache_metrics.page_hits; },
             sm::description("Index page cache requests which were served from cache")),
         sm::make_derive("index_page_cache_misses", [] { return index_page_cache_metrics.page_misses; },
@@ -2901,11 +2995,16 @@ sstable::sstable(schema_ptr schema,
     , _write_error_handler(error_handler_gen(sstable_write_error))
     , _large_data_handler(large_data_handler)
     , _manager(manager)
+    , _index_cache(std::make_unique<partition_index_cache>(manager.get_cache_tracker()))
 {
     tracker.add(*this);
     manager.add(this);
 }
 
+sstable::~sstable() {
+    _manager._range_hashes_memory -= range_hashes_memory_size();
+}
+
 void sstable::unused() {
     if (_active) {
         _active = false;
@@ -2942,6 +3041,8 @@ std::ostream& operator<<(std::ostream& out, const sstables::component_type& comp
     case ct::TemporaryTOC: out << "TemporaryTOC"; break;
     case ct::TemporaryStatistics: out << "TemporaryStatistics"; break;
     case ct::Scylla: out << "Scylla"; break;
+    case ct::CompressionDictionary: out << "CompressionDictionary"; break;
+    case ct::RangeHashes: out << "RangeHashes"; break;
     case ct::Unknown: out << "Unknown"; break;
     }
     return out;
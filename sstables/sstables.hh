@@ -102,6 +102,7 @@ class data_consume_context;
 
 class index_reader;
 class sstables_manager;
+class partition_index_cache;
 
 extern bool use_binary_search_in_promoted_index;
 
@@ -120,6 +121,10 @@ struct sstable_writer_config {
     bool correctly_serialize_static_compact_in_mc;
     utils::UUID run_identifier = utils::make_random_uuid();
     size_t summary_byte_cost;
+    // Dictionary to compress Data.db with, used only if the table's compressor supports dictionaries.
+    lw_shared_ptr<const bytes> compression_dictionary;
+    // Sorted tokens of the ring, which delimit the buckets of the RangeHashes component.
+    lw_shared_ptr<const std::vector<dht::token>> range_hash_boundaries;
 
 private:
     explicit sstable_writer_config() {}
@@ -147,6 +152,7 @@ class sstable : public enable_lw_shared_from_this<sstable> {
             gc_clock::time_point now,
             io_error_handler_gen error_handler_gen,
             size_t buffer_size);
+    ~sstable();
     sstable& operator=(const sstable&) = delete;
     sstable(const sstable&) = delete;
     sstable(sstable&&) = delete;
@@ -316,6 +322,20 @@ class sstable : public enable_lw_shared_from_this<sstable> {
     // Returns true iff this sstable contains data which belongs to many shards.
     bool is_shared() const;
 
+    // Returns the combined hash of the rows in the token range, see
+    // sum_range_hashes(). Rows are hashed the same way in every sstable, so the
+    // hashes of the sstables of a replica can be added up and compared with
+    // another replica's.
+    // Returns a disengaged optional if the sstable has no RangeHashes component,
+    // or its buckets don't line up with the range.
+    //
+    // The component is kept in memory once loaded, see range_hashes_memory_size().
+    future<std::optional<uint64_t>> get_range_hash(const dht::token_range& range, const io_priority_class& pc);
+
+    uint64_t range_hashes_memory_size() const {
+        return _range_hashes ? sizeof(range_hashes) + _range_hashes->buckets.elements.memory_size() : 0;
+    }
+
     // Returns uncompressed size of data component.
     uint64_t data_size() const;
     // Returns on-disk size of data component.
@@ -539,6 +559,8 @@ class sstable : public enable_lw_shared_from_this<sstable> {
 
     db::large_data_handler& _large_data_handler;
     sstables_manager& _manager;
+    // Partition index pages cached across reads, evicted by the row cache's tracker.
+    std::unique_ptr<partition_index_cache> _index_cache;
 
     sstables_stats _stats;
     tracker_link_type _tracker_link;
@@ -550,11 +572,15 @@ class sstable : public enable_lw_shared_from_this<sstable> {
     // It can be disengaged normally when loading legacy sstables that do not have this
     // information in their scylla metadata.
     std::optional<scylla_metadata::large_data_stats> _large_data_stats;
+
+    // Loaded on first use by get_range_hash().
+    lw_shared_ptr<const range_hashes> _range_hashes;
 public:
     const bool has_component(component_type f) const;
     sstables_manager& manager() { return _manager; }
     const sstables_manager& manager() const { return _manager; }
 private:
+    partition_index_cache& get_index_cache() { return *_index_cache; }
     void unused(); // Called when reference count drops to zero
     future<file> open_file(component_type, open_flags, file_open_options = {}) noexcept;
 
@@ -593,6 +619,8 @@ class sstable : public enable_lw_shared_from_this<sstable> {
 
     void write_filter(const io_priority_class& pc);
 
+    void write_range_hashes(const io_priority_class& pc, const range_hashes& hashes);
+
     future<> read_summary(const io_priority_class& pc) noexcept;
 
     void write_summary(const io_priority_class& pc) {
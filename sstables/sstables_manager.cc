@@ -25,14 +25,15 @@
 #include "db/config.hh"
 #include "gms/feature.hh"
 #include "gms/feature_service.hh"
+#include "locator/token_metadata.hh"
 
 namespace sstables {
 
 logging::logger smlogger("sstables_manager");
 
 sstables_manager::sstables_manager(
-    db::large_data_handler& large_data_handler, const db::config& dbcfg, gms::feature_service& feat)
-    : _large_data_handler(large_data_handler), _db_config(dbcfg), _features(feat) {
+    db::large_data_handler& large_data_handler, const db::config& dbcfg, gms::feature_service& feat, cache_tracker& ct)
+    : _large_data_handler(large_data_handler), _db_config(dbcfg), _features(feat), _cache_tracker(ct) {
 }
 
 sstables_manager::~sstables_manager() {
@@ -63,6 +64,15 @@ sstable_writer_config sstables_manager::configure_writer() const {
     cfg.correctly_serialize_static_compact_in_mc =
             bool(_features.cluster_supports_correct_static_compact_in_mc());
 
+    if (_token_metadata) {
+        auto tm = _token_metadata->get();
+        if (!_range_hash_boundaries || _range_hash_boundaries_ring_version != tm->get_ring_version()) {
+            _range_hash_boundaries = make_lw_shared<const std::vector<dht::token>>(tm->sorted_tokens());
+            _range_hash_boundaries_ring_version = tm->get_ring_version();
+        }
+        cfg.range_hash_boundaries = _range_hash_boundaries;
+    }
+
     return cfg;
 }
 
@@ -45,6 +45,10 @@ class config;
 
 namespace gms { class feature_service; }
 
+namespace locator { class shared_token_metadata; }
+
+class cache_tracker;
+
 namespace sstables {
 
 using schema_ptr = lw_shared_ptr<const schema>;
@@ -60,6 +64,7 @@ class sstables_manager {
     db::large_data_handler& _large_data_handler;
     const db::config& _db_config;
     gms::feature_service& _features;
+    cache_tracker& _cache_tracker;
     // _sstables_format is the format used for writing new sstables.
     // Here we set its default value, but if we discover that all the nodes
     // in the cluster support a newer format, _sstables_format will be set to
@@ -67,13 +72,20 @@ class sstables_manager {
     // if an sstable format was chosen earlier (and this choice was persisted
     // in the system table).
     sstable_version_types _format = sstable_version_types::mc;
+    // Null if the manager isn't used by a node of a ring, e.g. in tools and tests.
+    const locator::shared_token_metadata* _token_metadata = nullptr;
+    // Copy of the sorted tokens of the ring, refreshed when the ring changes.
+    mutable lw_shared_ptr<const std::vector<dht::token>> _range_hash_boundaries;
+    mutable long _range_hash_boundaries_ring_version = -1;
+    // Memory used by the range hashes loaded by the sstables, see sstable::get_range_hash().
+    uint64_t _range_hashes_memory = 0;
 
     list_type _active;
     list_type _undergoing_close;
     bool _closing = false;
     promise<> _done;
 public:
-    explicit sstables_manager(db::large_data_handler& large_data_handler, const db::config& dbcfg, gms::feature_service& feat);
+    explicit sstables_manager(db::large_data_handler& large_data_handler, const db::config& dbcfg, gms::feature_service& feat, cache_tracker&);
     ~sstables_manager();
 
     // Constructs a shared sstable
@@ -88,8 +100,11 @@ class sstables_manager {
 
     sstable_writer_config configure_writer() const;
     const db::config& config() const { return _db_config; }
+    cache_tracker& get_cache_tracker() { return _cache_tracker; }
 
     void set_format(sstable_version_types format) { _format = format; }
+    void set_token_metadata(const locator::shared_token_metadata& stm) { _token_metadata = &stm; }
+    uint64_t range_hashes_memory() const { return _range_hashes_memory; }
     sstables::sstable::version_types get_highest_supported_format() const { return _format; }
 
     // Wait until all sstables managed by this sstables_manager instance
@@ -32,6 +32,7 @@
 #include "db/commitlog/replay_position.hh"
 #include "version.hh"
 #include <vector>
+#include <limits>
 #include <unordered_map>
 #include <type_traits>
 #include "version.hh"
@@ -91,12 +92,21 @@ struct option {
     auto describe_type(sstable_version_types v, Describer f) { return f(key, value); }
 };
 
+// Filter.db comes in two variants:
+//  - classic: the number of hashes followed by the bitmap,
+//  - split block: split_block_marker in place of the number of hashes,
+//    followed by the version of the split block layout and the bitmap.
+// No classic filter uses that many hashes, so old sstables keep being read as before.
+// Parsed and written by hand, see parse() and write() in sstables.cc.
 struct filter {
+    static constexpr uint32_t split_block_marker = std::numeric_limits<uint32_t>::max();
+    static constexpr uint32_t split_block_version = 1;
+
     uint32_t hashes;
+    uint32_t version = 0; // Only present in split block filters
     disk_array<uint32_t, uint64_t> buckets;
 
-    template <typename Describer>
-    auto describe_type(sstable_version_types v, Describer f) { return f(hashes, buckets); }
+    bool is_split_block() const { return hashes == split_block_marker; }
 
     // Create an always positive filter if nothing else is specified.
     filter() : hashes(0), buckets({}) {}
@@ -106,11 +116,19 @@ struct filter {
 // Do this so we don't have to copy on write time. We can just keep a reference.
 struct filter_ref {
     uint32_t hashes;
+    uint32_t version = 0;
     disk_array_ref<uint32_t, uint64_t> buckets;
 
-    template <typename Describer>
-    auto describe_type(sstable_version_types v, Describer f) { return f(hashes, buckets); }
+    bool is_split_block() const { return hashes == filter::split_block_marker; }
+
     explicit filter_ref(int hashes, const utils::chunked_vector<uint64_t>& buckets) : hashes(hashes), buckets(buckets) {}
+
+    static filter_ref split_block(const utils::chunked_vector<uint64_t>& buckets) {
+        filter_ref f(0, buckets);
+        f.hashes = filter::split_block_marker;
+        f.version = filter::split_block_version;
+        return f;
+    }
 };
 
 enum class indexable_element {
@@ -583,6 +601,38 @@ struct checksum {
     auto describe_type(sstable_version_types v, Describer f) { return f(chunk_size, checksums); }
 };
 
+// Raw token values of the bounds of the token range (start, end] covered by
+// the bucket, and the sum of the hashes of the rows in it.
+struct range_hash_bucket {
+    int64_t start;
+    int64_t end;
+    uint64_t hash;
+
+    template <typename Describer>
+    auto describe_type(sstable_version_types v, Describer f) { return f(start, end, hash); }
+};
+
+// Contents of the RangeHashes component: each bucket is one of the token
+// ranges of the ring the sstable was written with, and holds the sum of the
+// hashes of the rows of Data.db whose token falls into it, see
+// range_hashes_builder. Only non-empty buckets are stored, in ring order.
+struct range_hashes {
+    uint8_t version;
+    disk_array<uint32_t, range_hash_bucket> buckets;
+
+    template <typename Describer>
+    auto describe_type(sstable_version_types v, Describer f) { return f(version, buckets); }
+};
+
+// Contents of the CompressionDictionary component: the dictionary which the
+// chunks of Data.db were compressed with, see compression::dictionary_option.
+struct compression_dictionary {
+    disk_string<uint32_t> data;
+
+    template <typename Describer>
+    auto describe_type(sstable_version_types v, Describer f) { return f(data); }
+};
+
 }
 
 namespace std {
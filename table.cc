@@ -356,6 +356,27 @@ void table::add_sstable(sstables::shared_sstable sstable) {
     // staging sstables or backlog tracker throws
     _sstables = std::move(new_sstables);
     update_stats_for_new_sstable(sstable->bytes_on_disk());
+    maybe_load_compression_dictionary(*sstable);
+}
+
+// Takes the dictionary of sstables loaded from disk until one is trained, so
+// that sstables written after a restart keep using the last trained one. The
+// loaded dictionary doesn't count as recently trained, so the next compaction
+// retrains it.
+void table::maybe_load_compression_dictionary(const sstables::sstable& sst) {
+    if (_compression_dictionary && !_compression_dictionary_loaded_generation) {
+        return;
+    }
+    auto& dictionary = sst.get_compression().dictionary();
+    // Sstables written with the loaded dictionary carry it too.
+    if (dictionary.empty() || (_compression_dictionary && *_compression_dictionary == dictionary)) {
+        return;
+    }
+    if (_compression_dictionary_loaded_generation && *_compression_dictionary_loaded_generation > sst.generation()) {
+        return;
+    }
+    _compression_dictionary = make_lw_shared<const bytes>(dictionary);
+    _compression_dictionary_loaded_generation = sst.generation();
 }
 
 future<>
@@ -369,11 +390,14 @@ table::add_sstable_and_update_cache(sstables::shared_sstable sst) {
 }
 
 future<>
-table::update_cache(lw_shared_ptr<memtable> m, sstables::shared_sstable sst) {
-    auto adder = row_cache::external_updater([this, m, sst] {
-        auto newtab_ms = sst->as_mutation_source();
-        add_sstable(sst);
-        m->mark_flushed(std::move(newtab_ms));
+table::update_cache(lw_shared_ptr<memtable> m, std::vector<sstables::shared_sstable> ssts) {
+    auto adder = row_cache::external_updater([this, m, ssts = std::move(ssts)] {
+        auto sources = boost::copy_range<std::vector<mutation_source>>(ssts
+                | boost::adaptors::transformed(std::mem_fn(&sstables::sstable::as_mutation_source)));
+        for (auto& sst : ssts) {
+            add_sstable(sst);
+        }
+        m->mark_flushed(sources.size() == 1 ? std::move(sources.front()) : make_combined_mutation_source(std::move(sources)));
         try_trigger_compaction();
     });
     if (cache_enabled()) {
@@ -385,12 +409,18 @@ table::update_cache(lw_shared_ptr<memtable> m, sstables::shared_sstable sst) {
 
 // Handles permit management only, used for situations where we don't want to inform
 // the compaction manager about backlogs (i.e., tests)
+//
+// The permit may be shared by the monitors of several sstables written together, it's
+// released once the data writes of all of them have completed.
 class permit_monitor : public sstables::write_monitor {
-    sstable_write_permit _permit;
+    lw_shared_ptr<sstable_write_permit> _permit;
 public:
-    permit_monitor(sstable_write_permit&& permit)
+    permit_monitor(lw_shared_ptr<sstable_write_permit> permit)
             : _permit(std::move(permit)) {
     }
+    permit_monitor(sstable_write_permit&& permit)
+            : permit_monitor(make_lw_shared<sstable_write_permit>(std::move(permit))) {
+    }
 
     virtual void on_write_started(const sstables::writer_offset_tracker& t) override { }
     virtual void on_data_write_completed() override {
@@ -398,7 +428,7 @@ class permit_monitor : public sstables::write_monitor {
         // we'll have a period without significant disk activity when the current
         // SSTable is being sealed, the caches are being updated, etc. To do that,
         // we ensure the permit doesn't outlive this continuation.
-        _permit = sstable_write_permit::unconditional();
+        _permit = {};
     }
 };
 
@@ -411,7 +441,7 @@ class database_sstable_write_monitor : public permit_monitor, public backlog_wri
     uint64_t _progress_seen = 0;
     api::timestamp_type _maximum_timestamp;
 public:
-    database_sstable_write_monitor(sstable_write_permit&& permit, sstables::shared_sstable sst, compaction_manager& manager,
+    database_sstable_write_monitor(lw_shared_ptr<sstable_write_permit> permit, sstables::shared_sstable sst, compaction_manager& manager,
                                    sstables::compaction_strategy& strategy, api::timestamp_type max_timestamp)
             : permit_monitor(std::move(permit))
             , _sst(std::move(sst))
@@ -512,56 +542,142 @@ table::seal_active_memtable(flush_permit&& permit) {
     // FIXME: provide back-pressure to upper layers
 }
 
+// A memtable is split into segments of at least this size when flushed.
+static constexpr uint64_t min_memtable_flush_segment_size = 16 << 20;
+
+// Splits the ring into the token ranges of the sstables the memtable is
+// flushed to, skipping ranges without partitions. Tokens are distributed
+// uniformly, so ranges of equal width get about equal shares of the memtable.
+// Never returns an empty vector, if no range has partitions the whole ring
+// is flushed to a single sstable.
+static dht::partition_range_vector memtable_flush_ranges(memtable& mt, uint32_t max_segments) {
+    uint64_t segments = std::clamp<uint64_t>(mt.occupancy().used_space() / min_memtable_flush_segment_size, 1, std::max<uint32_t>(max_segments, 1));
+    if (segments == 1) {
+        return {query::full_partition_range};
+    }
+    dht::partition_range_vector ranges;
+    const uint64_t width = std::numeric_limits<uint64_t>::max() / segments;
+    std::optional<dht::partition_range::bound> start;
+    for (uint64_t i = 1; i <= segments; ++i) {
+        std::optional<dht::partition_range::bound> end;
+        if (i < segments) {
+            auto t = dht::token::from_int64(int64_t(uint64_t(std::numeric_limits<int64_t>::min()) + i * width));
+            end = dht::partition_range::bound(dht::ring_position::starting_at(t), false);
+        }
+        auto range = dht::partition_range(start, end);
+        if (mt.has_partitions_in(range)) {
+            ranges.push_back(std::move(range));
+        }
+        if (end) {
+            start = dht::partition_range::bound(end->value(), true);
+        }
+    }
+    if (ranges.empty()) {
+        return {query::full_partition_range};
+    }
+    return ranges;
+}
+
 future<stop_iteration>
 table::try_flush_memtable_to_sstable(lw_shared_ptr<memtable> old, sstable_write_permit&& permit) {
-  return with_scheduling_group(_config.memtable_scheduling_group, [this, old = std::move(old), permit = std::move(permit)] () mutable {
-    auto newtab = make_sstable();
+    return with_scheduling_group(_config.memtable_scheduling_group, [this, old = std::move(old), permit = std::move(permit)] () mutable {
+        return flush_memtable_to_sstables(std::move(old), std::move(permit));
+    });
+}
 
-    tlogger.debug("Flushing to {}", newtab->get_filename());
-    // Note that due to our sharded architecture, it is possible that
-    // in the face of a value change some shards will backup sstables
-    // while others won't.
-    //
-    // This is, in theory, possible to mitigate through a rwlock.
-    // However, this doesn't differ from the situation where all tables
-    // are coming from a single shard and the toggle happens in the
-    // middle of them.
-    //
-    // The code as is guarantees that we'll never partially backup a
-    // single sstable, so that is enough of a guarantee.
-    database_sstable_write_monitor monitor(std::move(permit), newtab, _compaction_manager, _compaction_strategy, old->get_max_timestamp());
-    return do_with(std::move(monitor), [this, old, newtab] (auto& monitor) {
+// Called in the memtable scheduling group.
+future<stop_iteration>
+table::flush_memtable_to_sstables(lw_shared_ptr<memtable> old, sstable_write_permit permit) {
+    struct segment {
+        dht::partition_range range;
+        sstables::shared_sstable sst;
+        database_sstable_write_monitor monitor;
+        sstables::sstable_writer_config cfg;
+    };
+    auto start_time = std::chrono::steady_clock::now();
+    auto flushed_bytes = old->occupancy().used_space();
+    std::vector<std::unique_ptr<segment>> segments;
+    std::exception_ptr ex;
+    try {
+        auto ranges = memtable_flush_ranges(*old, _config.memtable_flush_segments());
+        // The segments of a large memtable are written concurrently, as a
+        // single run, so that the serialization of some overlaps the I/O of
+        // others.
+        auto run_id = utils::make_random_uuid();
+        // Tokens are uniform, so allow each segment twice its share of the
+        // partitions to keep the false positive rate of the filters in check.
+        auto estimated_partitions = std::min<uint64_t>(old->partition_count(), 2 * old->partition_count() / ranges.size() + 1);
+        // The segments can differ in size a lot, the permit is held until the
+        // data writes of all of them have completed, so that the next flush
+        // doesn't start writing while this one still does.
+        auto shared_permit = make_lw_shared<sstable_write_permit>(std::move(permit));
+        segments.reserve(ranges.size());
+        for (auto& range : ranges) {
+            auto newtab = make_sstable();
+            tlogger.debug("Flushing to {}", newtab->get_filename());
+            // Note that due to our sharded architecture, it is possible that
+            // in the face of a value change some shards will backup sstables
+            // while others won't.
+            //
+            // This is, in theory, possible to mitigate through a rwlock.
+            // However, this doesn't differ from the situation where all tables
+            // are coming from a single shard and the toggle happens in the
+            // middle of them.
+            //
+            // The code as is guarantees that we'll never partially backup a
+            // single sstable, so that is enough of a guarantee.
+            sstables::sstable_writer_config cfg = get_sstables_manager().configure_writer();
+            cfg.backup = incremental_backups_enabled();
+            cfg.compression_dictionary = _compression_dictionary;
+            cfg.run_identifier = run_id;
+            segments.push_back(std::make_unique<segment>(segment{std::move(range), newtab,
+                    database_sstable_write_monitor(shared_permit, newtab, _compaction_manager, _compaction_strategy, old->get_max_timestamp()),
+                    std::move(cfg)}));
+        }
+        shared_permit = {};
         auto&& priority = service::get_local_memtable_flush_priority();
-        sstables::sstable_writer_config cfg = get_sstables_manager().configure_writer();
-        cfg.backup = incremental_backups_enabled();
-        auto f = write_memtable_to_sstable(*old, newtab, monitor, cfg, priority);
+        co_await parallel_for_each(segments, [&] (std::unique_ptr<segment>& s) {
+            return write_memtable_to_sstable(*old, s->sst, s->monitor, s->cfg, priority, s->range, estimated_partitions);
+        });
         // Switch back to default scheduling group for post-flush actions, to avoid them being staved by the memtable flush
         // controller. Cache update does not affect the input of the memtable cpu controller, so it can be subject to
         // priority inversion.
-        return with_scheduling_group(default_scheduling_group(), [this, old = std::move(old), newtab = std::move(newtab), f = std::move(f)] () mutable {
-            return f.then([this, newtab, old] {
-                return newtab->open_data().then([this, old, newtab] () {
-                    tlogger.debug("Flushing to {} done", newtab->get_filename());
-                    return with_scheduling_group(_config.memtable_to_cache_scheduling_group, [this, old, newtab] {
-                        return update_cache(old, newtab);
-                    });
-                }).then([this, old, newtab] () noexcept {
-                    _memtables->erase(old);
-                    tlogger.debug("Memtable for {} replaced", newtab->get_filename());
-                    return stop_iteration::yes;
+        co_await with_scheduling_group(default_scheduling_group(), [&] {
+            return parallel_for_each(segments, [] (std::unique_ptr<segment>& s) {
+                return s->sst->open_data().then([&s] {
+                    tlogger.debug("Flushing to {} done", s->sst->get_filename());
+                });
+            }).then([&] {
+                return with_scheduling_group(_config.memtable_to_cache_scheduling_group, [&] {
+                    return update_cache(old, boost::copy_range<std::vector<sstables::shared_sstable>>(segments
+                            | boost::adaptors::transformed([] (const std::unique_ptr<segment>& s) { return s->sst; })));
                 });
-            }).handle_exception([this, old, newtab] (auto e) {
-                newtab->mark_for_deletion();
-                _config.cf_stats->failed_memtables_flushes_count++;
-                tlogger.error("failed to write sstable {}: {}", newtab->get_filename(), e);
-                // If we failed this write we will try the write again and that will create a new flush reader
-                // that will decrease dirty memory again. So we need to reset the accounting.
-                old->revert_flushed_memory();
-                return stop_iteration(_async_gate.is_closed());
             });
         });
-    });
-  });
+    } catch (...) {
+        ex = std::current_exception();
+    }
+    if (ex) {
+        for (auto& s : segments) {
+            s->sst->mark_for_deletion();
+        }
+        _config.cf_stats->failed_memtables_flushes_count++;
+        tlogger.error("failed to write sstable {}: {}", ::join(", ", segments
+                | boost::adaptors::transformed([] (const std::unique_ptr<segment>& s) { return s->sst->get_filename(); })), ex);
+        // If we failed this write we will try the write again and that will create a new flush reader
+        // that will decrease dirty memory again. So we need to reset the accounting.
+        old->revert_flushed_memory();
+        co_return stop_iteration(_async_gate.is_closed());
+    }
+    _memtables->erase(old);
+    tlogger.debug("Memtable for {} replaced", ::join(", ", segments
+            | boost::adaptors::transformed([] (const std::unique_ptr<segment>& s) { return s->sst->get_filename(); })));
+    _config.cf_stats->memtables_flushed_count++;
+    _config.cf_stats->memtables_flushed_bytes += flushed_bytes;
+    _config.cf_stats->memtables_flushed_sstables += segments.size();
+    _config.cf_stats->memtables_flush_time_ms += std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start_time).count();
+    co_return stop_iteration::yes;
 }
 
 void
@@ -577,6 +693,8 @@ table::stop() {
     }
     return _async_gate.close().then([this] {
         return await_pending_ops().finally([this] {
+            return _view_update_read_batcher.stop();
+        }).finally([this] {
             return _memtables->request_flush().finally([this] {
                 return _compaction_manager.remove(this).then([this] {
                     return _sstable_deletion_gate.close().then([this] {
@@ -905,6 +1023,40 @@ future<std::unordered_set<sstring>> table::get_sstables_by_partition_key(const s
     });
 }
 
+future<std::optional<uint64_t>> table::get_range_hash(const dht::token_range& range, const io_priority_class& pc) const {
+    auto pr = dht::to_partition_range(range);
+    // Sstables and memtables have to be checked atomically, data could move
+    // from a memtable to a new sstable otherwise.
+    for (auto&& mt : *_memtables) {
+        if (mt->has_partitions_in(pr)) {
+            return make_ready_future<std::optional<uint64_t>>();
+        }
+    }
+    auto sstables = get_sstable_set().select(pr);
+    for (auto& sst : sstables) {
+        if (sst->is_shared()) {
+            return make_ready_future<std::optional<uint64_t>>();
+        }
+    }
+    return do_with(std::move(sstables), std::optional<uint64_t>(0), dht::token_range(range),
+            [&pc] (std::vector<sstables::shared_sstable>& sstables, std::optional<uint64_t>& sum, const dht::token_range& range) {
+        return do_for_each(sstables, [&range, &pc, &sum] (const sstables::shared_sstable& sst) {
+            if (!sum) {
+                return make_ready_future<>();
+            }
+            return sst->get_range_hash(range, pc).then([&sum] (std::optional<uint64_t> hash) {
+                if (hash) {
+                    *sum += *hash;
+                } else {
+                    sum = std::nullopt;
+                }
+            });
+        }).then([&sum] {
+            return sum;
+        });
+    });
+}
+
 const sstables::sstable_set& table::get_sstable_set() const {
     return *_sstables;
 }
@@ -979,6 +1131,7 @@ table::table(schema_ptr schema, config config, db::commitlog* cl, compaction_man
     , _index_manager(*this)
     , _counter_cell_locks(_schema->is_counter() ? std::make_unique<cell_locker>(_schema, cl_stats) : nullptr)
     , _row_locker(_schema)
+    , _view_update_read_batcher(as_mutation_source(), _view_stats)
 {
     if (!_config.enable_disk_writes) {
         tlogger.warn("Writes disabled, column family no durable.");
@@ -1635,9 +1788,19 @@ write_memtable_to_sstable(memtable& mt, sstables::shared_sstable sst,
                           sstables::write_monitor& monitor,
                           sstables::sstable_writer_config& cfg,
                           const io_priority_class& pc) {
+    return write_memtable_to_sstable(mt, std::move(sst), monitor, cfg, pc, query::full_partition_range, mt.partition_count());
+}
+
+future<>
+write_memtable_to_sstable(memtable& mt, sstables::shared_sstable sst,
+                          sstables::write_monitor& monitor,
+                          sstables::sstable_writer_config& cfg,
+                          const io_priority_class& pc,
+                          const dht::partition_range& range,
+                          uint64_t estimated_partitions) {
     cfg.replay_position = mt.replay_position();
     cfg.monitor = &monitor;
-    return sst->write_components(mt.make_flush_reader(mt.schema(), pc), mt.partition_count(),
+    return sst->write_components(mt.make_flush_reader(mt.schema(), pc, range), estimated_partitions,
         mt.schema(), cfg, mt.get_encoding_stats(), pc);
 }
 
@@ -1862,7 +2025,8 @@ future<row_locker::lock_holder> table::push_view_replica_updates(const schema_pt
 }
 
 future<row_locker::lock_holder> table::do_push_view_replica_updates(const schema_ptr& s, mutation&& m, db::timeout_clock::time_point timeout, mutation_source&& source,
-        tracing::trace_state_ptr tr_state, reader_concurrency_semaphore& sem, const io_priority_class& io_priority, query::partition_slice::option_set custom_opts) const {
+        tracing::trace_state_ptr tr_state, reader_concurrency_semaphore& sem, const io_priority_class& io_priority, query::partition_slice::option_set custom_opts,
+        db::view::base_read_batcher* read_batcher) const {
     if (!_config.view_update_concurrency_semaphore->current()) {
         // We don't have resources to generate view updates for this write. If we reached this point, we failed to
         // throttle the client. The memory queue is already full, waiting on the semaphore would cause this node to
@@ -1910,7 +2074,22 @@ future<row_locker::lock_holder> table::do_push_view_replica_updates(const schema
     future<row_locker::lock_holder> lockf = local_base_lock(base, m.decorated_key(), slice.default_row_ranges(), timeout);
     return utils::get_local_injector().inject("table_push_view_replica_updates_timeout", timeout).then([lockf = std::move(lockf), timeout] () mutable {
         return std::move(lockf);
-    }).then([m = std::move(m), slice = std::move(slice), views = std::move(views), base, this, timeout, now, source = std::move(source), &sem, tr_state = std::move(tr_state), &io_priority] (row_locker::lock_holder lock) mutable {
+    }).then([m = std::move(m), slice = std::move(slice), views = std::move(views), base, this, timeout, now, source = std::move(source), &sem, tr_state = std::move(tr_state), &io_priority, read_batcher] (row_locker::lock_holder lock) mutable {
+      if (read_batcher) {
+        auto existing = read_batcher->read(base, m.decorated_key(), slice.default_row_ranges(), sem, timeout, tr_state);
+        return existing.then([m = std::move(m), views = std::move(views), base, this, now, &sem, tr_state = std::move(tr_state), lock = std::move(lock)] (mutation_opt existing) mutable {
+            auto permit = sem.make_permit(base.get(), "push-view-updates-2");
+            flat_mutation_reader_opt reader;
+            if (existing) {
+                reader = flat_mutation_reader_from_mutations(permit, {std::move(*existing)});
+            }
+            return this->generate_and_propagate_view_updates(base, std::move(permit), std::move(views), std::move(m), std::move(reader), tr_state, now)
+                    .then([base, tr_state = std::move(tr_state), lock = std::move(lock)] () mutable {
+                tracing::trace(tr_state, "View updates for {}.{} were generated and propagated", base->ks_name(), base->cf_name());
+                return std::move(lock);
+            });
+        });
+      }
       return do_with(
         dht::partition_range::make_singular(m.decorated_key()),
         std::move(slice),
@@ -1933,7 +2112,7 @@ future<row_locker::lock_holder> table::do_push_view_replica_updates(const schema
 future<row_locker::lock_holder> table::push_view_replica_updates(const schema_ptr& s, mutation&& m, db::timeout_clock::time_point timeout,
         tracing::trace_state_ptr tr_state, reader_concurrency_semaphore& sem) const {
     return do_push_view_replica_updates(s, std::move(m), timeout, as_mutation_source(),
-            std::move(tr_state), sem, service::get_local_sstable_query_read_priority(), {});
+            std::move(tr_state), sem, service::get_local_sstable_query_read_priority(), {}, &_view_update_read_batcher);
 }
 
 future<row_locker::lock_holder>
@@ -1947,7 +2126,8 @@ table::stream_view_replica_updates(const schema_ptr& s, mutation&& m, db::timeou
             tracing::trace_state_ptr(),
             *_config.streaming_read_concurrency_semaphore,
             service::get_local_streaming_priority(),
-            query::partition_slice::option_set::of<query::partition_slice::option::bypass_cache>());
+            query::partition_slice::option_set::of<query::partition_slice::option::bypass_cache>(),
+            nullptr);
 }
 
 mutation_source
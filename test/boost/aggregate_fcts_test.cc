@@ -242,6 +242,104 @@ SEASTAR_TEST_CASE(test_aggregate_count) {
     });
 }
 
+// count(*) only counts the accepted rows, without extracting their values.
+// Check that partitions without rows and filtering are still accounted for.
+SEASTAR_TEST_CASE(test_aggregate_count_rows) {
+    return do_with_cql_env_thread([&] (auto& e) {
+        e.execute_cql("CREATE TABLE test(p int, c int, s int static, v int, primary key (p, c))").get();
+        for (int p = 0; p < 10; ++p) {
+            for (int c = 0; c < 7; ++c) {
+                e.execute_cql(format("INSERT INTO test(p, c, s, v) VALUES ({}, {}, {}, {})", p, c, p, c)).get();
+            }
+        }
+        // Partitions with only a static row count as one row.
+        e.execute_cql("INSERT INTO test(p, s) VALUES (10, 10)").get();
+        e.execute_cql("INSERT INTO test(p, s) VALUES (11, 11)").get();
+
+        auto count = [] (int64_t n) {
+            return std::vector<bytes_opt>{long_type->decompose(n)};
+        };
+        {
+            auto msg = e.execute_cql("SELECT count(*) FROM test").get0();
+            assert_that(msg).is_rows().with_rows({count(72)});
+        }
+        {
+            auto msg = e.execute_cql("SELECT count(*), count(*) FROM test").get0();
+            assert_that(msg).is_rows().with_size(1).with_row({long_type->decompose(int64_t(72)), long_type->decompose(int64_t(72))});
+        }
+        {
+            auto msg = e.execute_cql("SELECT count(*) FROM test WHERE p = 3").get0();
+            assert_that(msg).is_rows().with_rows({count(7)});
+        }
+        {
+            auto msg = e.execute_cql("SELECT count(*) FROM test WHERE p = 10").get0();
+            assert_that(msg).is_rows().with_rows({count(1)});
+        }
+        {
+            auto msg = e.execute_cql("SELECT count(*) FROM test WHERE p = 12").get0();
+            assert_that(msg).is_rows().with_rows({count(0)});
+        }
+        {
+            auto msg = e.execute_cql("SELECT count(*) FROM test WHERE v = 3 ALLOW FILTERING").get0();
+            assert_that(msg).is_rows().with_rows({count(10)});
+        }
+        {
+            auto msg = e.execute_cql("SELECT count(*) FROM test WHERE p = 3 AND c > 1 AND c < 5").get0();
+            assert_that(msg).is_rows().with_rows({count(3)});
+        }
+        {
+            // Mixed with an aggregate of values, rows go through the regular path.
+            auto msg = e.execute_cql("SELECT count(*), sum(v) FROM test WHERE p = 3").get0();
+            assert_that(msg).is_rows().with_size(1).with_row({long_type->decompose(int64_t(7)), int32_type->decompose(int32_t(21))});
+        }
+        {
+            auto msg = e.execute_cql("SELECT count(*) FROM test WHERE p IN (3, 10) GROUP BY p").get0();
+            assert_that(msg).is_rows().with_rows_ignore_order({count(7), count(1)});
+        }
+    });
+}
+
+SEASTAR_TEST_CASE(test_aggregate_negative_numbers) {
+    return do_with_cql_env_thread([&] (auto& e) {
+        e.execute_cql("CREATE TABLE test(p int primary key, a tinyint, b smallint, c int, d bigint, e float, f double)").get();
+        e.execute_cql("INSERT INTO test(p, a, b, c, d, e, f) VALUES (1, -100, -30000, -2000000000, -9000000000000000000, -1.5, -2.5)").get();
+        e.execute_cql("INSERT INTO test(p, a, b, c, d, e, f) VALUES (2, 90, 20000, 1000000000, 8000000000000000000, 0.5, 0.25)").get();
+        e.execute_cql("INSERT INTO test(p, c) VALUES (3, 3)").get();
+
+        {
+            auto msg = e.execute_cql("SELECT sum(a), sum(b), sum(c), sum(d), sum(e), sum(f) FROM test").get0();
+            assert_that(msg).is_rows().with_size(1).with_row({{byte_type->decompose(int8_t(-10))},
+                                                              {short_type->decompose(int16_t(-10000))},
+                                                              {int32_type->decompose(int32_t(-999999997))},
+                                                              {long_type->decompose(int64_t(-1000000000000000000))},
+                                                              {float_type->decompose(-1.f)},
+                                                              {double_type->decompose(-2.25)}});
+        }
+        {
+            auto msg = e.execute_cql("SELECT min(a), min(b), min(c), min(d), min(e), min(f) FROM test").get0();
+            assert_that(msg).is_rows().with_size(1).with_row({{byte_type->decompose(int8_t(-100))},
+                                                              {short_type->decompose(int16_t(-30000))},
+                                                              {int32_type->decompose(int32_t(-2000000000))},
+                                                              {long_type->decompose(int64_t(-9000000000000000000))},
+                                                              {float_type->decompose(-1.5f)},
+                                                              {double_type->decompose(-2.5)}});
+        }
+        {
+            auto msg = e.execute_cql("SELECT max(a), max(b), max(c), max(d), max(e), max(f) FROM test").get0();
+            assert_that(msg).is_rows().with_size(1).with_row({{byte_type->decompose(int8_t(90))},
+                                                              {short_type->decompose(int16_t(20000))},
+                                                              {int32_type->decompose(int32_t(1000000000))},
+                                                              {long_type->decompose(int64_t(8000000000000000000))},
+                                                              {float_type->decompose(0.5f)},
+                                                              {double_type->decompose(0.25)}});
+        }
+        {
+            auto msg = e.execute_cql("SELECT avg(c) FROM test").get0();
+            assert_that(msg).is_rows().with_size(1).with_row({{int32_type->decompose(int32_t(-333333332))}});
+        }
+    });
+}
+
 SEASTAR_TEST_CASE(test_reverse_type_aggregation) {
     return do_with_cql_env_thread([&] (auto& e) {
         e.execute_cql("CREATE TABLE test(p int, c timestamp, v int, primary key (p, c)) with clustering order by (c desc)").get();
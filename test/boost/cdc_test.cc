@@ -27,6 +27,7 @@
 #include "cdc/cdc_extension.hh"
 #include "db/config.hh"
 #include "schema_builder.hh"
+#include "service/storage_proxy.hh"
 #include "test/lib/cql_assertions.hh"
 #include "test/lib/cql_test_env.hh"
 #include "test/lib/exception_utils.hh"
@@ -1973,3 +1974,43 @@ SEASTAR_THREAD_TEST_CASE(test_postimage_with_no_regular_columns) {
         BOOST_REQUIRE_EQUAL(expected, result);
     }).get();
 }
+
+// The preimage of every row of a batch must include the columns the row
+// touches, even if other rows of the partition touch different ones.
+SEASTAR_THREAD_TEST_CASE(test_batch_pre_image_of_rows_touching_different_columns) {
+    do_with_cql_env_thread([] (cql_test_env& e) {
+        using oper_ut = std::underlying_type_t<cdc::operation>;
+
+        cquery_nofail(e, "create table ks.t (pk int, ck int, v1 int, v2 int, primary key (pk, ck)) with cdc = {'enabled': true, 'preimage': true}");
+        cquery_nofail(e, "insert into ks.t (pk, ck, v1, v2) values (0, 1, 1, 2)");
+        cquery_nofail(e, "insert into ks.t (pk, ck, v1, v2) values (0, 2, 3, 4)");
+
+        auto& cdc_stats = service::get_local_storage_proxy().get_cdc_stats();
+        auto local_selects = cdc_stats.counters_total.preimage_selects_local;
+
+        cquery_nofail(e, "begin unlogged batch "
+                "update ks.t set v1 = 10 where pk = 0 and ck = 1; "
+                "update ks.t set v2 = 40 where pk = 0 and ck = 2; "
+                "apply batch");
+
+        // The test node is the only replica, so the preimage is read locally.
+        BOOST_REQUIRE_GT(cdc_stats.counters_total.preimage_selects_local, local_selects);
+
+        auto result = get_result(e,
+            {data_type_for<oper_ut>(), int32_type, int32_type, int32_type},
+            "select \"cdc$operation\", ck, v1, v2 from ks.t_scylla_cdc_log");
+        std::vector<std::vector<data_value>> pre_images;
+        for (auto& row : result) {
+            if (row[0] == data_value(oper_ut(cdc::operation::pre_image))) {
+                pre_images.push_back(row);
+            }
+        }
+
+        auto null = data_value::make_null(int32_type);
+        std::vector<std::vector<data_value>> expected = {
+            { oper_ut(cdc::operation::pre_image), int32_t(1), int32_t(1), null },
+            { oper_ut(cdc::operation::pre_image), int32_t(2), null, int32_t(4) },
+        };
+        BOOST_REQUIRE_EQUAL(expected, pre_images);
+    }).get();
+}
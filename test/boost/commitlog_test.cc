@@ -22,6 +22,7 @@
 
 #include <boost/test/unit_test.hpp>
 #include <boost/range/adaptor/map.hpp>
+#include <boost/range/irange.hpp>
 
 #include <stdlib.h>
 #include <iostream>
@@ -37,6 +38,7 @@
 #include <seastar/core/seastar.hh>
 #include <seastar/util/noncopyable_function.hh>
 #include "utils/UUID_gen.hh"
+#include "utils/estimated_histogram.hh"
 #include "test/lib/tmpdir.hh"
 #include "db/commitlog/commitlog.hh"
 #include "db/commitlog/commitlog_replayer.hh"
@@ -105,6 +107,52 @@ SEASTAR_TEST_CASE(test_commitlog_written_to_disk_batch){
         });
 }
 
+// check that O_DSYNC segments are synced without flushing the file
+SEASTAR_TEST_CASE(test_commitlog_written_to_disk_batch_dsync){
+    commitlog::config cfg;
+    cfg.mode = commitlog::sync_mode::BATCH;
+    cfg.use_o_dsync = true;
+    cfg.min_reserve_segments = 2;
+    return cl_test(cfg, [](commitlog& log) {
+            sstring tmp = "hej bubba cow";
+            return log.add_mutation(utils::UUID_gen::get_time_UUID(), tmp.size(), db::commitlog::force_sync::no, [tmp](db::commitlog::output& dst) {
+                        dst.write(tmp.data(), tmp.size());
+                    }).then([&log](replay_position rp) {
+                        BOOST_CHECK_NE(rp, db::replay_position());
+                        auto n = log.get_flush_count();
+                        BOOST_REQUIRE(n > 0);
+                        BOOST_REQUIRE_EQUAL(log.get_num_flushes_elided(), n);
+                    });
+        });
+}
+
+// check that concurrent writes in batch mode share a single group commit
+SEASTAR_TEST_CASE(test_commitlog_batch_group_commit){
+    commitlog::config cfg;
+    cfg.mode = commitlog::sync_mode::BATCH;
+    cfg.group_commit_window_in_us = 1000000;
+    return cl_test(cfg, [](commitlog& log) {
+            static constexpr int n = 10;
+            return parallel_for_each(boost::irange(0, n), [&log] (int) {
+                sstring tmp = "hej bubba cow";
+                return log.add_mutation(utils::UUID_gen::get_time_UUID(), tmp.size(), db::commitlog::force_sync::no, [tmp](db::commitlog::output& dst) {
+                            dst.write(tmp.data(), tmp.size());
+                        }).then([](replay_position rp) {
+                            BOOST_CHECK_NE(rp, db::replay_position());
+                        });
+            }).then([&log] {
+                auto flushes = log.get_flush_count();
+                BOOST_REQUIRE(flushes > 0);
+                BOOST_REQUIRE_LT(flushes, n);
+                // One window covered all of the writes. n is a bucket offset
+                // of the histogram, so its mean is exact.
+                auto& batch_size = log.get_group_commit_batch_size();
+                BOOST_REQUIRE_EQUAL(batch_size.count(), 1);
+                BOOST_REQUIRE_EQUAL(batch_size.mean(), n);
+            });
+        });
+}
+
 // check that an entry marked as sync is immediately flushed to a storage
 SEASTAR_TEST_CASE(test_commitlog_written_to_disk_sync){
     commitlog::config cfg;
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <seastar/testing/test_case.hh>
+#include <seastar/testing/thread_test_case.hh>
+#include <seastar/core/iostream.hh>
+#include <seastar/core/temporary_buffer.hh>
+#include <random>
+
+#include "transport/segment.hh"
+#include "exceptions/exceptions.hh"
+#include "utils/buffer_input_stream.hh"
+
+using namespace cql_transport;
+
+static void append(bytes& out, const temporary_buffer<char>& buf) {
+    out.append(reinterpret_cast<const int8_t*>(buf.get()), buf.size());
+}
+
+static bytes encode(const std::vector<bytes>& envelopes, bool compress) {
+    segment_encoder enc(compress);
+    for (auto& e : envelopes) {
+        // Split each envelope into two fragments, like a header and a body.
+        auto split = std::min<size_t>(e.size(), 9);
+        enc.append({bytes_view(e).substr(0, split), bytes_view(e).substr(split)});
+    }
+    enc.flush();
+    bytes out;
+    while (auto s = enc.next()) {
+        append(out, s->header);
+        if (s->compressed_payload) {
+            append(out, s->compressed_payload);
+        } else {
+            for (bytes_view f : s->payload) {
+                out.append(f.data(), f.size());
+            }
+        }
+        append(out, s->payload_crc);
+    }
+    return out;
+}
+
+static bytes decode(bytes_view segments, bool compressed) {
+    temporary_buffer<char> buf(reinterpret_cast<const char*>(segments.data()), segments.size());
+    std::mt19937 rnd(segments.size());
+    // Feed the decoder in small irregular chunks so that segments straddle reads.
+    auto in = make_segment_input_stream(make_buffer_input_stream(std::move(buf), [&rnd] {
+        return size_t(std::uniform_int_distribution<int>(1, 5000)(rnd));
+    }), compressed);
+    bytes out;
+    while (true) {
+        auto b = in.read().get0();
+        if (b.empty()) {
+            break;
+        }
+        out.append(reinterpret_cast<const int8_t*>(b.get()), b.size());
+    }
+    in.close().get();
+    return out;
+}
+
+static bytes concat(const std::vector<bytes>& envelopes) {
+    bytes out;
+    for (auto& e : envelopes) {
+        out.append(e.data(), e.size());
+    }
+    return out;
+}
+
+static bytes random_bytes(std::mt19937& rnd, size_t size) {
+    bytes b(bytes::initialized_later(), size);
+    std::uniform_int_distribution<int> dist(0, 255);
+    for (auto& c : b) {
+        c = dist(rnd);
+    }
+    return b;
+}
+
+static bytes repetitive_bytes(size_t size) {
+    bytes b(bytes::initialized_later(), size);
+    for (size_t i = 0; i < size; ++i) {
+        b[i] = "scylla"[i % 6];
+    }
+    return b;
+}
+
+SEASTAR_THREAD_TEST_CASE(test_segment_round_trip) {
+    std::mt19937 rnd(0);
+    std::vector<std::vector<bytes>> cases = {
+        {},
+        {random_bytes(rnd, 9)},
+        {repetitive_bytes(100), random_bytes(rnd, 200), repetitive_bytes(1000)},
+        // Many small envelopes which fill more than one self-contained segment.
+        std::vector<bytes>(1000, repetitive_bytes(300)),
+        // Envelopes too large for a single segment.
+        {random_bytes(rnd, 100), random_bytes(rnd, 3 * max_segment_payload_size), random_bytes(rnd, 10)},
+        {repetitive_bytes(max_segment_payload_size), repetitive_bytes(max_segment_payload_size + 1)},
+    };
+    for (bool compress : {false, true}) {
+        for (auto& envelopes : cases) {
+            auto segments = encode(envelopes, compress);
+            BOOST_REQUIRE(decode(segments, compress) == concat(envelopes));
+        }
+    }
+}
+
+SEASTAR_THREAD_TEST_CASE(test_compressed_segments_are_smaller) {
+    std::vector<bytes> envelopes(100, repetitive_bytes(500));
+    auto segments = encode(envelopes, true);
+    BOOST_REQUIRE_LT(segments.size(), concat(envelopes).size() / 10);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_corrupted_segment_is_rejected) {
+    std::mt19937 rnd(1);
+    std::vector<bytes> envelopes = {random_bytes(rnd, 1000), repetitive_bytes(1000)};
+    for (bool compress : {false, true}) {
+        auto segments = encode(envelopes, compress);
+        // Flip a bit in the header, the payload and the payload CRC.
+        for (size_t pos : {size_t(1), segments.size() / 2, segments.size() - 1}) {
+            auto corrupted = segments;
+            corrupted[pos] ^= 0x10;
+            BOOST_REQUIRE_THROW(decode(corrupted, compress), exceptions::protocol_exception);
+        }
+        auto truncated = bytes(segments.data(), segments.size() - 1);
+        BOOST_REQUIRE_THROW(decode(truncated, compress), exceptions::protocol_exception);
+    }
+}
+
+// Segments computed from the protocol v5 specification, independently of
+// segment_encoder (the CRC32 is zlib's, the CRC24 follows the specification's
+// reference implementation).
+SEASTAR_THREAD_TEST_CASE(test_segment_known_answers) {
+    // A READY response envelope: version 5 response, stream 1, empty body.
+    const bytes ready = from_hex("850000010200000000");
+
+    // An uncompressed self-contained segment.
+    const bytes uncompressed = from_hex("090002a4c8c1" "850000010200000000" "ea890152");
+    BOOST_REQUIRE_EQUAL(encode({ready}, false), uncompressed);
+    BOOST_REQUIRE_EQUAL(decode(uncompressed, false), ready);
+
+    // The payload doesn't compress, so the compressed segment carries it
+    // as it is, with an uncompressed length of 0.
+    const bytes not_compressed = from_hex("0900000004c2b895" "850000010200000000" "ea890152");
+    BOOST_REQUIRE_EQUAL(encode({ready}, true), not_compressed);
+    BOOST_REQUIRE_EQUAL(decode(not_compressed, true), ready);
+
+    // A compressed segment carrying 32 'a's as an LZ4 block: a literal 'a',
+    // a match of 26 at offset 1, and 5 trailing literals.
+    const bytes compressed = from_hex("0b004000041557d3" "1f61010007506161616161" "abf158d9");
+    BOOST_REQUIRE_EQUAL(decode(compressed, true), bytes(32, int8_t('a')));
+}
@@ -25,7 +25,12 @@
 #include <seastar/testing/test_case.hh>
 #include <seastar/testing/thread_test_case.hh>
 
+#include <boost/range/adaptor/map.hpp>
+#include <boost/range/algorithm/max_element.hpp>
+#include <boost/range/algorithm/sort.hpp>
+
 #include "test/lib/cql_test_env.hh"
+#include "test/lib/cql_assertions.hh"
 #include "test/lib/result_set_assertions.hh"
 #include "test/lib/reader_permit.hh"
 #include "test/lib/log.hh"
@@ -550,3 +555,49 @@ SEASTAR_THREAD_TEST_CASE(read_max_size) {
         }
     }).get();
 }
+
+// A large memtable is flushed to several sstables of disjoint token ranges,
+// which form a single run.
+SEASTAR_THREAD_TEST_CASE(test_memtable_flush_to_several_sstables) {
+    cql_test_config cfg;
+    cfg.db_config->memtable_flush_segments(4);
+    do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("CREATE TABLE test (pk text PRIMARY KEY, v blob) WITH compaction = {'class': 'NullCompactionStrategy'};").get();
+        auto& db = e.local_db();
+        auto& tab = db.find_column_family("ks", "test");
+        auto s = tab.schema();
+
+        // Enough data for the memtable to be split into at least 2 segments of 16MB.
+        const auto keys = make_local_keys(3000, s);
+        const auto value = bytes(16 * 1024, int8_t(1));
+        for (auto& key : keys) {
+            mutation m(s, partition_key::from_single_value(*s, utf8_type->decompose(data_value(key))));
+            m.set_clustered_cell(clustering_key::make_empty(), "v", data_value(value), api::new_timestamp());
+            db.apply(s, freeze(m), tracing::trace_state_ptr(), db::commitlog::force_sync::no, db::no_timeout).get();
+        }
+        tab.flush().get();
+
+        std::unordered_map<utils::UUID, std::vector<sstables::shared_sstable>> runs;
+        for (auto& sst : *tab.get_sstables()) {
+            runs[sst->run_identifier()].push_back(sst);
+        }
+        auto largest_run = boost::max_element(runs | boost::adaptors::map_values, [] (auto& a, auto& b) {
+            return a.size() < b.size();
+        });
+        BOOST_REQUIRE_GT(largest_run->size(), 1);
+        auto& run = *largest_run;
+        boost::sort(run, [&s] (auto& a, auto& b) {
+            return a->get_first_decorated_key().tri_compare(*s, b->get_first_decorated_key()) < 0;
+        });
+        for (size_t i = 1; i < run.size(); ++i) {
+            BOOST_REQUIRE_LT(run[i - 1]->get_last_decorated_key().tri_compare(*s, run[i]->get_first_decorated_key()), 0);
+        }
+
+        auto msg = e.execute_cql("SELECT count(*) FROM test;").get0();
+        assert_that(msg).is_rows().with_rows({{long_type->decompose(int64_t(keys.size()))}});
+        for (auto& key : {keys.front(), keys.back()}) {
+            msg = e.execute_cql(format("SELECT v FROM test WHERE pk = '{}';", key)).get0();
+            assert_that(msg).is_rows().with_rows({{bytes_type->decompose(data_value(value))}});
+        }
+    }, std::move(cfg)).get();
+}
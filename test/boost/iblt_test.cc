@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE core
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "utils/iblt.hh"
+
+static std::set<uint64_t> to_set(const std::vector<uint64_t>& v) {
+    return std::set<uint64_t>(v.begin(), v.end());
+}
+
+BOOST_AUTO_TEST_CASE(test_identical_sets_decode_empty) {
+    std::mt19937_64 rnd(1);
+    utils::iblt a(utils::iblt::cells_for(0));
+    utils::iblt b(utils::iblt::cells_for(0));
+    for (int i = 0; i < 100000; ++i) {
+        auto key = rnd();
+        a.insert(key);
+        b.insert(key);
+    }
+    a.subtract(b);
+    auto diff = a.decode();
+    BOOST_REQUIRE(diff);
+    BOOST_REQUIRE(diff->added.empty());
+    BOOST_REQUIRE(diff->removed.empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_decode_difference) {
+    std::mt19937_64 rnd(2);
+    for (size_t nr_diff : {1, 10, 100, 1000}) {
+        utils::iblt a(utils::iblt::cells_for(nr_diff));
+        utils::iblt b(utils::iblt::cells_for(nr_diff));
+        for (int i = 0; i < 10000; ++i) {
+            auto key = rnd();
+            a.insert(key);
+            b.insert(key);
+        }
+        std::set<uint64_t> only_a, only_b;
+        for (size_t i = 0; i < nr_diff; ++i) {
+            auto key = rnd();
+            if (i % 2) {
+                a.insert(key);
+                only_a.insert(key);
+            } else {
+                b.insert(key);
+                only_b.insert(key);
+            }
+        }
+        a.subtract(b);
+        auto diff = a.decode();
+        BOOST_REQUIRE(diff);
+        BOOST_REQUIRE(to_set(diff->added) == only_a);
+        BOOST_REQUIRE(to_set(diff->removed) == only_b);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_insert_erase) {
+    utils::iblt t(30);
+    t.insert(0);
+    t.insert(7);
+    t.erase(42);
+    t.erase(7);
+    auto diff = t.decode();
+    BOOST_REQUIRE(diff);
+    BOOST_REQUIRE(diff->added == std::vector<uint64_t>({0}));
+    BOOST_REQUIRE(diff->removed == std::vector<uint64_t>({42}));
+}
+
+BOOST_AUTO_TEST_CASE(test_too_small_table_fails) {
+    std::mt19937_64 rnd(3);
+    utils::iblt t(utils::iblt::cells_for(10));
+    for (int i = 0; i < 1000; ++i) {
+        t.insert(rnd());
+    }
+    BOOST_REQUIRE(!t.decode());
+}
+
+BOOST_AUTO_TEST_CASE(test_round_trip_through_cells) {
+    utils::iblt a(31);
+    BOOST_REQUIRE_EQUAL(a.size() % utils::iblt::hash_count, 0);
+    a.insert(1);
+    a.insert(2);
+    utils::iblt b(a.cells());
+    auto diff = b.decode();
+    BOOST_REQUIRE(diff);
+    BOOST_REQUIRE(to_set(diff->added) == std::set<uint64_t>({1, 2}));
+
+    BOOST_REQUIRE_THROW(utils::iblt(std::vector<utils::iblt::cell>(4)), std::invalid_argument);
+    BOOST_REQUIRE_THROW(a.subtract(utils::iblt(a.size() + utils::iblt::hash_count)), std::invalid_argument);
+}
@@ -0,0 +1,287 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE intrusive_btree
+
+#include <boost/test/unit_test.hpp>
+#include <fmt/core.h>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "utils/intrusive_btree.hh"
+
+using namespace intrusive_b;
+
+class test_elem {
+public:
+    member_hook hook;
+    int value;
+
+    explicit test_elem(int v) noexcept : value(v) {}
+    test_elem(test_elem&& o) noexcept : hook(std::move(o.hook)), value(o.value) {}
+};
+
+struct test_compare {
+    bool operator()(const test_elem& a, const test_elem& b) const noexcept { return a.value < b.value; }
+    bool operator()(const test_elem& a, int b) const noexcept { return a.value < b; }
+    bool operator()(int a, const test_elem& b) const noexcept { return a < b.value; }
+};
+
+template <key_search Search>
+using test_tree_with = tree<test_elem, &test_elem::hook, Search>;
+using test_tree = test_tree_with<key_search::linear>;
+
+static auto deleter = [] (test_elem* e) noexcept { delete e; };
+
+template <typename Tree>
+static void check_contents(const Tree& t, const std::set<int>& expected) {
+    auto i = t.begin();
+    for (int v : expected) {
+        BOOST_REQUIRE(i != t.end());
+        BOOST_REQUIRE_EQUAL(i->value, v);
+        ++i;
+    }
+    BOOST_REQUIRE(i == t.end());
+
+    auto ri = t.rbegin();
+    for (auto e = expected.rbegin(); e != expected.rend(); ++e) {
+        BOOST_REQUIRE(ri != t.rend());
+        BOOST_REQUIRE_EQUAL(ri->value, *e);
+        ++ri;
+    }
+    BOOST_REQUIRE(ri == t.rend());
+    BOOST_REQUIRE_EQUAL(t.calculate_size(), expected.size());
+}
+
+BOOST_AUTO_TEST_CASE(test_ops_empty_tree) {
+    test_tree t;
+    BOOST_REQUIRE(t.empty());
+    BOOST_REQUIRE(t.begin() == t.end());
+    BOOST_REQUIRE(t.find(1, test_compare{}) == t.end());
+    BOOST_REQUIRE(t.lower_bound(1, test_compare{}) == t.end());
+    BOOST_REQUIRE(t.upper_bound(1, test_compare{}) == t.end());
+    BOOST_REQUIRE(t.unlink_leftmost_without_rebalance() == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(test_insert_check) {
+    test_tree t;
+    test_elem a(1), b(1);
+    auto i = t.insert_check(t.end(), a, test_compare{});
+    BOOST_REQUIRE(i.second);
+    BOOST_REQUIRE(&*i.first == &a);
+    i = t.insert_check(t.end(), b, test_compare{});
+    BOOST_REQUIRE(!i.second);
+    BOOST_REQUIRE(&*i.first == &a);
+    BOOST_REQUIRE(!b.hook.is_linked());
+    BOOST_REQUIRE(test_tree::is_only_member(a));
+    BOOST_REQUIRE(&test_tree::container_of_only_member(a) == &t);
+}
+
+BOOST_AUTO_TEST_CASE(test_bounds) {
+    test_tree t;
+    test_elem a(1), b(3);
+    t.insert_before(t.end(), a);
+    t.insert_before(t.end(), b);
+
+    BOOST_REQUIRE_EQUAL(t.lower_bound(0, test_compare{})->value, 1);
+    BOOST_REQUIRE_EQUAL(t.lower_bound(1, test_compare{})->value, 1);
+    BOOST_REQUIRE_EQUAL(t.lower_bound(2, test_compare{})->value, 3);
+    BOOST_REQUIRE_EQUAL(t.lower_bound(3, test_compare{})->value, 3);
+    BOOST_REQUIRE(t.lower_bound(4, test_compare{}) == t.end());
+
+    BOOST_REQUIRE_EQUAL(t.upper_bound(0, test_compare{})->value, 1);
+    BOOST_REQUIRE_EQUAL(t.upper_bound(1, test_compare{})->value, 3);
+    BOOST_REQUIRE_EQUAL(t.upper_bound(2, test_compare{})->value, 3);
+    BOOST_REQUIRE(t.upper_bound(3, test_compare{}) == t.end());
+
+    BOOST_REQUIRE(t.find(2, test_compare{}) == t.end());
+    BOOST_REQUIRE(&*t.find(3, test_compare{}) == &b);
+    BOOST_REQUIRE(!test_tree::is_only_member(a));
+}
+
+BOOST_AUTO_TEST_CASE(test_end_iterator) {
+    test_tree t;
+    test_elem a(1);
+    auto i = t.insert_before(t.end(), a);
+    i++;
+    BOOST_REQUIRE(i == t.end());
+    i--;
+    BOOST_REQUIRE(&*i == &a);
+    BOOST_REQUIRE(&*std::prev(t.end()) == &a);
+}
+
+BOOST_AUTO_TEST_CASE(test_iterators_survive_modifications) {
+    test_tree t;
+    std::vector<std::unique_ptr<test_elem>> elems;
+    for (int i = 0; i < 1000; i += 2) {
+        elems.push_back(std::make_unique<test_elem>(i));
+        t.insert_before(t.end(), *elems.back());
+    }
+
+    auto it = test_tree::iterator_to(*elems[250]);
+    BOOST_REQUIRE_EQUAL(it->value, 500);
+
+    // Odd keys go in between, splitting nodes all over the tree
+    std::vector<std::unique_ptr<test_elem>> odd;
+    for (int i = 1; i < 1000; i += 2) {
+        odd.push_back(std::make_unique<test_elem>(i));
+        t.insert_before(t.lower_bound(i, test_compare{}), *odd.back());
+    }
+    BOOST_REQUIRE_EQUAL(it->value, 500);
+    BOOST_REQUIRE_EQUAL(std::next(it)->value, 501);
+    BOOST_REQUIRE_EQUAL(std::prev(it)->value, 499);
+
+    // ... and leave, merging them back
+    odd.clear();
+    BOOST_REQUIRE_EQUAL(it->value, 500);
+    BOOST_REQUIRE_EQUAL(std::next(it)->value, 502);
+    BOOST_REQUIRE_EQUAL(std::prev(it)->value, 498);
+
+    t.erase(t.begin(), it);
+    BOOST_REQUIRE(t.begin() == it);
+    elems.clear();
+    BOOST_REQUIRE(t.empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_element_move) {
+    test_tree t;
+    std::set<int> expected;
+    std::vector<test_elem*> elems;
+    for (int i = 0; i < 100; i++) {
+        elems.push_back(new test_elem(i));
+        t.insert_before(t.end(), *elems.back());
+        expected.insert(i);
+    }
+
+    for (auto& e : elems) {
+        auto* moved = new test_elem(std::move(*e));
+        BOOST_REQUIRE(!e->hook.is_linked());
+        delete e;
+        e = moved;
+    }
+    check_contents(t, expected);
+
+    test_tree t2(std::move(t));
+    BOOST_REQUIRE(t.empty());
+    check_contents(t2, expected);
+    t2.clear_and_dispose(deleter);
+}
+
+BOOST_AUTO_TEST_CASE(test_move_between_trees) {
+    test_tree t1, t2;
+    std::set<int> e1, e2;
+    for (int i = 0; i < 200; i++) {
+        t1.insert_before(t1.end(), *new test_elem(i));
+        e1.insert(i);
+    }
+
+    for (auto i = t1.begin(); i != t1.end(); ) {
+        auto next = std::next(i);
+        if (i->value % 3 == 0) {
+            e1.erase(i->value);
+            e2.insert(i->value);
+            t2.insert_before(t2.end(), *i);
+        }
+        i = next;
+    }
+
+    check_contents(t1, e1);
+    check_contents(t2, e2);
+    t1.clear_and_dispose(deleter);
+    t2.clear_and_dispose(deleter);
+}
+
+BOOST_AUTO_TEST_CASE(test_clone_and_drain) {
+    test_tree t;
+    std::set<int> expected;
+    for (int i = 0; i < 300; i++) {
+        t.insert_before(t.end(), *new test_elem(i));
+        expected.insert(i);
+    }
+
+    test_tree c;
+    c.clone_from(t, [] (const test_elem& e) { return new test_elem(e.value); }, deleter);
+    check_contents(c, expected);
+    t.clear_and_dispose(deleter);
+    BOOST_REQUIRE(t.empty());
+
+    int v = 0;
+    while (test_elem* e = c.unlink_leftmost_without_rebalance()) {
+        BOOST_REQUIRE_EQUAL(e->value, v++);
+        BOOST_REQUIRE(!e->hook.is_linked());
+        delete e;
+    }
+    BOOST_REQUIRE_EQUAL(v, 300);
+    BOOST_REQUIRE(c.empty());
+}
+
+template <key_search Search>
+static void test_random_operations() {
+    test_tree_with<Search> t;
+    std::set<int> expected;
+    std::vector<std::unique_ptr<test_elem>> elems(2000);
+    std::mt19937 rnd(42);
+
+    for (int step = 0; step < 50000; step++) {
+        int k = rnd() % elems.size();
+        switch (rnd() % 4) {
+        case 0:
+        case 1:
+            if (!elems[k]) {
+                elems[k] = std::make_unique<test_elem>(k);
+                BOOST_REQUIRE(t.insert_check(t.end(), *elems[k], test_compare{}).second);
+                expected.insert(k);
+            }
+            break;
+        case 2:
+            if (elems[k]) {
+                auto i = t.find(k, test_compare{});
+                BOOST_REQUIRE(&*i == elems[k].get());
+                auto next = t.erase(i);
+                auto exp_next = expected.upper_bound(k);
+                BOOST_REQUIRE((next == t.end()) == (exp_next == expected.end()));
+                elems[k].reset();
+                expected.erase(k);
+            }
+            break;
+        case 3:
+            // auto-unlink
+            elems[k].reset();
+            expected.erase(k);
+            break;
+        }
+
+        if (step % 1000 == 0) {
+            check_contents(t, expected);
+        }
+    }
+
+    check_contents(t, expected);
+}
+
+BOOST_AUTO_TEST_CASE(test_random_linear) {
+    test_random_operations<key_search::linear>();
+}
+
+BOOST_AUTO_TEST_CASE(test_random_binary) {
+    test_random_operations<key_search::binary>();
+}
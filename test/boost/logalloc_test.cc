@@ -40,6 +40,7 @@
 #include "utils/managed_ref.hh"
 #include "utils/managed_bytes.hh"
 #include "test/lib/log.hh"
+#include "test/lib/eventually.hh"
 #include "log.hh"
 
 [[gnu::unused]]
@@ -1461,4 +1462,112 @@ SEASTAR_THREAD_TEST_CASE(test_decay_reserves) {
     BOOST_REQUIRE_LE(reclaims, expected_reclaims);
 }
 
+SEASTAR_THREAD_TEST_CASE(test_background_defragmentation) {
+    region_group group;
+    region reg(group);
+    std::vector<managed_ref<int>> refs;
+
+    with_allocator(reg.allocator(), [&] {
+        for (int i = 0; i < 32 * 1024 * 32; i++) {
+            refs.push_back(make_managed<int>());
+        }
+        // Leave every segment about half full.
+        for (size_t i = 0; i < refs.size(); i += 2) {
+            refs[i] = {};
+        }
+    });
+
+    // Buckets are cumulative, bucket 5 holds segments at most 60% full.
+    auto sparse_segments = [&] {
+        return group.segment_occupancy_histogram().buckets[5].count;
+    };
+    auto initial_sparse_segments = sparse_segments();
+    BOOST_REQUIRE_GT(initial_sparse_segments, 10);
+    auto initial_total_space = reg.occupancy().total_space();
+
+    logalloc::tracker::config cfg{};
+    cfg.lsa_reclamation_step = 1;
+    // Compact as long as there are segments worth compacting.
+    cfg.background_defragment_free_segments = std::numeric_limits<size_t>::max();
+    cfg.background_defragment_sched_group = default_scheduling_group();
+    shard_tracker().configure(cfg);
+    auto stop = defer([] {
+        shard_tracker().stop().get();
+    });
+
+    BOOST_REQUIRE(eventually_true([&] {
+        return sparse_segments() < initial_sparse_segments / 4;
+    }));
+    BOOST_REQUIRE_LT(reg.occupancy().total_space(), initial_total_space * 3 / 4);
+
+    with_allocator(reg.allocator(), [&] {
+        refs.clear();
+    });
+}
+
+// The histogram is updated as segments are allocated from and freed, it has to
+// match the occupancy of the regions through allocations, frees and merges.
+SEASTAR_THREAD_TEST_CASE(test_segment_occupancy_histogram) {
+    region_group group;
+    auto check = [&] (std::initializer_list<region*> regions) {
+        auto hist = group.segment_occupancy_histogram();
+        occupancy_stats occ;
+        for (auto r : regions) {
+            occ += r->occupancy();
+        }
+        BOOST_REQUIRE_EQUAL(hist.sample_count, occ.total_space() / logalloc::segment_size);
+        BOOST_REQUIRE_CLOSE(hist.sample_sum, double(occ.used_space()) * 100 / logalloc::segment_size, 0.001);
+        BOOST_REQUIRE_EQUAL(hist.buckets.back().count, hist.sample_count);
+    };
+
+    region reg1(group);
+    region reg2(group);
+    std::vector<managed_bytes> objs1;
+    std::vector<managed_bytes> objs2;
+    with_allocator(reg1.allocator(), [&] {
+        for (int i = 0; i < 1000; i++) {
+            objs1.emplace_back(managed_bytes(managed_bytes::initialized_later(), 1024));
+        }
+    });
+    with_allocator(reg2.allocator(), [&] {
+        for (int i = 0; i < 500; i++) {
+            objs2.emplace_back(managed_bytes(managed_bytes::initialized_later(), 1024));
+        }
+    });
+    check({&reg1, &reg2});
+
+    with_allocator(reg1.allocator(), [&] {
+        for (size_t i = 0; i < objs1.size(); i += 3) {
+            objs1[i] = {};
+        }
+    });
+    check({&reg1, &reg2});
+
+    reg1.merge(reg2);
+    check({&reg1});
+
+    with_allocator(reg1.allocator(), [&] {
+        objs1.clear();
+        objs2.clear();
+    });
+    check({&reg1});
+}
+
+// The background defragmenter must be stopped before it can be configured again.
+SEASTAR_THREAD_TEST_CASE(test_background_defragmentation_reconfiguration) {
+    logalloc::tracker::config cfg{};
+    cfg.lsa_reclamation_step = 1;
+    cfg.background_defragment_free_segments = 1;
+    cfg.background_defragment_sched_group = default_scheduling_group();
+    shard_tracker().configure(cfg);
+    auto stop = defer([] {
+        shard_tracker().stop().get();
+    });
+
+    BOOST_REQUIRE_THROW(shard_tracker().configure(cfg), std::logic_error);
+
+    shard_tracker().stop().get();
+    shard_tracker().configure(cfg);
+}
+
 #endif
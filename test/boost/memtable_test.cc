@@ -30,6 +30,7 @@
 
 #include <seastar/core/thread.hh>
 #include "memtable.hh"
+#include "frozen_mutation.hh"
 #include "test/lib/mutation_source_test.hh"
 #include "test/lib/mutation_assertions.hh"
 #include "test/lib/flat_mutation_reader_assertions.hh"
@@ -177,6 +178,44 @@ SEASTAR_TEST_CASE(test_memtable_flush_reader) {
     });
 }
 
+// A memtable may be flushed to several sstables at once, by flush readers of
+// disjoint ranges.
+SEASTAR_TEST_CASE(test_memtable_flush_readers_of_disjoint_ranges) {
+    return seastar::async([] {
+        schema_ptr s = schema_builder("ks", "cf")
+                .with_column("pk", bytes_type, column_kind::partition_key)
+                .with_column("col", bytes_type, column_kind::regular_column)
+                .build();
+
+        table_stats tbl_stats;
+        dirty_memory_manager mgr;
+
+        auto mt = make_lw_shared<memtable>(s, mgr, tbl_stats);
+
+        std::vector<mutation> ring = make_ring(s, 6);
+        for (auto& m : ring) {
+            m.set_clustered_cell(clustering_key::make_empty(), to_bytes("col"), data_value(bytes(bytes::initialized_later(), 8)), next_timestamp());
+            mt->apply(m);
+        }
+
+        auto split = dht::ring_position::starting_at(ring[3].token());
+        auto first_half = dht::partition_range::make_ending_with({split, false});
+        auto second_half = dht::partition_range::make_starting_with({split, true});
+        auto virtual_dirty_before = mgr.virtual_dirty_memory();
+
+        auto rd1 = assert_that(mt->make_flush_reader(s, default_priority_class(), first_half));
+        auto rd2 = assert_that(mt->make_flush_reader(s, default_priority_class(), second_half));
+        for (int i = 0; i < 3; ++i) {
+            rd1.produces(ring[i]);
+            rd2.produces(ring[3 + i]);
+        }
+        rd1.produces_end_of_stream();
+        rd2.produces_end_of_stream();
+
+        BOOST_REQUIRE_LT(mgr.virtual_dirty_memory(), virtual_dirty_before);
+    });
+}
+
 SEASTAR_TEST_CASE(test_adding_a_column_during_reading_doesnt_affect_read_result) {
     return seastar::async([] {
         auto common_builder = schema_builder("ks", "cf")
@@ -614,3 +653,42 @@ SEASTAR_THREAD_TEST_CASE(test_collecting_encoding_stats) {
     BOOST_CHECK_EQUAL(stats.min_timestamp, -10);
     BOOST_CHECK(stats.min_ttl == md2_ttl);
 }
+
+SEASTAR_THREAD_TEST_CASE(test_frozen_mutation_apply_matches_mutation_apply) {
+    random_mutation_generator gen(random_mutation_generator::generate_counters::no);
+    auto s = gen.schema();
+
+    for (int i = 0; i < 10; ++i) {
+        auto m1 = gen();
+        auto m2 = mutation(s, m1.decorated_key(), gen().partition());
+        auto m3 = mutation(s, m1.decorated_key(), gen().partition());
+
+        auto expected = make_lw_shared<memtable>(s);
+        expected->apply(m1);
+        expected->apply(m2);
+        expected->apply(m3);
+
+        auto mt = make_lw_shared<memtable>(s);
+        mt->apply(freeze(m1), s);
+        mt->apply(freeze(m2), s);
+        {
+            // Applying under a snapshot must not modify the snapshotted version.
+            auto rd = mt->make_flat_reader(s, tests::make_permit());
+            rd.set_max_buffer_size(1);
+            rd.fill_buffer(db::no_timeout).get();
+            mt->apply(freeze(m3), s);
+        }
+        // Applying the same mutation again must not change anything.
+        mt->apply(freeze(m2), s);
+
+        assert_that(mt->make_flat_reader(s, tests::make_permit()))
+            .produces(m1 + m2 + m3)
+            .produces_end_of_stream();
+
+        auto expected_stats = expected->get_encoding_stats();
+        auto stats = mt->get_encoding_stats();
+        BOOST_REQUIRE_EQUAL(stats.min_timestamp, expected_stats.min_timestamp);
+        BOOST_REQUIRE(stats.min_local_deletion_time == expected_stats.min_local_deletion_time);
+        BOOST_REQUIRE(stats.min_ttl == expected_stats.min_ttl);
+    }
+}
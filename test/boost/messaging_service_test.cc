@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <set>
+
+#include <seastar/core/distributed.hh>
+#include <seastar/testing/thread_test_case.hh>
+#include <seastar/util/defer.hh>
+
+#include "message/messaging_service.hh"
+#include "locator/snitch_base.hh"
+#include "utils/fb_utilities.hh"
+
+namespace {
+
+struct node_connections {
+    size_t plain = 0;
+    size_t pinned = 0;
+    std::set<uint32_t> shards;
+};
+
+node_connections connections_to(const netw::messaging_service& ms, gms::inet_address ep) {
+    node_connections ret;
+    ms.foreach_client([&] (const netw::msg_addr& id, const netw::messaging_service::shard_info&) {
+        if (id.addr != ep) {
+            return;
+        }
+        if (id.shard_pinned) {
+            ++ret.pinned;
+            ret.shards.insert(id.cpu_id);
+        } else {
+            ++ret.plain;
+        }
+    });
+    return ret;
+}
+
+}
+
+SEASTAR_THREAD_TEST_CASE(test_connections_to_shards) {
+    utils::fb_utilities::set_broadcast_address(gms::inet_address("127.0.0.1"));
+    locator::i_endpoint_snitch::create_snitch("SimpleSnitch").get();
+    auto stop_snitch = defer([] { locator::i_endpoint_snitch::stop_snitch().get(); });
+
+    sharded<netw::messaging_service> messaging;
+    messaging.start(gms::inet_address("127.0.0.1"), 7000).get();
+    auto stop_messaging = defer([&] { messaging.stop().get(); });
+    auto& ms = messaging.local();
+
+    // Nobody listens on these nodes, the sends fail, but the clients are
+    // created and kept until the next send to the same client.
+    auto send = [&] (netw::msg_addr id) {
+        ms.send_gossip_shutdown(id, utils::fb_utilities::get_broadcast_address()).handle_exception([] (std::exception_ptr) { }).get();
+    };
+
+    auto sharded_node = gms::inet_address("127.0.0.2");
+    ms.set_peer_sharding(sharded_node, 2, 12);
+    send(netw::msg_addr::pinned(sharded_node, 0));
+    send(netw::msg_addr::pinned(sharded_node, 1));
+    auto c = connections_to(ms, sharded_node);
+    BOOST_REQUIRE_EQUAL(c.pinned, 2);
+    BOOST_REQUIRE_EQUAL(c.plain, 0);
+    BOOST_REQUIRE(c.shards == std::set<uint32_t>({0, 1}));
+
+    // A failed client is replaced, not duplicated.
+    send(netw::msg_addr::pinned(sharded_node, 1));
+    BOOST_REQUIRE_EQUAL(connections_to(ms, sharded_node).pinned, 2);
+
+    // Addresses which aren't pinned use the plain connection, whatever the shard.
+    send(netw::msg_addr(sharded_node, 0));
+    send(netw::msg_addr(sharded_node, 1));
+    c = connections_to(ms, sharded_node);
+    BOOST_REQUIRE_EQUAL(c.pinned, 2);
+    BOOST_REQUIRE_EQUAL(c.plain, 1);
+
+    // So do shards the node doesn't have.
+    send(netw::msg_addr::pinned(sharded_node, 5));
+    c = connections_to(ms, sharded_node);
+    BOOST_REQUIRE_EQUAL(c.pinned, 2);
+    BOOST_REQUIRE_EQUAL(c.plain, 1);
+
+    // While the sharding is unknown, all shards share the plain connection.
+    auto unknown_node = gms::inet_address("127.0.0.3");
+    send(netw::msg_addr::pinned(unknown_node, 0));
+    send(netw::msg_addr::pinned(unknown_node, 1));
+    c = connections_to(ms, unknown_node);
+    BOOST_REQUIRE_EQUAL(c.pinned, 0);
+    BOOST_REQUIRE_EQUAL(c.plain, 1);
+
+    // Learning the sharding keeps the plain connection.
+    ms.set_peer_sharding(unknown_node, 2, 12);
+    c = connections_to(ms, unknown_node);
+    BOOST_REQUIRE_EQUAL(c.pinned, 0);
+    BOOST_REQUIRE_EQUAL(c.plain, 1);
+
+    // A change of the sharding of the node drops the pinned connections only.
+    ms.set_peer_sharding(sharded_node, 4, 12);
+    c = connections_to(ms, sharded_node);
+    BOOST_REQUIRE_EQUAL(c.pinned, 0);
+    BOOST_REQUIRE_EQUAL(c.plain, 1);
+}
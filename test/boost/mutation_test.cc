@@ -1231,17 +1231,27 @@ static mutation compacted(const mutation& m) {
     return result;
 }
 
+static mutation with_cached_cell_hashes(const mutation& m) {
+    auto result = m;
+    for (rows_entry& e : result.partition().clustered_rows()) {
+        e.row().cells().prepare_hash(*result.schema(), column_kind::regular_column);
+    }
+    return result;
+}
+
 SEASTAR_TEST_CASE(test_query_digest) {
     return seastar::async([] {
         auto check_digests_equal = [] (const mutation& m1, const mutation& m2) {
             auto ps1 = partition_slice_builder(*m1.schema()).build();
             auto ps2 = partition_slice_builder(*m2.schema()).build();
-            auto digest1 = *m1.query(ps1, query::result_memory_accounter{ query::result_memory_limiter::unlimited_result_size },
-                    query::result_options::only_digest(query::digest_algorithm::xxHash)).digest();
-            auto digest2 = *m2.query(ps2, query::result_memory_accounter{ query::result_memory_limiter::unlimited_result_size },
-                    query::result_options::only_digest(query::digest_algorithm::xxHash)).digest();
-            if (digest1 != digest2) {
-                BOOST_FAIL(format("Digest should be the same for {} and {}", m1, m2));
+            for (auto algo : {query::digest_algorithm::xxHash, query::digest_algorithm::xxHash3}) {
+                auto digest1 = *m1.query(ps1, query::result_memory_accounter{ query::result_memory_limiter::unlimited_result_size },
+                        query::result_options::only_digest(algo)).digest();
+                auto digest2 = *m2.query(ps2, query::result_memory_accounter{ query::result_memory_limiter::unlimited_result_size },
+                        query::result_options::only_digest(algo)).digest();
+                if (digest1 != digest2) {
+                    BOOST_FAIL(format("Digest should be the same for {} and {}", m1, m2));
+                }
             }
         };
 
@@ -1253,6 +1263,7 @@ SEASTAR_TEST_CASE(test_query_digest) {
             if (eq) {
                 check_digests_equal(compacted(m1), m2);
                 check_digests_equal(m1, compacted(m2));
+                check_digests_equal(m1, with_cached_cell_hashes(m2));
             } else {
                 testlog.info("If not equal, they should become so after applying diffs mutually");
 
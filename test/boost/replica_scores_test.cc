@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE core
+
+#include <boost/test/unit_test.hpp>
+#include <optional>
+#include <vector>
+
+#include "service/replica_scores.hh"
+
+using namespace std::chrono_literals;
+
+static const gms::inet_address ep1("127.0.0.1");
+static const gms::inet_address ep2("127.0.0.2");
+static const gms::inet_address ep3("127.0.0.3");
+
+static void respond(service::replica_scores& scores, gms::inet_address ep, std::chrono::microseconds response_time,
+        std::optional<service::replica_load> load = {}) {
+    scores.on_request_sent(ep);
+    if (load) {
+        scores.on_load_report(ep, *load);
+    }
+    scores.on_response(ep, response_time);
+}
+
+BOOST_AUTO_TEST_CASE(test_unknown_endpoints_keep_their_order) {
+    service::replica_scores scores;
+    std::vector<gms::inet_address> eps{ep3, ep1, ep2};
+    scores.sort(eps.begin(), eps.end());
+    BOOST_REQUIRE(eps == std::vector<gms::inet_address>({ep3, ep1, ep2}));
+}
+
+BOOST_AUTO_TEST_CASE(test_slow_endpoint_goes_last) {
+    service::replica_scores scores;
+    for (int i = 0; i < 10; ++i) {
+        respond(scores, ep1, 5000us);
+        respond(scores, ep2, 500us);
+        respond(scores, ep3, 1000us);
+    }
+    std::vector<gms::inet_address> eps{ep1, ep2, ep3};
+    scores.sort(eps.begin(), eps.end());
+    BOOST_REQUIRE(eps == std::vector<gms::inet_address>({ep2, ep3, ep1}));
+}
+
+BOOST_AUTO_TEST_CASE(test_queue_length_outweighs_network_time) {
+    service::replica_scores scores;
+    // ep1 answers faster, but has requests piling up.
+    for (int i = 0; i < 10; ++i) {
+        respond(scores, ep1, 600us, service::replica_load{8, 400});
+        respond(scores, ep2, 900us, service::replica_load{0, 400});
+    }
+    BOOST_REQUIRE_GT(scores.score(ep1), scores.score(ep2));
+}
+
+BOOST_AUTO_TEST_CASE(test_outstanding_requests_raise_score) {
+    service::replica_scores scores;
+    respond(scores, ep1, 1000us);
+    respond(scores, ep2, 1000us);
+    BOOST_REQUIRE_EQUAL(scores.score(ep1), scores.score(ep2));
+    scores.on_request_sent(ep1);
+    BOOST_REQUIRE_GT(scores.score(ep1), scores.score(ep2));
+    scores.on_response(ep1, 1000us);
+    BOOST_REQUIRE_EQUAL(scores.score(ep1), scores.score(ep2));
+}
+
+BOOST_AUTO_TEST_CASE(test_outstanding_requests_without_response) {
+    service::replica_scores scores;
+    respond(scores, ep1, 50000us);
+    scores.on_request_sent(ep2);
+    BOOST_REQUIRE_GT(scores.score(ep2), scores.score(ep1));
+    BOOST_REQUIRE_GT(scores.score(ep2), scores.score(ep3));
+    auto one_outstanding = scores.score(ep2);
+    scores.on_request_sent(ep2);
+    BOOST_REQUIRE_GT(scores.score(ep2), one_outstanding);
+
+    std::vector<gms::inet_address> eps{ep2, ep1, ep3};
+    scores.sort(eps.begin(), eps.end());
+    BOOST_REQUIRE(eps == std::vector<gms::inet_address>({ep3, ep1, ep2}));
+}
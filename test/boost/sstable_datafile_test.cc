@@ -62,6 +62,7 @@
 #include "db/config.hh"
 
 #include <stdio.h>
+#include <fstream>
 #include <ftw.h>
 #include <unistd.h>
 #include <boost/range/algorithm/find_if.hpp>
@@ -1104,6 +1105,61 @@ SEASTAR_TEST_CASE(compaction_manager_test) {
   });
 }
 
+SEASTAR_TEST_CASE(compaction_manager_maintenance_slots_test) {
+  return seastar::async([] {
+    auto cm = make_lw_shared<compaction_manager>();
+    cm->configure_maintenance(2, 200);
+    auto cmt = compaction_manager_test_helper(*cm);
+
+    // Slots are handed out right away while the budget allows.
+    auto first = cmt.acquire_maintenance_slot(10);
+    auto second = cmt.acquire_maintenance_slot(20);
+    BOOST_REQUIRE(first.available() && second.available());
+    first.get();
+    second.get();
+    BOOST_REQUIRE_EQUAL(cmt.maintenance_running(), 2);
+
+    // Once it's used up, operations wait and are admitted largest first,
+    // in submission order among equally large ones.
+    std::vector<int> admitted;
+    auto acquire = [&] (uint64_t priority, int id) {
+        return cmt.acquire_maintenance_slot(priority).then([&admitted, id] {
+            admitted.push_back(id);
+        });
+    };
+    auto small = acquire(1, 0);
+    auto large = acquire(100, 1);
+    auto medium_first = acquire(50, 2);
+    auto medium_second = acquire(50, 3);
+    BOOST_REQUIRE_EQUAL(cmt.maintenance_waiters(), 4);
+    BOOST_REQUIRE_EQUAL(cmt.maintenance_running(), 2);
+
+    cmt.release_maintenance_slot();
+    large.get();
+    BOOST_REQUIRE_EQUAL(admitted, std::vector<int>({1}));
+    BOOST_REQUIRE_EQUAL(cmt.maintenance_running(), 2);
+    BOOST_REQUIRE(!medium_first.available());
+
+    cmt.release_maintenance_slot();
+    medium_first.get();
+    BOOST_REQUIRE_EQUAL(admitted, std::vector<int>({1, 2}));
+    BOOST_REQUIRE(!medium_second.available() && !small.available());
+
+    // Raising the budget wakes up the remaining waiters.
+    cm->configure_maintenance(4, 200);
+    medium_second.get();
+    small.get();
+    BOOST_REQUIRE_EQUAL(admitted, std::vector<int>({1, 2, 3, 0}));
+    BOOST_REQUIRE_EQUAL(cmt.maintenance_running(), 4);
+    BOOST_REQUIRE_EQUAL(cmt.maintenance_waiters(), 0);
+
+    for (int i = 0; i < 4; ++i) {
+        cmt.release_maintenance_slot();
+    }
+    BOOST_REQUIRE_EQUAL(cmt.maintenance_running(), 0);
+  });
+}
+
 SEASTAR_TEST_CASE(compact) {
   return sstables::test_env::do_with([] (sstables::test_env& env) {
     BOOST_REQUIRE(smp::count == 1);
@@ -4520,6 +4576,52 @@ SEASTAR_TEST_CASE(size_tiered_beyond_max_threshold_test) {
   });
 }
 
+SEASTAR_TEST_CASE(incremental_compaction_strategy_test) {
+  return test_env::do_with([] (test_env& env) {
+    column_family_for_tests cf(env.manager());
+    const uint64_t fragment_size = 1024 * 1024;
+    auto cs = sstables::make_compaction_strategy(sstables::compaction_strategy_type::incremental, {{"sstable_size_in_mb", "1"}});
+    BOOST_REQUIRE_EQUAL(cs.name(), "IncrementalCompactionStrategy");
+    BOOST_REQUIRE(sstables::compaction_strategy::type("IncrementalCompactionStrategy") == sstables::compaction_strategy_type::incremental);
+
+    std::vector<sstables::shared_sstable> candidates;
+    int64_t generation = 0;
+    auto add_run = [&] (unsigned fragments) {
+        auto run_id = utils::make_random_uuid();
+        for (unsigned i = 0; i < fragments; i++) {
+            auto sst = env.make_sstable(cf.schema(), "", generation++, la, big);
+            sstables::test(sst).set_data_file_size(fragment_size);
+            sstables::test(sst).set_run_identifier(run_id);
+            candidates.push_back(std::move(sst));
+        }
+        return run_id;
+    };
+
+    // min_threshold runs of similar size, and a much bigger run which is alone in its tier.
+    // All fragments are of the same size, so only tiering by run size tells them apart.
+    int min_threshold = cf->schema()->min_compaction_threshold();
+    for (auto i = 0; i < min_threshold; i++) {
+        add_run(4);
+    }
+    auto big_run = add_run(64);
+
+    auto desc = cs.get_sstables_for_compaction(*cf, candidates);
+    BOOST_REQUIRE_EQUAL(desc.sstables.size(), size_t(min_threshold * 4));
+    BOOST_REQUIRE_EQUAL(desc.max_sstable_bytes, fragment_size);
+    for (auto& sst : desc.sstables) {
+        BOOST_REQUIRE(sst->run_identifier() != big_run);
+    }
+
+    auto major = cs.get_major_compaction_job(*cf, candidates);
+    BOOST_REQUIRE_EQUAL(major.sstables.size(), candidates.size());
+    BOOST_REQUIRE_EQUAL(major.max_sstable_bytes, fragment_size);
+
+    BOOST_REQUIRE_THROW(sstables::make_compaction_strategy(sstables::compaction_strategy_type::incremental, {{"sstable_size_in_mb", "0"}}),
+            exceptions::configuration_exception);
+    return make_ready_future<>();
+  });
+}
+
 SEASTAR_TEST_CASE(sstable_set_incremental_selector) {
   return test_env::do_with([] (test_env& env) {
     auto s = make_shared_schema({}, some_keyspace, some_column_family,
@@ -5142,6 +5244,290 @@ SEASTAR_TEST_CASE(test_broken_promoted_index_is_skipped) {
     });
 }
 
+SEASTAR_TEST_CASE(test_partition_index_pages_are_cached) {
+    return test_env::do_with_async([] (test_env& env) {
+      for (const auto version : all_sstable_versions) {
+        storage_service_for_tests ssft;
+        simple_schema table;
+
+        const unsigned rows_per_part = 10;
+        const unsigned partition_count = 100;
+
+        std::vector<mutation> partitions;
+        uint32_t row_id = 0;
+        for (unsigned i = 0; i < partition_count; ++i) {
+            mutation m(table.schema(), table.make_pkey(i));
+            for (unsigned j = 0; j < rows_per_part; ++j) {
+                table.add_row(m, table.make_ckey(row_id++), make_random_string(1));
+            }
+            partitions.emplace_back(std::move(m));
+        }
+        std::sort(partitions.begin(), partitions.end(), mutation_decorated_key_less_comparator());
+
+        tmpdir dir;
+        sstable_writer_config cfg = env.manager().configure_writer();
+        cfg.promoted_index_block_size = 1; // So that every partition has a promoted index
+        auto sst = make_sstable_easy(env, dir.path(), flat_mutation_reader_from_mutations(tests::make_permit(), partitions), cfg, version);
+
+        auto read_index = [&] {
+            std::vector<std::pair<dht::decorated_key, uint64_t>> entries;
+            auto ir = get_index_reader(sst);
+            ir->read_partition_data().get();
+            while (!ir->eof()) {
+                auto& e = ir->current_partition_entry();
+                entries.emplace_back(dht::decorate_key(*table.schema(), e.get_key().to_partition_key(*table.schema())), e.position());
+                ir->advance_to_next_partition().get();
+            }
+            ir->close().get();
+            BOOST_REQUIRE_EQUAL(entries.size(), partition_count);
+            assert_that(get_index_reader(sst)).has_monotonic_positions(*table.schema());
+            return entries;
+        };
+
+        auto check_same = [&] (const auto& a, const auto& b) {
+            BOOST_REQUIRE_EQUAL(a.size(), b.size());
+            for (unsigned i = 0; i < a.size(); ++i) {
+                BOOST_REQUIRE(a[i].first.equal(*table.schema(), b[i].first));
+                BOOST_REQUIRE_EQUAL(a[i].second, b[i].second);
+            }
+        };
+
+        auto& stats = partition_index_cache::shard_stats();
+
+        auto misses = stats.misses;
+        auto populations = stats.populations;
+        auto from_disk = read_index();
+        BOOST_REQUIRE_GT(stats.misses, misses);
+        BOOST_REQUIRE_GT(stats.populations, populations);
+        BOOST_REQUIRE_GT(stats.pages, 0);
+
+        misses = stats.misses;
+        auto hits = stats.hits;
+        auto from_cache = read_index();
+        BOOST_REQUIRE_EQUAL(stats.misses, misses);
+        BOOST_REQUIRE_GT(stats.hits, hits);
+        check_same(from_disk, from_cache);
+
+        // Pages are evicted along with the row cache
+        auto evictions = stats.evictions;
+        env.get_cache_tracker().clear();
+        BOOST_REQUIRE_GT(stats.evictions, evictions);
+
+        misses = stats.misses;
+        check_same(from_disk, read_index());
+        BOOST_REQUIRE_GT(stats.misses, misses);
+      }
+    });
+}
+
+SEASTAR_TEST_CASE(test_split_block_bloom_filter) {
+    return test_env::do_with_async([] (test_env& env) {
+      for (const auto version : all_sstable_versions) {
+        storage_service_for_tests ssft;
+        simple_schema table;
+        auto s = schema_builder(table.schema())
+                .set_bloom_filter_type(utils::filter_type::split_block)
+                .build();
+
+        const unsigned partition_count = 1000;
+        std::vector<mutation> partitions;
+        for (unsigned i = 0; i < partition_count; ++i) {
+            mutation m(s, table.make_pkey(i));
+            m.partition().apply(tombstone(api::new_timestamp(), gc_clock::now()));
+            partitions.emplace_back(std::move(m));
+        }
+        std::sort(partitions.begin(), partitions.end(), mutation_decorated_key_less_comparator());
+
+        tmpdir dir;
+        // Reloads the components, including the filter, from disk
+        auto sst = make_sstable_easy(env, dir.path(), flat_mutation_reader_from_mutations(tests::make_permit(), partitions),
+                env.manager().configure_writer(), version);
+
+        std::ifstream ifs;
+        ifs.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+        ifs.open(sst->filename(component_type::Filter), std::ios_base::in | std::ios_base::binary);
+        uint32_t hashes;
+        ifs.read(reinterpret_cast<char*>(&hashes), sizeof(hashes));
+        // Old formats are written by the kl writer, which always uses the classic filter
+        bool split_block = version >= sstable_version_types::mc;
+        BOOST_REQUIRE_EQUAL(net::ntoh(hashes) == sstables::filter::split_block_marker, split_block);
+
+        for (auto& m : partitions) {
+            BOOST_REQUIRE(sst->filter_has_key(*s, m.decorated_key()));
+        }
+        auto rd = assert_that(sstable_reader(sst, s));
+        for (auto& m : partitions) {
+            rd.produces(m);
+        }
+        rd.produces_end_of_stream();
+      }
+    });
+}
+
+SEASTAR_TEST_CASE(test_zstd_compression_dictionary) {
+    return test_env::do_with_async([] (test_env& env) {
+      for (const auto version : all_sstable_versions) {
+        // The kl writer doesn't use compression dictionaries
+        if (version < sstable_version_types::mc) {
+            continue;
+        }
+        storage_service_for_tests ssft;
+        simple_schema table;
+        auto s = schema_builder(table.schema())
+                .set_compressor_params(compression_parameters{compressor::create({
+                    {"sstable_compression", "org.apache.cassandra.io.compress.ZstdCompressor"},
+                    {"dictionary_size_kb", "4"},
+                })})
+                .build();
+
+        std::vector<mutation> partitions;
+        for (unsigned i = 0; i < 100; ++i) {
+            mutation m(s, table.make_pkey(i));
+            for (unsigned j = 0; j < 10; ++j) {
+                table.add_row(m, table.make_ckey(j), format("value of row {} in partition {}", j, i));
+            }
+            partitions.emplace_back(std::move(m));
+        }
+        std::sort(partitions.begin(), partitions.end(), mutation_decorated_key_less_comparator());
+
+        // zstd accepts any content as a raw dictionary, no need to train one.
+        bytes dictionary = to_bytes("value of row in partition ck0000000000 ck0000000001 ck0000000002 key0 key1 key2");
+        auto cfg = env.manager().configure_writer();
+        cfg.compression_dictionary = make_lw_shared<const bytes>(dictionary);
+
+        tmpdir dir;
+        // Reloads the components, including CompressionInfo and the dictionary, from disk
+        auto sst = make_sstable_easy(env, dir.path(), flat_mutation_reader_from_mutations(tests::make_permit(), partitions), cfg, version);
+
+        BOOST_REQUIRE(sst->has_component(component_type::CompressionDictionary));
+        BOOST_REQUIRE(sst->get_compression().dictionary() == dictionary);
+        BOOST_REQUIRE(sst->get_compression().dictionary_checksum());
+
+        auto rd = assert_that(sstable_reader(sst, s));
+        for (auto& m : partitions) {
+            rd.produces(m);
+        }
+        rd.produces_end_of_stream();
+
+        // A table loading the sstable keeps using its dictionary.
+        column_family_for_tests cf(env.manager(), s);
+        BOOST_REQUIRE(!cf->compression_dictionary());
+        cf->add_sstable_and_update_cache(sst).get();
+        BOOST_REQUIRE(cf->compression_dictionary());
+        BOOST_REQUIRE(*cf->compression_dictionary() == dictionary);
+      }
+    });
+}
+
+SEASTAR_TEST_CASE(test_range_hashes) {
+    return test_env::do_with_async([] (test_env& env) {
+      for (const auto version : all_sstable_versions) {
+        // The kl writer doesn't write range hashes
+        if (version < sstable_version_types::mc) {
+            continue;
+        }
+        storage_service_for_tests ssft;
+        simple_schema table;
+        auto s = table.schema();
+
+        std::vector<mutation> partitions;
+        for (unsigned i = 0; i < 100; ++i) {
+            mutation m(s, table.make_pkey(i));
+            for (unsigned j = 0; j < 10; ++j) {
+                table.add_row(m, table.make_ckey(j), format("value of row {} in partition {}", j, i));
+            }
+            partitions.emplace_back(std::move(m));
+        }
+        std::sort(partitions.begin(), partitions.end(), mutation_decorated_key_less_comparator());
+
+        // The same rows, half of them in each of two sstables
+        std::vector<mutation> even, odd;
+        for (unsigned i = 0; i < partitions.size(); ++i) {
+            (i % 2 ? odd : even).push_back(partitions[i]);
+        }
+
+        // Same as the first partition, with one row changed
+        auto changed = partitions.front();
+        table.add_row(changed, table.make_ckey(0), "changed value");
+
+        // A ring whose first token range holds just the first partition
+        auto first_token = partitions.front().decorated_key().token();
+        auto middle_token = partitions[partitions.size() / 2].decorated_key().token();
+        auto cfg = env.manager().configure_writer();
+        cfg.range_hash_boundaries = make_lw_shared<const std::vector<dht::token>>({first_token, middle_token});
+
+        tmpdir dir;
+        auto make = [&] (std::vector<mutation> muts, int64_t generation) {
+            return make_sstable_easy(env, dir.path(), flat_mutation_reader_from_mutations(tests::make_permit(), std::move(muts)),
+                    cfg, version, generation);
+        };
+        auto all = make(partitions, 1);
+        auto sst_even = make(even, 2);
+        auto sst_odd = make(odd, 3);
+        auto sst_changed = make({changed}, 4);
+        auto sst_unchanged = make({partitions.front()}, 5);
+
+        BOOST_REQUIRE(all->has_component(component_type::RangeHashes));
+
+        auto hash = [] (shared_sstable sst, const dht::token_range& range) {
+            auto h = sst->get_range_hash(range, default_priority_class()).get0();
+            BOOST_REQUIRE(h);
+            return *h;
+        };
+        auto first_range = dht::token_range::make_ending_with({first_token, true});
+        auto middle_range = dht::token_range({first_token, false}, {middle_token, true});
+        for (auto& range : {dht::token_range::make_open_ended_both_sides(), first_range, middle_range}) {
+            BOOST_REQUIRE_EQUAL(hash(all, range), hash(sst_even, range) + hash(sst_odd, range));
+        }
+        BOOST_REQUIRE_NE(hash(sst_changed, first_range), hash(sst_unchanged, first_range));
+        BOOST_REQUIRE_EQUAL(hash(sst_changed, middle_range), 0);
+
+        // Ranges which split a non-empty token range of the ring can't be hashed.
+        auto second_token = partitions[1].decorated_key().token();
+        for (auto& range : {dht::token_range::make_singular(second_token), dht::token_range::make_starting_with({second_token, true})}) {
+            BOOST_REQUIRE(!all->get_range_hash(range, default_priority_class()).get0());
+        }
+      }
+    });
+}
+
+SEASTAR_TEST_CASE(test_range_hashes_across_schema_versions) {
+    return test_env::do_with_async([] (test_env& env) {
+        storage_service_for_tests ssft;
+        auto s1 = schema_builder("ks", "cf")
+                .with_column("pk", int32_type, column_kind::partition_key)
+                .with_column("ck", int32_type, column_kind::clustering_key)
+                .with_column("a", int32_type)
+                .with_column("v", int32_type)
+                .with_column("s", int32_type, column_kind::static_column)
+                .build();
+        // Dropping "a" shifts the id of "v".
+        auto s2 = schema_builder(s1).remove_column(to_bytes("a")).build();
+        BOOST_REQUIRE_NE(s1->get_column_definition("v")->id, s2->get_column_definition("v")->id);
+
+        auto make_mutation = [] (schema_ptr s) {
+            auto pk = partition_key::from_single_value(*s, int32_type->decompose(1));
+            mutation m(s, pk);
+            auto ck = clustering_key::from_single_value(*s, int32_type->decompose(2));
+            m.set_clustered_cell(ck, to_bytes("v"), data_value(3), api::timestamp_type(1));
+            m.set_static_cell(to_bytes("s"), data_value(4), api::timestamp_type(1));
+            return m;
+        };
+
+        tmpdir dir;
+        auto sst1 = make_sstable_easy(env, dir.path(), flat_mutation_reader_from_mutations(tests::make_permit(), {make_mutation(s1)}),
+                env.manager().configure_writer(), sstable_version_types::mc, 1);
+        auto sst2 = make_sstable_easy(env, dir.path(), flat_mutation_reader_from_mutations(tests::make_permit(), {make_mutation(s2)}),
+                env.manager().configure_writer(), sstable_version_types::mc, 2);
+
+        auto range = dht::token_range::make_open_ended_both_sides();
+        auto h1 = sst1->get_range_hash(range, default_priority_class()).get0();
+        auto h2 = sst2->get_range_hash(range, default_priority_class()).get0();
+        BOOST_REQUIRE(h1 && h2);
+        BOOST_REQUIRE_EQUAL(*h1, *h2);
+    });
+}
+
 SEASTAR_TEST_CASE(test_old_format_non_compound_range_tombstone_is_read) {
     // create table ks.test (pk int, ck int, v int, primary key(pk, ck)) with compact storage;
     //
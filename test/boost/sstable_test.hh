@@ -68,6 +68,28 @@ class column_family_test {
     }
 };
 
+class compaction_manager_test_helper {
+    compaction_manager& _cm;
+public:
+    compaction_manager_test_helper(compaction_manager& cm) : _cm(cm) {}
+
+    future<> acquire_maintenance_slot(uint64_t priority) {
+        return _cm.acquire_maintenance_slot(priority);
+    }
+
+    void release_maintenance_slot() {
+        _cm.release_maintenance_slot();
+    }
+
+    size_t maintenance_running() const {
+        return _cm._maintenance_running;
+    }
+
+    size_t maintenance_waiters() const {
+        return _cm._maintenance_waiters.size();
+    }
+};
+
 namespace sstables {
 
 inline sstring get_test_dir(const sstring& name, const sstring& ks, const sstring& cf)
@@ -20,6 +20,7 @@
  */
 
 
+#include <boost/range/adaptor/transformed.hpp>
 #include <seastar/core/thread.hh>
 #include <seastar/testing/test_case.hh>
 #include "query-result-writer.hh"
@@ -27,9 +28,14 @@
 #include "test/lib/cql_test_env.hh"
 #include "test/lib/mutation_source_test.hh"
 #include "test/lib/result_set_assertions.hh"
+#include "test/lib/cql_assertions.hh"
 #include "service/storage_proxy.hh"
 #include "partition_slice_builder.hh"
 #include "schema_builder.hh"
+#include "frozen_mutation.hh"
+#include "gms/feature.hh"
+#include "utils/fb_utilities.hh"
+#include "message/messaging_service.hh"
 
 // Returns random keys sorted in ring order.
 // The schema must have a single bytes_type partition key column.
@@ -112,3 +118,74 @@ SEASTAR_TEST_CASE(test_get_restricted_ranges) {
         });
     });
 }
+
+using send_hint_batch_func = std::function<future<std::vector<uint32_t>> (std::vector<frozen_mutation_and_schema>)>;
+
+// Sends a batch of hints to this node, with a hint for a dropped table in the
+// middle, and checks that the other hints are applied and only the hint for
+// the dropped table is reported as failed.
+static void test_hint_batch(cql_test_env& e, send_hint_batch_func send) {
+    e.execute_cql("CREATE TABLE ks.t (pk int PRIMARY KEY, v int)").get();
+    e.execute_cql("CREATE TABLE ks.dropped (pk int PRIMARY KEY, v int)").get();
+    auto t = e.local_db().find_schema("ks", "t");
+    auto dropped = e.local_db().find_schema("ks", "dropped");
+    e.execute_cql("DROP TABLE ks.dropped").get();
+
+    auto make_hint = [] (schema_ptr s, int pk) {
+        mutation m(s, partition_key::from_single_value(*s, int32_type->decompose(pk)));
+        m.set_clustered_cell(clustering_key::make_empty(), "v", data_value(pk), api::new_timestamp());
+        return frozen_mutation_and_schema{freeze(m), s};
+    };
+    std::vector<frozen_mutation_and_schema> hints;
+    for (int pk = 0; pk < 10; ++pk) {
+        hints.push_back(make_hint(t, pk));
+    }
+    hints.insert(hints.begin() + 3, make_hint(dropped, 0));
+
+    auto failed = send(std::move(hints)).get0();
+    BOOST_REQUIRE_EQUAL(failed, std::vector<uint32_t>({3}));
+
+    auto msg = e.execute_cql("SELECT pk, v FROM ks.t").get0();
+    std::vector<std::vector<bytes_opt>> rows;
+    for (int pk = 0; pk < 10; ++pk) {
+        rows.push_back({int32_type->decompose(pk), int32_type->decompose(pk)});
+    }
+    assert_that(msg).is_rows().with_rows_ignore_order(std::move(rows));
+}
+
+static future<std::vector<uint32_t>> send_hint_batch_to_endpoint(std::vector<frozen_mutation_and_schema> hints) {
+    return service::get_local_storage_proxy().send_hint_batch_to_endpoint(std::move(hints), utils::fb_utilities::get_broadcast_address());
+}
+
+SEASTAR_TEST_CASE(test_send_hint_batch_to_endpoint) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        BOOST_REQUIRE(e.local_db().features().cluster_supports_hinted_handoff_batch_replay());
+        test_hint_batch(e, send_hint_batch_to_endpoint);
+    });
+}
+
+// Batches for this node are applied directly, send one over the HINT_MUTATION_BATCH
+// verb as it is sent to other nodes, to exercise the verb handler and serialization.
+SEASTAR_TEST_CASE(test_hint_mutation_batch_verb) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        auto& ms = e.get_messaging_service();
+        ms.invoke_on_all(&netw::messaging_service::start_listen).get();
+        test_hint_batch(e, [&ms] (std::vector<frozen_mutation_and_schema> hints) {
+            auto fms = boost::copy_range<std::vector<frozen_mutation>>(hints | boost::adaptors::transformed([] (frozen_mutation_and_schema& m) {
+                return std::move(m.fm);
+            }));
+            auto timeout = netw::messaging_service::clock_type::now() + std::chrono::seconds(10);
+            return ms.local().send_hint_mutation_batch(netw::msg_addr{utils::fb_utilities::get_broadcast_address(), 0}, timeout, std::move(fms));
+        });
+    });
+}
+
+// Without the HINTED_HANDOFF_BATCH_REPLAY feature the hints of a batch are sent one by one.
+SEASTAR_TEST_CASE(test_send_hint_batch_to_endpoint_without_batch_replay_feature) {
+    cql_test_config cfg;
+    cfg.disabled_features.insert(sstring(gms::features::HINTED_HANDOFF_BATCH_REPLAY));
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        BOOST_REQUIRE(!e.local_db().features().cluster_supports_hinted_handoff_batch_replay());
+        test_hint_batch(e, send_hint_batch_to_endpoint);
+    }, std::move(cfg));
+}
@@ -171,6 +171,30 @@ SEASTAR_TEST_CASE(test_builder_with_multiple_partitions_of_batch_size_rows) {
     });
 }
 
+// View updates are propagated in the background while the build step reads
+// on. Make the base rows of a step exceed the memory allowed for them, so
+// the step has to wait for earlier updates before it can go on.
+SEASTAR_TEST_CASE(test_builder_with_rows_exceeding_populate_memory) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        const int nrows = 2 * db::view::view_builder::max_populate_memory / db::view::view_builder::batch_memory_max;
+        e.execute_cql("create table cf (p int, c int, s ascii, primary key (p, c))").get();
+        const sstring longstring = sstring(db::view::view_builder::batch_memory_max, 'x');
+        for (auto i = 0; i < nrows; ++i) {
+            e.execute_cql(format("insert into cf (p, c, s) values ({:d}, {:d}, '{}')", i % 3, i, longstring)).get();
+        }
+
+        auto f = e.local_view_builder().wait_until_built("ks", "vcf");
+        e.execute_cql("create materialized view vcf as select p, c from cf "
+                      "where p is not null and c is not null "
+                      "primary key (c, p)").get();
+
+        f.get();
+        auto msg = e.execute_cql("select count(*) from vcf").get0();
+        assert_that(msg).is_rows().with_size(1);
+        assert_that(msg).is_rows().with_rows({{{long_type->decompose(long(nrows))}}});
+    });
+}
+
 SEASTAR_TEST_CASE(test_builder_view_added_during_ongoing_build) {
     return do_with_cql_env_thread([] (cql_test_env& e) {
         e.execute_cql("create table cf (p int, c int, v int, primary key (p, c))").get();
@@ -3174,3 +3174,52 @@ SEASTAR_TEST_CASE(test_mv_allow_some_column_drops) {
         BOOST_REQUIRE_THROW(e.execute_cql("alter table cf2 drop d").get(), exceptions::invalid_request_exception);
     });
 }
+
+// Concurrent base writes have their existing rows read in batches. Check that
+// every write still sees its own row, including writes to different rows of
+// the same partition.
+SEASTAR_TEST_CASE(test_concurrent_view_updates_with_batched_reads) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("create table cf (p int, c int, v int, primary key (p, c))").get();
+        e.execute_cql("create materialized view mv1 as select * from cf "
+                      "where p is not null and c is not null and v is not null primary key (v, p, c)").get();
+        e.execute_cql("create materialized view mv2 as select * from cf "
+                      "where p is not null and c is not null and v is not null primary key ((v, c), p)").get();
+        const int partitions = 50;
+        const int rows = 4;
+        for (int p = 0; p < partitions; ++p) {
+            for (int c = 0; c < rows; ++c) {
+                e.execute_cql(format("insert into cf (p, c, v) values ({}, {}, 0)", p, c)).get();
+            }
+        }
+        // Make the reads go to sstables, so they don't complete immediately.
+        e.db().invoke_on_all([] (database& db) {
+            return db.flush_all_memtables();
+        }).get();
+        auto update = e.prepare("update cf set v = 1 where p = ? and c = ?").get0();
+        std::vector<std::pair<int, int>> keys;
+        for (int p = 0; p < partitions; ++p) {
+            for (int c = 0; c < rows; ++c) {
+                keys.emplace_back(p, c);
+            }
+        }
+        parallel_for_each(keys, [&] (std::pair<int, int> key) {
+            return e.execute_prepared(update, {cql3::raw_value::make_value(int32_type->decompose(key.first)),
+                                               cql3::raw_value::make_value(int32_type->decompose(key.second))}).discard_result();
+        }).get();
+
+        eventually([&] {
+            auto msg = e.execute_cql("select count(*) from mv1 where v = 0").get0();
+            assert_that(msg).is_rows().with_rows({{{long_type->decompose(int64_t(0))}}});
+            msg = e.execute_cql("select count(*) from mv1 where v = 1").get0();
+            assert_that(msg).is_rows().with_rows({{{long_type->decompose(int64_t(partitions * rows))}}});
+            msg = e.execute_cql("select count(*) from mv2").get0();
+            assert_that(msg).is_rows().with_rows({{{long_type->decompose(int64_t(partitions * rows))}}});
+        });
+
+        auto batched_reads = e.db().map_reduce0([] (database& local_db) {
+            return local_db.find_column_family("ks", "cf").get_view_stats().view_update_batched_reads;
+        }, int64_t(0), std::plus<int64_t>()).get0();
+        BOOST_REQUIRE_GE(batched_reads, partitions * rows);
+    });
+}
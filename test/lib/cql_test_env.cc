@@ -120,6 +120,7 @@ class single_node_cql_env : public cql_test_env {
     sharded<db::view::view_builder>& _view_builder;
     sharded<db::view::view_update_generator>& _view_update_generator;
     sharded<service::migration_notifier>& _mnotifier;
+    sharded<netw::messaging_service>& _ms;
 private:
     struct core_local_state {
         service::client_state client_state;
@@ -150,7 +151,8 @@ class single_node_cql_env : public cql_test_env {
             sharded<auth::service>& auth_service,
             sharded<db::view::view_builder>& view_builder,
             sharded<db::view::view_update_generator>& view_update_generator,
-            sharded<service::migration_notifier>& mnotifier)
+            sharded<service::migration_notifier>& mnotifier,
+            sharded<netw::messaging_service>& ms)
             : _feature_service(feature_service)
             , _db(db)
             , _qp(qp)
@@ -158,6 +160,7 @@ class single_node_cql_env : public cql_test_env {
             , _view_builder(view_builder)
             , _view_update_generator(view_update_generator)
             , _mnotifier(mnotifier)
+            , _ms(ms)
     { }
 
     virtual future<::shared_ptr<cql_transport::messages::result_message>> execute_cql(sstring_view text) override {
@@ -340,6 +343,10 @@ class single_node_cql_env : public cql_test_env {
         return _mnotifier.local();
     }
 
+    virtual sharded<netw::messaging_service>& get_messaging_service() override {
+        return _ms;
+    }
+
     future<> start() {
         return _core_local.start(std::ref(_auth_service));
     }
@@ -621,7 +628,7 @@ class single_node_cql_env : public cql_test_env {
                 // The default user may already exist if this `cql_test_env` is starting with previously populated data.
             }
 
-            single_node_cql_env env(feature_service, db, qp, auth_service, view_builder, view_update_generator, mm_notif);
+            single_node_cql_env env(feature_service, db, qp, auth_service, view_builder, view_update_generator, mm_notif, ms);
             env.start().get();
             auto stop_env = defer([&env] { env.stop().get(); });
 
@@ -52,6 +52,10 @@ namespace cql3 {
     class query_processor;
 }
 
+namespace netw {
+class messaging_service;
+}
+
 class not_prepared_exception : public std::runtime_error {
 public:
     not_prepared_exception(const cql3::prepared_cache_key_type& id) : std::runtime_error(format("Not prepared: {}", id)) {}
@@ -132,6 +136,9 @@ class cql_test_env {
     virtual db::view::view_update_generator& local_view_update_generator() = 0;
 
     virtual service::migration_notifier& local_mnotifier() = 0;
+
+    // Doesn't listen unless a test starts it, so that tests can run in parallel.
+    virtual sharded<netw::messaging_service>& get_messaging_service() = 0;
 };
 
 future<> do_with_cql_env(std::function<future<>(cql_test_env&)> func, cql_test_config = {});
@@ -27,6 +27,7 @@
 #include <seastar/util/defer.hh>
 
 #include "sstables/sstables.hh"
+#include "row_cache.hh"
 #include "test/lib/tmpdir.hh"
 #include "test/lib/test_services.hh"
 #include "test/lib/log.hh"
@@ -34,9 +35,13 @@
 namespace sstables {
 
 class test_env {
+    std::unique_ptr<cache_tracker> _cache_tracker;
     std::unique_ptr<sstables_manager> _mgr;
 public:
-    explicit test_env() : _mgr(std::make_unique<sstables_manager>(nop_lp_handler, test_db_config, test_feature_service)) { }
+    explicit test_env()
+        : _cache_tracker(std::make_unique<cache_tracker>())
+        , _mgr(std::make_unique<sstables_manager>(nop_lp_handler, test_db_config, test_feature_service, *_cache_tracker))
+    { }
 
     future<> stop() {
         return _mgr->close();
@@ -57,6 +62,7 @@ class test_env {
     }
 
     sstables_manager& manager() { return *_mgr; }
+    cache_tracker& get_cache_tracker() { return *_cache_tracker; }
 
     future<> working_sst(schema_ptr schema, sstring dir, unsigned long generation) {
         return reusable_sst(std::move(schema), dir, generation).then([] (auto ptr) { return make_ready_future<>(); });
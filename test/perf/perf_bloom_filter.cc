@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Compares the classic and the split block bloom filters.
+//
+// Usage: perf_bloom_filter [num_keys [false_positive_chance]]
+//
+// For each filter type prints the size of the filter, the measured false
+// positive ratio and the throughput of lookups of keys which are absent
+// (the common case for sstables which don't hold the partition).
+// The keys are hashed upfront so only the probing is timed.
+
+#include "utils/bloom_filter.hh"
+#include "utils/bloom_calculations.hh"
+#include "test/perf/perf.hh"
+
+#include <random>
+
+volatile uint64_t black_hole;
+
+static bytes make_key(uint64_t v) {
+    bytes b(bytes::initialized_later(), sizeof(v));
+    std::copy_n(reinterpret_cast<const int8_t*>(&v), sizeof(v), b.begin());
+    return b;
+}
+
+static utils::filter_ptr make_filter(utils::filter_type type, int64_t num_keys, double fp_chance) {
+    switch (type) {
+    case utils::filter_type::classic: {
+        // Same as utils::i_filter::get_filter(), which can only be called from a seastar thread.
+        int buckets_per_element = utils::bloom_calculations::max_buckets_per_element(num_keys);
+        auto spec = utils::bloom_calculations::compute_bloom_spec(buckets_per_element, fp_chance);
+        return utils::filter::create_filter(spec.K, num_keys, spec.buckets_per_element, utils::filter_format::m_format);
+    }
+    case utils::filter_type::split_block:
+        return utils::filter::create_split_block_filter(num_keys, fp_chance);
+    }
+    abort();
+}
+
+int main(int argc, char* argv[]) {
+    const int64_t num_keys = argc > 1 ? std::stoll(argv[1]) : 10'000'000;
+    const double fp_chance = argc > 2 ? std::stod(argv[2]) : 0.01;
+    const size_t num_probes = 1'000'000;
+
+    std::mt19937_64 rnd(0);
+    std::vector<uint64_t> present;
+    present.reserve(num_keys);
+    for (int64_t i = 0; i < num_keys; ++i) {
+        present.push_back(rnd());
+    }
+    // Random 64-bit values, so collisions with present keys are negligible.
+    std::vector<utils::hashed_key> absent;
+    absent.reserve(num_probes);
+    for (size_t i = 0; i < num_probes; ++i) {
+        absent.push_back(utils::make_hashed_key(make_key(rnd())));
+    }
+
+    std::cout << format("{} keys, false positive chance {}\n", num_keys, fp_chance);
+
+    for (auto type : {utils::filter_type::classic, utils::filter_type::split_block}) {
+        auto filter = make_filter(type, num_keys, fp_chance);
+        for (auto v : present) {
+            filter->add(make_key(v));
+        }
+
+        size_t false_positives = 0;
+        for (auto& hk : absent) {
+            false_positives += filter->is_present(hk);
+        }
+
+        std::cout << format("\n{}: {} bytes ({:.2f} bits per key), false positive ratio {:.5f}\n",
+                type, filter->memory_size(), double(filter->memory_size()) * 8 / num_keys,
+                double(false_positives) / num_probes);
+
+        std::cout << "Timing lookups of absent keys...\n";
+        size_t idx = 0;
+        uint64_t sink = 0;
+        time_it([&] {
+            sink += filter->is_present(absent[idx]);
+            if (++idx == absent.size()) {
+                idx = 0;
+            }
+        });
+        black_hole = sink;
+    }
+}
@@ -176,6 +176,76 @@ class isec_tester : public collection_tester {
     virtual ~isec_tester() { clear(); }
 };
 
+#include "utils/intrusive_btree.hh"
+
+class ibtree_tester : public collection_tester {
+    class ibt_node {
+        friend class ibtree_tester;
+        intrusive_b::member_hook link;
+        per_key_t key;
+    public:
+        explicit ibt_node(per_key_t k) : key(k) {}
+        ibt_node(ibt_node&&) noexcept = default;
+    };
+    class compare {
+        key_compare cmp;
+    public:
+        bool operator()(const ibt_node& a, const ibt_node& b) const {
+            return cmp(a.key, b.key);
+        }
+        bool operator()(per_key_t a, const ibt_node& b) const {
+            return cmp(a, b.key);
+        }
+        bool operator()(const ibt_node& a, per_key_t b) const {
+            return cmp(a.key, b);
+        }
+    };
+
+    using test_tree = intrusive_b::tree<ibt_node, &ibt_node::link, intrusive_b::key_search::linear>;
+    test_tree _t;
+public:
+    virtual void insert(per_key_t k) override {
+        auto i = _t.lower_bound(k, compare{});
+        auto n = std::make_unique<ibt_node>(k);
+        _t.insert_before(i, *n);
+        n.release();
+    }
+    virtual void lower_bound(per_key_t k) override {
+        auto i = _t.lower_bound(k, compare{});
+        assert(i != _t.end());
+    }
+    virtual void scan(int batch) override {
+        scan_collection(_t, batch);
+    }
+    virtual void erase(per_key_t k) override {
+        auto i = _t.find(k, compare{});
+        _t.erase_and_dispose(i, [] (ibt_node* n) { delete n; });
+    }
+    virtual void drain(int batch) override {
+        int x = 0;
+        while (true) {
+            ibt_node* n = _t.unlink_leftmost_without_rebalance();
+            if (n == nullptr) {
+                break;
+            }
+            delete n;
+            if (++x % batch == 0) {
+                seastar::thread::yield();
+            }
+        }
+    }
+    virtual void clear() override {
+        _t.clear_and_dispose([] (ibt_node* n) { delete n; });
+    }
+    virtual void insert_and_erase(per_key_t k) override {
+        ibt_node n(k);
+        auto i = _t.insert_before(_t.end(), n);
+        _t.erase(i);
+    }
+    virtual void show_stats() { }
+    virtual ~ibtree_tester() { clear(); }
+};
+
 class set_tester : public collection_tester {
     std::set<per_key_t> _s;
 public:
@@ -270,6 +340,8 @@ int main(int argc, char **argv) {
                 c = std::make_unique<map_tester>();
             } else if (col == "isec") {
                 c = std::make_unique<isec_tester>();
+            } else if (col == "ibtree") {
+                c = std::make_unique<ibtree_tester>();
             } else {
                 fmt::print("Unknown collection\n");
                 return;
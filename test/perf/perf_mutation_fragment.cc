@@ -25,6 +25,7 @@
 #include "test/lib/simple_schema.hh"
 
 #include "mutation_fragment.hh"
+#include "digester.hh"
 
 namespace tests {
 
@@ -140,4 +141,55 @@ PERF_TEST_F(clustering_row, hash_1M)
     });
 }
 
+// Digests the row the way a query with a digest does, see
+// mutation_partition::query_compacted().
+template<typename Hasher>
+static void digest(const schema& s, mutation_fragment& mf, bool cached_cell_hashes) {
+    mf.mutate_as_clustering_row(s, [&] (::clustering_row& cr) mutable {
+        if (cached_cell_hashes) {
+            cr.cells().prepare_hash(s, column_kind::regular_column);
+        }
+        query::column_id_vector columns;
+        for (auto& def : s.regular_columns()) {
+            columns.push_back(def.id);
+        }
+        Hasher h;
+        max_timestamp max_ts;
+        feed_hash(h, cr.key(), s);
+        feed_hash(h, cr.cells(), s, column_kind::regular_column, columns, max_ts);
+        perf_tests::do_not_optimize(h.finalize_array());
+        cr.cells().clear_hash();
+    });
+}
+
+PERF_TEST_F(clustering_row, digest_xxhash_4)
+{
+    digest<xx_hasher>(*schema(), clustering_row_4(), false);
+}
+
+PERF_TEST_F(clustering_row, digest_xxhash_cached_4)
+{
+    digest<xx_hasher>(*schema(), clustering_row_4(), true);
+}
+
+PERF_TEST_F(clustering_row, digest_xxhash3_4)
+{
+    digest<xxh3_hasher>(*schema(), clustering_row_4(), false);
+}
+
+PERF_TEST_F(clustering_row, digest_xxhash_4k)
+{
+    digest<xx_hasher>(*schema(), clustering_row_4k(), false);
+}
+
+PERF_TEST_F(clustering_row, digest_xxhash_cached_4k)
+{
+    digest<xx_hasher>(*schema(), clustering_row_4k(), true);
+}
+
+PERF_TEST_F(clustering_row, digest_xxhash3_4k)
+{
+    digest<xxh3_hasher>(*schema(), clustering_row_4k(), false);
+}
+
 }
@@ -29,6 +29,7 @@
 #include "db/large_data_handler.hh"
 #include "db/config.hh"
 #include "gms/feature_service.hh"
+#include "row_cache.hh"
 #include "sstables/index_reader.hh"
 #include "sstables/open_info.hh"
 #include "sstables/sstables_manager.hh"
@@ -166,7 +167,8 @@ Note: UDT is not supported for now.
 
             db::config dbcfg;
             gms::feature_service feature_service(gms::feature_config_from_db_config(dbcfg));
-            sstables::sstables_manager sst_man(large_data_handler, dbcfg, feature_service);
+            cache_tracker tracker;
+            sstables::sstables_manager sst_man(large_data_handler, dbcfg, feature_service, tracker);
 
             auto ed = sstables::entry_descriptor::make_descriptor(dir_path.c_str(), sst_filename.c_str());
             auto sst = sst_man.make_sstable(primary_key_schema, dir_path.c_str(), ed.generation, ed.version, ed.format);
@@ -206,7 +206,10 @@ class request_reader {
         PAGING_STATE,
         SERIAL_CONSISTENCY,
         TIMESTAMP,
-        NAMES_FOR_VALUES
+        NAMES_FOR_VALUES,
+        // Since protocol v5
+        KEYSPACE,
+        NOW_IN_SECONDS
     };
 
     using options_flag_enum = super_enum<options_flag,
@@ -216,7 +219,9 @@ class request_reader {
         options_flag::PAGING_STATE,
         options_flag::SERIAL_CONSISTENCY,
         options_flag::TIMESTAMP,
-        options_flag::NAMES_FOR_VALUES
+        options_flag::NAMES_FOR_VALUES,
+        options_flag::KEYSPACE,
+        options_flag::NOW_IN_SECONDS
     >;
 public:
     std::unique_ptr<cql3::query_options> read_options(uint8_t version, cql_serialization_format cql_ser_format, const timeout_config& timeouts, const cql3::cql_config& cql_config) {
@@ -228,7 +233,8 @@ class request_reader {
 
         assert(version >= 2);
 
-        auto flags = enum_set<options_flag_enum>::from_mask(read_byte());
+        // The flags grew from a [byte] to an [int] in v5.
+        auto flags = enum_set<options_flag_enum>::from_mask(version >= 5 ? uint32_t(read_int()) : read_byte());
         std::vector<cql3::raw_value_view> values;
         std::vector<sstring_view> names;
 
@@ -266,6 +272,13 @@ class request_reader {
                 }
             }
 
+            if (flags.contains<options_flag::KEYSPACE>()) {
+                throw exceptions::protocol_exception("Setting the keyspace of a request is not supported");
+            }
+            if (flags.contains<options_flag::NOW_IN_SECONDS>()) {
+                throw exceptions::protocol_exception("Setting the current time of a request is not supported");
+            }
+
             std::optional<std::vector<sstring_view>> onames;
             if (!names.empty()) {
                 onames = std::move(names);
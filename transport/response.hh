@@ -22,6 +22,7 @@
 #pragma once
 
 #include "server.hh"
+#include "segment.hh"
 #include "utils/reusable_buffer.hh"
 
 namespace cql_transport {
@@ -51,6 +52,8 @@ class response {
     cql_binary_opcode _opcode;
     uint8_t           _flags = 0; // a bitwise OR mask of zero or more cql_frame_flags values
     bytes_ostream _body;
+    // The header of the envelope, referred to by the segments carrying it.
+    sstring _envelope_header;
 public:
     template<typename T>
     class placeholder;
@@ -95,6 +98,10 @@ class response {
     // as the response object is alive.
     scattered_message<char> make_message(uint8_t version, cql_compression compression);
 
+    // Adds the envelope of the response to the segments of a v5 connection.
+    // The segments refer to the response, which must outlive them.
+    void encode_envelope(uint8_t version, segment_encoder& out);
+
     cql_binary_opcode opcode() const {
         return _opcode;
     }
@@ -120,7 +127,7 @@ class response {
     }
 
     sstring make_frame(uint8_t version, size_t length) {
-        if (version > 0x04) {
+        if (version > 0x05) {
             throw exceptions::protocol_exception(format("Invalid or unsupported protocol version: {:d}", version));
         }
 
@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <zlib.h>
+#include <lz4.h>
+
+#include <seastar/core/future-util.hh>
+
+#include "transport/segment.hh"
+#include "exceptions/exceptions.hh"
+
+namespace cql_transport {
+
+using namespace seastar;
+
+static constexpr uint32_t crc24_init = 0x875060;
+static constexpr uint32_t crc24_poly = 0x1974f0b;
+static constexpr unsigned uncompressed_header_size = 6;
+static constexpr unsigned compressed_header_size = 8;
+static constexpr unsigned payload_crc_size = 4;
+
+uint32_t segment_header_crc24(uint64_t header, unsigned length) {
+    uint32_t crc = crc24_init;
+    while (length--) {
+        crc ^= (header & 0xff) << 16;
+        header >>= 8;
+        for (int i = 0; i < 8; ++i) {
+            crc <<= 1;
+            if (crc & 0x1000000) {
+                crc ^= crc24_poly;
+            }
+        }
+    }
+    return crc;
+}
+
+uint32_t segment_payload_crc32(bytes_view payload) {
+    static const Bytef initial_bytes[] = { 0xfa, 0x2d, 0x55, 0xca };
+    auto crc = ::crc32(0, initial_bytes, sizeof(initial_bytes));
+    return ::crc32(crc, reinterpret_cast<const Bytef*>(payload.data()), payload.size());
+}
+
+static uint32_t segment_payload_crc32(const std::vector<bytes_view>& payload) {
+    static const Bytef initial_bytes[] = { 0xfa, 0x2d, 0x55, 0xca };
+    auto crc = ::crc32(0, initial_bytes, sizeof(initial_bytes));
+    for (bytes_view f : payload) {
+        crc = ::crc32(crc, reinterpret_cast<const Bytef*>(f.data()), f.size());
+    }
+    return crc;
+}
+
+static temporary_buffer<char> make_le(uint64_t v, unsigned size) {
+    temporary_buffer<char> buf(size);
+    auto p = buf.get_write();
+    for (unsigned i = 0; i < size; ++i) {
+        p[i] = char(v >> (8 * i));
+    }
+    return buf;
+}
+
+static uint64_t read_le(const char* p, unsigned size) {
+    uint64_t v = 0;
+    for (unsigned i = 0; i < size; ++i) {
+        v |= uint64_t(uint8_t(p[i])) << (8 * i);
+    }
+    return v;
+}
+
+// Segments are encoded synchronously, so all encoders of a shard can share
+// the buffers.
+static bytes& payload_buffer() {
+    static thread_local bytes buf(bytes::initialized_later(), max_segment_payload_size);
+    return buf;
+}
+
+static bytes& compression_buffer() {
+    static thread_local bytes buf(bytes::initialized_later(), LZ4_COMPRESSBOUND(max_segment_payload_size));
+    return buf;
+}
+
+segment_encoder::segment_encoder(bool compress)
+    : _compress(compress)
+{ }
+
+segment_encoder::segment segment_encoder::encode(planned_segment p) const {
+    segment s;
+    if (!_compress) {
+        uint64_t header = p.size | (uint64_t(p.self_contained) << 17);
+        s.header = make_le(header | (uint64_t(segment_header_crc24(header, 3)) << 24), uncompressed_header_size);
+        s.payload_crc = make_le(segment_payload_crc32(p.payload), payload_crc_size);
+        s.payload = std::move(p.payload);
+        return s;
+    }
+    // LZ4 compresses a contiguous buffer.
+    bytes_view input;
+    if (p.payload.size() == 1) {
+        input = p.payload.front();
+    } else {
+        auto& buf = payload_buffer();
+        auto out = buf.begin();
+        for (bytes_view f : p.payload) {
+            out = std::copy(f.begin(), f.end(), out);
+        }
+        input = bytes_view(buf.data(), p.size);
+    }
+    auto& buf = compression_buffer();
+#ifdef HAVE_LZ4_COMPRESS_DEFAULT
+    auto len = LZ4_compress_default(reinterpret_cast<const char*>(input.data()), reinterpret_cast<char*>(buf.data()), input.size(), buf.size());
+#else
+    auto len = LZ4_compress(reinterpret_cast<const char*>(input.data()), reinterpret_cast<char*>(buf.data()), input.size());
+#endif
+    uint64_t uncompressed_length = 0;
+    uint64_t payload_length = p.size;
+    if (len > 0 && size_t(len) < p.size) {
+        uncompressed_length = p.size;
+        payload_length = len;
+        s.compressed_payload = temporary_buffer<char>(reinterpret_cast<const char*>(buf.data()), len);
+        s.payload_crc = make_le(segment_payload_crc32(bytes_view(buf.data(), len)), payload_crc_size);
+    } else {
+        s.payload_crc = make_le(segment_payload_crc32(p.payload), payload_crc_size);
+        s.payload = std::move(p.payload);
+    }
+    uint64_t header = payload_length | (uncompressed_length << 17) | (uint64_t(p.self_contained) << 34);
+    s.header = make_le(header | (uint64_t(segment_header_crc24(header, 5)) << 40), compressed_header_size);
+    return s;
+}
+
+void segment_encoder::close_current() {
+    if (_current.size) {
+        _planned.push_back(std::exchange(_current, planned_segment()));
+    }
+}
+
+void segment_encoder::append(const std::vector<bytes_view>& envelope) {
+    size_t size = 0;
+    for (auto& f : envelope) {
+        size += f.size();
+    }
+    if (_current.size + size > max_segment_payload_size) {
+        close_current();
+    }
+    if (size <= max_segment_payload_size) {
+        for (auto& f : envelope) {
+            _current.payload.push_back(f);
+        }
+        _current.size += size;
+        return;
+    }
+    // Too large for a single segment, split into segments which are not self-contained.
+    planned_segment p;
+    p.self_contained = false;
+    for (auto f : envelope) {
+        while (!f.empty()) {
+            auto n = std::min(f.size(), max_segment_payload_size - p.size);
+            p.payload.push_back(f.substr(0, n));
+            p.size += n;
+            f.remove_prefix(n);
+            if (p.size == max_segment_payload_size) {
+                _planned.push_back(std::exchange(p, planned_segment()));
+                p.self_contained = false;
+            }
+        }
+    }
+    if (p.size) {
+        _planned.push_back(std::move(p));
+    }
+}
+
+void segment_encoder::flush() {
+    close_current();
+}
+
+std::optional<segment_encoder::segment> segment_encoder::next() {
+    if (_planned.empty()) {
+        return std::nullopt;
+    }
+    auto p = std::move(_planned.front());
+    _planned.pop_front();
+    return encode(std::move(p));
+}
+
+class segment_source final : public data_source_impl {
+    input_stream<char> _in;
+    bool _compressed;
+private:
+    static void check_crc32(const temporary_buffer<char>& buf, size_t payload_size) {
+        auto payload = bytes_view(reinterpret_cast<const int8_t*>(buf.get()), payload_size);
+        if (read_le(buf.get() + payload_size, payload_crc_size) != segment_payload_crc32(payload)) {
+            throw exceptions::protocol_exception("CQL segment payload CRC mismatch");
+        }
+    }
+
+    temporary_buffer<char> decompress(temporary_buffer<char> buf, size_t compressed_size, size_t uncompressed_size) {
+        temporary_buffer<char> out(uncompressed_size);
+        auto ret = LZ4_decompress_safe(buf.get(), out.get_write(), compressed_size, uncompressed_size);
+        if (ret < 0 || size_t(ret) != uncompressed_size) {
+            throw exceptions::protocol_exception("CQL segment LZ4 decompression failure");
+        }
+        return out;
+    }
+public:
+    segment_source(input_stream<char> in, bool compressed)
+        : _in(std::move(in))
+        , _compressed(compressed)
+    { }
+
+    virtual future<temporary_buffer<char>> get() override {
+        auto header_size = _compressed ? compressed_header_size : uncompressed_header_size;
+        return _in.read_exactly(header_size).then([this, header_size] (temporary_buffer<char> h) {
+            if (h.empty()) {
+                return make_ready_future<temporary_buffer<char>>();
+            }
+            if (h.size() != header_size) {
+                throw exceptions::protocol_exception("Truncated CQL segment header");
+            }
+            auto header_length = header_size - 3;
+            auto header = read_le(h.get(), header_length);
+            if (read_le(h.get() + header_length, 3) != segment_header_crc24(header, header_length)) {
+                throw exceptions::protocol_exception("CQL segment header CRC mismatch");
+            }
+            size_t payload_size = header & max_segment_payload_size;
+            size_t uncompressed_size = _compressed ? (header >> 17) & max_segment_payload_size : 0;
+            return _in.read_exactly(payload_size + payload_crc_size).then([this, payload_size, uncompressed_size] (temporary_buffer<char> buf) {
+                if (buf.size() != payload_size + payload_crc_size) {
+                    throw exceptions::protocol_exception("Truncated CQL segment");
+                }
+                check_crc32(buf, payload_size);
+                if (uncompressed_size) {
+                    buf = decompress(std::move(buf), payload_size, uncompressed_size);
+                } else {
+                    buf.trim(payload_size);
+                }
+                if (buf.empty()) {
+                    // An empty buffer would be taken for the end of stream.
+                    return get();
+                }
+                return make_ready_future<temporary_buffer<char>>(std::move(buf));
+            });
+        });
+    }
+
+    virtual future<> close() override {
+        return _in.close();
+    }
+};
+
+input_stream<char> make_segment_input_stream(input_stream<char> in, bool compressed) {
+    return input_stream<char>(data_source(std::make_unique<segment_source>(std::move(in), compressed)));
+}
+
+}
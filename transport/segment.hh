@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <deque>
+#include <optional>
+#include <vector>
+
+#include <seastar/core/iostream.hh>
+#include <seastar/core/temporary_buffer.hh>
+
+#include "bytes.hh"
+
+namespace cql_transport {
+
+// Framing layer of native protocol v5.
+//
+// Once a v5 connection is established (the server responded to STARTUP with
+// READY or AUTHENTICATE), envelopes (what the older versions call frames) are
+// no longer sent on their own but in segments. A segment carries either one or
+// more complete envelopes (it is "self-contained") or a part of an envelope too
+// large to fit into a single segment. Segment headers are protected by a
+// CRC24 and payloads by a CRC32. When LZ4 compression was negotiated, the
+// payload of a segment is compressed as a whole, so many small envelopes share
+// a single compression call.
+//
+// Segment layout, all integers little endian:
+//
+//   uncompressed: [payload length:17 | self-contained:1 | padding:6] [CRC24:24]
+//                 [payload] [CRC32 of payload:32]
+//   compressed:   [compressed length:17 | uncompressed length:17 | self-contained:1 | padding:5] [CRC24:24]
+//                 [payload] [CRC32 of payload:32]
+//
+// A compressed segment with an uncompressed length of 0 carries its payload
+// uncompressed, which is used when compression doesn't make it smaller.
+
+constexpr size_t max_segment_payload_size = 128 * 1024 - 1;
+
+uint32_t segment_header_crc24(uint64_t header, unsigned length);
+uint32_t segment_payload_crc32(bytes_view payload);
+
+// Packs envelopes into segments.
+//
+// The envelopes are not copied: uncompressed segments refer to the envelope
+// fragments they carry, so those must stay valid until the segments are
+// written out. Segments are checksummed and compressed one at a time by next(),
+// so that the caller can yield between them.
+class segment_encoder {
+public:
+    struct segment {
+        // The header, with its CRC24.
+        seastar::temporary_buffer<char> header;
+        // The compressed payload. Empty if the payload is sent as it is.
+        seastar::temporary_buffer<char> compressed_payload;
+        // The payload as it is, if it isn't compressed.
+        std::vector<bytes_view> payload;
+        // The CRC32 of the payload, as sent.
+        seastar::temporary_buffer<char> payload_crc;
+    };
+private:
+    struct planned_segment {
+        std::vector<bytes_view> payload;
+        size_t size = 0;
+        bool self_contained = true;
+    };
+    bool _compress;
+    // The self-contained segment being filled.
+    planned_segment _current;
+    std::deque<planned_segment> _planned;
+private:
+    void close_current();
+    segment encode(planned_segment p) const;
+public:
+    explicit segment_encoder(bool compress);
+
+    // Adds an envelope, given as its fragments.
+    void append(const std::vector<bytes_view>& envelope);
+
+    // Closes the self-contained segment being filled, so that next() returns it.
+    void flush();
+
+    // Encodes the next complete segment, or returns a disengaged optional if
+    // there is none.
+    std::optional<segment> next();
+};
+
+// Returns a stream of the envelope bytes carried by the segments read from in.
+// Throws exceptions::protocol_exception on a corrupted segment.
+seastar::input_stream<char> make_segment_input_stream(seastar::input_stream<char> in, bool compressed);
+
+}
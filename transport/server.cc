@@ -382,7 +382,8 @@ cql_server::connection::parse_frame(temporary_buffer<char> buf) const {
         break;
     }
     case 3:
-    case 4: {
+    case 4:
+    case 5: {
         v3 = net::ntoh(*reinterpret_cast<const cql_binary_frame_v3*>(buf.get()));
         break;
     }
@@ -408,7 +409,7 @@ cql_server::connection::read_frame() {
             }
             _version = buf[0];
             init_cql_serialization_format();
-            if (_version < 1 || _version > current_version) {
+            if (_version < 1 || _version > _server.max_version()) {
                 auto client_version = _version;
                 _version = current_version;
                 throw exceptions::protocol_exception(format("Invalid or unsupported protocol version: {:d}", client_version));
@@ -716,7 +717,10 @@ future<> cql_server::connection::process_request() {
             // Replacing the immediately-invoked lambda below with just its body costs 5-10 usec extra per invocation.
             // Cause not understood.
             auto istream = buf.get_istream();
-            (void)_process_request_stage(this, istream, op, stream, seastar::ref(_client_state), tracing_requested, mem_permit)
+            // The response to STARTUP may switch a v5 connection to segments, so
+            // the next envelope can't be read before the response is produced.
+            bool may_start_segments = _version >= v5 && !_segmented && op == uint8_t(cql_binary_opcode::STARTUP);
+            auto f = _process_request_stage(this, istream, op, stream, seastar::ref(_client_state), tracing_requested, mem_permit)
                     .then_wrapped([this, buf = std::move(buf), mem_permit, leave = std::move(leave)] (future<foreign_ptr<std::unique_ptr<cql_server::response>>> response_f) mutable {
                 try {
                     write_response(std::move(response_f.get0()), std::move(mem_permit), _compression);
@@ -726,6 +730,14 @@ future<> cql_server::connection::process_request() {
                 }
             });
 
+            if (may_start_segments) {
+                return f.then([this] {
+                    if (_segmented) {
+                        _read_buf = make_segment_input_stream(std::move(_read_buf), _compression == cql_compression::lz4);
+                    }
+                });
+            }
+            (void)f;
             return make_ready_future<>();
           });
         });
@@ -761,6 +773,9 @@ future<fragmented_temporary_buffer> cql_server::connection::read_and_decompress_
 {
     using namespace compression_buffers;
     if (flags & cql_frame_flags::compression) {
+        if (_version >= v5) {
+            throw exceptions::protocol_exception("Compressed envelopes are not allowed in protocol v5, compression applies to segments");
+        }
         if (_compression == cql_compression::lz4) {
             if (length < 4) {
                 throw std::runtime_error("Truncated frame");
@@ -819,6 +834,9 @@ future<std::unique_ptr<cql_server::response>> cql_server::connection::process_st
          if (compression == "lz4") {
              _compression = cql_compression::lz4;
          } else if (compression == "snappy") {
+             if (_version >= v5) {
+                 throw exceptions::protocol_exception("Snappy compression is not supported in protocol v5");
+             }
              _compression = cql_compression::snappy;
          } else {
              throw exceptions::protocol_exception(format("Unknown compression algorithm: {}", compression));
@@ -986,11 +1004,20 @@ cql_server::connection::process_query(uint16_t stream, request_reader in, servic
     return process(stream, in, client_state, std::move(permit), std::move(trace_state), process_query_internal);
 }
 
+// PREPARE flag of protocol v5.
+static constexpr int32_t prepare_with_keyspace_flag = 0x01;
+
 future<std::unique_ptr<cql_server::response>> cql_server::connection::process_prepare(uint16_t stream, request_reader in, service::client_state& client_state,
         tracing::trace_state_ptr trace_state) {
     ++_server._stats.prepare_requests;
 
     auto query = sstring(in.read_long_string_view());
+    if (_version >= v5) {
+        auto flags = in.read_int();
+        if (flags & prepare_with_keyspace_flag) {
+            throw exceptions::protocol_exception("Setting the keyspace of a PREPARE message is not supported");
+        }
+    }
 
     tracing::add_query(trace_state, query);
     tracing::begin(trace_state, "Preparing CQL3 query", client_state.get_client_address());
@@ -1024,6 +1051,12 @@ process_execute_internal(service::client_state& client_state, distributed<cql3::
     cql3::prepared_cache_key_type cache_key(in.read_short_bytes());
     auto& id = cql3::prepared_cache_key_type::cql_id(cache_key);
     bool needs_authorization = false;
+    if (version >= 5) {
+        // Prepared statements are invalidated when their schema changes, so the
+        // result metadata of a statement never changes and the client's copy
+        // of it is always up to date.
+        in.read_short_bytes();
+    }
 
     // First, try to lookup in the cache of already authorized statements. If the corresponding entry is not found there
     // look for the prepared statement and then authorize it.
@@ -1264,6 +1297,16 @@ std::unique_ptr<cql_server::response> cql_server::connection::make_read_timeout_
     return response;
 }
 
+void cql_server::connection::write_failures(cql_server::response& response, int32_t numfailures) const {
+    if (_version < v5) {
+        response.write_int(numfailures);
+        return;
+    }
+    // v5 replaces the number of failures with a map from the failed replicas
+    // to their failure reasons, which we don't track. Send an empty map.
+    response.write_int(0);
+}
+
 std::unique_ptr<cql_server::response> cql_server::connection::make_read_failure_error(int16_t stream, exceptions::exception_code err, sstring msg, db::consistency_level cl, int32_t received, int32_t numfailures, int32_t blockfor, bool data_present, const tracing::trace_state_ptr& tr_state) const
 {
     if (_version < 4) {
@@ -1275,7 +1318,7 @@ std::unique_ptr<cql_server::response> cql_server::connection::make_read_failure_
     response->write_consistency(cl);
     response->write_int(received);
     response->write_int(blockfor);
-    response->write_int(numfailures);
+    write_failures(*response, numfailures);
     response->write_byte(data_present);
     return response;
 }
@@ -1303,7 +1346,7 @@ std::unique_ptr<cql_server::response> cql_server::connection::make_mutation_writ
     response->write_consistency(cl);
     response->write_int(received);
     response->write_int(blockfor);
-    response->write_int(numfailures);
+    write_failures(*response, numfailures);
     response->write_string(format("{}", type));
     return response;
 }
@@ -1418,6 +1461,11 @@ class cql_server::fmt_visitor : public messages::result_message::visitor_base {
     virtual void visit(const messages::result_message::prepared::cql& m) override {
         _response.write_int(0x0004);
         _response.write_short_bytes(m.get_id());
+        if (_version >= 5) {
+            // The result metadata id. The statement id identifies the result
+            // metadata too, see process_execute_internal().
+            _response.write_short_bytes(m.get_id());
+        }
         _response.write(m.metadata(), _version);
         if (_version > 1) {
             _response.write(*m.result_metadata());
@@ -1511,6 +1559,21 @@ cql_server::connection::make_schema_change_event(const event::schema_change& eve
 
 void cql_server::connection::write_response(foreign_ptr<std::unique_ptr<cql_server::response>>&& response, service_permit permit, cql_compression compression)
 {
+    if (_segmented) {
+        _pending_responses.push_back(std::move(response));
+        _ready_to_respond = _ready_to_respond.then([this, permit = std::move(permit)] {
+            return write_pending_segments();
+        });
+        return;
+    }
+    bool start_segments = false;
+    if (_version >= v5) {
+        // Segments are compressed as a whole, envelopes never are. The response
+        // to STARTUP is the last envelope sent on its own, unless it is an error.
+        compression = cql_compression::none;
+        auto op = response->opcode();
+        start_segments = op == cql_binary_opcode::READY || op == cql_binary_opcode::AUTHENTICATE;
+    }
     _ready_to_respond = _ready_to_respond.then([this, compression, response = std::move(response), permit = std::move(permit)] () mutable {
         auto message = response->make_message(_version, compression);
         message.on_delete([response = std::move(response)] { });
@@ -1518,6 +1581,50 @@ void cql_server::connection::write_response(foreign_ptr<std::unique_ptr<cql_serv
             return _write_buf.flush();
         });
     });
+    _segmented = start_segments;
+}
+
+future<> cql_server::connection::write_pending_segments() {
+    if (_pending_responses.empty()) {
+        // Written together with an earlier response.
+        return make_ready_future<>();
+    }
+    // Pack all responses which became ready while the previous write was in
+    // progress into as few segments as possible. The segments refer to the
+    // bodies of the responses, so the responses are kept until all of them
+    // are sent.
+    auto responses = make_lw_shared(std::exchange(_pending_responses, {}));
+    segment_encoder encoder(_compression == cql_compression::lz4);
+    for (auto& response : *responses) {
+        response->encode_envelope(_version, encoder);
+    }
+    encoder.flush();
+    // Segments are encoded one at a time, so that checksumming and
+    // compressing large responses can be preempted.
+    return do_with(std::move(encoder), [this, responses = std::move(responses)] (segment_encoder& encoder) {
+        return repeat([this, &encoder, responses] {
+            auto segment = encoder.next();
+            if (!segment) {
+                return make_ready_future<stop_iteration>(stop_iteration::yes);
+            }
+            scattered_message<char> message;
+            message.append(std::move(segment->header));
+            if (segment->compressed_payload) {
+                message.append(std::move(segment->compressed_payload));
+            } else {
+                for (bytes_view fragment : segment->payload) {
+                    message.append_static(reinterpret_cast<const char*>(fragment.data()), fragment.size());
+                }
+            }
+            message.append(std::move(segment->payload_crc));
+            message.on_delete([responses] { });
+            return _write_buf.write(std::move(message)).then([] {
+                return stop_iteration::no;
+            });
+        }).then([this] {
+            return _write_buf.flush();
+        });
+    });
 }
 
 scattered_message<char> cql_server::response::make_message(uint8_t version, cql_compression compression) {
@@ -1533,6 +1640,16 @@ scattered_message<char> cql_server::response::make_message(uint8_t version, cql_
     return msg;
 }
 
+void cql_server::response::encode_envelope(uint8_t version, segment_encoder& out) {
+    _envelope_header = make_frame(version, _body.size());
+    std::vector<bytes_view> envelope;
+    envelope.emplace_back(reinterpret_cast<const int8_t*>(_envelope_header.data()), _envelope_header.size());
+    for (bytes_view fragment : _body.fragments()) {
+        envelope.push_back(fragment);
+    }
+    out.append(envelope);
+}
+
 void cql_server::response::compress(cql_compression compression)
 {
     switch (compression) {
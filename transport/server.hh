@@ -113,6 +113,7 @@ struct cql_server_config {
     std::optional<uint16_t> shard_aware_transport_port;
     std::optional<uint16_t> shard_aware_transport_port_ssl;
     bool allow_shard_aware_drivers = true;
+    bool allow_protocol_v5 = false;
     smp_service_group bounce_request_smp_service_group = default_smp_service_group();
 };
 
@@ -143,6 +144,7 @@ class cql_server : public seastar::peering_sharded_service<cql_server> {
     class event_notifier;
 
     static constexpr cql_protocol_version_type current_version = cql_serialization_format::latest_version;
+    static constexpr cql_protocol_version_type v5 = 5;
 
     std::vector<server_socket> _listeners;
     distributed<cql3::query_processor>& _query_processor;
@@ -180,6 +182,10 @@ class cql_server : public seastar::peering_sharded_service<cql_server> {
         future<> _ready_to_respond = make_ready_future<>();
         cql_protocol_version_type _version = 0;
         cql_compression _compression = cql_compression::none;
+        // Set once a v5 connection switched to sending and receiving segments.
+        bool _segmented = false;
+        // Responses waiting to be packed into segments.
+        std::vector<foreign_ptr<std::unique_ptr<cql_server::response>>> _pending_responses;
         cql_serialization_format _cql_serialization_format = cql_serialization_format::latest();
         service::client_state _client_state;
         std::unordered_map<uint16_t, cql_query_state> _query_states;
@@ -230,6 +236,7 @@ class cql_server : public seastar::peering_sharded_service<cql_server> {
 
         std::unique_ptr<cql_server::response> make_unavailable_error(int16_t stream, exceptions::exception_code err, sstring msg, db::consistency_level cl, int32_t required, int32_t alive, const tracing::trace_state_ptr& tr_state) const;
         std::unique_ptr<cql_server::response> make_read_timeout_error(int16_t stream, exceptions::exception_code err, sstring msg, db::consistency_level cl, int32_t received, int32_t blockfor, bool data_present, const tracing::trace_state_ptr& tr_state) const;
+        void write_failures(cql_server::response& response, int32_t numfailures) const;
         std::unique_ptr<cql_server::response> make_read_failure_error(int16_t stream, exceptions::exception_code err, sstring msg, db::consistency_level cl, int32_t received, int32_t numfailures, int32_t blockfor, bool data_present, const tracing::trace_state_ptr& tr_state) const;
         std::unique_ptr<cql_server::response> make_mutation_write_timeout_error(int16_t stream, exceptions::exception_code err, sstring msg, db::consistency_level cl, int32_t received, int32_t blockfor, db::write_type type, const tracing::trace_state_ptr& tr_state) const;
         std::unique_ptr<cql_server::response> make_mutation_write_failure_error(int16_t stream, exceptions::exception_code err, sstring msg, db::consistency_level cl, int32_t received, int32_t numfailures, int32_t blockfor, db::write_type type, const tracing::trace_state_ptr& tr_state) const;
@@ -256,6 +263,7 @@ class cql_server : public seastar::peering_sharded_service<cql_server> {
                 service_permit permit, tracing::trace_state_ptr trace_state, Process process_fn);
 
         void write_response(foreign_ptr<std::unique_ptr<cql_server::response>>&& response, service_permit permit = empty_service_permit(), cql_compression compression = cql_compression::none);
+        future<> write_pending_segments();
 
         void init_cql_serialization_format();
 
@@ -281,6 +289,9 @@ class cql_server : public seastar::peering_sharded_service<cql_server> {
         }
     }
     const ::timeout_config& timeout_config() { return _config.timeout_config; }
+    cql_protocol_version_type max_version() const {
+        return _config.allow_protocol_v5 ? v5 : current_version;
+    }
 };
 
 class cql_server::event_notifier : public service::migration_listener,
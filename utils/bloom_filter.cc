@@ -49,6 +49,14 @@
 #include <array>
 #include <cstdlib>
 #include "bloom_filter.hh"
+#include <cmath>
+
+#ifdef __x86_64__
+#include <x86intrin.h>
+#define arch_target(name) [[gnu::target(name)]]
+#else
+#define arch_target(name)
+#endif
 
 namespace utils {
 namespace filter {
@@ -99,5 +107,107 @@ filter_ptr create_filter(int hash, int64_t num_elements, int buckets_per, filter
     large_bitset bitset(num_bits);
     return std::make_unique<murmur3_bloom_filter>(hash, std::move(bitset), format);
 }
+
+// Odd constants used to derive the bit of each 32-bit lane of a block from the key,
+// the same ones as in the Parquet split block bloom filter.
+static constexpr uint32_t split_block_salt[8] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U,
+};
+
+// Lane i of a block is bits [32 * (i % 2), 32 * (i % 2) + 32) of word i / 2.
+static inline uint64_t split_block_word_mask(uint32_t key, unsigned word) {
+    uint64_t lo = uint64_t(1) << ((key * split_block_salt[2 * word]) >> 27);
+    uint64_t hi = uint64_t(1) << ((key * split_block_salt[2 * word + 1]) >> 27);
+    return lo | (hi << 32);
+}
+
+arch_target("default") bool split_block_check(const uint64_t* block, uint32_t key) {
+    for (unsigned i = 0; i < split_block_bloom_filter::words_per_block; i++) {
+        auto mask = split_block_word_mask(key, i);
+        if ((block[i] & mask) != mask) {
+            return false;
+        }
+    }
+    return true;
+}
+
+arch_target("default") void split_block_insert(uint64_t* block, uint32_t key) {
+    for (unsigned i = 0; i < split_block_bloom_filter::words_per_block; i++) {
+        block[i] |= split_block_word_mask(key, i);
+    }
+}
+
+#ifdef __x86_64__
+
+// On little endian the 32-bit lanes of the vector are laid out
+// the same way as in split_block_word_mask().
+arch_target("avx2") static inline __m256i split_block_mask(uint32_t key) {
+    const __m256i salt = _mm256_setr_epi32(
+            split_block_salt[0], split_block_salt[1], split_block_salt[2], split_block_salt[3],
+            split_block_salt[4], split_block_salt[5], split_block_salt[6], split_block_salt[7]);
+    // 1. Multiply the key by all salts at once and take the top 5 bits of each lane
+    __m256i bit = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(key), salt), 27);
+    // 2. Turn bit numbers into single-bit masks
+    return _mm256_sllv_epi32(_mm256_set1_epi32(1), bit);
+}
+
+arch_target("avx2") bool split_block_check(const uint64_t* block, uint32_t key) {
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+    // True iff all bits set in the mask are also set in the block
+    return _mm256_testc_si256(b, split_block_mask(key));
+}
+
+arch_target("avx2") void split_block_insert(uint64_t* block, uint32_t key) {
+    auto p = reinterpret_cast<__m256i*>(block);
+    _mm256_storeu_si256(p, _mm256_or_si256(_mm256_loadu_si256(p), split_block_mask(key)));
+}
+
+#endif
+
+split_block_bloom_filter::split_block_bloom_filter(utils::chunked_vector<uint64_t> words)
+    : _words(std::move(words))
+    , _num_blocks(_words.size() / words_per_block)
+{
+    static_assert(128 * 1024 % (words_per_block * sizeof(uint64_t)) == 0, "Blocks must not straddle chunks");
+    assert(_num_blocks && _words.size() % words_per_block == 0);
+}
+
+bool split_block_bloom_filter::is_present(hashed_key key) {
+    auto h = key.hash();
+    return split_block_check(block_for(h[0]), static_cast<uint32_t>(h[1]));
+}
+
+bool split_block_bloom_filter::is_present(const bytes_view& key) {
+    return is_present(make_hashed_key(key));
+}
+
+void split_block_bloom_filter::add(const bytes_view& key) {
+    auto h = make_hashed_key(key).hash();
+    split_block_insert(block_for(h[0]), static_cast<uint32_t>(h[1]));
+}
+
+void split_block_bloom_filter::clear() {
+    std::fill(_words.begin(), _words.end(), 0);
+}
+
+size_t split_block_bloom_filter::words_for(int64_t num_elements, double max_false_pos_probability) {
+    // With 8 bits set per key within a block, the false positive ratio is about
+    // (1 - exp(-8 / bits_per_key))^8, ignoring the variance of the block load,
+    // which matters only for very low ratios.
+    double bits_per_key = -8.0 / std::log1p(-std::pow(max_false_pos_probability, 1.0 / 8));
+    auto num_bits = static_cast<uint64_t>(std::ceil(std::max<int64_t>(num_elements, 1) * bits_per_key));
+    auto num_blocks = std::max<uint64_t>(align_up<uint64_t>(num_bits, bits_per_block) / bits_per_block, 1);
+    return num_blocks * words_per_block;
+}
+
+filter_ptr create_split_block_filter(utils::chunked_vector<uint64_t>&& words) {
+    return std::make_unique<split_block_bloom_filter>(std::move(words));
+}
+
+filter_ptr create_split_block_filter(int64_t num_elements, double max_false_pos_probability) {
+    utils::chunked_vector<uint64_t> words(split_block_bloom_filter::words_for(num_elements, max_false_pos_probability), 0);
+    return create_split_block_filter(std::move(words));
+}
 }
 }
@@ -28,7 +28,25 @@
 namespace utils {
 static logging::logger filterlog("bloom_filter");
 
-filter_ptr i_filter::get_filter(int64_t num_elements, double max_false_pos_probability, filter_format fformat) {
+std::ostream& operator<<(std::ostream& os, filter_type type) {
+    switch (type) {
+    case filter_type::classic: return os << "classic";
+    case filter_type::split_block: return os << "split_block";
+    }
+    abort();
+}
+
+filter_type filter_type_from_string(std::string_view s) {
+    if (s == "classic") {
+        return filter_type::classic;
+    }
+    if (s == "split_block") {
+        return filter_type::split_block;
+    }
+    throw std::invalid_argument(format("Invalid bloom filter type '{}': must be one of 'classic', 'split_block'", s));
+}
+
+filter_ptr i_filter::get_filter(int64_t num_elements, double max_false_pos_probability, filter_format fformat, filter_type type) {
     assert(seastar::thread::running_in_thread());
 
     if (max_false_pos_probability > 1.0) {
@@ -39,6 +57,10 @@ filter_ptr i_filter::get_filter(int64_t num_elements, double max_false_pos_proba
         return std::make_unique<filter::always_present_filter>();
     }
 
+    if (type == filter_type::split_block) {
+        return filter::create_split_block_filter(num_elements, max_false_pos_probability);
+    }
+
     int buckets_per_element = bloom_calculations::max_buckets_per_element(num_elements);
     auto spec = bloom_calculations::compute_bloom_spec(buckets_per_element, max_false_pos_probability);
     return filter::create_filter(spec.K, num_elements, spec.buckets_per_element, fformat);
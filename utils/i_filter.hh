@@ -53,6 +53,17 @@ enum class filter_format {
     m_format,
 };
 
+// How the bits of a key are laid out in the filter.
+enum class filter_type {
+    // Each of the K bits of a key goes to a random position in the whole bitmap.
+    classic,
+    // All bits of a key fall into a single 256-bit block, see split_block_bloom_filter.
+    split_block,
+};
+
+std::ostream& operator<<(std::ostream& os, filter_type);
+filter_type filter_type_from_string(std::string_view);
+
 class hashed_key {
 private:
     std::array<uint64_t, 2> _hash;
@@ -83,6 +94,7 @@ struct i_filter {
      *         Asserts that the given probability can be satisfied using this
      *         filter.
      */
-    static filter_ptr get_filter(int64_t num_elements, double max_false_pos_prob, filter_format format);
+    static filter_ptr get_filter(int64_t num_elements, double max_false_pos_prob, filter_format format,
+                                 filter_type type = filter_type::classic);
 };
 }
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "utils/iblt.hh"
+
+namespace utils {
+
+// The splitmix64 finalizer. Keys are usually hashes already, but the cell
+// indexes and the checksum have to be independent of each other.
+static uint64_t mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+static uint64_t cell_hash(uint64_t key, unsigned i) {
+    return mix(key + 0x9e3779b97f4a7c15ULL * (i + 1));
+}
+
+static uint64_t check_hash(uint64_t key) {
+    return mix(key ^ 0x5851f42d4c957f2dULL);
+}
+
+static bool is_pure(const iblt::cell& c) {
+    return (c.count == 1 || c.count == -1) && c.hash_sum == check_hash(c.key_sum);
+}
+
+iblt::iblt(size_t nr_cells)
+    : _cells(std::max<size_t>((nr_cells + hash_count - 1) / hash_count, 1) * hash_count)
+{ }
+
+iblt::iblt(std::vector<cell> cells)
+    : _cells(std::move(cells))
+{
+    if (_cells.empty() || _cells.size() % hash_count) {
+        throw std::invalid_argument("iblt: the number of cells must be a positive multiple of the hash count");
+    }
+}
+
+size_t iblt::cells_for(size_t expected_difference) {
+    // Peeling a 3-hypergraph succeeds with high probability above ~1.23 cells
+    // per key, small tables need more slack. Fallback to the full set is
+    // expensive, so err on the side of a larger table.
+    return 2 * expected_difference + 16 * hash_count;
+}
+
+void iblt::update(uint64_t key, int32_t count) {
+    auto sub = subtable_size();
+    auto check = check_hash(key);
+    for (unsigned i = 0; i < hash_count; ++i) {
+        auto& c = _cells[i * sub + cell_hash(key, i) % sub];
+        c.count += count;
+        c.key_sum ^= key;
+        c.hash_sum ^= check;
+    }
+}
+
+void iblt::subtract(const iblt& other) {
+    if (_cells.size() != other._cells.size()) {
+        throw std::invalid_argument("iblt: cannot subtract tables of different sizes");
+    }
+    for (size_t i = 0; i < _cells.size(); ++i) {
+        _cells[i].count -= other._cells[i].count;
+        _cells[i].key_sum ^= other._cells[i].key_sum;
+        _cells[i].hash_sum ^= other._cells[i].hash_sum;
+    }
+}
+
+std::optional<iblt::difference> iblt::decode() const {
+    iblt t(*this);
+    difference diff;
+    std::vector<size_t> pure;
+    for (size_t i = 0; i < t._cells.size(); ++i) {
+        if (is_pure(t._cells[i])) {
+            pure.push_back(i);
+        }
+    }
+    auto sub = t.subtable_size();
+    // Each peeled key empties at least one cell, so a table can't hold more
+    // keys than cells. Bounds the work if a cell only looks pure.
+    size_t peeled = 0;
+    while (!pure.empty()) {
+        auto& c = t._cells[pure.back()];
+        pure.pop_back();
+        if (!is_pure(c)) {
+            continue;
+        }
+        if (++peeled > t._cells.size()) {
+            return std::nullopt;
+        }
+        auto key = c.key_sum;
+        auto count = c.count;
+        (count > 0 ? diff.added : diff.removed).push_back(key);
+        t.update(key, -count);
+        for (unsigned i = 0; i < hash_count; ++i) {
+            auto idx = i * sub + cell_hash(key, i) % sub;
+            if (is_pure(t._cells[idx])) {
+                pure.push_back(idx);
+            }
+        }
+    }
+    for (auto& c : t._cells) {
+        if (!c.empty()) {
+            return std::nullopt;
+        }
+    }
+    return diff;
+}
+
+}
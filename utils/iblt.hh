@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace utils {
+
+// Invertible bloom lookup table of 64-bit keys.
+//
+// Used for set reconciliation: each side inserts its keys into a table of the
+// same size, one table is subtracted from the other and decoding the result
+// lists the keys present on only one side. The size of the table is
+// proportional to the size of the difference, not to the size of the sets.
+//
+// Decoding succeeds with high probability as long as the table has at least
+// cells_for(d) cells, where d is the size of the difference, and fails
+// (rather than returning wrong keys) otherwise.
+class iblt {
+public:
+    // Number of cells each key is inserted into.
+    static constexpr unsigned hash_count = 3;
+
+    struct cell {
+        int32_t count = 0;
+        uint64_t key_sum = 0;
+        uint64_t hash_sum = 0;
+
+        bool empty() const {
+            return count == 0 && key_sum == 0 && hash_sum == 0;
+        }
+    };
+
+    struct difference {
+        // Keys present in this table but not in the subtracted one.
+        std::vector<uint64_t> added;
+        // Keys present in the subtracted table but not in this one.
+        std::vector<uint64_t> removed;
+    };
+private:
+    // The cells are split into hash_count sub-tables of equal size,
+    // key is inserted into one cell of each of them.
+    std::vector<cell> _cells;
+private:
+    size_t subtable_size() const {
+        return _cells.size() / hash_count;
+    }
+    void update(uint64_t key, int32_t count);
+public:
+    // nr_cells is rounded up to a multiple of hash_count.
+    explicit iblt(size_t nr_cells);
+    // Throws std::invalid_argument if the number of cells is not a positive multiple of hash_count.
+    explicit iblt(std::vector<cell> cells);
+
+    // Returns the number of cells needed to decode a difference of up to expected_difference keys.
+    static size_t cells_for(size_t expected_difference);
+
+    void insert(uint64_t key) {
+        update(key, 1);
+    }
+    void erase(uint64_t key) {
+        update(key, -1);
+    }
+
+    // Subtracts the other table cell by cell.
+    // Throws std::invalid_argument if the tables have different sizes.
+    void subtract(const iblt& other);
+
+    // Lists the keys which were inserted but not erased (or subtracted), and vice versa.
+    // Returns a disengaged optional when the table is too small for the difference.
+    std::optional<difference> decode() const;
+
+    const std::vector<cell>& cells() const {
+        return _cells;
+    }
+    size_t size() const {
+        return _cells.size();
+    }
+};
+
+}
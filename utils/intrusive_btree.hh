@@ -0,0 +1,1006 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <boost/intrusive/parent_from_member.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <array>
+#include <utility>
+#include <type_traits>
+#include "utils/allocation_strategy.hh"
+
+/*
+ * Intrusive B-tree.
+ *
+ * This is the intrusive sibling of the bplus::tree from utils/bptree.hh.
+ * Elements are not copied into the tree, instead each element embeds
+ * a member_hook and the tree nodes keep pointers to the hooks. Unlike
+ * the B+ tree, keys live in both inner and leaf nodes, so no separation
+ * keys are duplicated and there's exactly one slot per element.
+ *
+ * The tree is intended to be a drop-in replacement for a red-black tree
+ * with an external comparator (intrusive_set_external_comparator.hh),
+ * in particular
+ *
+ *  - the comparator is passed to every lookup method, not stored in the tree
+ *  - iterators point to elements, not to node slots, so they are not
+ *    invalidated by insertions or removals of other elements
+ *  - the hook unlinks the element from the tree when destroyed
+ *  - elements and nodes can be moved by LSA, the hook and the node move
+ *    constructors update all the back-references
+ *
+ * Compared to the rb-tree the hook is one pointer instead of three, and the
+ * lookup touches a few densely packed nodes instead of every element on the
+ * path from the root.
+ *
+ * Inserting may allocate nodes and thus may throw. All the allocations are
+ * done before the tree is modified, so on exception the tree is left intact.
+ * Removal never allocates and is noexcept.
+ */
+
+namespace intrusive_b {
+
+/*
+ * The comparator is arbitrary (and usually needs a schema), so the
+ * intra-node search cannot be vectorized like in the bplus::tree. The
+ * linear scan wins on the node size used here, binary is for testing.
+ */
+enum class key_search { linear, binary };
+
+class node;
+class inner_node;
+class tree_base;
+
+class member_hook {
+    friend class node;
+    friend class inner_node;
+    friend class tree_base;
+
+    node* _node = nullptr;
+public:
+    member_hook() noexcept = default;
+    member_hook(const member_hook&) = delete;
+    member_hook& operator=(const member_hook&) = delete;
+    member_hook& operator=(member_hook&&) = delete;
+    member_hook(member_hook&& o) noexcept;
+    ~member_hook();
+
+    bool is_linked() const noexcept { return _node != nullptr; }
+
+    // Removes the element from the tree it belongs to.
+    void unlink() noexcept;
+
+    // Neighbours in the tree order, nullptr when there are none.
+    const member_hook* next() const noexcept;
+    const member_hook* prev() const noexcept;
+
+    // Walks up to the root node, O(depth)
+    const tree_base* tree_slow() const noexcept;
+};
+
+class node {
+    friend class member_hook;
+    friend class inner_node;
+    friend class tree_base;
+
+public:
+    /*
+     * Leaf node with this many keys fits into two cache lines: 16 bytes
+     * of header and 14 key pointers take exactly 128 bytes. A split of
+     * max_keys + 1 keys produces two nodes with at least min_keys.
+     */
+    static constexpr size_t max_keys = 14;
+    static constexpr size_t min_keys = max_keys / 2;
+
+private:
+    static constexpr uint16_t NODE_ROOT = 0x1;
+    static constexpr uint16_t NODE_LEAF = 0x2;
+
+    /*
+     * The root node points to the tree object, so that the tree->_root
+     * can be updated on node move.
+     */
+    union {
+        node* _parent;
+        tree_base* _tree;
+    };
+    uint16_t _num_keys;
+    uint16_t _flags;
+    member_hook* _keys[max_keys];
+
+public:
+    explicit node(uint16_t flags) noexcept : _parent(nullptr), _num_keys(0), _flags(flags) { }
+    node(const node&) = delete;
+    node(node&& o) noexcept;
+    ~node() {
+        assert(_num_keys == 0);
+    }
+
+    bool is_root() const noexcept { return _flags & NODE_ROOT; }
+    bool is_leaf() const noexcept { return _flags & NODE_LEAF; }
+    size_t num_keys() const noexcept { return _num_keys; }
+    const member_hook* key(size_t i) const noexcept { return _keys[i]; }
+    const node* kid(size_t i) const noexcept;
+
+private:
+    inner_node& as_inner() noexcept;
+    const inner_node& as_inner() const noexcept;
+
+    size_t index_of(const member_hook* h) const noexcept {
+        size_t i = 0;
+        while (_keys[i] != h) {
+            i++;
+            assert(i < _num_keys);
+        }
+        return i;
+    }
+
+    size_t index_of_kid(const node* n) const noexcept;
+
+    const node* leftmost_leaf() const noexcept {
+        const node* n = this;
+        while (!n->is_leaf()) {
+            n = n->kid(0);
+        }
+        return n;
+    }
+
+    const node* rightmost_leaf() const noexcept {
+        const node* n = this;
+        while (!n->is_leaf()) {
+            n = n->kid(n->_num_keys);
+        }
+        return n;
+    }
+
+    node* rightmost_leaf() noexcept {
+        return const_cast<node*>(const_cast<const node*>(this)->rightmost_leaf());
+    }
+
+    void set_key(size_t i, member_hook* h) noexcept {
+        _keys[i] = h;
+        h->_node = this;
+    }
+
+    void set_kid(size_t i, node* n) noexcept;
+
+    // Inserts key at i, for inner nodes the kid goes to the right of it
+    void insert_key(size_t i, member_hook* h, node* right) noexcept;
+
+    static node* create_leaf() {
+        return current_allocator().construct<node>(NODE_LEAF);
+    }
+    static inner_node* create_inner();
+    static void destroy(node* n) noexcept;
+
+    // The tree is tolerant to being destroyed while still having elements,
+    // they are just unlinked. Disposing is up to the caller.
+    template <typename Func>
+    static void drain(node* n, Func& on_key) noexcept;
+};
+
+static_assert(sizeof(node) <= 128, "leaf node doesn't fit into two cache lines");
+
+class inner_node final : public node {
+    friend class node;
+    friend class tree_base;
+
+    node* _kids[max_keys + 1];
+public:
+    inner_node() noexcept : node(0) { }
+    inner_node(inner_node&& o) noexcept : node(std::move(o)) {
+        // node(node&&) has already taken the keys
+        for (size_t i = 0; i <= num_keys(); i++) {
+            set_kid(i, o._kids[i]);
+        }
+    }
+};
+
+inline inner_node& node::as_inner() noexcept {
+    assert(!is_leaf());
+    return static_cast<inner_node&>(*this);
+}
+
+inline const inner_node& node::as_inner() const noexcept {
+    assert(!is_leaf());
+    return static_cast<const inner_node&>(*this);
+}
+
+inline const node* node::kid(size_t i) const noexcept {
+    return as_inner()._kids[i];
+}
+
+inline void node::set_kid(size_t i, node* n) noexcept {
+    as_inner()._kids[i] = n;
+    n->_parent = this;
+}
+
+inline size_t node::index_of_kid(const node* n) const noexcept {
+    const auto& kids = as_inner()._kids;
+    size_t i = 0;
+    while (kids[i] != n) {
+        i++;
+        assert(i <= _num_keys);
+    }
+    return i;
+}
+
+inline void node::insert_key(size_t i, member_hook* h, node* right) noexcept {
+    assert(_num_keys < max_keys);
+    for (size_t j = _num_keys; j > i; j--) {
+        _keys[j] = _keys[j - 1];
+    }
+    set_key(i, h);
+    if (!is_leaf()) {
+        auto& kids = as_inner()._kids;
+        for (size_t j = _num_keys + 1; j > i + 1; j--) {
+            kids[j] = kids[j - 1];
+        }
+        set_kid(i + 1, right);
+    }
+    _num_keys++;
+}
+
+inline inner_node* node::create_inner() {
+    return current_allocator().construct<inner_node>();
+}
+
+inline void node::destroy(node* n) noexcept {
+    if (n->is_leaf()) {
+        current_allocator().destroy(n);
+    } else {
+        current_allocator().destroy(&n->as_inner());
+    }
+}
+
+template <typename Func>
+inline void node::drain(node* n, Func& on_key) noexcept {
+    if (!n->is_leaf()) {
+        for (size_t i = 0; i <= n->_num_keys; i++) {
+            drain(n->as_inner()._kids[i], on_key);
+        }
+    }
+    for (size_t i = 0; i < n->_num_keys; i++) {
+        member_hook* h = n->_keys[i];
+        h->_node = nullptr;
+        on_key(h);
+    }
+    n->_num_keys = 0;
+    destroy(n);
+}
+
+/*
+ * The structural part of the tree, it doesn't need to know neither
+ * the element type nor how to compare them.
+ */
+class tree_base {
+    friend class node;
+    friend class member_hook;
+
+    /*
+     * Nodes that are needed to insert one key are allocated in advance,
+     * so that the insertion itself cannot fail half-way. With at least
+     * min_keys + 1 kids per inner node the depth is bounded by the
+     * size of the address space.
+     */
+    class prealloc {
+        node* _leaf = nullptr;
+        std::array<inner_node*, 24> _inner;
+        size_t _nr_inner = 0;
+    public:
+        prealloc(size_t leaves, size_t inners) {
+            assert(leaves <= 1 && inners <= _inner.size());
+            try {
+                if (leaves) {
+                    _leaf = node::create_leaf();
+                }
+                while (_nr_inner < inners) {
+                    _inner[_nr_inner] = node::create_inner();
+                    _nr_inner++;
+                }
+            } catch (...) {
+                release();
+                throw;
+            }
+        }
+        prealloc(const prealloc&) = delete;
+        ~prealloc() { release(); }
+
+        node* leaf() noexcept {
+            assert(_leaf != nullptr);
+            return std::exchange(_leaf, nullptr);
+        }
+        inner_node* inner() noexcept {
+            assert(_nr_inner > 0);
+            return _inner[--_nr_inner];
+        }
+    private:
+        void release() noexcept {
+            if (_leaf) {
+                node::destroy(_leaf);
+            }
+            while (_nr_inner > 0) {
+                node::destroy(_inner[--_nr_inner]);
+            }
+        }
+    };
+
+    static void insert_into(node* n, size_t i, member_hook* h, node* right, prealloc& pa) noexcept;
+    static void rebalance(node* n) noexcept;
+    static void rotate_right(inner_node& p, size_t k) noexcept;
+    static void rotate_left(inner_node& p, size_t k) noexcept;
+    static void merge(inner_node& p, size_t k) noexcept;
+
+protected:
+    node* _root = nullptr;
+
+    tree_base() noexcept = default;
+    tree_base(tree_base&& o) noexcept : _root(std::exchange(o._root, nullptr)) {
+        if (_root) {
+            _root->_tree = this;
+        }
+    }
+    ~tree_base() {
+        drain([] (member_hook*) noexcept { });
+    }
+
+    const member_hook* first() const noexcept {
+        return _root ? _root->leftmost_leaf()->_keys[0] : nullptr;
+    }
+
+    template <typename Func>
+    void drain(Func&& on_key) noexcept {
+        if (_root) {
+            node::drain(std::exchange(_root, nullptr), on_key);
+        }
+    }
+
+    // Links h right before pos, nullptr pos means the end. If the h is
+    // linked into another tree, it's moved into this one, but only after
+    // all the allocations are done.
+    void insert_before(const member_hook* pos, member_hook& h);
+
+    static void erase(member_hook& h) noexcept;
+
+    static const node* node_of(const member_hook& h) noexcept { return h._node; }
+
+public:
+    const member_hook* last() const noexcept {
+        if (!_root) {
+            return nullptr;
+        }
+        const node* n = _root->rightmost_leaf();
+        return n->_keys[n->_num_keys - 1];
+    }
+
+    bool empty() const noexcept { return _root == nullptr; }
+    const node* root() const noexcept { return _root; }
+};
+
+inline member_hook::member_hook(member_hook&& o) noexcept : _node(o._node) {
+    if (_node) {
+        _node->_keys[_node->index_of(&o)] = this;
+        o._node = nullptr;
+    }
+}
+
+inline member_hook::~member_hook() {
+    if (_node) {
+        unlink();
+    }
+}
+
+inline void member_hook::unlink() noexcept {
+    tree_base::erase(*this);
+}
+
+inline const member_hook* member_hook::next() const noexcept {
+    const node* n = _node;
+    size_t i = n->index_of(this);
+    if (!n->is_leaf()) {
+        return n->kid(i + 1)->leftmost_leaf()->_keys[0];
+    }
+    if (i + 1 < n->_num_keys) {
+        return n->_keys[i + 1];
+    }
+    while (!n->is_root()) {
+        const node* p = n->_parent;
+        size_t j = p->index_of_kid(n);
+        if (j < p->_num_keys) {
+            return p->_keys[j];
+        }
+        n = p;
+    }
+    return nullptr;
+}
+
+inline const member_hook* member_hook::prev() const noexcept {
+    const node* n = _node;
+    size_t i = n->index_of(this);
+    if (!n->is_leaf()) {
+        const node* l = n->kid(i)->rightmost_leaf();
+        return l->_keys[l->_num_keys - 1];
+    }
+    if (i > 0) {
+        return n->_keys[i - 1];
+    }
+    while (!n->is_root()) {
+        const node* p = n->_parent;
+        size_t j = p->index_of_kid(n);
+        if (j > 0) {
+            return p->_keys[j - 1];
+        }
+        n = p;
+    }
+    return nullptr;
+}
+
+inline const tree_base* member_hook::tree_slow() const noexcept {
+    const node* n = _node;
+    while (!n->is_root()) {
+        n = n->_parent;
+    }
+    return n->_tree;
+}
+
+inline node::node(node&& o) noexcept
+        : _parent(o._parent)
+        , _num_keys(o._num_keys)
+        , _flags(o._flags)
+{
+    for (size_t i = 0; i < _num_keys; i++) {
+        set_key(i, o._keys[i]);
+    }
+    if (is_root()) {
+        _tree->_root = this;
+    } else {
+        _parent->as_inner()._kids[_parent->index_of_kid(&o)] = this;
+    }
+    o._num_keys = 0;
+}
+
+inline void tree_base::insert_before(const member_hook* pos, member_hook& h) {
+    assert(!h.is_linked() || h.tree_slow() != this);
+
+    node* n = nullptr;
+    size_t i = 0;
+    if (!_root) {
+        // nothing to find
+    } else if (pos == nullptr) {
+        n = _root->rightmost_leaf();
+        i = n->_num_keys;
+    } else {
+        n = pos->_node;
+        i = n->index_of(pos);
+        if (!n->is_leaf()) {
+            // The slot right before pos is at the end of its left sub-tree
+            n = n->as_inner()._kids[i]->rightmost_leaf();
+            i = n->_num_keys;
+        }
+    }
+
+    size_t leaves = 0, inners = 0;
+    if (!n) {
+        leaves = 1;
+    } else {
+        for (node* x = n; x->_num_keys == node::max_keys; x = x->_parent) {
+            (x->is_leaf() ? leaves : inners)++;
+            if (x->is_root()) {
+                inners++;
+                break;
+            }
+        }
+    }
+
+    prealloc pa(leaves, inners);
+
+    if (h.is_linked()) {
+        erase(h);
+    }
+
+    if (!n) {
+        n = pa.leaf();
+        n->_flags |= node::NODE_ROOT;
+        n->_tree = this;
+        _root = n;
+    }
+
+    insert_into(n, i, &h, nullptr, pa);
+}
+
+inline void tree_base::insert_into(node* n, size_t i, member_hook* h, node* right, prealloc& pa) noexcept {
+    while (n->_num_keys == node::max_keys) {
+        /*
+         * Split. The max_keys + 1 keys (and max_keys + 2 kids) are laid
+         * out in temporary arrays, then the left half stays in n, the
+         * right half goes to the new node and the middle key moves up.
+         */
+        const bool leaf = n->is_leaf();
+        member_hook* keys[node::max_keys + 1];
+        node* kids[node::max_keys + 2];
+
+        for (size_t j = 0, k = 0; j <= node::max_keys; j++) {
+            keys[j] = (j == i) ? h : n->_keys[k++];
+        }
+        if (!leaf) {
+            auto& nkids = n->as_inner()._kids;
+            for (size_t j = 0, k = 0; j <= node::max_keys + 1; j++) {
+                kids[j] = (j == i + 1) ? right : nkids[k++];
+            }
+        }
+
+        constexpr size_t split = (node::max_keys + 1) / 2;
+        node* r = leaf ? pa.leaf() : pa.inner();
+
+        for (size_t j = 0; j < split; j++) {
+            n->set_key(j, keys[j]);
+        }
+        n->_num_keys = split;
+        member_hook* sep = keys[split];
+        for (size_t j = split + 1; j <= node::max_keys; j++) {
+            r->set_key(j - split - 1, keys[j]);
+        }
+        r->_num_keys = node::max_keys - split;
+
+        if (!leaf) {
+            for (size_t j = 0; j <= split; j++) {
+                n->set_kid(j, kids[j]);
+            }
+            for (size_t j = split + 1; j <= node::max_keys + 1; j++) {
+                r->set_kid(j - split - 1, kids[j]);
+            }
+        }
+
+        if (n->is_root()) {
+            tree_base* t = n->_tree;
+            inner_node* nr = pa.inner();
+            n->_flags &= ~node::NODE_ROOT;
+            nr->_flags |= node::NODE_ROOT;
+            nr->set_key(0, sep);
+            nr->set_kid(0, n);
+            nr->set_kid(1, r);
+            nr->_num_keys = 1;
+            nr->_tree = t;
+            t->_root = nr;
+            return;
+        }
+
+        node* p = n->_parent;
+        i = p->index_of_kid(n);
+        h = sep;
+        right = r;
+        n = p;
+    }
+
+    n->insert_key(i, h, right);
+}
+
+inline void tree_base::erase(member_hook& h) noexcept {
+    node* n = h._node;
+    size_t i = n->index_of(&h);
+
+    if (!n->is_leaf()) {
+        // Replace the key with its predecessor, which always sits in a leaf
+        node* l = n->as_inner()._kids[i]->rightmost_leaf();
+        n->set_key(i, l->_keys[l->_num_keys - 1]);
+        n = l;
+        i = l->_num_keys - 1;
+    }
+
+    for (size_t j = i + 1; j < n->_num_keys; j++) {
+        n->_keys[j - 1] = n->_keys[j];
+    }
+    n->_num_keys--;
+    h._node = nullptr;
+
+    rebalance(n);
+}
+
+inline void tree_base::rebalance(node* n) noexcept {
+    while (true) {
+        if (n->is_root()) {
+            if (n->_num_keys == 0) {
+                tree_base* t = n->_tree;
+                if (n->is_leaf()) {
+                    t->_root = nullptr;
+                } else {
+                    node* k = n->as_inner()._kids[0];
+                    k->_flags |= node::NODE_ROOT;
+                    k->_tree = t;
+                    t->_root = k;
+                }
+                node::destroy(n);
+            }
+            return;
+        }
+
+        if (n->_num_keys >= node::min_keys) {
+            return;
+        }
+
+        inner_node& p = n->_parent->as_inner();
+        size_t j = p.index_of_kid(n);
+        node* left = j > 0 ? p._kids[j - 1] : nullptr;
+        node* right = j < p._num_keys ? p._kids[j + 1] : nullptr;
+
+        if (left && left->_num_keys > node::min_keys) {
+            rotate_right(p, j - 1);
+            return;
+        }
+        if (right && right->_num_keys > node::min_keys) {
+            rotate_left(p, j);
+            return;
+        }
+
+        merge(p, left ? j - 1 : j);
+        n = &p;
+    }
+}
+
+// Moves the last key of kids[k] up to the parent and the parent's key down to kids[k + 1]
+inline void tree_base::rotate_right(inner_node& p, size_t k) noexcept {
+    node* l = p._kids[k];
+    node* r = p._kids[k + 1];
+
+    for (size_t j = r->_num_keys; j > 0; j--) {
+        r->_keys[j] = r->_keys[j - 1];
+    }
+    r->set_key(0, p._keys[k]);
+    if (!r->is_leaf()) {
+        auto& rkids = r->as_inner()._kids;
+        for (size_t j = r->_num_keys + 1; j > 0; j--) {
+            rkids[j] = rkids[j - 1];
+        }
+        r->set_kid(0, l->as_inner()._kids[l->_num_keys]);
+    }
+    r->_num_keys++;
+
+    p.set_key(k, l->_keys[l->_num_keys - 1]);
+    l->_num_keys--;
+}
+
+// Moves the first key of kids[k + 1] up to the parent and the parent's key down to kids[k]
+inline void tree_base::rotate_left(inner_node& p, size_t k) noexcept {
+    node* l = p._kids[k];
+    node* r = p._kids[k + 1];
+
+    l->set_key(l->_num_keys, p._keys[k]);
+    if (!l->is_leaf()) {
+        l->set_kid(l->_num_keys + 1, r->as_inner()._kids[0]);
+    }
+    l->_num_keys++;
+
+    p.set_key(k, r->_keys[0]);
+    for (size_t j = 1; j < r->_num_keys; j++) {
+        r->_keys[j - 1] = r->_keys[j];
+    }
+    if (!r->is_leaf()) {
+        auto& rkids = r->as_inner()._kids;
+        for (size_t j = 1; j <= r->_num_keys; j++) {
+            rkids[j - 1] = rkids[j];
+        }
+    }
+    r->_num_keys--;
+}
+
+// Merges kids[k + 1] and the separating key into kids[k]
+inline void tree_base::merge(inner_node& p, size_t k) noexcept {
+    node* l = p._kids[k];
+    node* r = p._kids[k + 1];
+    size_t base = l->_num_keys + 1;
+
+    assert(base + r->_num_keys <= node::max_keys);
+    l->set_key(l->_num_keys, p._keys[k]);
+    for (size_t j = 0; j < r->_num_keys; j++) {
+        l->set_key(base + j, r->_keys[j]);
+    }
+    if (!l->is_leaf()) {
+        for (size_t j = 0; j <= r->_num_keys; j++) {
+            l->set_kid(base + j, r->as_inner()._kids[j]);
+        }
+    }
+    l->_num_keys = base + r->_num_keys;
+    r->_num_keys = 0;
+
+    for (size_t j = k + 1; j < p._num_keys; j++) {
+        p._keys[j - 1] = p._keys[j];
+        p._kids[j] = p._kids[j + 1];
+    }
+    p._num_keys--;
+
+    node::destroy(r);
+}
+
+template <typename Elem, member_hook Elem::* Hook, key_search Search = key_search::linear>
+class tree final : public tree_base {
+    static Elem* elem(const member_hook* h) noexcept {
+        return boost::intrusive::get_parent_from_member(const_cast<member_hook*>(h), Hook);
+    }
+
+    template <bool Const>
+    class iterator_base {
+        friend class tree;
+        const member_hook* _hook;
+        // Only needed by the end iterator to step back
+        const tree_base* _tree;
+
+        iterator_base(const member_hook* h, const tree_base* t) noexcept : _hook(h), _tree(t) { }
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = Elem;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const Elem*, Elem*>;
+        using reference = std::conditional_t<Const, const Elem&, Elem&>;
+
+        iterator_base() noexcept : _hook(nullptr), _tree(nullptr) { }
+
+        template <bool C = Const>
+        requires C
+        iterator_base(const iterator_base<false>& o) noexcept : _hook(o._hook), _tree(o._tree) { }
+
+        reference operator*() const noexcept { return *elem(_hook); }
+        pointer operator->() const noexcept { return elem(_hook); }
+
+        iterator_base& operator++() noexcept {
+            const member_hook* n = _hook->next();
+            if (!n) {
+                _tree = _hook->tree_slow();
+            }
+            _hook = n;
+            return *this;
+        }
+        iterator_base operator++(int) noexcept {
+            iterator_base cur = *this;
+            operator++();
+            return cur;
+        }
+        iterator_base& operator--() noexcept {
+            _hook = _hook ? _hook->prev() : _tree->last();
+            return *this;
+        }
+        iterator_base operator--(int) noexcept {
+            iterator_base cur = *this;
+            operator--();
+            return cur;
+        }
+
+        bool operator==(const iterator_base& o) const noexcept { return _hook == o._hook; }
+
+        iterator_base<false> unconst() const noexcept { return iterator_base<false>(_hook, _tree); }
+
+        friend class iterator_base<!Const>;
+    };
+
+    template <typename Less>
+    static size_t search(const node& n, Less&& before) noexcept {
+        // Returns the index of the first key which is not before() the searched one
+        if constexpr (Search == key_search::linear) {
+            size_t i = 0;
+            while (i < n.num_keys() && before(*elem(n.key(i)))) {
+                i++;
+            }
+            return i;
+        } else {
+            size_t lo = 0, hi = n.num_keys();
+            while (lo < hi) {
+                size_t mid = (lo + hi) / 2;
+                if (before(*elem(n.key(mid)))) {
+                    lo = mid + 1;
+                } else {
+                    hi = mid;
+                }
+            }
+            return lo;
+        }
+    }
+
+    // Returns the first element which is not before() the searched one
+    template <typename Less>
+    const member_hook* bound(Less&& before) const noexcept {
+        const member_hook* ret = nullptr;
+        const node* n = _root;
+        while (n) {
+            size_t i = search(*n, before);
+            if (i < n->num_keys()) {
+                ret = n->key(i);
+            }
+            if (n->is_leaf()) {
+                break;
+            }
+            n = n->kid(i);
+        }
+        return ret;
+    }
+
+public:
+    using value_type = Elem;
+    using iterator = iterator_base<false>;
+    using const_iterator = iterator_base<true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    tree() noexcept = default;
+    tree(tree&& o) noexcept = default;
+    tree(const tree&) = delete;
+
+    static iterator iterator_to(Elem& e) noexcept {
+        return iterator(&(e.*Hook), nullptr);
+    }
+
+    // Returns true if and only if e is the only member of the tree.
+    static bool is_only_member(Elem& e) noexcept {
+        const node* n = node_of(e.*Hook);
+        return n->is_root() && n->is_leaf() && n->num_keys() == 1;
+    }
+
+    // Returns container of e, assuming is_only_member(e).
+    static tree& container_of_only_member(Elem& e) noexcept {
+        assert(is_only_member(e));
+        return static_cast<tree&>(const_cast<tree_base&>(*(e.*Hook).tree_slow()));
+    }
+
+    iterator begin() noexcept { return iterator(first(), this); }
+    const_iterator begin() const noexcept { return const_iterator(first(), this); }
+    iterator end() noexcept { return iterator(nullptr, this); }
+    const_iterator end() const noexcept { return const_iterator(nullptr, this); }
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+    // WARNING: this method has O(N) time complexity, use with care
+    size_t calculate_size() const noexcept {
+        size_t ret = 0;
+        for (auto it = begin(); it != end(); ++it) {
+            ret++;
+        }
+        return ret;
+    }
+
+    template <typename Disposer>
+    void clear_and_dispose(Disposer disposer) noexcept {
+        drain([&disposer] (member_hook* h) noexcept { disposer(elem(h)); });
+    }
+
+    iterator erase(const_iterator i) noexcept {
+        const_iterator next = std::next(i);
+        tree_base::erase(const_cast<member_hook&>(*i._hook));
+        return next.unconst();
+    }
+
+    iterator erase(const_iterator b, const_iterator e) noexcept {
+        while (b != e) {
+            b = erase(b);
+        }
+        return b.unconst();
+    }
+
+    template <typename Disposer>
+    iterator erase_and_dispose(const_iterator i, Disposer disposer) noexcept {
+        Elem* e = elem(i._hook);
+        iterator ret = erase(i);
+        disposer(e);
+        return ret;
+    }
+
+    template <typename Disposer>
+    iterator erase_and_dispose(const_iterator b, const_iterator e, Disposer disposer) noexcept {
+        while (b != e) {
+            b = erase_and_dispose(b, disposer);
+        }
+        return b.unconst();
+    }
+
+    template <typename Cloner, typename Disposer>
+    void clone_from(const tree& src, Cloner cloner, Disposer disposer) {
+        clear_and_dispose(disposer);
+        try {
+            for (const Elem& e : src) {
+                Elem* c = cloner(e);
+                try {
+                    tree_base::insert_before(nullptr, c->*Hook);
+                } catch (...) {
+                    disposer(c);
+                    throw;
+                }
+            }
+        } catch (...) {
+            clear_and_dispose(disposer);
+            throw;
+        }
+    }
+
+    Elem* unlink_leftmost_without_rebalance() noexcept {
+        if (empty()) {
+            return nullptr;
+        }
+        Elem* e = elem(first());
+        tree_base::erase(e->*Hook);
+        return e;
+    }
+
+    /*
+     * May throw, in which case the tree is not modified. If the value
+     * is linked into another tree, it's moved into this one only when
+     * the insertion cannot fail.
+     */
+    iterator insert_before(const_iterator pos, Elem& value) {
+        tree_base::insert_before(pos._hook, value.*Hook);
+        return iterator_to(value);
+    }
+
+    template <typename KeyType, typename KeyTypeKeyCompare>
+    iterator lower_bound(const KeyType& key, KeyTypeKeyCompare comp) noexcept {
+        return const_cast<const tree*>(this)->lower_bound(key, std::move(comp)).unconst();
+    }
+
+    template <typename KeyType, typename KeyTypeKeyCompare>
+    const_iterator lower_bound(const KeyType& key, KeyTypeKeyCompare comp) const noexcept {
+        return const_iterator(bound([&] (const Elem& e) { return comp(e, key); }), this);
+    }
+
+    template <typename KeyType, typename KeyTypeKeyCompare>
+    iterator upper_bound(const KeyType& key, KeyTypeKeyCompare comp) noexcept {
+        return const_cast<const tree*>(this)->upper_bound(key, std::move(comp)).unconst();
+    }
+
+    template <typename KeyType, typename KeyTypeKeyCompare>
+    const_iterator upper_bound(const KeyType& key, KeyTypeKeyCompare comp) const noexcept {
+        return const_iterator(bound([&] (const Elem& e) { return !comp(key, e); }), this);
+    }
+
+    template <typename KeyType, typename KeyTypeKeyCompare>
+    iterator find(const KeyType& key, KeyTypeKeyCompare comp) noexcept {
+        return const_cast<const tree*>(this)->find(key, std::move(comp)).unconst();
+    }
+
+    template <typename KeyType, typename KeyTypeKeyCompare>
+    const_iterator find(const KeyType& key, KeyTypeKeyCompare comp) const noexcept {
+        const_iterator i = lower_bound(key, comp);
+        if (i != end() && comp(key, *i)) {
+            return end();
+        }
+        return i;
+    }
+
+    // The hint is not used, the lookup always starts from the root
+    template <typename ElemCompare>
+    iterator insert(const_iterator hint, Elem& value, ElemCompare cmp) {
+        return insert_check(hint, value, std::move(cmp)).first;
+    }
+
+    template <typename ElemCompare>
+    std::pair<iterator, bool> insert_check(const_iterator hint, Elem& value, ElemCompare cmp) {
+        iterator i = lower_bound(value, cmp);
+        if (i != end() && !cmp(value, *i)) {
+            return std::make_pair(i, false);
+        }
+        return std::make_pair(insert_before(i, value), true);
+    }
+
+    using tree_base::empty;
+};
+
+} // namespace intrusive_b
@@ -42,6 +42,7 @@
 #include "utils/dynamic_bitset.hh"
 #include "utils/log_heap.hh"
 
+#include <cmath>
 #include <random>
 
 #ifdef SEASTAR_ASAN_ENABLED
@@ -360,12 +361,21 @@ static thread_local tracker& tracker_instance = get_tracker_instance();
 
 using clock = std::chrono::steady_clock;
 
+class segment_occupancy_histogram;
+
 class tracker::impl {
     std::vector<region::impl*> _regions;
     seastar::metrics::metric_groups _metrics;
     bool _reclaiming_enabled = true;
     size_t _reclamation_step = 1;
     bool _abort_on_bad_alloc = false;
+    size_t _background_defragment_free_segments = 0;
+    uint64_t _segments_compacted_in_background = 0;
+    bool _background_defragmenter_stopped = false;
+    // Set until the background defragmenter fiber exits, which may be after stop() returns.
+    bool _background_defragmenter_running = false;
+    condition_variable _background_defragmenter_cv;
+    future<> _background_defragmenter = make_ready_future<>();
 private:
     // Prevents tracker's reclaimer from running while live. Reclaimer may be
     // invoked synchronously with allocator. This guard ensures that this
@@ -393,6 +403,9 @@ class tracker::impl {
     // Compacts one segment at a time from sparsest segment to least sparse until work_waiting_on_reactor returns true
     // or there are no more segments to compact.
     idle_cpu_handler_result compact_on_idle(work_waiting_on_reactor check_for_work);
+    // Compacts the sparsest segments in the background, see tracker::config.
+    void start_background_defragmenter(size_t free_segments, scheduling_group sg);
+    future<> stop();
     // Releases whole segments back to the segment pool.
     // After the call, if there is enough evictable memory, the amount of free segments in the pool
     // will be at least reserve_segments + div_ceil(bytes, segment::size).
@@ -403,6 +416,7 @@ class tracker::impl {
     occupancy_stats region_occupancy();
     occupancy_stats occupancy();
     size_t non_lsa_used_space();
+    segment_occupancy_histogram occupancy_histogram();
     // Set the minimum number of segments reclaimed during single reclamation cycle.
     void set_reclamation_step(size_t step_in_segments) { _reclamation_step = step_in_segments; }
     size_t reclamation_step() const { return _reclamation_step; }
@@ -412,6 +426,10 @@ class tracker::impl {
 private:
     // Like compact_and_evict() but assumes that reclaim_lock is held around the operation.
     size_t compact_and_evict_locked(size_t reserve_segments, size_t bytes);
+    // Compacts one segment at a time from sparsest segment to least sparse until the segment pool has
+    // free_segments free segments, there are no more segments to compact or the task quota is exhausted.
+    // Returns true in the latter case.
+    bool defragment(size_t free_segments);
 };
 
 class tracker_reclaimer_lock {
@@ -498,6 +516,62 @@ static_assert(min_free_space_for_compaction >= max_managed_object_size,
 // everything below that value in the same bucket.
 extern constexpr log_heap_options segment_descriptor_hist_options(min_free_space_for_compaction, 3, segment_size);
 
+// Histogram of the occupancy of segments, in buckets of 10 percent. It's kept up
+// to date as segments are opened, allocated from, freed from and released, so
+// that reporting it doesn't have to walk the segments.
+class segment_occupancy_histogram {
+    static constexpr unsigned nr_buckets = 10;
+    std::array<int64_t, nr_buckets> _counts{};
+    uint64_t _used_space = 0;
+private:
+    // Bucket i holds occupancies in (10 * i, 10 * (i + 1)] percent, bucket 0 also holds empty segments.
+    static unsigned bucket_of(size_t used_space) noexcept {
+        return used_space ? (used_space * nr_buckets - 1) / segment_size : 0;
+    }
+public:
+    void add(size_t used_space) noexcept {
+        ++_counts[bucket_of(used_space)];
+        _used_space += used_space;
+    }
+
+    void remove(size_t used_space) noexcept {
+        --_counts[bucket_of(used_space)];
+        _used_space -= used_space;
+    }
+
+    void update(size_t old_used_space, size_t new_used_space) noexcept {
+        auto old_bucket = bucket_of(old_used_space);
+        auto new_bucket = bucket_of(new_used_space);
+        if (old_bucket != new_bucket) {
+            --_counts[old_bucket];
+            ++_counts[new_bucket];
+        }
+        _used_space = _used_space - old_used_space + new_used_space;
+    }
+
+    segment_occupancy_histogram& operator+=(const segment_occupancy_histogram& o) noexcept {
+        for (unsigned i = 0; i < nr_buckets; ++i) {
+            _counts[i] += o._counts[i];
+        }
+        _used_space += o._used_space;
+        return *this;
+    }
+
+    seastar::metrics::histogram to_metrics_histogram() const {
+        seastar::metrics::histogram res;
+        res.buckets.resize(nr_buckets);
+        uint64_t cumulative_count = 0;
+        for (unsigned i = 0; i < nr_buckets; ++i) {
+            cumulative_count += _counts[i];
+            res.buckets[i].upper_bound = (i + 1) * (100 / nr_buckets);
+            res.buckets[i].count = cumulative_count;
+        }
+        res.sample_count = cumulative_count;
+        res.sample_sum = double(_used_space) * 100 / segment_size;
+        return res;
+    }
+};
+
 struct segment_descriptor : public log_heap_hook<segment_descriptor_hist_options> {
     segment::size_type _free_space;
     region::impl* _region;
@@ -514,17 +588,42 @@ struct segment_descriptor : public log_heap_hook<segment_descriptor_hist_options
         return { _free_space, segment::size };
     }
 
-    void record_alloc(segment::size_type size) {
-        _free_space -= size;
+    size_t used_space() const {
+        return segment::size - _free_space;
     }
 
-    void record_free(segment::size_type size) {
-        _free_space += size;
-    }
+    // Also update the occupancy histograms of the segment pool and of the region.
+    void record_alloc(segment::size_type size) noexcept;
+    void record_free(segment::size_type size) noexcept;
 };
 
 using segment_descriptor_hist = log_heap<segment_descriptor, segment_descriptor_hist_options>;
 
+    double _used_percent_sum = 0;
+public:
+    void add(const occupancy_stats& occ) {
+        auto used_percent = occ.used_fraction() * 100;
+        // Bucket i holds occupancies in (10 * i, 10 * (i + 1)], bucket 0 also holds empty segments.
+        auto bucket = std::clamp<int>(int(std::ceil(used_percent / (100 / nr_buckets))) - 1, 0, nr_buckets - 1);
+        ++_counts[bucket];
+        _used_percent_sum += used_percent;
+    }
+
+    seastar::metrics::histogram to_metrics_histogram() const {
+        seastar::metrics::histogram res;
+        res.buckets.resize(nr_buckets);
+        uint64_t cumulative_count = 0;
+        for (unsigned i = 0; i < nr_buckets; ++i) {
+            cumulative_count += _counts[i];
+            res.buckets[i].upper_bound = (i + 1) * (100 / nr_buckets);
+            res.buckets[i].count = cumulative_count;
+        }
+        res.sample_count = cumulative_count;
+        res.sample_sum = _used_percent_sum;
+        return res;
+    }
+};
+
 #ifndef SEASTAR_DEFAULT_ALLOCATOR
 class segment_store {
     memory::memory_layout _layout;
@@ -645,6 +744,8 @@ class segment_pool {
     };
 
     size_t _non_lsa_memory_in_use = 0;
+    // Of the segments in use by regions.
+    segment_occupancy_histogram _occupancy_histogram;
     // Invariants - a segment is in one of the following states:
     //   In use by some region
     //     - set in _lsa_owned_segments_bitmap
@@ -707,6 +808,9 @@ class segment_pool {
     size_t total_free_memory() const {
         return _free_segments * segment::size;
     }
+    segment_occupancy_histogram& occupancy_histogram() noexcept {
+        return _occupancy_histogram;
+    }
     struct reservation_goal;
     void set_region(segment* seg, region::impl* r) {
         set_region(descriptor(seg), r);
@@ -885,6 +989,7 @@ segment_pool::new_segment(region::impl* r) {
     segment_descriptor& desc = descriptor(seg);
     desc._free_space = segment::size;
     desc._region = r;
+    _occupancy_histogram.add(0);
     return seg;
 }
 
@@ -894,6 +999,7 @@ void segment_pool::free_segment(segment* seg) noexcept {
 
 void segment_pool::free_segment(segment* seg, segment_descriptor& desc) noexcept {
     llogger.trace("Releasing segment {}", fmt::ptr(seg));
+    _occupancy_histogram.remove(desc.used_space());
     desc._region = nullptr;
     deallocate_segment(seg);
     --_segments_in_use;
@@ -1145,6 +1251,7 @@ class region_impl final : public basic_region_impl {
     segment_descriptor_hist _segment_descs; // Contains only closed segments
     occupancy_stats _closed_occupancy;
     occupancy_stats _non_lsa_occupancy;
+    segment_occupancy_histogram _occupancy_histogram;
     // This helps us keeping track of the region_group* heap. That's because we call update before
     // we have a chance to update the occupancy stats - mainly because at this point we don't know
     // what will we do with the new segment. Also, because we are not ever interested in the
@@ -1249,6 +1356,7 @@ class region_impl final : public basic_region_impl {
     }
 
     void free_segment(segment* seg, segment_descriptor& desc) noexcept {
+        _occupancy_histogram.remove(desc.used_space());
         shard_segment_pool.free_segment(seg, desc);
         if (_group) {
             _evictable_space -= segment_size;
@@ -1258,6 +1366,7 @@ class region_impl final : public basic_region_impl {
 
     segment* new_segment() {
         segment* seg = shard_segment_pool.new_segment(this);
+        _occupancy_histogram.add(0);
         if (_group) {
             _evictable_space += segment_size;
             _group->increase_usage(_heap_handle, segment::size);
@@ -1513,6 +1622,7 @@ class region_impl final : public basic_region_impl {
         degroup_temporarily dgt2(&other);
 
         if (_active && _active->is_empty()) {
+            _occupancy_histogram.remove(0);
             shard_segment_pool.free_segment(_active);
             _active = nullptr;
         }
@@ -1534,8 +1644,10 @@ class region_impl final : public basic_region_impl {
 
         _closed_occupancy += other._closed_occupancy;
         _non_lsa_occupancy += other._non_lsa_occupancy;
+        _occupancy_histogram += other._occupancy_histogram;
         other._closed_occupancy = {};
         other._non_lsa_occupancy = {};
+        other._occupancy_histogram = {};
 
         // Make sure both regions will notice a future increment
         // to the reclaim counter
@@ -1545,6 +1657,11 @@ class region_impl final : public basic_region_impl {
         other._sanitizer = { };
     }
 
+    // Of the segments of this region, including the active one.
+    segment_occupancy_histogram& occupancy_histogram() noexcept {
+        return _occupancy_histogram;
+    }
+
     // Returns occupancy of the sparsest compactible segment.
     occupancy_stats min_occupancy() const {
         if (_segment_descs.empty()) {
@@ -1627,6 +1744,20 @@ class region_impl final : public basic_region_impl {
     friend class region_group::region_evictable_occupancy_ascending_less_comparator;
 };
 
+inline void segment_descriptor::record_alloc(segment::size_type size) noexcept {
+    auto old_used_space = used_space();
+    _free_space -= size;
+    shard_segment_pool.occupancy_histogram().update(old_used_space, used_space());
+    _region->occupancy_histogram().update(old_used_space, used_space());
+}
+
+inline void segment_descriptor::record_free(segment::size_type size) noexcept {
+    auto old_used_space = used_space();
+    _free_space += size;
+    shard_segment_pool.occupancy_histogram().update(old_used_space, used_space());
+    _region->occupancy_histogram().update(old_used_space, used_space());
+}
+
 inline void
 region_group_binomial_group_sanity_check(const region_group::region_heap& bh) {
 #ifdef SEASTAR_DEBUG
@@ -1663,6 +1794,9 @@ bool tracker::should_abort_on_bad_alloc() {
 }
 
 void tracker::configure(const config& cfg) {
+    if (cfg.background_defragment_free_segments) {
+        _impl->start_background_defragmenter(cfg.background_defragment_free_segments, cfg.background_defragment_sched_group);
+    }
     if (cfg.defragment_on_idle) {
         engine().set_idle_cpu_handler([this] (reactor::work_waiting_on_reactor check_for_work) {
             return _impl->compact_on_idle(check_for_work);
@@ -1675,6 +1809,10 @@ void tracker::configure(const config& cfg) {
     }
 }
 
+future<> tracker::stop() {
+    return _impl->stop();
+}
+
 memory::reclaiming_result tracker::reclaim(seastar::memory::reclaimer::request r) {
     return reclaim(std::max(r.bytes_to_reclaim, _impl->reclamation_step() * segment::size))
            ? memory::reclaiming_result::reclaimed_something
@@ -1909,6 +2047,77 @@ idle_cpu_handler_result tracker::impl::compact_on_idle(work_waiting_on_reactor c
     return idle_cpu_handler_result::interrupted_by_higher_priority_task;
 }
 
+bool tracker::impl::defragment(size_t free_segments) {
+    if (!_reclaiming_enabled) {
+        return false;
+    }
+    reclaiming_lock rl(*this);
+    if (_regions.empty()) {
+        return false;
+    }
+    segment_pool::reservation_goal open_emergency_pool(shard_segment_pool, 0);
+
+    auto cmp = [] (region::impl* c1, region::impl* c2) {
+        if (c1->is_compactible() != c2->is_compactible()) {
+            return !c1->is_compactible();
+        }
+        return c2->min_occupancy() < c1->min_occupancy();
+    };
+
+    boost::range::make_heap(_regions, cmp);
+
+    while (shard_segment_pool.free_segments() < free_segments) {
+        if (need_preempt()) {
+            return true;
+        }
+        boost::range::pop_heap(_regions, cmp);
+        region::impl* r = _regions.back();
+
+        if (!r->is_compactible()) {
+            return false;
+        }
+
+        r->compact();
+        ++_segments_compacted_in_background;
+
+        boost::range::push_heap(_regions, cmp);
+    }
+    return false;
+}
+
+void tracker::impl::start_background_defragmenter(size_t free_segments, scheduling_group sg) {
+    // How often the pool is checked once it has enough free segments.
+    static constexpr auto check_period = std::chrono::milliseconds(100);
+
+    if (_background_defragmenter_running) {
+        throw std::logic_error("LSA background defragmentation is already running, the tracker has to be stopped before it is reconfigured");
+    }
+    _background_defragmenter_running = true;
+    _background_defragment_free_segments = free_segments;
+    _background_defragmenter_stopped = false;
+    _background_defragmenter = with_scheduling_group(sg, [this] {
+        return do_until([this] { return _background_defragmenter_stopped; }, [this] {
+            if (defragment(_background_defragment_free_segments)) {
+                // Let other tasks run, do_until() yields when the task quota is exhausted.
+                return make_ready_future<>();
+            }
+            return _background_defragmenter_cv.wait(check_period).handle_exception_type([] (const condition_variable_timed_out&) { });
+        });
+    }).finally([this] {
+        _background_defragmenter_running = false;
+    });
+}
+
+future<> tracker::impl::stop() {
+    _background_defragmenter_stopped = true;
+    _background_defragmenter_cv.broadcast();
+    return std::exchange(_background_defragmenter, make_ready_future<>());
+}
+
+segment_occupancy_histogram tracker::impl::occupancy_histogram() {
+    return shard_segment_pool.occupancy_histogram();
+}
+
 size_t tracker::impl::reclaim(size_t memory_to_release) {
     // Reclamation steps:
     // 1. Try to release free segments from segment pool and emergency reserve.
@@ -2100,6 +2309,16 @@ tracker::impl::impl() {
 
         sm::make_derive("memory_allocated", [this] { return shard_segment_pool.statistics().memory_allocated; },
                         sm::description("Counts number of bytes which were requested from LSA allocator.")),
+
+        sm::make_derive("segments_compacted_in_background", [this] { return _segments_compacted_in_background; },
+                        sm::description("Counts a number of segments compacted in the background to keep free segments in the pool. "
+                                        "The rest of segments_compacted were compacted when memory was needed or on idle.")),
+
+        sm::make_gauge("free_segments", [this] { return shard_segment_pool.free_segments(); },
+                       sm::description("Holds a current number of free segments in the pool, including the emergency reserve.")),
+
+        sm::make_histogram("segment_occupancy", sm::description("Histogram of the occupancy (in percents) of the segments in use."),
+                           [this] { return occupancy_histogram().to_metrics_histogram(); }),
     });
 }
 
@@ -2135,6 +2354,20 @@ uint64_t region_group::top_region_evictable_space() const {
     return _regions.empty() ? 0 : _regions.top()->evictable_occupancy().total_space();
 }
 
+seastar::metrics::histogram region_group::segment_occupancy_histogram() const {
+    logalloc::segment_occupancy_histogram hist;
+    std::function<void(const region_group&)> add_group = [&] (const region_group& rg) {
+        for (region_impl* r : rg._regions) {
+            hist += r->occupancy_histogram();
+        }
+        for (region_group* child : rg._subgroups) {
+            add_group(*child);
+        }
+    };
+    add_group(*this);
+    return hist.to_metrics_histogram();
+}
+
 region* region_group::get_largest_region() {
     if (!_maximal_rg || _maximal_rg->_regions.empty()) {
         return nullptr;
@@ -32,6 +32,7 @@
 #include <seastar/core/future-util.hh>
 #include <seastar/core/circular_buffer.hh>
 #include <seastar/core/expiring_fifo.hh>
+#include <seastar/core/metrics_types.hh>
 #include "allocation_strategy.hh"
 #include <boost/heap/binomial_heap.hpp>
 #include "seastarx.hh"
@@ -378,6 +379,10 @@ class region_group {
     uint64_t blocked_requests_counter() const {
         return _blocked_requests_counter;
     }
+
+    // Returns the histogram of the occupancy, in percent, of the LSA segments
+    // of the regions in this group and its subgroups.
+    seastar::metrics::histogram segment_occupancy_histogram() const;
 private:
     // Returns true if and only if constraints of this group are not violated.
     // That's taking into account any constraints imposed by enclosing (parent) groups.
@@ -449,10 +454,23 @@ class tracker {
         bool defragment_on_idle;
         bool abort_on_lsa_bad_alloc;
         size_t lsa_reclamation_step;
+        // If non-zero, the sparsest segments are compacted in the background,
+        // in background_defragment_sched_group, until the segment pool has at
+        // least this many free segments. Allocations then rarely need to
+        // reclaim memory synchronously. Like the free_segments metric, the
+        // count includes the segments of the emergency reserve.
+        size_t background_defragment_free_segments = 0;
+        scheduling_group background_defragment_sched_group;
     };
 
+    // Background defragmentation can't be reconfigured while it runs: if it
+    // was started by a previous call, stop() has to complete first, otherwise
+    // std::logic_error is thrown.
     void configure(const config& cfg);
 
+    // Stops the background defragmentation started by configure().
+    future<> stop();
+
 private:
     std::unique_ptr<impl> _impl;
     memory::reclaimer _reclaimer;
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <boost/intrusive/list.hpp>
+
+class cache_tracker;
+
+// Base class for objects which live in the cache_tracker's LRU.
+//
+// Lets objects of different kinds (rows of the row cache, sstable index pages)
+// compete for the same memory under a single eviction policy.
+//
+// The LRU position is preserved when the object is moved, so it is safe
+// to use as a base of LSA-managed objects.
+//
+// Eviction is dispatched on a type tag rather than through a vtable, so that
+// cached rows don't pay for a vptr. The tag fits into what would otherwise be
+// padding, derived classes can place their small members right after it.
+class evictable {
+public:
+    enum class kind : uint8_t {
+        rows_entry,
+        partition_index_page,
+    };
+    using lru_link_type = boost::intrusive::list_member_hook<boost::intrusive::link_mode<boost::intrusive::auto_unlink>>;
+private:
+    lru_link_type _lru_link;
+    kind _kind;
+public:
+    using lru_type = boost::intrusive::list<evictable,
+        boost::intrusive::member_hook<evictable, lru_link_type, &evictable::_lru_link>,
+        boost::intrusive::constant_time_size<false>>; // we need this to have bi::auto_unlink on hooks.
+
+    explicit evictable(kind k) noexcept : _kind(k) { }
+
+    // Takes over the LRU position of the other object.
+    evictable(evictable&& o) noexcept : _kind(o._kind) {
+        if (o._lru_link.is_linked()) {
+            auto prev = o._lru_link.prev_;
+            o._lru_link.unlink();
+            lru_type::node_algorithms::link_after(prev, _lru_link.this_ptr());
+        }
+    }
+
+    evictable& operator=(evictable&&) = delete;
+
+    // Called by the cache_tracker when this object is chosen for eviction.
+    // The object is unlinked from the LRU by the time this returns; usually it is destroyed.
+    // Calls on_evicted() of the derived class of the given kind, see row_cache.cc.
+    void on_evicted(cache_tracker&) noexcept;
+
+    bool is_linked_in_lru() const noexcept { return _lru_link.is_linked(); }
+    void unlink_from_lru() noexcept { _lru_link.unlink(); }
+
+    // Exchanges LRU positions with the other object.
+    void swap_lru_position(evictable& o) noexcept { _lru_link.swap_nodes(o._lru_link); }
+protected:
+    ~evictable() = default;
+};
@@ -68,6 +68,50 @@ class xx_hasher {
     }
 };
 
+// Same digest size and interface as xx_hasher, using XXH3.
+//
+// XXH3 gathers small updates, like the ones appending_hash makes for every
+// cell, in its internal buffer and consumes the input in 64-byte stripes
+// using SIMD where available, so it's much cheaper than XXH64 per byte and
+// per update call.
+class xxh3_hasher {
+    static constexpr size_t digest_size = 16;
+    XXH3_state_t _state;
+
+public:
+    explicit xxh3_hasher(uint64_t seed = 0) noexcept {
+        XXH3_128bits_reset_withSeed(&_state, seed);
+    }
+
+    void update(const char* ptr, size_t length) noexcept {
+        XXH3_128bits_update(&_state, ptr, length);
+    }
+
+    bytes finalize() {
+        bytes digest{bytes::initialized_later(), digest_size};
+        serialize_to(digest.begin());
+        return digest;
+    }
+
+    std::array<uint8_t, digest_size> finalize_array() {
+        std::array<uint8_t, digest_size> digest;
+        serialize_to(digest.begin());
+        return digest;
+    }
+
+    uint64_t finalize_uint64() {
+        return XXH3_128bits_digest(&_state).low64;
+    }
+
+private:
+    template<typename OutIterator>
+    void serialize_to(OutIterator&& out) {
+        auto h = XXH3_128bits_digest(&_state);
+        serialize_int64(out, h.high64);
+        serialize_int64(out, h.low64);
+    }
+};
+
 // Used to specialize templates in order to fix a bug
 // in handling null values: #4567
 class legacy_xx_hasher_without_null_digest : public xx_hasher {
@@ -25,25 +25,36 @@
 // which are available only when the library is linked statically.
 #define ZSTD_STATIC_LINKING_ONLY
 #include "zstd.h"
+#include "zdict.h"
 
 #include "compress.hh"
 #include "utils/class_registrator.hh"
 
 static const sstring COMPRESSION_LEVEL = "compression_level";
+static const sstring DICTIONARY_SIZE_KB = "dictionary_size_kb";
 static const sstring COMPRESSOR_NAME = compressor::namespace_prefix + "ZstdCompressor";
 
 class zstd_processor : public compressor {
     int _compression_level = 3;
+    // 0 if dictionaries are disabled
+    size_t _dictionary_size = 0;
+    int _chunk_len;
+
+    // Contexts are allocated on first use. Processors which only create a
+    // zstd_dictionary_processor never need them.
 
     // Manages memory for the compression context.
-    std::unique_ptr<char[], free_deleter> _cctx_raw;
+    mutable std::unique_ptr<char[], free_deleter> _cctx_raw;
     // Compression context. Observer of _cctx_raw.
-    ZSTD_CCtx* _cctx;
+    mutable ZSTD_CCtx* _cctx = nullptr;
 
     // Manages memory for the decompression context.
-    std::unique_ptr<char[], free_deleter> _dctx_raw;
+    mutable std::unique_ptr<char[], free_deleter> _dctx_raw;
     // Decompression context. Observer of _dctx_raw.
-    ZSTD_DCtx* _dctx;
+    mutable ZSTD_DCtx* _dctx = nullptr;
+
+    ZSTD_CCtx* cctx() const;
+    ZSTD_DCtx* dctx() const;
 public:
     zstd_processor(const opt_getter&);
 
@@ -55,6 +66,53 @@ class zstd_processor : public compressor {
 
     std::set<sstring> option_names() const override;
     std::map<sstring, sstring> options() const override;
+
+    size_t dictionary_size() const override;
+    bytes train_dictionary(const std::vector<bytes_view>& samples) const override;
+    compressor_ptr with_dictionary(bytes_view dictionary) const override;
+};
+
+struct zstd_deleter {
+    void operator()(ZSTD_CCtx* p) const noexcept { ZSTD_freeCCtx(p); }
+    void operator()(ZSTD_DCtx* p) const noexcept { ZSTD_freeDCtx(p); }
+    void operator()(ZSTD_CDict* p) const noexcept { ZSTD_freeCDict(p); }
+    void operator()(ZSTD_DDict* p) const noexcept { ZSTD_freeDDict(p); }
+};
+
+// Compresses and uncompresses using a dictionary trained by zstd_processor::train_dictionary().
+//
+// The dictionary is digested on first use, separately for compression and decompression,
+// since sstable readers never compress and writers never uncompress. The readers of an
+// sstable share a single processor, see sstables::compression. Contexts are allocated
+// dynamically, because their size depends on the parameters the dictionary was digested with.
+class zstd_dictionary_processor : public compressor {
+    int _compression_level;
+    std::map<sstring, sstring> _options;
+    bytes_view _dictionary;
+
+    mutable std::unique_ptr<ZSTD_CCtx, zstd_deleter> _cctx;
+    mutable std::unique_ptr<ZSTD_CDict, zstd_deleter> _cdict;
+    mutable std::unique_ptr<ZSTD_DCtx, zstd_deleter> _dctx;
+    mutable std::unique_ptr<ZSTD_DDict, zstd_deleter> _ddict;
+public:
+    zstd_dictionary_processor(int compression_level, std::map<sstring, sstring> options, bytes_view dictionary)
+        : compressor(COMPRESSOR_NAME)
+        , _compression_level(compression_level)
+        , _options(std::move(options))
+        , _dictionary(dictionary)
+    {}
+
+    size_t uncompress(const char* input, size_t input_len, char* output,
+                    size_t output_len) const override;
+    size_t compress(const char* input, size_t input_len, char* output,
+                    size_t output_len) const override;
+    size_t compress_max_size(size_t input_len) const override {
+        return ZSTD_compressBound(input_len);
+    }
+
+    std::map<sstring, sstring> options() const override {
+        return _options;
+    }
 };
 
 zstd_processor::zstd_processor(const opt_getter& opts)
@@ -76,35 +134,64 @@ zstd_processor::zstd_processor(const opt_getter& opts)
         }
     }
 
+    auto dictionary_size_kb = opts(DICTIONARY_SIZE_KB);
+    if (dictionary_size_kb) {
+        int size_kb;
+        try {
+            size_kb = std::stoi(*dictionary_size_kb);
+        } catch (const std::exception& e) {
+            throw exceptions::syntax_exception(
+                format("Invalid integer value {} for {}", *dictionary_size_kb, DICTIONARY_SIZE_KB));
+        }
+        // zstd can't train dictionaries smaller than 1 KiB. Training samples are
+        // capped to keep the training short, see compaction, larger dictionaries
+        // wouldn't have enough of them.
+        if (size_kb != 0 && (size_kb < 1 || size_kb > 16)) {
+            throw exceptions::configuration_exception(
+                format("{} must be 0 (disabled) or between 1 and 16, got {}", DICTIONARY_SIZE_KB, size_kb));
+        }
+        _dictionary_size = size_t(size_kb) * 1024;
+    }
+
     auto chunk_len_kb = opts(compression_parameters::CHUNK_LENGTH_KB);
     if (!chunk_len_kb) {
         chunk_len_kb = opts(compression_parameters::CHUNK_LENGTH_KB_ERR);
     }
-    auto chunk_len = chunk_len_kb
+    _chunk_len = chunk_len_kb
        // This parameter has already been validated.
        ? std::stoi(*chunk_len_kb) * 1024
        : compression_parameters::DEFAULT_CHUNK_LENGTH;
+}
 
-    // We assume that the uncompressed input length is always <= chunk_len.
-    auto cparams = ZSTD_getCParams(_compression_level, chunk_len, 0);
-    auto cctx_size = ZSTD_estimateCCtxSize_usingCParams(cparams);
-    // According to the ZSTD documentation, pointer to the context buffer must be 8-bytes aligned.
-    _cctx_raw = allocate_aligned_buffer<char>(cctx_size, 8);
-    _cctx = ZSTD_initStaticCCtx(_cctx_raw.get(), cctx_size);
+ZSTD_CCtx* zstd_processor::cctx() const {
     if (!_cctx) {
-        throw std::runtime_error("Unable to initialize ZSTD compression context");
+        // We assume that the uncompressed input length is always <= chunk_len.
+        auto cparams = ZSTD_getCParams(_compression_level, _chunk_len, 0);
+        auto cctx_size = ZSTD_estimateCCtxSize_usingCParams(cparams);
+        // According to the ZSTD documentation, pointer to the context buffer must be 8-bytes aligned.
+        _cctx_raw = allocate_aligned_buffer<char>(cctx_size, 8);
+        _cctx = ZSTD_initStaticCCtx(_cctx_raw.get(), cctx_size);
+        if (!_cctx) {
+            throw std::runtime_error("Unable to initialize ZSTD compression context");
+        }
     }
+    return _cctx;
+}
 
-    auto dctx_size = ZSTD_estimateDCtxSize();
-    _dctx_raw = allocate_aligned_buffer<char>(dctx_size, 8);
-    _dctx = ZSTD_initStaticDCtx(_dctx_raw.get(), dctx_size);
-    if (!_cctx) {
-        throw std::runtime_error("Unable to initialize ZSTD decompression context");
+ZSTD_DCtx* zstd_processor::dctx() const {
+    if (!_dctx) {
+        auto dctx_size = ZSTD_estimateDCtxSize();
+        _dctx_raw = allocate_aligned_buffer<char>(dctx_size, 8);
+        _dctx = ZSTD_initStaticDCtx(_dctx_raw.get(), dctx_size);
+        if (!_dctx) {
+            throw std::runtime_error("Unable to initialize ZSTD decompression context");
+        }
     }
+    return _dctx;
 }
 
 size_t zstd_processor::uncompress(const char* input, size_t input_len, char* output, size_t output_len) const {
-    auto ret = ZSTD_decompressDCtx(_dctx, output, output_len, input, input_len);
+    auto ret = ZSTD_decompressDCtx(dctx(), output, output_len, input, input_len);
     if (ZSTD_isError(ret)) {
         throw std::runtime_error( format("ZSTD decompression failure: {}", ZSTD_getErrorName(ret)));
     }
@@ -113,7 +200,7 @@ size_t zstd_processor::uncompress(const char* input, size_t input_len, char* out
 
 
 size_t zstd_processor::compress(const char* input, size_t input_len, char* output, size_t output_len) const {
-    auto ret = ZSTD_compressCCtx(_cctx, output, output_len, input, input_len, _compression_level);
+    auto ret = ZSTD_compressCCtx(cctx(), output, output_len, input, input_len, _compression_level);
     if (ZSTD_isError(ret)) {
         throw std::runtime_error( format("ZSTD compression failure: {}", ZSTD_getErrorName(ret)));
     }
@@ -125,11 +212,81 @@ size_t zstd_processor::compress_max_size(size_t input_len) const {
 }
 
 std::set<sstring> zstd_processor::option_names() const {
-    return {COMPRESSION_LEVEL};
+    return {COMPRESSION_LEVEL, DICTIONARY_SIZE_KB};
 }
 
 std::map<sstring, sstring> zstd_processor::options() const {
-    return {{COMPRESSION_LEVEL, std::to_string(_compression_level)}};
+    std::map<sstring, sstring> opts{{COMPRESSION_LEVEL, std::to_string(_compression_level)}};
+    if (_dictionary_size) {
+        opts.emplace(DICTIONARY_SIZE_KB, std::to_string(_dictionary_size / 1024));
+    }
+    return opts;
+}
+
+size_t zstd_processor::dictionary_size() const {
+    return _dictionary_size;
+}
+
+bytes zstd_processor::train_dictionary(const std::vector<bytes_view>& samples) const {
+    if (!_dictionary_size) {
+        return bytes();
+    }
+    // The trainer wants all samples in a single buffer.
+    size_t total_size = 0;
+    std::vector<size_t> sample_sizes;
+    sample_sizes.reserve(samples.size());
+    for (auto& s : samples) {
+        total_size += s.size();
+        sample_sizes.push_back(s.size());
+    }
+    bytes buf(bytes::initialized_later(), total_size);
+    auto out = buf.begin();
+    for (auto& s : samples) {
+        out = std::copy(s.begin(), s.end(), out);
+    }
+
+    bytes dict(bytes::initialized_later(), _dictionary_size);
+    auto ret = ZDICT_trainFromBuffer(dict.data(), dict.size(), buf.data(), sample_sizes.data(), sample_sizes.size());
+    if (ZDICT_isError(ret)) {
+        return bytes();
+    }
+    dict.resize(ret);
+    return dict;
+}
+
+compressor_ptr zstd_processor::with_dictionary(bytes_view dictionary) const {
+    return ::make_shared<zstd_dictionary_processor>(_compression_level, options(), dictionary);
+}
+
+size_t zstd_dictionary_processor::uncompress(const char* input, size_t input_len, char* output, size_t output_len) const {
+    if (!_ddict) {
+        _dctx.reset(ZSTD_createDCtx());
+        // The dictionary outlives us, no need to copy it.
+        _ddict.reset(ZSTD_createDDict_byReference(_dictionary.data(), _dictionary.size()));
+        if (!_dctx || !_ddict) {
+            throw std::runtime_error("Unable to initialize ZSTD decompression context");
+        }
+    }
+    auto ret = ZSTD_decompress_usingDDict(_dctx.get(), output, output_len, input, input_len, _ddict.get());
+    if (ZSTD_isError(ret)) {
+        throw std::runtime_error( format("ZSTD decompression failure: {}", ZSTD_getErrorName(ret)));
+    }
+    return ret;
+}
+
+size_t zstd_dictionary_processor::compress(const char* input, size_t input_len, char* output, size_t output_len) const {
+    if (!_cdict) {
+        _cctx.reset(ZSTD_createCCtx());
+        _cdict.reset(ZSTD_createCDict(_dictionary.data(), _dictionary.size(), _compression_level));
+        if (!_cctx || !_cdict) {
+            throw std::runtime_error("Unable to initialize ZSTD compression context");
+        }
+    }
+    auto ret = ZSTD_compress_usingCDict(_cctx.get(), output, output_len, input, input_len, _cdict.get());
+    if (ZSTD_isError(ret)) {
+        throw std::runtime_error( format("ZSTD compression failure: {}", ZSTD_getErrorName(ret)));
+    }
+    return ret;
 }
 
 static const class_registrator<compressor_ptr, zstd_processor, const compressor::opt_getter&>